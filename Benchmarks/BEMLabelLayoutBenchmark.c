@@ -0,0 +1,147 @@
+//
+//  BEMLabelLayoutBenchmark.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+//  Measures the label layout of a graph with 10,000 candidate labels, without UIKit: measuring the texts through the cache, picking the ticks which don't overlap and placing the popups.
+//  Build and run from this folder, on Linux or macOS:
+//
+//      cc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L -I../Classes BEMLabelLayoutBenchmark.c ../Classes/BEMLabelLayout.c -o label-benchmark
+//      ./label-benchmark
+//
+//  Prints one JSON object per step, with the time spent on every label in nanoseconds.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "BEMLabelLayout.h"
+
+/// The number of candidate labels, one for every point of the graph
+#define BEMBenchmarkLabelCount 10000
+
+/// The duration every measurement runs for, in seconds
+#define BEMBenchmarkDuration 0.25
+
+static double BEMBenchmarkTime(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/// Stands in for the text system: digits are narrower than the other characters
+static bool BEMBenchmarkMeasure(void *context, const char *text, size_t length, float *width, float *height) {
+    (void)context;
+    float textWidth = 0;
+    for (size_t i = 0; i < length; i++) textWidth += (text[i] >= '0' && text[i] <= '9') ? 7.5f : 9.0f;
+    *width = textWidth;
+    *height = 15;
+    return true;
+}
+
+static char texts[BEMBenchmarkLabelCount][16];
+static size_t lengths[BEMBenchmarkLabelCount];
+static BEMLabelBox boxes[BEMBenchmarkLabelCount];
+static BEMLabelBox belowBoxes[BEMBenchmarkLabelCount];
+static size_t selected[BEMBenchmarkLabelCount];
+static bool isBelow[BEMBenchmarkLabelCount];
+
+static void BEMBenchmarkPrint(const char *step, size_t passCount, double elapsed, size_t result) {
+    double nanosecondsPerLabel = elapsed * 1e9 / ((double)passCount * BEMBenchmarkLabelCount);
+    printf("{\"benchmark\": \"labels\", \"step\": \"%s\", \"labels\": %d, \"passes\": %zu, \"nanosecondsPerLabel\": %.2f, \"result\": %zu}\n", step, BEMBenchmarkLabelCount, passCount, nanosecondsPerLabel, result);
+}
+
+int main(void) {
+    // A week of minute labels on a 2000 points wide graph, every text is different
+    const float graphWidth = 2000;
+    const float graphHeight = 400;
+    for (size_t i = 0; i < BEMBenchmarkLabelCount; i++) {
+        lengths[i] = (size_t)snprintf(texts[i], sizeof(texts[i]), "%zu:%02zu", i / 60, i % 60);
+    }
+
+    // Measuring every text for the first time, then from the cache
+    BEMTextMetricsCacheRef cache = BEMTextMetricsCacheCreate(2 * BEMBenchmarkLabelCount);
+    if (cache == NULL) return 1;
+    size_t passCount = 0;
+    double start = BEMBenchmarkTime();
+    double elapsed = 0;
+    do {
+        BEMTextMetricsCacheRemoveAll(cache);
+        for (size_t i = 0; i < BEMBenchmarkLabelCount; i++) {
+            float width, height;
+            BEMTextMetricsCacheMeasure(cache, 1, texts[i], lengths[i], BEMBenchmarkMeasure, NULL, &width, &height);
+        }
+        passCount++;
+        elapsed = BEMBenchmarkTime() - start;
+    } while (elapsed < BEMBenchmarkDuration);
+    BEMBenchmarkPrint("measureUncached", passCount, elapsed, cache->count);
+
+    passCount = 0;
+    start = BEMBenchmarkTime();
+    do {
+        for (size_t i = 0; i < BEMBenchmarkLabelCount; i++) {
+            float width, height;
+            BEMTextMetricsCacheMeasure(cache, 1, texts[i], lengths[i], BEMBenchmarkMeasure, NULL, &width, &height);
+            boxes[i].width = width;
+            boxes[i].height = height;
+            boxes[i].x = graphWidth * i / (BEMBenchmarkLabelCount - 1) - width / 2;
+            boxes[i].y = graphHeight - height;
+        }
+        passCount++;
+        elapsed = BEMBenchmarkTime() - start;
+    } while (elapsed < BEMBenchmarkDuration);
+    BEMBenchmarkPrint("measureCached", passCount, elapsed, cache->count);
+
+    // Picking the ticks in the order of the axis, then in a shuffled order of priority
+    BEMLabelBox bounds = {0, 0, graphWidth, graphHeight};
+    size_t keptCount = 0;
+    passCount = 0;
+    start = BEMBenchmarkTime();
+    do {
+        keptCount = BEMLabelLayoutSelect(boxes, BEMBenchmarkLabelCount, bounds, BEMLabelAxisHorizontal, 2, selected);
+        passCount++;
+        elapsed = BEMBenchmarkTime() - start;
+    } while (elapsed < BEMBenchmarkDuration);
+    BEMBenchmarkPrint("selectTicks", passCount, elapsed, keptCount);
+
+    static BEMLabelBox shuffledBoxes[BEMBenchmarkLabelCount];
+    for (size_t i = 0; i < BEMBenchmarkLabelCount; i++) shuffledBoxes[i] = boxes[i];
+    srand(1);
+    for (size_t i = BEMBenchmarkLabelCount - 1; i > 0; i--) {
+        size_t j = (size_t)rand() % (i + 1);
+        BEMLabelBox box = shuffledBoxes[i];
+        shuffledBoxes[i] = shuffledBoxes[j];
+        shuffledBoxes[j] = box;
+    }
+    passCount = 0;
+    start = BEMBenchmarkTime();
+    do {
+        keptCount = BEMLabelLayoutSelect(shuffledBoxes, BEMBenchmarkLabelCount, bounds, BEMLabelAxisHorizontal, 2, selected);
+        passCount++;
+        elapsed = BEMBenchmarkTime() - start;
+    } while (elapsed < BEMBenchmarkDuration);
+    BEMBenchmarkPrint("selectShuffledTicks", passCount, elapsed, keptCount);
+
+    // A popup above or below every point of a sawtooth
+    for (size_t i = 0; i < BEMBenchmarkLabelCount; i++) {
+        float pointY = graphHeight / 2 + (float)(i % 200) - 100;
+        boxes[i].y = pointY - 15 - boxes[i].height;
+        belowBoxes[i] = boxes[i];
+        belowBoxes[i].y = pointY + 15;
+    }
+    size_t belowCount = 0;
+    passCount = 0;
+    start = BEMBenchmarkTime();
+    do {
+        BEMLabelLayoutPlacePopups(boxes, belowBoxes, BEMBenchmarkLabelCount, 1, isBelow);
+        passCount++;
+        elapsed = BEMBenchmarkTime() - start;
+    } while (elapsed < BEMBenchmarkDuration);
+    for (size_t i = 0; i < BEMBenchmarkLabelCount; i++) belowCount += isBelow[i];
+    BEMBenchmarkPrint("placePopups", passCount, elapsed, belowCount);
+
+    BEMTextMetricsCacheFree(cache);
+    return 0;
+}
@@ -0,0 +1,368 @@
+//
+//  BEMPipelineBenchmark.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+//  Measures every step a reload runs through without UIKit, from 10 to 10,000,000 points: the scale, the straight and curved paths of the line (quadratic, monotone cubic and Catmull-Rom) and its areas, the statistics, the nearest-point lookup, the min/max tree of zoomable graphs, the decimation and the label layout.
+//  Build and run from this folder, on Linux or macOS:
+//
+//      cc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L -I../Classes BEMPipelineBenchmark.c ../Classes/BEMGraphTransform.c ../Classes/BEMGraphLayout.c ../Classes/BEMPointSegments.c ../Classes/BEMPointBuffer.c ../Classes/BEMStatistics.c ../Classes/BEMPointLookup.c ../Classes/BEMRangeTree.c ../Classes/BEMDecimation.c ../Classes/BEMLabelLayout.c -lm -o pipeline-benchmark
+//      ./pipeline-benchmark [maximum number of points]
+//
+//  Prints one JSON object per step and number of points, with the time spent on every point in nanoseconds, the allocations of the first pass and of every following pass, and the peak resident memory of the process.
+//  Every measurement runs in its own child process so that the peak memory is its own. Allocations are counted with glibc only, they are reported as null elsewhere.
+//
+
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "BEMGraphLayout.h"
+#include "BEMGraphTransform.h"
+#include "BEMPointBuffer.h"
+#include "BEMStatistics.h"
+#include "BEMPointLookup.h"
+#include "BEMRangeTree.h"
+#include "BEMDecimation.h"
+#include "BEMLabelLayout.h"
+
+/// The duration every measurement runs for, in seconds. Steps slower than this run once after the first pass.
+#define BEMBenchmarkDuration 0.25
+
+/// Same value as BEMNullGraphValue
+#define BEMBenchmarkNullValue DBL_MAX
+
+/// The size of the graph, in points
+#define BEMBenchmarkWidth 2000.0f
+#define BEMBenchmarkHeight 400.0f
+
+/// The number of touches looked up in every pass of the nearest-point step
+#define BEMBenchmarkTouchCount 1000
+
+/// The number of points the decimation keeps and the number of columns of the envelope, about one per pixel of the graph
+#define BEMBenchmarkDrawnCount 2000
+
+static double BEMBenchmarkTime(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+
+//----- ALLOCATIONS -----//
+
+static size_t allocationCount;
+static size_t allocatedBytes;
+
+#if defined(__GLIBC__)
+#define BEM_COUNTS_ALLOCATIONS 1
+
+// The allocator of the process is replaced by one counting every call before forwarding it to glibc
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void __libc_free(void *pointer);
+
+void *malloc(size_t size) {
+    allocationCount++;
+    allocatedBytes += size;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    allocationCount++;
+    allocatedBytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+    allocationCount++;
+    allocatedBytes += size;
+    return __libc_realloc(pointer, size);
+}
+
+void free(void *pointer) {
+    __libc_free(pointer);
+}
+#else
+#define BEM_COUNTS_ALLOCATIONS 0
+#endif
+
+
+//----- STEPS -----//
+
+/// The data of a graph and the scratch memory the steps reuse from one pass to the next, as the graph does from one reload to the next
+typedef struct BEMBenchmarkInput {
+    size_t count;
+    double *values;
+    BEMGraphScale scale;
+    /// The points of the values, mapped before the steps which start from them
+    BEMPointBufferRef points;
+
+    BEMPointSegmentsRef segments;
+    BEMPathRef line;
+    BEMPathRef area;
+    BEMPointBufferRef keptPoints;
+    size_t *keptIndices;
+    size_t *columnIndices;
+    BEMLabelBox *boxes;
+    BEMLabelBox *belowBoxes;
+    size_t *selected;
+    bool *isBelow;
+} BEMBenchmarkInput;
+
+typedef struct BEMBenchmarkStep {
+    const char *name;
+    /// The range of numbers of points the step is measured with, 0 for no maximum. A graph with fewer points than the minimum doesn't run the step.
+    size_t minimumCount;
+    size_t maximumCount;
+    /// Prepares the input of the step, not measured. Returns false if the memory could not be allocated.
+    bool (*prepare)(BEMBenchmarkInput *input);
+    /// Runs one pass of the step and returns a value depending on its output, so that it can't be optimized away
+    size_t (*run)(BEMBenchmarkInput *input);
+} BEMBenchmarkStep;
+
+static size_t BEMBenchmarkScale(BEMBenchmarkInput *input) {
+    BEMGraphTransform transform = BEMGraphTransformMake(&input->scale, BEMBenchmarkWidth, input->count);
+    BEMGraphTransformPoints(&transform, input->values, input->count, BEMBenchmarkNullValue, 0, input->points->x, input->points->y);
+    input->points->count = input->count;
+    return (size_t)input->points->y[input->count / 2];
+}
+
+/// The stroke of the line, then the areas above and under it, as BEMLine builds them
+static size_t BEMBenchmarkPath(BEMBenchmarkInput *input, BEMCurveInterpolation curve) {
+    if (input->line == NULL) input->line = BEMPathCreate();
+    if (input->area == NULL) input->area = BEMPathCreate();
+    if (input->segments == NULL) input->segments = BEMPointSegmentsCreate();
+    if (input->line == NULL || input->area == NULL || input->segments == NULL) return 0;
+
+    const BEMPointBuffer *points = input->points;
+    if (!BEMPointSegmentsClassify(input->segments, points->y, points->count)) return 0;
+    BEMPathRemoveAllElements(input->line);
+    if (!BEMPathAppendSegments(input->line, points->x, points->y, input->segments, curve, BEMNullValueFillLinear)) return 0;
+    BEMPathRemoveAllElements(input->area);
+    if (!BEMPathAppendArea(input->area, input->line, 0, BEMBenchmarkWidth, 0)) return 0;
+    BEMPathRemoveAllElements(input->area);
+    if (!BEMPathAppendArea(input->area, input->line, 0, BEMBenchmarkWidth, BEMBenchmarkHeight)) return 0;
+    return input->line->elementCount + input->area->elementCount;
+}
+
+static size_t BEMBenchmarkLinePath(BEMBenchmarkInput *input) {
+    return BEMBenchmarkPath(input, BEMCurveInterpolationNone);
+}
+
+static size_t BEMBenchmarkCurvedPath(BEMBenchmarkInput *input) {
+    return BEMBenchmarkPath(input, BEMCurveInterpolationQuadratic);
+}
+
+static size_t BEMBenchmarkMonotonePath(BEMBenchmarkInput *input) {
+    return BEMBenchmarkPath(input, BEMCurveInterpolationMonotoneCubic);
+}
+
+static size_t BEMBenchmarkCatmullRomPath(BEMBenchmarkInput *input) {
+    return BEMBenchmarkPath(input, BEMCurveInterpolationCatmullRom);
+}
+
+static size_t BEMBenchmarkStatistics(BEMBenchmarkInput *input) {
+    BEMStatistics statistics;
+    if (!BEMStatisticsCompute(input->values, input->count, BEMBenchmarkNullValue, &statistics)) return 0;
+    return statistics.count + (size_t)statistics.median;
+}
+
+/// Building the lookup of a reload, then following a finger across the graph
+static size_t BEMBenchmarkNearestPoint(BEMBenchmarkInput *input) {
+    BEMPointLookupRef lookup = BEMPointLookupCreate(input->points);
+    if (lookup == NULL) return 0;
+    size_t sum = 0;
+    for (size_t i = 0; i < BEMBenchmarkTouchCount; i++) {
+        sum += BEMPointLookupFindClosest(lookup, BEMBenchmarkWidth * i / BEMBenchmarkTouchCount);
+    }
+    BEMPointLookupFree(lookup);
+    return sum;
+}
+
+/// Building the tree of a zoomable graph, then reading the envelope of the whole range
+static size_t BEMBenchmarkRangeTree(BEMBenchmarkInput *input) {
+    if (input->columnIndices == NULL) input->columnIndices = malloc(sizeof(size_t) * 2 * BEMBenchmarkDrawnCount);
+    BEMRangeTreeRef tree = BEMRangeTreeCreate(input->values, input->count, BEMBenchmarkNullValue);
+    if (tree == NULL || input->columnIndices == NULL) {
+        BEMRangeTreeFree(tree);
+        return 0;
+    }
+    size_t envelopeCount = BEMRangeTreeEnvelope(tree, 0, input->count, BEMBenchmarkDrawnCount, input->columnIndices);
+    BEMRangeTreeFree(tree);
+    return envelopeCount;
+}
+
+static size_t BEMBenchmarkDecimation(BEMBenchmarkInput *input) {
+    if (input->keptPoints == NULL) input->keptPoints = BEMPointBufferCreate(BEMBenchmarkDrawnCount);
+    if (input->keptIndices == NULL) input->keptIndices = malloc(sizeof(size_t) * BEMBenchmarkDrawnCount);
+    if (input->keptPoints == NULL || input->keptIndices == NULL) return 0;
+    return BEMDecimateLargestTriangleThreeBuckets(input->points, BEMBenchmarkDrawnCount, input->keptPoints, input->keptIndices);
+}
+
+/// A label under every point, picked for the X-Axis
+static bool BEMBenchmarkPrepareLabels(BEMBenchmarkInput *input) {
+    input->boxes = malloc(sizeof(BEMLabelBox) * input->count);
+    input->selected = malloc(sizeof(size_t) * input->count);
+    if (input->boxes == NULL || input->selected == NULL) return false;
+    for (size_t i = 0; i < input->count; i++) {
+        input->boxes[i] = (BEMLabelBox){input->points->x[i] - 20, BEMBenchmarkHeight - 15, 40, 15};
+    }
+    return true;
+}
+
+static size_t BEMBenchmarkLabels(BEMBenchmarkInput *input) {
+    BEMLabelBox bounds = {0, 0, BEMBenchmarkWidth, BEMBenchmarkHeight};
+    return BEMLabelLayoutSelect(input->boxes, input->count, bounds, BEMLabelAxisHorizontal, 2, input->selected);
+}
+
+/// A permanent popup above or below every point
+static bool BEMBenchmarkPreparePopups(BEMBenchmarkInput *input) {
+    input->boxes = malloc(sizeof(BEMLabelBox) * input->count);
+    input->belowBoxes = malloc(sizeof(BEMLabelBox) * input->count);
+    input->isBelow = malloc(sizeof(bool) * input->count);
+    if (input->boxes == NULL || input->belowBoxes == NULL || input->isBelow == NULL) return false;
+    for (size_t i = 0; i < input->count; i++) {
+        float pointX = input->points->x[i];
+        float pointY = isnan(input->points->y[i]) ? BEMBenchmarkHeight / 2 : input->points->y[i];
+        input->boxes[i] = (BEMLabelBox){pointX - 20, pointY - 30, 40, 15};
+        input->belowBoxes[i] = (BEMLabelBox){pointX - 20, pointY + 15, 40, 15};
+    }
+    return true;
+}
+
+static size_t BEMBenchmarkPopups(BEMBenchmarkInput *input) {
+    if (!BEMLabelLayoutPlacePopups(input->boxes, input->belowBoxes, input->count, 1, input->isBelow)) return 0;
+    size_t belowCount = 0;
+    for (size_t i = 0; i < input->count; i++) belowCount += input->isBelow[i];
+    return belowCount;
+}
+
+static const BEMBenchmarkStep steps[] = {
+    {"scale", 0, 0, NULL, BEMBenchmarkScale},
+    {"linePath", 0, 0, NULL, BEMBenchmarkLinePath},
+    {"curvedPath", 0, 0, NULL, BEMBenchmarkCurvedPath},
+    {"monotonePath", 0, 0, NULL, BEMBenchmarkMonotonePath},
+    {"catmullRomPath", 0, 0, NULL, BEMBenchmarkCatmullRomPath},
+    {"statistics", 0, 0, NULL, BEMBenchmarkStatistics},
+    {"nearestPoint", 0, 0, NULL, BEMBenchmarkNearestPoint},
+    {"rangeTree", 0, 0, NULL, BEMBenchmarkRangeTree},
+    {"decimation", BEMBenchmarkDrawnCount + 1, 0, NULL, BEMBenchmarkDecimation},
+    {"labels", 0, 0, BEMBenchmarkPrepareLabels, BEMBenchmarkLabels},
+    // Popups avoid each other by comparing every popup with the ones already placed near it, nobody displays this many
+    {"popups", 0, 100000, BEMBenchmarkPreparePopups, BEMBenchmarkPopups},
+};
+
+
+//----- MEASUREMENT -----//
+
+/// A random walk with a missing value every 97 points
+static bool BEMBenchmarkPrepareInput(BEMBenchmarkInput *input, size_t count) {
+    memset(input, 0, sizeof(BEMBenchmarkInput));
+    input->count = count;
+    input->values = malloc(sizeof(double) * count);
+    input->points = BEMPointBufferCreate(count);
+    if (input->values == NULL || input->points == NULL || !BEMPointBufferReserve(input->points, count)) return false;
+
+    srand(1);
+    double value = 0;
+    double minimumValue = DBL_MAX;
+    double maximumValue = -DBL_MAX;
+    for (size_t i = 0; i < count; i++) {
+        value += (double)rand() / RAND_MAX - 0.5;
+        input->values[i] = (i % 97 == 96) ? BEMBenchmarkNullValue : value;
+        if (input->values[i] == BEMBenchmarkNullValue) continue;
+        if (value < minimumValue) minimumValue = value;
+        if (value > maximumValue) maximumValue = value;
+    }
+    input->scale = (BEMGraphScale){minimumValue, maximumValue, BEMBenchmarkHeight, BEMGraphScaleDefaultPadding(BEMBenchmarkHeight), 15, true};
+    BEMBenchmarkScale(input);
+    return true;
+}
+
+/// Returns the peak resident memory of the process, in kilobytes
+static long BEMBenchmarkPeakMemory(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+/// Measures one step with \p count points and prints its results. Runs in a child process, the memory is left to the system.
+static int BEMBenchmarkMeasure(const BEMBenchmarkStep *step, size_t count) {
+    BEMBenchmarkInput input;
+    if (!BEMBenchmarkPrepareInput(&input, count)) return 1;
+    if (step->prepare && !step->prepare(&input)) return 1;
+
+    // The first pass allocates the scratch memory the next ones reuse, its allocations are reported separately
+    size_t firstAllocationCount = allocationCount;
+    size_t firstAllocatedBytes = allocatedBytes;
+    double start = BEMBenchmarkTime();
+    size_t result = step->run(&input);
+    double firstElapsed = BEMBenchmarkTime() - start;
+    firstAllocationCount = allocationCount - firstAllocationCount;
+    firstAllocatedBytes = allocatedBytes - firstAllocatedBytes;
+
+    size_t passAllocationCount = allocationCount;
+    size_t passAllocatedBytes = allocatedBytes;
+    size_t passCount = 0;
+    double elapsed = 0;
+    start = BEMBenchmarkTime();
+    do {
+        result = step->run(&input);
+        passCount++;
+        elapsed = BEMBenchmarkTime() - start;
+    } while (elapsed < BEMBenchmarkDuration);
+    passAllocationCount = allocationCount - passAllocationCount;
+    passAllocatedBytes = allocatedBytes - passAllocatedBytes;
+
+    double nanosecondsPerPoint = elapsed * 1e9 / ((double)passCount * count);
+    double firstNanosecondsPerPoint = firstElapsed * 1e9 / count;
+    printf("{\"benchmark\": \"pipeline\", \"step\": \"%s\", \"points\": %zu, \"passes\": %zu, \"nanosecondsPerPoint\": %.3f, \"firstPassNanosecondsPerPoint\": %.3f, ", step->name, count, passCount, nanosecondsPerPoint, firstNanosecondsPerPoint);
+    if (BEM_COUNTS_ALLOCATIONS) {
+        printf("\"firstPassAllocations\": %zu, \"firstPassBytes\": %zu, \"allocationsPerPass\": %.2f, \"bytesPerPass\": %.0f, ", firstAllocationCount, firstAllocatedBytes, (double)passAllocationCount / passCount, (double)passAllocatedBytes / passCount);
+    } else {
+        printf("\"firstPassAllocations\": null, \"firstPassBytes\": null, \"allocationsPerPass\": null, \"bytesPerPass\": null, ");
+    }
+    printf("\"peakMemoryKilobytes\": %ld, \"result\": %zu}\n", BEMBenchmarkPeakMemory(), result);
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t maximumCount = 10000000;
+    if (argc > 1) maximumCount = strtoul(argv[1], NULL, 10);
+
+    int status = 0;
+    for (size_t count = 10; count <= maximumCount; count *= 10) {
+        for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+            const BEMBenchmarkStep *step = &steps[s];
+            if (count < step->minimumCount || (step->maximumCount > 0 && count > step->maximumCount)) continue;
+
+            fflush(stdout);
+            pid_t child = fork();
+            if (child < 0) return 1;
+            if (child == 0) _exit(BEMBenchmarkMeasure(step, count));
+
+            int childStatus = 0;
+            if (waitpid(child, &childStatus, 0) < 0 || !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0) {
+                fprintf(stderr, "%s with %zu points failed\n", step->name, count);
+                status = 1;
+            }
+        }
+    }
+    return status;
+}
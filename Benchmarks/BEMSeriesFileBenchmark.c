@@ -0,0 +1,114 @@
+//
+//  BEMSeriesFileBenchmark.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+//  Measures how long a series file takes to load compared to reading the values into memory and building their tree, without UIKit.
+//  Build and run from this folder, on Linux or macOS:
+//
+//      cc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L -I../Classes BEMSeriesFileBenchmark.c ../Classes/BEMSeriesFile.c ../Classes/BEMRangeTree.c -lm -o series-file-benchmark
+//      ./series-file-benchmark [number of points] [path of the file]
+//
+//  Writes 100 million points by default, 800 MB, to a file in the temporary folder which is removed at the end.
+//  Prints one JSON object per measurement, with its duration in milliseconds. The file is in the page cache when it is loaded: the copy is then bound by memory bandwidth, while mapping it doesn't depend on its size.
+//
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "BEMSeriesFile.h"
+
+/// The duration every measurement runs for, in seconds
+#define BEMBenchmarkDuration 0.25
+
+/// The number of columns of the envelopes, the width of a phone screen
+#define BEMBenchmarkColumnCount 375
+
+static double BEMBenchmarkTime(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static void BEMBenchmarkPrint(const char *measurement, size_t count, double seconds) {
+    printf("{\"benchmark\": \"seriesFile\", \"measurement\": \"%s\", \"points\": %zu, \"milliseconds\": %.4f}\n", measurement, count, seconds * 1e3);
+}
+
+/// Loads the values the way a graph without series files does: into memory, then builds their tree
+static bool BEMBenchmarkCopyFile(const char *path, size_t count) {
+    FILE *stream = fopen(path, "rb");
+    double *values = malloc(sizeof(double) * (count > 0 ? count : 1));
+    bool didRead = stream && values && fseek(stream, sizeof(BEMSeriesFileHeader), SEEK_SET) == 0 && fread(values, sizeof(double), count, stream) == count;
+    BEMRangeTreeRef tree = didRead ? BEMRangeTreeCreate(values, count, BEMSeriesFileNullValue) : NULL;
+    BEMRangeTreeFree(tree);
+    free(values);
+    if (stream) fclose(stream);
+    return didRead;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000000;
+    char defaultPath[1024];
+    const char *temporaryFolder = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    snprintf(defaultPath, sizeof(defaultPath), "%s/series-file-benchmark.bemgraph", temporaryFolder);
+    const char *path = argc > 2 ? argv[2] : defaultPath;
+
+    // A noisy sine with a missing point every 64 values
+    double *values = malloc(sizeof(double) * (count > 0 ? count : 1));
+    if (values == NULL) return 1;
+    for (size_t i = 0; i < count; i++) values[i] = i % 64 == 63 ? DBL_MAX : sin(i * 0.0001) * 100 + (double)(i % 7);
+
+    double start = BEMBenchmarkTime();
+    if (!BEMSeriesFileWrite(path, values, count, DBL_MAX, true)) {
+        perror("BEMSeriesFileWrite");
+        return 1;
+    }
+    BEMBenchmarkPrint("write", count, BEMBenchmarkTime() - start);
+    free(values);
+
+    // Opening and closing, as many times as fit in the duration
+    size_t passCount = 0;
+    double elapsed = 0;
+    start = BEMBenchmarkTime();
+    do {
+        BEMSeriesFileRef file = BEMSeriesFileOpen(path);
+        if (file == NULL) {
+            perror("BEMSeriesFileOpen");
+            return 1;
+        }
+        BEMSeriesFileClose(file);
+        passCount++;
+        elapsed = BEMBenchmarkTime() - start;
+    } while (elapsed < BEMBenchmarkDuration);
+    BEMBenchmarkPrint("open", count, elapsed / passCount);
+
+    // What a graph reads to draw the whole series just after opening it: the extremes, then the envelope from the stored tree
+    size_t *indices = malloc(sizeof(size_t) * 2 * BEMBenchmarkColumnCount);
+    if (indices == NULL) return 1;
+    start = BEMBenchmarkTime();
+    BEMSeriesFileRef file = BEMSeriesFileOpen(path);
+    size_t keptCount = file ? BEMRangeTreeEnvelope(file->tree, 0, count, BEMBenchmarkColumnCount, indices) : 0;
+    double checksum = 0;
+    for (size_t i = 0; i < keptCount; i++) checksum += file->values[indices[i]];
+    BEMBenchmarkPrint("openAndFirstEnvelope", count, BEMBenchmarkTime() - start);
+    if (file == NULL || !isfinite(checksum)) return 1;
+
+    start = BEMBenchmarkTime();
+    bool isValid = BEMSeriesFileVerify(file);
+    BEMBenchmarkPrint("verify", count, BEMBenchmarkTime() - start);
+    BEMSeriesFileClose(file);
+    if (!isValid) return 1;
+    free(indices);
+
+    start = BEMBenchmarkTime();
+    if (!BEMBenchmarkCopyFile(path, count)) return 1;
+    BEMBenchmarkPrint("copyAndBuildTree", count, BEMBenchmarkTime() - start);
+
+    remove(path);
+    return 0;
+}
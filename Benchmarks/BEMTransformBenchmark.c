@@ -0,0 +1,80 @@
+//
+//  BEMTransformBenchmark.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+//  Measures how fast every transform kernel available on this machine maps values to points, without UIKit.
+//  Build and run from this folder, on Linux or macOS:
+//
+//      cc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L -I../Classes BEMTransformBenchmark.c ../Classes/BEMGraphTransform.c ../Classes/BEMGraphLayout.c ../Classes/BEMPointBuffer.c -lm -o transform-benchmark
+//      ./transform-benchmark
+//
+//  Prints one JSON object per kernel and point count, with the throughput in points per nanosecond.
+//
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "BEMGraphTransform.h"
+
+/// The duration every measurement runs for, in seconds
+#define BEMBenchmarkDuration 0.25
+
+static double BEMBenchmarkTime(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+int main(void) {
+    // From points which stay in the L1 cache to points which stream from memory
+    const size_t pointCounts[] = {1000, 100000, 10000000};
+    const BEMGraphTransformKernel kernels[] = {BEMGraphTransformKernelScalar, BEMGraphTransformKernelSSE2, BEMGraphTransformKernelAVX, BEMGraphTransformKernelNEON};
+
+    for (size_t c = 0; c < sizeof(pointCounts) / sizeof(pointCounts[0]); c++) {
+        size_t count = pointCounts[c];
+        double *values = malloc(sizeof(double) * count);
+        float *x = malloc(sizeof(float) * count);
+        float *y = malloc(sizeof(float) * count);
+        if (values == NULL || x == NULL || y == NULL) return 1;
+
+        // A noisy sine with a missing point every 64 values
+        for (size_t i = 0; i < count; i++) values[i] = i % 64 == 63 ? DBL_MAX : sin(i * 0.01) * 100 + (double)(i % 7);
+
+        BEMGraphScale scale = {0};
+        scale.minimumValue = -100;
+        scale.maximumValue = 106;
+        scale.height = 300;
+        scale.padding = BEMGraphScaleDefaultPadding(scale.height);
+        scale.xAxisLabelHeight = 20;
+        scale.autoScale = true;
+        BEMGraphTransform transform = BEMGraphTransformMake(&scale, 1000, count);
+
+        for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+            if (!BEMGraphTransformKernelIsAvailable(kernels[k])) continue;
+
+            // One pass to warm up the caches, then as many passes as fit in the duration
+            BEMGraphTransformPointsWithKernel(kernels[k], &transform, values, count, DBL_MAX, 0, x, y);
+            size_t passCount = 0;
+            double start = BEMBenchmarkTime();
+            double elapsed = 0;
+            do {
+                BEMGraphTransformPointsWithKernel(kernels[k], &transform, values, count, DBL_MAX, 0, x, y);
+                passCount++;
+                elapsed = BEMBenchmarkTime() - start;
+            } while (elapsed < BEMBenchmarkDuration);
+
+            double pointsPerNanosecond = (double)count * passCount / (elapsed * 1e9);
+            printf("{\"benchmark\": \"transform\", \"kernel\": \"%s\", \"points\": %zu, \"passes\": %zu, \"pointsPerNanosecond\": %.4f}\n", BEMGraphTransformKernelName(kernels[k]), count, passCount, pointsPerNanosecond);
+        }
+
+        free(values);
+        free(x);
+        free(y);
+    }
+    return 0;
+}
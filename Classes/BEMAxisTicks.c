@@ -0,0 +1,55 @@
+//
+//  BEMAxisTicks.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMAxisTicks.h"
+
+#include <math.h>
+
+double BEMAxisNiceNumber(double value, bool round) {
+    if (!(value > 0) || isinf(value)) return value;
+
+    double exponent = floor(log10(value));
+    double power = pow(10, exponent);
+    double fraction = value / power;
+    double niceFraction;
+    if (round) {
+        if (fraction < 1.5) niceFraction = 1;
+        else if (fraction < 3) niceFraction = 2;
+        else if (fraction < 7) niceFraction = 5;
+        else niceFraction = 10;
+    } else {
+        if (fraction <= 1) niceFraction = 1;
+        else if (fraction <= 2) niceFraction = 2;
+        else if (fraction <= 5) niceFraction = 5;
+        else niceFraction = 10;
+    }
+    return niceFraction * power;
+}
+
+bool BEMAxisTicksMake(double minimum, double maximum, size_t targetCount, double minimumStep, BEMAxisTicks *ticks) {
+    if (!isfinite(minimum) || !isfinite(maximum) || minimum > maximum) return false;
+
+    // The extremes themselves when there is nothing to divide
+    ticks->first = minimum;
+    ticks->step = maximum - minimum;
+    ticks->count = minimum == maximum ? 1 : 2;
+    if (minimum == maximum) return true;
+
+    if (targetCount < 2) targetCount = 2;
+    double range = BEMAxisNiceNumber(maximum - minimum, false);
+    double step = BEMAxisNiceNumber(range / (double)(targetCount - 1), true);
+    if (step < minimumStep) step = minimumStep;
+
+    double firstMultiple = ceil(minimum / step);
+    double lastMultiple = floor(maximum / step);
+    if (!(lastMultiple >= firstMultiple)) return true;
+
+    ticks->first = firstMultiple * step;
+    ticks->step = step;
+    ticks->count = (size_t)(lastMultiple - firstMultiple) + 1;
+    return true;
+}
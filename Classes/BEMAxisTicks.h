@@ -0,0 +1,47 @@
+//
+//  BEMAxisTicks.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMAxisTicks_h
+#define BEMAxisTicks_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Evenly spaced ticks on round values, for the labels of an axis.
+ @discussion The step is 1, 2 or 5 times a power of 10, and every tick is a multiple of the step, so the labels read 0, 25, 50 or 0.2, 0.4, 0.6 rather than the raw extremes of the data and the values linearly between them. */
+typedef struct BEMAxisTicks {
+    /// The value of the first tick
+    double first;
+    /// The distance between two ticks
+    double step;
+    /// The number of ticks
+    size_t count;
+} BEMAxisTicks;
+
+/** Rounds \p value to 1, 2, 5 or 10 times a power of 10, the "nice numbers" of Heckbert's labeling algorithm.
+ @param round If true, the closest nice number is returned. Otherwise the smallest nice number at least as big as \p value. */
+double BEMAxisNiceNumber(double value, bool round);
+
+/** Picks about \p targetCount ticks on round values between \p minimum and \p maximum, both included.
+ @discussion The range is rounded to a nice number and divided in \p targetCount - 1 steps, themselves rounded to a nice number, then the ticks are the multiples of the step within the range. The step is never smaller than \p minimumStep, so values formatted with a fixed number of decimals don't repeat: pass 1 for integers, 0.01 for two decimals, or 0 for no limit. When the extremes are equal, or no multiple of the step falls between them, the ticks are the extremes themselves.
+ @return false if the extremes are not finite or \p minimum is bigger than \p maximum. */
+bool BEMAxisTicksMake(double minimum, double maximum, size_t targetCount, double minimumStep, BEMAxisTicks *ticks);
+
+/// The value of the tick at \p index, computed from its index so the ticks don't accumulate rounding errors
+static inline double BEMAxisTickValue(const BEMAxisTicks *ticks, size_t index) {
+    return ticks->first + (double)index * ticks->step;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+//
+//  BEMBatchRenderer.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMBatchRenderer.h"
+
+#include <float.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/// Number of series taken at once from a share, small enough to balance the threads and big enough to keep them from contending
+#define BEMBatchGroupSize 8
+
+#define BEMBatchCacheLineSize 64
+
+/// The series left to a thread, taken by the thread itself and then by the others. The shares are allocated on a cache line boundary and padded to a whole line, so the threads taking from different shares don't contend.
+typedef struct BEMBatchShare {
+    /// The next series of the share
+    atomic_size_t next;
+    /// The end of the share
+    size_t end;
+    char padding[BEMBatchCacheLineSize - sizeof(atomic_size_t) - sizeof(size_t)];
+} BEMBatchShare;
+
+struct BEMBatchJob;
+
+/// A rendering thread and everything it owns
+typedef struct BEMBatchWorker {
+    size_t index;
+    const struct BEMBatchJob *job;
+    pthread_t thread;
+    bool isStarted;
+
+    /// Scratch memory, allocated by the thread for the whole batch
+    BEMGraphRendererRef renderer;
+    BEMRasterCanvasRef canvas;
+    uint8_t *pixels;
+    uint8_t *image;
+    size_t imageCapacity;
+
+    size_t imageCount;
+    size_t failedCount;
+    size_t stolenCount;
+    double layoutTime;
+    double rasterizationTime;
+    double encodingTime;
+} BEMBatchWorker;
+
+typedef struct BEMBatchJob {
+    const BEMBatchSeries *series;
+    const BEMBatchOptions *options;
+    BEMBatchWorker *workers;
+    BEMBatchShare *shares;
+    size_t workerCount;
+} BEMBatchJob;
+
+static double BEMBatchTime(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+BEMBatchOptions BEMBatchOptionsDefault(size_t width, size_t height) {
+    BEMBatchOptions options;
+    memset(&options, 0, sizeof(options));
+    options.width = width;
+    options.height = height;
+    options.style = BEMGraphStyleDefault();
+    // BEMNullGraphValue on 64-bit platforms
+    options.nullValue = DBL_MAX;
+    options.format = BEMBatchFormatPNG;
+    return options;
+}
+
+static bool BEMBatchWorkerAllocate(BEMBatchWorker *worker) {
+    const BEMBatchOptions *options = worker->job->options;
+    worker->imageCapacity = options->format == BEMBatchFormatPNG ? BEMRasterPNGSize(options->width, options->height) : BEMRasterPPMSize(options->width, options->height);
+    worker->pixels = malloc(options->width * options->height * 4);
+    worker->image = malloc(worker->imageCapacity);
+    worker->canvas = BEMRasterCanvasCreate(worker->pixels, options->width, options->height, options->width * 4);
+    worker->renderer = BEMGraphRendererCreate();
+    return worker->pixels && worker->image && worker->canvas && worker->renderer;
+}
+
+static void BEMBatchWorkerFree(BEMBatchWorker *worker) {
+    BEMGraphRendererFree(worker->renderer);
+    BEMRasterCanvasFree(worker->canvas);
+    free(worker->pixels);
+    free(worker->image);
+}
+
+static void BEMBatchWorkerRender(BEMBatchWorker *worker, size_t index) {
+    const BEMBatchOptions *options = worker->job->options;
+    const BEMBatchSeries *series = &worker->job->series[index];
+
+    double start = BEMBatchTime();
+    bool isRendered = BEMGraphRendererLayout(worker->renderer, series->values, series->count, options->nullValue, &options->style, options->width, options->height);
+    double laidOut = BEMBatchTime();
+    isRendered = isRendered && BEMGraphRendererDraw(worker->renderer, &options->style, worker->canvas);
+    double rasterized = BEMBatchTime();
+    size_t size = 0;
+    if (isRendered) {
+        if (options->format == BEMBatchFormatPNG) size = BEMRasterEncodePNG(worker->canvas, worker->image, worker->imageCapacity);
+        else size = BEMRasterEncodePPM(worker->canvas, worker->image, worker->imageCapacity);
+    }
+    double encoded = BEMBatchTime();
+
+    worker->layoutTime += laidOut - start;
+    worker->rasterizationTime += rasterized - laidOut;
+    worker->encodingTime += encoded - rasterized;
+    if (size == 0) {
+        worker->failedCount++;
+        return;
+    }
+    worker->imageCount++;
+    if (options->output) options->output(options->context, index, worker->image, size);
+}
+
+static void *BEMBatchWorkerRun(void *argument) {
+    BEMBatchWorker *worker = argument;
+    const BEMBatchJob *job = worker->job;
+
+    // A thread which couldn't get its memory leaves its share to the others
+    if (!BEMBatchWorkerAllocate(worker)) {
+        BEMBatchWorkerFree(worker);
+        return NULL;
+    }
+
+    // The thread's own share first, then the shares of the following threads
+    for (size_t offset = 0; offset < job->workerCount; offset++) {
+        BEMBatchShare *share = &job->shares[(worker->index + offset) % job->workerCount];
+        while (true) {
+            size_t first = atomic_fetch_add_explicit(&share->next, BEMBatchGroupSize, memory_order_relaxed);
+            if (first >= share->end) break;
+            if (offset > 0) worker->stolenCount++;
+
+            size_t last = first + BEMBatchGroupSize < share->end ? first + BEMBatchGroupSize : share->end;
+            for (size_t i = first; i < last; i++) BEMBatchWorkerRender(worker, i);
+        }
+    }
+
+    BEMBatchWorkerFree(worker);
+    return NULL;
+}
+
+bool BEMBatchRender(const BEMBatchSeries *series, size_t count, const BEMBatchOptions *options, BEMBatchStatistics *statistics) {
+    double start = BEMBatchTime();
+
+    size_t workerCount = options->threadCount;
+    if (workerCount == 0) {
+        long coreCount = sysconf(_SC_NPROCESSORS_ONLN);
+        workerCount = coreCount > 0 ? (size_t)coreCount : 1;
+    }
+    size_t groupCount = (count + BEMBatchGroupSize - 1) / BEMBatchGroupSize;
+    if (workerCount > groupCount) workerCount = groupCount > 0 ? groupCount : 1;
+
+    BEMBatchWorker *workers = calloc(workerCount, sizeof(BEMBatchWorker));
+    BEMBatchShare *shares = NULL;
+    if (!workers || posix_memalign((void **)&shares, BEMBatchCacheLineSize, sizeof(BEMBatchShare) * workerCount) != 0) {
+        free(workers);
+        return false;
+    }
+
+    BEMBatchJob job = {series, options, workers, shares, workerCount};
+    for (size_t i = 0; i < workerCount; i++) {
+        workers[i].index = i;
+        workers[i].job = &job;
+        atomic_init(&shares[i].next, count * i / workerCount);
+        shares[i].end = count * (i + 1) / workerCount;
+    }
+
+    // The calling thread is the first worker, so the batch always makes progress
+    for (size_t i = 1; i < workerCount; i++) {
+        workers[i].isStarted = pthread_create(&workers[i].thread, NULL, BEMBatchWorkerRun, &workers[i]) == 0;
+    }
+    BEMBatchWorkerRun(&workers[0]);
+
+    BEMBatchStatistics result;
+    memset(&result, 0, sizeof(result));
+    for (size_t i = 0; i < workerCount; i++) {
+        if (i > 0 && workers[i].isStarted) pthread_join(workers[i].thread, NULL);
+        if (workers[i].imageCount + workers[i].failedCount > 0) result.threadCount++;
+        result.imageCount += workers[i].imageCount;
+        result.stolenCount += workers[i].stolenCount;
+        result.layoutTime += workers[i].layoutTime;
+        result.rasterizationTime += workers[i].rasterizationTime;
+        result.encodingTime += workers[i].encodingTime;
+    }
+    free(workers);
+    free(shares);
+
+    // Series left by threads which couldn't get their memory are failures too
+    result.failedCount = count - result.imageCount;
+    result.elapsedTime = BEMBatchTime() - start;
+    result.imagesPerSecond = result.elapsedTime > 0 ? result.imageCount / result.elapsedTime : 0;
+    if (statistics) *statistics = result;
+    return true;
+}
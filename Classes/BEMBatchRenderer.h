@@ -0,0 +1,91 @@
+//
+//  BEMBatchRenderer.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMBatchRenderer_h
+#define BEMBatchRenderer_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "BEMGraphRenderer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The values of one graph of a batch
+typedef struct BEMBatchSeries {
+    const double *values;
+    size_t count;
+} BEMBatchSeries;
+
+/// The file format of the images of a batch
+typedef enum BEMBatchFormat {
+    /// RGBA PNG images, see \p BEMRasterEncodePNG
+    BEMBatchFormatPNG,
+    /// Binary PPM images, see \p BEMRasterEncodePPM
+    BEMBatchFormatPPM
+} BEMBatchFormat;
+
+/** Receives the image of the series at \p index. Called on the rendering threads, possibly at the same time for different images.
+ @discussion \p bytes belongs to the rendering thread and is only valid during the call: copy or write the image before returning. */
+typedef void (*BEMBatchOutputFunction)(void *context, size_t index, const uint8_t *bytes, size_t size);
+
+/// How a batch is rendered
+typedef struct BEMBatchOptions {
+    /// The size of every image, in pixels
+    size_t width;
+    size_t height;
+    /// The appearance shared by every graph
+    BEMGraphStyle style;
+    /// The value of missing points, BEMNullGraphValue by default
+    double nullValue;
+    BEMBatchFormat format;
+    /// The number of rendering threads. 0 to use one thread per core.
+    size_t threadCount;
+    /// Receives every image, with \p context
+    BEMBatchOutputFunction output;
+    void *context;
+} BEMBatchOptions;
+
+/// What a batch did and where the time went
+typedef struct BEMBatchStatistics {
+    /// The number of images passed to the output function
+    size_t imageCount;
+    /// The number of series which could not be rendered because memory could not be allocated
+    size_t failedCount;
+    /// The number of threads which rendered images
+    size_t threadCount;
+    /// The number of groups of series a thread took from another thread's share after finishing its own
+    size_t stolenCount;
+    /// Wall-clock duration of the batch, in seconds
+    double elapsedTime;
+    /// \p imageCount divided by \p elapsedTime
+    double imagesPerSecond;
+    /// Time spent in every stage, in seconds, summed over the threads
+    double layoutTime;
+    double rasterizationTime;
+    double encodingTime;
+} BEMBatchStatistics;
+
+/// Options to render PNG images of \p width by \p height pixels with the default style on every core
+BEMBatchOptions BEMBatchOptionsDefault(size_t width, size_t height);
+
+/** Renders one image per series on a pool of threads.
+ @discussion Every thread starts with an even share of the series and takes small groups of series from the threads which still have some once it's done, so a few long series don't leave the other cores idle. Every thread owns its canvas, renderer and image buffer, which are allocated once for the whole batch: rendering doesn't allocate, and threads never share memory they write to.
+
+ The layout and rasterization are done by \p BEMGraphRenderer, with the same geometry as \p BEMSimpleLineGraphView.
+ @param statistics Filled with the statistics of the batch. Can be NULL.
+ @return false if the workers could not be allocated, in which case no image was rendered. A thread which can't be started leaves its series to the other threads, the calling thread included, so the batch still completes. */
+bool BEMBatchRender(const BEMBatchSeries *series, size_t count, const BEMBatchOptions *options, BEMBatchStatistics *statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -16,10 +16,17 @@
     if (self) {
         // Initialization code
         self.backgroundColor = [UIColor clearColor];
+        // Reused dots are drawn again when their size changes
+        self.contentMode = UIViewContentModeRedraw;
     }
     return self;
 }
 
+- (void)setPointcolor:(UIColor *)Pointcolor {
+    _Pointcolor = Pointcolor;
+    [self setNeedsDisplay];
+}
+
 - (void)drawRect:(CGRect)rect {
     CGContextRef ctx = UIGraphicsGetCurrentContext();
     CGContextAddEllipseInRect(ctx, rect);
@@ -0,0 +1,148 @@
+//
+//  BEMDecimation.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMDecimation.h"
+
+#include <math.h>
+
+static inline void BEMDecimationKeepPoint(const BEMPointBuffer *source, size_t index, BEMPointBufferRef destination, size_t *indices) {
+    indices[destination->count] = index;
+    destination->x[destination->count] = source->x[index];
+    destination->y[destination->count] = source->y[index];
+    destination->count++;
+}
+
+/// Copies every point when there is nothing to reduce, and the ends of the series when the threshold leaves no point between them. Returns false if \p destination must still be filled.
+static bool BEMDecimationPrepare(const BEMPointBuffer *source, size_t threshold, BEMPointBufferRef destination, size_t *indices, size_t *keptCount) {
+    BEMPointBufferRemoveAllPoints(destination);
+    size_t capacity = source->count < threshold ? source->count : threshold;
+    if (!BEMPointBufferReserve(destination, capacity)) {
+        *keptCount = 0;
+        return true;
+    }
+
+    if (source->count <= threshold) {
+        for (size_t i = 0; i < capacity; i++) BEMDecimationKeepPoint(source, i, destination, indices);
+        *keptCount = destination->count;
+        return true;
+    }
+    if (threshold < 3) {
+        // Too few points for a bucket between the ends: the line still spans the whole series
+        if (threshold > 0) BEMDecimationKeepPoint(source, 0, destination, indices);
+        if (threshold > 1) BEMDecimationKeepPoint(source, source->count - 1, destination, indices);
+        *keptCount = destination->count;
+        return true;
+    }
+    return false;
+}
+
+size_t BEMDecimateLargestTriangleThreeBuckets(const BEMPointBuffer *source, size_t threshold, BEMPointBufferRef destination, size_t *indices) {
+    size_t keptCount;
+    if (BEMDecimationPrepare(source, threshold, destination, indices, &keptCount)) return keptCount;
+
+    const float *x = source->x;
+    const float *y = source->y;
+    size_t count = source->count;
+
+    // The first and last points are always kept, the points in between are split into buckets
+    double bucketSize = (double)(count - 2) / (threshold - 2);
+
+    BEMDecimationKeepPoint(source, 0, destination, indices);
+    double previousX = x[0];
+    double previousY = y[0];
+    bool hasPrevious = !BEMPointBufferIsNull(y[0]);
+
+    for (size_t bucket = 0; bucket < threshold - 2; bucket++) {
+        size_t start = (size_t)(bucket * bucketSize) + 1;
+        size_t end = (size_t)((bucket + 1) * bucketSize) + 1;
+        if (end > count - 1) end = count - 1;
+
+        // Average of the next bucket (the last point for the last bucket)
+        size_t nextStart = end;
+        size_t nextEnd = (size_t)((bucket + 2) * bucketSize) + 1;
+        if (nextEnd > count) nextEnd = count;
+        double averageX = 0, averageY = 0;
+        size_t averageCount = 0;
+        for (size_t i = nextStart; i < nextEnd; i++) {
+            if (BEMPointBufferIsNull(y[i])) continue;
+            averageX += x[i];
+            averageY += y[i];
+            averageCount++;
+        }
+        if (averageCount > 0) {
+            averageX /= averageCount;
+            averageY /= averageCount;
+        } else {
+            averageX = previousX;
+            averageY = previousY;
+        }
+
+        size_t keptIndex = start;
+        double maximumArea = -1;
+        for (size_t i = start; i < end; i++) {
+            if (BEMPointBufferIsNull(y[i])) continue;
+            double area = hasPrevious ? fabs((previousX - averageX) * (y[i] - previousY) - (previousX - x[i]) * (averageY - previousY)) : 0;
+            if (area > maximumArea) {
+                maximumArea = area;
+                keptIndex = i;
+            }
+        }
+
+        BEMDecimationKeepPoint(source, keptIndex, destination, indices);
+        if (maximumArea >= 0) {
+            previousX = x[keptIndex];
+            previousY = y[keptIndex];
+            hasPrevious = true;
+        }
+    }
+
+    BEMDecimationKeepPoint(source, count - 1, destination, indices);
+    return destination->count;
+}
+
+size_t BEMDecimateMinMax(const BEMPointBuffer *source, size_t threshold, BEMPointBufferRef destination, size_t *indices) {
+    size_t keptCount;
+    if (BEMDecimationPrepare(source, threshold, destination, indices, &keptCount)) return keptCount;
+
+    const float *x = source->x;
+    const float *y = source->y;
+    size_t count = source->count;
+    size_t numberOfColumns = threshold / 2;
+    double firstX = x[0];
+    double columnWidth = (x[count - 1] - firstX) / numberOfColumns;
+    if (!(columnWidth > 0)) columnWidth = 1;
+
+    size_t i = 0;
+    while (i < count) {
+        size_t column = (size_t)((x[i] - firstX) / columnWidth);
+        if (column >= numberOfColumns) column = numberOfColumns - 1;
+
+        size_t columnStart = i;
+        size_t minimumIndex = count, maximumIndex = count;
+        for (; i < count; i++) {
+            size_t pointColumn = (size_t)((x[i] - firstX) / columnWidth);
+            if (pointColumn >= numberOfColumns) pointColumn = numberOfColumns - 1;
+            if (pointColumn != column) break;
+            if (BEMPointBufferIsNull(y[i])) continue;
+            if (minimumIndex == count || y[i] < y[minimumIndex]) minimumIndex = i;
+            if (maximumIndex == count || y[i] > y[maximumIndex]) maximumIndex = i;
+        }
+
+        if (minimumIndex == count) {
+            BEMDecimationKeepPoint(source, columnStart, destination, indices);
+        } else if (minimumIndex == maximumIndex) {
+            BEMDecimationKeepPoint(source, minimumIndex, destination, indices);
+        } else {
+            size_t first = minimumIndex < maximumIndex ? minimumIndex : maximumIndex;
+            size_t last = minimumIndex < maximumIndex ? maximumIndex : minimumIndex;
+            BEMDecimationKeepPoint(source, first, destination, indices);
+            BEMDecimationKeepPoint(source, last, destination, indices);
+        }
+    }
+
+    return destination->count;
+}
@@ -0,0 +1,41 @@
+//
+//  BEMDecimation.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMDecimation_h
+#define BEMDecimation_h
+
+#include <stddef.h>
+
+#include "BEMPointBuffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Reduces \p source to at most \p threshold points with the Largest-Triangle-Three-Buckets algorithm.
+ @discussion The points of \p source must be sorted by x coordinate. The first and last points are always kept. Every bucket keeps the point forming the largest triangle with the previously kept point and the average of the next bucket, which preserves the visual shape of the series. A bucket made only of missing points keeps one missing point, so gaps survive the reduction.
+ @param source The points to reduce.
+ @param threshold The maximum number of points to keep. When \p source has \p threshold points or less, every point is kept. A threshold of 2 keeps the first and last points, 1 the first point only.
+ @param destination The buffer receiving the kept points. Its previous points are removed.
+ @param indices Receives the index in \p source of every kept point. Must be able to hold \p threshold indices (or the number of points of \p source if it is smaller).
+ @return The number of points kept, or 0 if \p destination could not be grown. */
+size_t BEMDecimateLargestTriangleThreeBuckets(const BEMPointBuffer *source, size_t threshold, BEMPointBufferRef destination, size_t *indices);
+
+/** Reduces \p source to at most \p threshold points by keeping the lowest and the highest point of every column.
+ @discussion The points of \p source must be sorted by x coordinate. The x range is split in \p threshold / 2 columns of equal width (typically one per pixel column), and the minimum and maximum of each column are kept in their original order. This keeps the exact vertical envelope of the series. A column made only of missing points keeps one missing point.
+ @param source The points to reduce.
+ @param threshold The maximum number of points to keep. When \p source has \p threshold points or less, every point is kept. A threshold of 2 keeps the first and last points, 1 the first point only.
+ @param destination The buffer receiving the kept points. Its previous points are removed.
+ @param indices Receives the index in \p source of every kept point. Must be able to hold \p threshold indices (or the number of points of \p source if it is smaller).
+ @return The number of points kept, or 0 if \p destination could not be grown. */
+size_t BEMDecimateMinMax(const BEMPointBuffer *source, size_t threshold, BEMPointBufferRef destination, size_t *indices);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+//
+//  BEMDotsLayer.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+@import Foundation;
+@import UIKit;
+@import CoreGraphics;
+
+#import "BEMPointBuffer.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The way the dots of the graph are rendered
+typedef NS_ENUM(NSInteger, BEMDotRendering) {
+    /// Every dot is a BEMCircle view added to the graph
+    BEMDotRenderingViews,
+    /// Every dot is drawn in a single BEMDotsLayer. Recommended for graphs with many points.
+    BEMDotRenderingLayer
+};
+
+
+/// Layer drawing every dot of the graph at once, instead of using one view per dot
+@interface BEMDotsLayer : CALayer
+
+/// The centers of the dots, offset by \p pointOffset. Dots with a null y coordinate are not drawn. The buffer is retained by the layer.
+@property (assign, nonatomic, nullable) BEMPointBufferRef pointBuffer;
+
+/// The offset added to every point of \p pointBuffer to get the center of its dot in the layer's coordinate system
+@property (nonatomic) CGPoint pointOffset;
+
+/// The diameter of the dots
+@property (nonatomic) CGFloat dotSize;
+
+/// The color of the dots
+@property (strong, nonatomic, nullable) UIColor *dotColor;
+
+/// The index of the highlighted dot in \p pointBuffer, or NSNotFound. The highlighted dot is drawn in its own sublayer so moving the highlight doesn't redraw the other dots.
+@property (nonatomic) NSInteger highlightedIndex;
+
+/// The alpha of the highlighted dot. Default value is 0.8.
+@property (nonatomic) CGFloat highlightedAlpha;
+
+
+/// Sets the alpha of one dot. Every dot has an alpha of 1 when the point buffer is set.
+- (void)setAlpha:(CGFloat)alpha forDotAtIndex:(NSInteger)index;
+
+/// Returns the alpha of one dot
+- (CGFloat)alphaForDotAtIndex:(NSInteger)index;
+
+/// Sets the alpha of every dot
+- (void)setAlphaForAllDots:(CGFloat)alpha;
+
+@end
+
+NS_ASSUME_NONNULL_END
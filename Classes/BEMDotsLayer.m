@@ -0,0 +1,149 @@
+//
+//  BEMDotsLayer.m
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#import "BEMDotsLayer.h"
+
+@interface BEMDotsLayer () {
+    /// The alpha of every dot, one per point of the point buffer
+    float *alphas;
+}
+
+/// The layer drawing the highlighted dot
+@property (strong, nonatomic) CAShapeLayer *highlightLayer;
+
+@end
+
+@implementation BEMDotsLayer
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _highlightedIndex = NSNotFound;
+        _highlightedAlpha = 0.8;
+        _dotSize = 10.0;
+        self.contentsScale = [UIScreen mainScreen].scale;
+        self.needsDisplayOnBoundsChange = YES;
+
+        _highlightLayer = [CAShapeLayer layer];
+        _highlightLayer.opacity = 0;
+        [self addSublayer:_highlightLayer];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(alphas);
+    BEMPointBufferRelease(_pointBuffer);
+}
+
+#pragma mark - Properties
+
+- (void)setPointBuffer:(BEMPointBufferRef)pointBuffer {
+    BEMPointBufferRetain(pointBuffer);
+    BEMPointBufferRelease(_pointBuffer);
+    _pointBuffer = pointBuffer;
+
+    free(alphas);
+    alphas = NULL;
+    if (pointBuffer && pointBuffer->count > 0) {
+        alphas = malloc(sizeof(float) * pointBuffer->count);
+        if (alphas) for (size_t i = 0; i < pointBuffer->count; i++) alphas[i] = 1;
+    }
+
+    _highlightedIndex = NSNotFound;
+    self.highlightLayer.opacity = 0;
+    [self setNeedsDisplay];
+}
+
+- (void)setPointOffset:(CGPoint)pointOffset {
+    _pointOffset = pointOffset;
+    [self setNeedsDisplay];
+}
+
+- (void)setDotSize:(CGFloat)dotSize {
+    _dotSize = dotSize;
+    [self setNeedsDisplay];
+}
+
+- (void)setDotColor:(UIColor *)dotColor {
+    _dotColor = dotColor;
+    [self setNeedsDisplay];
+}
+
+- (void)setHighlightedIndex:(NSInteger)highlightedIndex {
+    if (highlightedIndex != NSNotFound && (self.pointBuffer == NULL || highlightedIndex < 0 || highlightedIndex >= (NSInteger)self.pointBuffer->count || BEMPointBufferIsNull(self.pointBuffer->y[highlightedIndex]))) {
+        highlightedIndex = NSNotFound;
+    }
+    _highlightedIndex = highlightedIndex;
+
+    if (highlightedIndex == NSNotFound) {
+        self.highlightLayer.opacity = 0;
+        return;
+    }
+
+    // Moving the highlight must not be animated, only fading it in and out
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    CGRect dotRect = CGRectMake(-self.dotSize/2, -self.dotSize/2, self.dotSize, self.dotSize);
+    self.highlightLayer.path = [UIBezierPath bezierPathWithOvalInRect:dotRect].CGPath;
+    self.highlightLayer.fillColor = self.dotColor.CGColor;
+    self.highlightLayer.position = CGPointMake(self.pointBuffer->x[highlightedIndex] + self.pointOffset.x, self.pointBuffer->y[highlightedIndex] + self.pointOffset.y);
+    [CATransaction commit];
+    self.highlightLayer.opacity = self.highlightedAlpha;
+}
+
+#pragma mark - Alpha
+
+- (void)setAlpha:(CGFloat)alpha forDotAtIndex:(NSInteger)index {
+    if (alphas == NULL || index < 0 || index >= (NSInteger)self.pointBuffer->count) return;
+    if (alphas[index] == (float)alpha) return;
+    alphas[index] = alpha;
+    [self setNeedsDisplay];
+}
+
+- (CGFloat)alphaForDotAtIndex:(NSInteger)index {
+    if (alphas == NULL || index < 0 || index >= (NSInteger)self.pointBuffer->count) return 0;
+    return alphas[index];
+}
+
+- (void)setAlphaForAllDots:(CGFloat)alpha {
+    if (alphas == NULL) return;
+    for (size_t i = 0; i < self.pointBuffer->count; i++) alphas[i] = alpha;
+    [self setNeedsDisplay];
+}
+
+#pragma mark - Drawing
+
+- (void)drawInContext:(CGContextRef)ctx {
+    if (self.pointBuffer == NULL || alphas == NULL || self.dotColor == nil) return;
+
+    const float *x = self.pointBuffer->x;
+    const float *y = self.pointBuffer->y;
+    size_t count = self.pointBuffer->count;
+    CGFloat radius = self.dotSize/2;
+    CGRect clipRect = CGRectInset(CGContextGetClipBoundingBox(ctx), -radius, -radius);
+
+    // Dots sharing the same alpha are filled together, which is a single fill when every dot has the same alpha
+    CGContextSetFillColorWithColor(ctx, self.dotColor.CGColor);
+    float pathAlpha = -1;
+    for (size_t i = 0; i < count; i++) {
+        if (alphas[i] <= 0 || BEMPointBufferIsNull(y[i])) continue;
+
+        CGPoint center = CGPointMake(x[i] + self.pointOffset.x, y[i] + self.pointOffset.y);
+        if (!CGRectContainsPoint(clipRect, center)) continue;
+
+        if (alphas[i] != pathAlpha) {
+            if (pathAlpha >= 0) CGContextFillPath(ctx);
+            pathAlpha = alphas[i];
+            CGContextSetAlpha(ctx, pathAlpha);
+        }
+        CGContextAddEllipseInRect(ctx, CGRectMake(center.x - radius, center.y - radius, self.dotSize, self.dotSize));
+    }
+    if (pathAlpha >= 0) CGContextFillPath(ctx);
+}
+
+@end
@@ -0,0 +1,481 @@
+//
+//  BEMGraphLayout.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMGraphLayout.h"
+#include "BEMGraphTransform.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+//----- SCALE -----//
+
+float BEMGraphScaleDefaultPadding(float height) {
+    float padding = height / 2;
+    return padding > 90 ? 90 : padding;
+}
+
+float BEMGraphScaleYPosition(const BEMGraphScale *scale, double value) {
+    BEMGraphTransform transform = BEMGraphTransformMake(scale, 0, 0);
+    return BEMGraphTransformY(&transform, value);
+}
+
+//----- POINTS -----//
+
+bool BEMGraphLayoutPoints(const double *values, size_t count, double nullValue, const BEMGraphScale *scale, float width, BEMPointBufferRef points) {
+    BEMPointBufferRemoveAllPoints(points);
+    if (!BEMPointBufferReserve(points, count)) return false;
+
+    BEMGraphTransform transform = BEMGraphTransformMake(scale, width, count);
+    BEMGraphTransformPoints(&transform, values, count, nullValue, 0, points->x, points->y);
+    points->count = count;
+    return true;
+}
+
+//----- PATHS -----//
+
+/// Grows the path so it can hold \p elementCount more elements with \p pointCount more points
+static bool BEMPathReserve(BEMPathRef path, size_t elementCount, size_t pointCount) {
+    if (path->elementCount + elementCount > path->elementCapacity) {
+        size_t capacity = path->elementCapacity * 2;
+        if (capacity < path->elementCount + elementCount) capacity = path->elementCount + elementCount;
+        uint8_t *elements = realloc(path->elements, capacity);
+        if (elements == NULL) return false;
+        path->elements = elements;
+        path->elementCapacity = capacity;
+    }
+    if (path->pointCount + pointCount > path->pointCapacity) {
+        size_t capacity = path->pointCapacity * 2;
+        if (capacity < path->pointCount + pointCount) capacity = path->pointCount + pointCount;
+        float *points = realloc(path->points, sizeof(float) * 2 * capacity);
+        if (points == NULL) return false;
+        path->points = points;
+        path->pointCapacity = capacity;
+    }
+    return true;
+}
+
+/// Appends an element whose points were reserved
+static inline void BEMPathAddElement(BEMPathRef path, BEMPathElement element, float x, float y) {
+    path->elements[path->elementCount++] = element;
+    path->points[2 * path->pointCount] = x;
+    path->points[2 * path->pointCount + 1] = y;
+    path->pointCount++;
+}
+
+/// Appends a quad curve whose points were reserved
+static inline void BEMPathAddQuadCurve(BEMPathRef path, float controlX, float controlY, float x, float y) {
+    path->elements[path->elementCount++] = BEMPathElementQuadCurve;
+    float *points = &path->points[2 * path->pointCount];
+    points[0] = controlX;
+    points[1] = controlY;
+    points[2] = x;
+    points[3] = y;
+    path->pointCount += 2;
+}
+
+/// Appends a cubic curve whose points were reserved
+static inline void BEMPathAddCubicCurve(BEMPathRef path, float firstControlX, float firstControlY, float secondControlX, float secondControlY, float x, float y) {
+    path->elements[path->elementCount++] = BEMPathElementCubicCurve;
+    float *points = &path->points[2 * path->pointCount];
+    points[0] = firstControlX;
+    points[1] = firstControlY;
+    points[2] = secondControlX;
+    points[3] = secondControlY;
+    points[4] = x;
+    points[5] = y;
+    path->pointCount += 3;
+}
+
+BEMPathRef BEMPathCreate(void) {
+    return calloc(1, sizeof(BEMPath));
+}
+
+void BEMPathFree(BEMPathRef path) {
+    if (path == NULL) return;
+    free(path->elements);
+    free(path->points);
+    free(path);
+}
+
+void BEMPathRemoveAllElements(BEMPathRef path) {
+    path->elementCount = 0;
+    path->pointCount = 0;
+}
+
+/** Reads the points of a line in order, crossing missing points as its fill requires.
+ @discussion Without runs, every point is tested and missing points are skipped. With runs, the points are read run after run, and a reader which holds values adds one point at the end of every gap, with the value of the point before the gap. */
+typedef struct BEMPathPointReader {
+    const float *x;
+    const float *y;
+    /// The number of points of the line, up to which a trailing gap is held
+    size_t count;
+    /// The runs of present points, NULL to test every point
+    const BEMPointSegment *segments;
+    size_t segmentCount;
+    /// The run being read and the index of the next point
+    size_t segment;
+    size_t index;
+    bool holdsValues;
+} BEMPathPointReader;
+
+/// Reads the next point. Returns false once every point was read.
+static inline bool BEMPathReadPoint(BEMPathPointReader *reader, float *pointX, float *pointY) {
+    if (reader->segments == NULL) {
+        while (reader->index < reader->count) {
+            size_t i = reader->index++;
+            if (BEMPointBufferIsNull(reader->y[i])) continue;
+            *pointX = reader->x[i];
+            *pointY = reader->y[i];
+            return true;
+        }
+        return false;
+    }
+
+    if (reader->segment == reader->segmentCount) {
+        // Missing points after the last run hold its value up to the end of the line
+        if (!reader->holdsValues || reader->segmentCount == 0 || reader->index >= reader->count) return false;
+        *pointX = reader->x[reader->count - 1];
+        *pointY = reader->y[reader->index - 1];
+        reader->index = reader->count;
+        return true;
+    }
+
+    BEMPointSegment segment = reader->segments[reader->segment];
+    if (reader->index < segment.start) {
+        // Entering a run after a gap. Missing points before the first run have no value to hold.
+        bool holdsGap = reader->holdsValues && reader->segment > 0;
+        if (holdsGap) {
+            *pointX = reader->x[segment.start - 1];
+            *pointY = reader->y[reader->index - 1];
+        }
+        reader->index = segment.start;
+        if (holdsGap) return true;
+    }
+    *pointX = reader->x[reader->index];
+    *pointY = reader->y[reader->index];
+    reader->index++;
+    if (reader->index == segment.start + segment.count) reader->segment++;
+    return true;
+}
+
+/// A reader of the points of one run, with no gap
+static inline BEMPathPointReader BEMPathSegmentReader(const float *x, const float *y, const BEMPointSegment *segment) {
+    BEMPathPointReader reader = {x, y, segment->start + segment->count, segment, 1, 0, segment->start, false};
+    return reader;
+}
+
+/// The control point of the curve from a segment's middle to one of its ends, which flattens the curve at the end
+static inline float BEMPathControlY(float middleY, float endY) {
+    float controlY = (middleY + endY) / 2;
+    float difference = fabsf(endY - controlY);
+    if (middleY < endY) return controlY + difference;
+    if (middleY > endY) return controlY - difference;
+    return controlY;
+}
+
+/// The slope of the segment between two points, 0 for a vertical segment
+static inline double BEMPathSlope(float startX, float startY, float endX, float endY) {
+    double width = (double)endX - startX;
+    return width > 0 ? ((double)endY - startY) / width : 0;
+}
+
+/** The tangent of the monotone cubic at a point, from the slopes and widths of the segments before and after it.
+ @discussion Steffen's variant of the Fritsch-Carlson tangents: 0 at extrema, otherwise no steeper than twice the gentlest of both slopes. This keeps every segment monotone, and only needs the neighbours of the point. */
+static inline double BEMPathMonotoneTangent(double previousSlope, double previousWidth, double nextSlope, double nextWidth) {
+    // Selects rather than an early return for extrema, which are as unpredictable as the values
+    double weightedSlope = 0.5 * fabs(previousSlope * nextWidth + nextSlope * previousWidth) / (previousWidth + nextWidth);
+    double tangent = fabs(previousSlope) < fabs(nextSlope) ? fabs(previousSlope) : fabs(nextSlope);
+    tangent = tangent < weightedSlope ? tangent : weightedSlope;
+    tangent = previousSlope * nextSlope > 0 ? 2 * tangent : 0;
+    return previousSlope < 0 ? -tangent : tangent;
+}
+
+/// The distance between two points raised to the power 1/2, the parametrization of the centripetal Catmull-Rom spline
+static inline double BEMPathCentripetalLength(float startX, float startY, float endX, float endY) {
+    double width = (double)endX - startX;
+    double height = (double)endY - startY;
+    return sqrt(sqrt(width * width + height * height));
+}
+
+static inline float BEMPathClamp(double value, float bound, float otherBound) {
+    double minimum = bound < otherBound ? bound : otherBound;
+    double maximum = bound < otherBound ? otherBound : bound;
+    value = value < minimum ? minimum : value;
+    return (float)(value > maximum ? maximum : value);
+}
+
+/** Appends one cubic curve per segment, after the first point was moved to.
+ @discussion Points are read one ahead of the segment being built: the tangents only depend on the neighbours of its ends, and the first and last points have no neighbour on one side. The control points are computed in double precision, so points far off screen can't overflow the squared distances. */
+static void BEMPathAppendCubicCurves(BEMPathRef path, BEMPathPointReader *reader, float startX, float startY, BEMCurveInterpolation curve) {
+    float endX, endY;
+    if (!BEMPathReadPoint(reader, &endX, &endY)) return;
+
+    float previousX = startX, previousY = startY;
+    double slope = BEMPathSlope(startX, startY, endX, endY);
+    double startTangent = slope;
+    double previousLength = 0;
+    double length = BEMPathCentripetalLength(startX, startY, endX, endY);
+    while (true) {
+        float nextX, nextY;
+        bool hasNextPoint = BEMPathReadPoint(reader, &nextX, &nextY);
+        if (!hasNextPoint) {
+            nextX = endX;
+            nextY = endY;
+        }
+
+        double width = (double)endX - startX;
+        double firstControlX, firstControlY, secondControlX, secondControlY;
+        if (curve == BEMCurveInterpolationMonotoneCubic) {
+            double nextSlope = BEMPathSlope(endX, endY, nextX, nextY);
+            double endTangent = hasNextPoint ? BEMPathMonotoneTangent(slope, width, nextSlope, (double)nextX - endX) : slope;
+            double third = width / 3;
+            firstControlX = startX + third;
+            firstControlY = startY + startTangent * third;
+            secondControlX = endX - third;
+            secondControlY = endY - endTangent * third;
+            startTangent = endTangent;
+            slope = nextSlope;
+        } else {
+            // The Bezier form of the centripetal Catmull-Rom segment, a missing neighbour leaves the control point on the end
+            double nextLength = BEMPathCentripetalLength(endX, endY, nextX, nextY);
+            firstControlX = startX;
+            firstControlY = startY;
+            if (previousLength > 1e-6) {
+                double weight = 2 * previousLength * previousLength + 3 * previousLength * length + length * length;
+                double divisor = 3 * previousLength * (previousLength + length);
+                firstControlX = (startX * weight - previousX * length * length + endX * previousLength * previousLength) / divisor;
+                firstControlY = (startY * weight - previousY * length * length + endY * previousLength * previousLength) / divisor;
+            }
+            secondControlX = endX;
+            secondControlY = endY;
+            if (nextLength > 1e-6) {
+                double weight = 2 * nextLength * nextLength + 3 * nextLength * length + length * length;
+                double divisor = 3 * nextLength * (nextLength + length);
+                secondControlX = (endX * weight + startX * nextLength * nextLength - nextX * length * length) / divisor;
+                secondControlY = (endY * weight + startY * nextLength * nextLength - nextY * length * length) / divisor;
+            }
+            previousLength = length;
+            length = nextLength;
+
+            // A cubic curve stays within the box of its control points: keeping them in the box of the segment keeps the spline from overshooting the points it joins. The monotone tangents already do.
+            firstControlX = BEMPathClamp(firstControlX, startX, endX);
+            firstControlY = BEMPathClamp(firstControlY, startY, endY);
+            secondControlX = BEMPathClamp(secondControlX, startX, endX);
+            secondControlY = BEMPathClamp(secondControlY, startY, endY);
+        }
+        BEMPathAddCubicCurve(path, firstControlX, firstControlY, secondControlX, secondControlY, endX, endY);
+
+        if (!hasNextPoint) return;
+        previousX = startX;
+        previousY = startY;
+        startX = endX;
+        startY = endY;
+        endX = nextX;
+        endY = nextY;
+    }
+}
+
+/// Appends the points read by \p reader as one subpath. \p numberOfPoints is the number of points the reader returns.
+static bool BEMPathAppendReader(BEMPathRef path, BEMPathPointReader *reader, size_t numberOfPoints, BEMCurveInterpolation curve) {
+    if (numberOfPoints <= 2) curve = BEMCurveInterpolationNone;
+    bool isCubic = curve == BEMCurveInterpolationMonotoneCubic || curve == BEMCurveInterpolationCatmullRom;
+    size_t elementCount = curve == BEMCurveInterpolationQuadratic ? 2 * numberOfPoints : numberOfPoints;
+    size_t pointCount = curve == BEMCurveInterpolationQuadratic ? 4 * numberOfPoints : (isCubic ? 3 * numberOfPoints : numberOfPoints);
+    if (!BEMPathReserve(path, elementCount, pointCount)) return false;
+
+    float startX, startY;
+    if (!BEMPathReadPoint(reader, &startX, &startY)) return true;
+    BEMPathAddElement(path, BEMPathElementMove, startX, startY);
+    if (isCubic) {
+        BEMPathAppendCubicCurves(path, reader, startX, startY, curve);
+        return true;
+    }
+
+    bool curved = curve == BEMCurveInterpolationQuadratic;
+    float previousX = startX, previousY = startY;
+    float pointX, pointY;
+    while (BEMPathReadPoint(reader, &pointX, &pointY)) {
+        if (!curved) BEMPathAddElement(path, BEMPathElementLine, pointX, pointY);
+        else {
+            float middleX = (previousX + pointX) / 2;
+            float middleY = (previousY + pointY) / 2;
+            BEMPathAddQuadCurve(path, (middleX + previousX) / 2, BEMPathControlY(middleY, previousY), middleX, middleY);
+            BEMPathAddQuadCurve(path, (middleX + pointX) / 2, BEMPathControlY(middleY, pointY), pointX, pointY);
+        }
+        previousX = pointX;
+        previousY = pointY;
+    }
+    return true;
+}
+
+bool BEMPathAppendPoints(BEMPathRef path, const float *x, const float *y, size_t count, BEMCurveInterpolation curve) {
+    size_t numberOfPoints = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!BEMPointBufferIsNull(y[i])) numberOfPoints++;
+    }
+    BEMPathPointReader reader = {x, y, count, NULL, 0, 0, 0, false};
+    return BEMPathAppendReader(path, &reader, numberOfPoints, curve);
+}
+
+bool BEMPathAppendSegments(BEMPathRef path, const float *x, const float *y, const BEMPointSegments *segments, BEMCurveInterpolation curve, BEMNullValueFill fill) {
+    if (segments->count == 0) return true;
+
+    if (fill == BEMNullValueFillGap) {
+        // Every run is its own line, curved on its own points
+        for (size_t s = 0; s < segments->count; s++) {
+            BEMPathPointReader reader = BEMPathSegmentReader(x, y, &segments->segments[s]);
+            if (!BEMPathAppendReader(path, &reader, segments->segments[s].count, curve)) return false;
+        }
+        return true;
+    }
+
+    // A held value adds one point at the end of every gap after the first run, including a gap at the end of the line
+    size_t numberOfPoints = segments->pointCount;
+    bool holdsValues = fill == BEMNullValueFillPrevious;
+    if (holdsValues) {
+        const BEMPointSegment *last = &segments->segments[segments->count - 1];
+        numberOfPoints += segments->count - 1;
+        if (last->start + last->count < segments->totalCount) numberOfPoints++;
+    }
+    BEMPathPointReader reader = {x, y, segments->totalCount, segments->segments, segments->count, 0, 0, holdsValues};
+    return BEMPathAppendReader(path, &reader, numberOfPoints, curve);
+}
+
+/// The number of points of an element
+static inline size_t BEMPathElementPointCount(uint8_t element) {
+    switch ((BEMPathElement)element) {
+        case BEMPathElementQuadCurve: return 2;
+        case BEMPathElementCubicCurve: return 3;
+        default: return 1;
+    }
+}
+
+bool BEMPathAppendArea(BEMPathRef path, const BEMPath *line, float startX, float endX, float edgeY) {
+    size_t subpathCount = 0;
+    for (size_t i = 0; i < line->elementCount; i++) {
+        if (line->elements[i] == BEMPathElementMove) subpathCount++;
+    }
+    if (subpathCount == 0) {
+        if (!BEMPathReserve(path, 2, 2)) return false;
+        BEMPathAddElement(path, BEMPathElementMove, startX, edgeY);
+        BEMPathAddElement(path, BEMPathElementLine, endX, edgeY);
+        return true;
+    }
+    if (!BEMPathReserve(path, line->elementCount + 2 * subpathCount, line->pointCount + 2 * subpathCount)) return false;
+
+    // Every subpath is closed on the edge on its own, so gaps stay empty. Only the first and the last reach out to startX and endX.
+    size_t element = 0, point = 0;
+    for (size_t subpath = 0; subpath < subpathCount; subpath++) {
+        size_t firstElement = element, firstPoint = point;
+        do {
+            point += BEMPathElementPointCount(line->elements[element]);
+            element++;
+        } while (element < line->elementCount && line->elements[element] != BEMPathElementMove);
+
+        BEMPathAddElement(path, BEMPathElementMove, subpath == 0 ? startX : line->points[2 * firstPoint], edgeY);
+        // The subpath's move becomes a line from the edge, the other elements are copied as they are
+        memcpy(&path->elements[path->elementCount], &line->elements[firstElement], element - firstElement);
+        path->elements[path->elementCount] = BEMPathElementLine;
+        memcpy(&path->points[2 * path->pointCount], &line->points[2 * firstPoint], sizeof(float) * 2 * (point - firstPoint));
+        path->elementCount += element - firstElement;
+        path->pointCount += point - firstPoint;
+        BEMPathAddElement(path, BEMPathElementLine, subpath + 1 == subpathCount ? endX : line->points[2 * point - 2], edgeY);
+    }
+    return true;
+}
+
+void BEMPathAreaBounds(const float *x, const BEMPointSegments *segments, BEMNullValueFill fill, float width, float *startX, float *endX) {
+    *startX = 0;
+    *endX = width;
+    if (fill != BEMNullValueFillGap || segments->count == 0) return;
+    const BEMPointSegment *first = &segments->segments[0];
+    const BEMPointSegment *last = &segments->segments[segments->count - 1];
+    if (first->start > 0) *startX = x[first->start];
+    if (last->start + last->count < segments->totalCount) *endX = x[last->start + last->count - 1];
+}
+
+/// Makes room for \p count more pairs in the outline
+static bool BEMPathReserveOutline(float **outline, size_t *outlineCapacity, size_t count) {
+    if (count <= *outlineCapacity) return true;
+    size_t capacity = *outlineCapacity * 2;
+    if (capacity < count) capacity = count;
+    float *grownOutline = realloc(*outline, sizeof(float) * 2 * capacity);
+    if (grownOutline == NULL) return false;
+    *outline = grownOutline;
+    *outlineCapacity = capacity;
+    return true;
+}
+
+size_t BEMPathFlatten(const BEMPath *path, float tolerance, float **outline, size_t *outlineCapacity) {
+    if (tolerance <= 0) tolerance = 0.25f;
+
+    size_t count = 0;
+    const float *points = path->points;
+    float currentX = 0, currentY = 0;
+    for (size_t i = 0; i < path->elementCount; i++) {
+        if (path->elements[i] == BEMPathElementQuadCurve) {
+            float controlX = points[0], controlY = points[1], endX = points[2], endY = points[3];
+            points += 4;
+
+            // The distance between a quadratic curve and its chords of n segments is at most |p0 - 2p1 + p2| / (8 n^2)
+            float deviation = hypotf(currentX - 2 * controlX + endX, currentY - 2 * controlY + endY);
+            size_t segments = (size_t)ceilf(sqrtf(deviation / (8 * tolerance)));
+            if (segments < 1) segments = 1;
+            if (segments > 64) segments = 64;
+            if (!BEMPathReserveOutline(outline, outlineCapacity, count + segments)) return 0;
+            for (size_t s = 1; s <= segments; s++) {
+                float t = (float)s / segments;
+                float u = 1 - t;
+                (*outline)[2 * count] = u * u * currentX + 2 * u * t * controlX + t * t * endX;
+                (*outline)[2 * count + 1] = u * u * currentY + 2 * u * t * controlY + t * t * endY;
+                count++;
+            }
+            currentX = endX;
+            currentY = endY;
+            continue;
+        }
+        if (path->elements[i] == BEMPathElementCubicCurve) {
+            float firstControlX = points[0], firstControlY = points[1], secondControlX = points[2], secondControlY = points[3], endX = points[4], endY = points[5];
+            points += 6;
+
+            // The second derivative of a cubic curve is at most 6 max(|p0 - 2p1 + p2|, |p1 - 2p2 + p3|), its chords of n segments are within an eighth of it divided by n^2
+            float deviation = fmaxf(hypotf(currentX - 2 * firstControlX + secondControlX, currentY - 2 * firstControlY + secondControlY),
+                                    hypotf(firstControlX - 2 * secondControlX + endX, firstControlY - 2 * secondControlY + endY));
+            size_t segments = (size_t)ceilf(sqrtf(3 * deviation / (4 * tolerance)));
+            if (segments < 1) segments = 1;
+            if (segments > 64) segments = 64;
+            if (!BEMPathReserveOutline(outline, outlineCapacity, count + segments)) return 0;
+            for (size_t s = 1; s <= segments; s++) {
+                float t = (float)s / segments;
+                float u = 1 - t;
+                (*outline)[2 * count] = u * u * u * currentX + 3 * u * u * t * firstControlX + 3 * u * t * t * secondControlX + t * t * t * endX;
+                (*outline)[2 * count + 1] = u * u * u * currentY + 3 * u * u * t * firstControlY + 3 * u * t * t * secondControlY + t * t * t * endY;
+                count++;
+            }
+            currentX = endX;
+            currentY = endY;
+            continue;
+        }
+
+        // A new subpath is separated from the previous one
+        bool isMove = path->elements[i] == BEMPathElementMove;
+        if (!BEMPathReserveOutline(outline, outlineCapacity, count + 2)) return 0;
+        if (isMove && count > 0) {
+            (*outline)[2 * count] = NAN;
+            (*outline)[2 * count + 1] = NAN;
+            count++;
+        }
+        currentX = points[0];
+        currentY = points[1];
+        points += 2;
+        (*outline)[2 * count] = currentX;
+        (*outline)[2 * count + 1] = currentY;
+        count++;
+    }
+    return count;
+}
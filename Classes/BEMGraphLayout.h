@@ -0,0 +1,133 @@
+//
+//  BEMGraphLayout.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMGraphLayout_h
+#define BEMGraphLayout_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "BEMPointBuffer.h"
+#include "BEMPointSegments.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//----- SCALE -----//
+
+/** Vertical scale of a graph, mapping values to y coordinates.
+ @discussion This is the geometry used by \p BEMSimpleLineGraphView to place its points, with no dependency on UIKit, so the same positions can be computed by a headless renderer. */
+typedef struct BEMGraphScale {
+    /// The smallest and biggest values of the graph
+    double minimumValue;
+    double maximumValue;
+    /// The height of the graph
+    float height;
+    /// The vertical room left around the points, see \p BEMGraphScaleDefaultPadding
+    float padding;
+    /// The height taken by the X-Axis labels at the bottom of the graph
+    float xAxisLabelHeight;
+    /// If false, values are used as y coordinates from the bottom of the graph
+    bool autoScale;
+} BEMGraphScale;
+
+/// The padding used when the delegate doesn't provide one: half the height of the graph, up to 90 points
+float BEMGraphScaleDefaultPadding(float height);
+
+/// Returns the y coordinate of \p value, with the origin at the top of the graph
+float BEMGraphScaleYPosition(const BEMGraphScale *scale, double value);
+
+
+//----- POINTS -----//
+
+/** Places the values evenly across \p width and appends the points to \p points, which is emptied first.
+ @discussion Values equal to \p nullValue (or NaN) become missing points, with a NaN y coordinate.
+ @return false if the memory could not be allocated. */
+bool BEMGraphLayoutPoints(const double *values, size_t count, double nullValue, const BEMGraphScale *scale, float width, BEMPointBufferRef points);
+
+
+//----- PATHS -----//
+
+/// The kind of a path element
+typedef enum BEMPathElement {
+    /// Starts a new subpath at one point
+    BEMPathElementMove,
+    /// Adds a straight line to one point
+    BEMPathElementLine,
+    /// Adds a quadratic curve through a control point to an end point
+    BEMPathElementQuadCurve,
+    /// Adds a cubic curve through two control points to an end point
+    BEMPathElementCubicCurve
+} BEMPathElement;
+
+/// The curve joining the points of a line
+typedef enum BEMCurveInterpolation {
+    /// Straight segments between the points
+    BEMCurveInterpolationNone,
+    /// Two quadratic curves per segment meeting at its middle, flat at every point. The original curve of \p enableBezierCurve.
+    BEMCurveInterpolationQuadratic,
+    /// One cubic curve per segment with Steffen's monotone tangents, a variant of Fritsch-Carlson's: the curve never goes above or below the points it joins, and flat runs stay flat
+    BEMCurveInterpolationMonotoneCubic,
+    /// One cubic curve per segment following a centripetal Catmull-Rom spline, bounded by the points it joins
+    BEMCurveInterpolationCatmullRom
+} BEMCurveInterpolation;
+
+/** Sequence of path elements, with the same semantics as a CGPath built with move, line, quad-curve and curve elements.
+ @discussion The points of every element are stored one after the other in \p points as (x, y) pairs: one point for moves and lines, the control point then the end point for quad curves, both control points then the end point for cubic curves. */
+typedef struct BEMPath {
+    /// The kind of every element
+    uint8_t *elements;
+    size_t elementCount;
+    size_t elementCapacity;
+    /// The coordinates of the points of every element, as (x, y) pairs
+    float *points;
+    size_t pointCount;
+    size_t pointCapacity;
+} BEMPath;
+
+typedef BEMPath *BEMPathRef;
+
+
+/// Creates an empty path. Returns NULL if the memory could not be allocated.
+BEMPathRef BEMPathCreate(void);
+
+/// Frees the path. Passing NULL does nothing.
+void BEMPathFree(BEMPathRef path);
+
+/// Removes every element from the path, keeping its capacity.
+void BEMPathRemoveAllElements(BEMPathRef path);
+
+/** Appends the line through the points to the path, as one subpath.
+ @discussion Lines of two points or less are always straight. The quadratic curve adds two elements per segment, the cubic curves one. The cubic curves are read from the points as they are appended, from the two points of the segment and their neighbours, and stay between the lowest and the highest of the two points of every segment, so the line never overshoots the data. The x coordinates must be ascending. Missing points are skipped, the line joins the points on both sides of them.
+ @return false if the memory could not be allocated. */
+bool BEMPathAppendPoints(BEMPathRef path, const float *x, const float *y, size_t count, BEMCurveInterpolation curve);
+
+/** Appends the line through the points whose runs were classified in \p segments, crossing the gaps between runs with \p fill.
+ @discussion The points are read through the runs, so missing points are never tested again nor given a coordinate. \p BEMNullValueFillGap appends one subpath per run, each curved on its own points. \p BEMNullValueFillLinear appends one subpath skipping the gaps, like \p BEMPathAppendPoints. \p BEMNullValueFillPrevious appends one subpath with an extra point at the end of every gap, at the x coordinate of its last missing point and the y coordinate of the point before the gap.
+ @return false if the memory could not be allocated. */
+bool BEMPathAppendSegments(BEMPathRef path, const float *x, const float *y, const BEMPointSegments *segments, BEMCurveInterpolation curve, BEMNullValueFill fill);
+
+/** Appends the area between a line and a horizontal edge: from (\p startX, \p edgeY) to the start of the line, along the line, then to (\p endX, \p edgeY).
+ @discussion This is how the areas above and under the line of a graph are filled: the elements of \p line are copied rather than built again, so one curve serves the stroke and both fills. A line of several subpaths, as built across gaps by \p BEMPathAppendSegments, gives one closed area per subpath: only the first starts from \p startX and only the last ends at \p endX, the others drop to the edge at their own ends so the gaps stay empty.
+ @return false if the memory could not be allocated. */
+bool BEMPathAppendArea(BEMPathRef path, const BEMPath *line, float startX, float endX, float edgeY);
+
+/// The x coordinates the areas of a line are closed at: 0 and \p width, except after or before a gap at either end of a line broken by \p BEMNullValueFillGap, whose areas start and end under its first and last points.
+void BEMPathAreaBounds(const float *x, const BEMPointSegments *segments, BEMNullValueFill fill, float width, float *startX, float *endX);
+
+/** Writes the polyline approximating every element of the path, for rasterization.
+ @discussion Quadratic and cubic curves are split in up to 64 segments each, which stay within about \p tolerance of the curve. Subpaths are left open, fills close them implicitly. The outline is written as (x, y) pairs, subpaths being separated by a pair of NaN coordinates.
+ @return The number of coordinate pairs written, or 0 if the memory could not be allocated. \p outline is reallocated as needed, \p outlineCapacity is its capacity in pairs. */
+size_t BEMPathFlatten(const BEMPath *path, float tolerance, float **outline, size_t *outlineCapacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
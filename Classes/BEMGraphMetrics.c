@@ -0,0 +1,92 @@
+//
+//  BEMGraphMetrics.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMGraphMetrics.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+const char *BEMGraphMetricsStageName(BEMGraphMetricsStage stage) {
+    switch (stage) {
+        case BEMGraphMetricsStageDataFetch: return "dataFetch";
+        case BEMGraphMetricsStageMinMax: return "minMax";
+        case BEMGraphMetricsStageXAxis: return "xAxis";
+        case BEMGraphMetricsStageDots: return "dots";
+        case BEMGraphMetricsStageLine: return "line";
+        case BEMGraphMetricsStageYAxis: return "yAxis";
+        case BEMGraphMetricsStageCommit: return "commit";
+        case BEMGraphMetricsStageTotal: return "total";
+        case BEMGraphMetricsStageCount: break;
+    }
+    return "unknown";
+}
+
+BEMGraphMetricsHistoryRef BEMGraphMetricsHistoryCreate(size_t capacity) {
+    BEMGraphMetricsHistoryRef history = calloc(1, sizeof(BEMGraphMetricsHistory));
+    if (history == NULL) return NULL;
+    history->capacity = capacity > 0 ? capacity : 1;
+    history->entries = malloc(sizeof(BEMGraphMetrics) * history->capacity);
+    if (history->entries == NULL) {
+        free(history);
+        return NULL;
+    }
+    return history;
+}
+
+void BEMGraphMetricsHistoryFree(BEMGraphMetricsHistoryRef history) {
+    if (history == NULL) return;
+    free(history->entries);
+    free(history);
+}
+
+void BEMGraphMetricsHistoryAdd(BEMGraphMetricsHistoryRef history, const BEMGraphMetrics *metrics) {
+    history->entries[history->next] = *metrics;
+    history->next = (history->next + 1) % history->capacity;
+    if (history->count < history->capacity) history->count++;
+}
+
+void BEMGraphMetricsHistoryRemoveAll(BEMGraphMetricsHistoryRef history) {
+    history->count = 0;
+    history->next = 0;
+}
+
+static int BEMGraphMetricsCompareDurations(const void *a, const void *b) {
+    double first = *(const double *)a;
+    double second = *(const double *)b;
+    return (first > second) - (first < second);
+}
+
+/// The duration at a nearest rank of the sorted durations
+static double BEMGraphMetricsPercentile(const double *sortedDurations, size_t count, double percentile) {
+    size_t rank = (size_t)(percentile * count);
+    if ((double)rank < percentile * count) rank++;
+    if (rank < 1) rank = 1;
+    return sortedDurations[rank - 1];
+}
+
+bool BEMGraphMetricsHistorySummarize(const BEMGraphMetricsHistory *history, BEMGraphMetricsStage stage, BEMGraphMetricsSummary *summary) {
+    memset(summary, 0, sizeof(BEMGraphMetricsSummary));
+    if (history->count == 0 || stage >= BEMGraphMetricsStageCount) return false;
+
+    // The history holds a few hundred reloads at most, sorting a copy is cheaper than anything smarter
+    double *durations = malloc(sizeof(double) * history->count);
+    if (durations == NULL) return false;
+    double sum = 0;
+    for (size_t i = 0; i < history->count; i++) {
+        durations[i] = history->entries[i].durations[stage];
+        sum += durations[i];
+    }
+    qsort(durations, history->count, sizeof(double), BEMGraphMetricsCompareDurations);
+
+    summary->count = history->count;
+    summary->mean = sum / history->count;
+    summary->p50 = BEMGraphMetricsPercentile(durations, history->count, 0.5);
+    summary->p99 = BEMGraphMetricsPercentile(durations, history->count, 0.99);
+    summary->maximum = durations[history->count - 1];
+    free(durations);
+    return true;
+}
@@ -0,0 +1,114 @@
+//
+//  BEMGraphMetrics.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMGraphMetrics_h
+#define BEMGraphMetrics_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The stages of a reload, in the order they run
+typedef enum BEMGraphMetricsStage {
+    /// Asking the data source for the number of points and the values of every series
+    BEMGraphMetricsStageDataFetch,
+    /// The extremes of the values, the visible range and the scale
+    BEMGraphMetricsStageMinMax,
+    /// Measuring, laying out and adding the X-Axis labels
+    BEMGraphMetricsStageXAxis,
+    /// Mapping and decimating the points, adding the dots and the permanent popups
+    BEMGraphMetricsStageDots,
+    /// Building the paths of the line and adding the line views
+    BEMGraphMetricsStageLine,
+    /// Measuring, laying out and adding the Y-Axis labels
+    BEMGraphMetricsStageYAxis,
+    /// From the end of the reload to the end of the Core Animation commit which displays it, drawing the lines included
+    BEMGraphMetricsStageCommit,
+    /// The whole reload, from the data fetch to the end of the commit
+    BEMGraphMetricsStageTotal,
+    /// The number of stages
+    BEMGraphMetricsStageCount
+} BEMGraphMetricsStage;
+
+/// What a single reload cost
+typedef struct BEMGraphMetrics {
+    /// The duration of every stage, in seconds, indexed by \p BEMGraphMetricsStage
+    double durations[BEMGraphMetricsStageCount];
+    /// The number of points of every series, and the number of points drawn after decimation
+    size_t pointCount;
+    size_t drawnPointCount;
+    /// The number of axis labels displayed
+    size_t labelCount;
+    /// The number of views allocated because none could be reused
+    size_t createdViewCount;
+    /** The growth of the heap during the reload, in blocks and bytes, freed memory deducted. Negative when the reload freed more than it allocated.
+     @discussion Read from the statistics of the whole process heap at the start and at the end of the reload: it includes everything allocated and freed by every thread in the meantime, the graph's own asynchronous reload queue included. Only meaningful when nothing else runs during the reload. */
+    int64_t allocationCount;
+    int64_t allocatedBytes;
+    /// true if the values were fetched and prepared on a background queue. The data fetch and min/max stages then report the time spent on that queue.
+    bool isAsynchronous;
+} BEMGraphMetrics;
+
+/// Returns the name of a stage, for reports and traces
+const char *BEMGraphMetricsStageName(BEMGraphMetricsStage stage);
+
+
+//----- HISTORY -----//
+
+/** The metrics of the last reloads of a graph, to follow typical and worst durations instead of single measures.
+ @discussion The history is a ring buffer: once it holds \p capacity reloads, every new reload replaces the oldest one. Only \p count should be read, the other fields are private. */
+typedef struct BEMGraphMetricsHistory {
+    /// The number of reloads in the history
+    size_t count;
+
+    size_t capacity;
+    /// The position of the next reload in \p entries
+    size_t next;
+    BEMGraphMetrics *entries;
+} BEMGraphMetricsHistory;
+
+typedef BEMGraphMetricsHistory *BEMGraphMetricsHistoryRef;
+
+/// Aggregated durations of a stage over the reloads of a history, in seconds
+typedef struct BEMGraphMetricsSummary {
+    /// The number of reloads aggregated
+    size_t count;
+    double mean;
+    /// The median duration
+    double p50;
+    /// The duration 99% of the reloads didn't exceed
+    double p99;
+    double maximum;
+} BEMGraphMetricsSummary;
+
+
+/// Creates an empty history keeping the last \p capacity reloads. Returns NULL if the memory could not be allocated.
+BEMGraphMetricsHistoryRef BEMGraphMetricsHistoryCreate(size_t capacity);
+
+/// Frees the history. Passing NULL does nothing.
+void BEMGraphMetricsHistoryFree(BEMGraphMetricsHistoryRef history);
+
+/// Adds the metrics of a reload, replacing the oldest reload when the history is full
+void BEMGraphMetricsHistoryAdd(BEMGraphMetricsHistoryRef history, const BEMGraphMetrics *metrics);
+
+/// Forgets every reload
+void BEMGraphMetricsHistoryRemoveAll(BEMGraphMetricsHistoryRef history);
+
+/** Aggregates the durations of a stage over every reload of the history.
+ @discussion Percentiles use the nearest rank: \p p99 is the smallest duration such that at least 99% of the reloads took as long or less, which is the maximum for fewer than 100 reloads.
+ @return false if the history is empty or the scratch memory could not be allocated, in which case \p summary is zeroed. */
+bool BEMGraphMetricsHistorySummarize(const BEMGraphMetricsHistory *history, BEMGraphMetricsStage stage, BEMGraphMetricsSummary *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,110 @@
+//
+//  BEMGraphRenderer.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMGraphRenderer.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+BEMGraphStyle BEMGraphStyleDefault(void) {
+    BEMGraphStyle style;
+    style.backgroundColor = (BEMRasterColor){1, 1, 1, 1};
+    style.topColor = (BEMRasterColor){0, 122.0f / 255.0f, 1, 1};
+    style.bottomColor = (BEMRasterColor){0, 122.0f / 255.0f, 1, 1};
+    style.lineColor = (BEMRasterColor){1, 1, 1, 1};
+    style.dotColor = (BEMRasterColor){1, 1, 1, 0.7f};
+    style.lineWidth = 1;
+    style.dotSize = 0;
+    style.padding = -1;
+    style.curve = BEMCurveInterpolationNone;
+    style.nullValueFill = BEMNullValueFillLinear;
+    return style;
+}
+
+BEMGraphRendererRef BEMGraphRendererCreate(void) {
+    BEMGraphRendererRef renderer = calloc(1, sizeof(BEMGraphRenderer));
+    if (renderer == NULL) return NULL;
+
+    renderer->points = BEMPointBufferCreate(0);
+    renderer->segments = BEMPointSegmentsCreate();
+    renderer->path = BEMPathCreate();
+    renderer->area = BEMPathCreate();
+    if (renderer->points == NULL || renderer->segments == NULL || renderer->path == NULL || renderer->area == NULL) {
+        BEMGraphRendererFree(renderer);
+        return NULL;
+    }
+    return renderer;
+}
+
+void BEMGraphRendererFree(BEMGraphRendererRef renderer) {
+    if (renderer == NULL) return;
+    BEMPointBufferRelease(renderer->points);
+    BEMPointSegmentsFree(renderer->segments);
+    BEMPathFree(renderer->path);
+    BEMPathFree(renderer->area);
+    free(renderer);
+}
+
+/// Fills the area between the line built in \p renderer->path and a horizontal edge of the canvas
+static bool BEMGraphRendererFillArea(BEMGraphRendererRef renderer, const BEMGraphStyle *style, float edgeY, BEMRasterColor color, BEMRasterCanvasRef canvas) {
+    if (color.alpha <= 0) return true;
+
+    float startX, endX;
+    BEMPathAreaBounds(renderer->points->x, renderer->segments, style->nullValueFill, (float)canvas->width, &startX, &endX);
+    BEMPathRemoveAllElements(renderer->area);
+    if (!BEMPathAppendArea(renderer->area, renderer->path, startX, endX, edgeY)) return false;
+    return BEMRasterFillPath(canvas, renderer->area, color);
+}
+
+bool BEMGraphRendererLayout(BEMGraphRendererRef renderer, const double *values, size_t count, double nullValue, const BEMGraphStyle *style, size_t width, size_t height) {
+    BEMPointBufferRemoveAllPoints(renderer->points);
+    if (count < 2) return true;
+
+    BEMGraphScale scale = {0};
+    scale.minimumValue = INFINITY;
+    scale.maximumValue = -INFINITY;
+    for (size_t i = 0; i < count; i++) {
+        double value = values[i];
+        if (value == nullValue || isnan(value)) continue;
+        if (value < scale.minimumValue) scale.minimumValue = value;
+        if (value > scale.maximumValue) scale.maximumValue = value;
+    }
+    scale.height = (float)height;
+    scale.padding = style->padding < 0 ? BEMGraphScaleDefaultPadding(scale.height) : style->padding;
+    scale.autoScale = true;
+    return BEMGraphLayoutPoints(values, count, nullValue, &scale, (float)width, renderer->points);
+}
+
+bool BEMGraphRendererDraw(BEMGraphRendererRef renderer, const BEMGraphStyle *style, BEMRasterCanvasRef canvas) {
+    BEMRasterClear(canvas, style->backgroundColor);
+    BEMPointBufferRef points = renderer->points;
+    if (points->count < 2) return true;
+
+    // The missing points are classified once, then the curve is built once for the fills and the stroke
+    if (!BEMPointSegmentsClassify(renderer->segments, points->y, points->count)) return false;
+    BEMPathRemoveAllElements(renderer->path);
+    if (!BEMPathAppendSegments(renderer->path, points->x, points->y, renderer->segments, style->curve, style->nullValueFill)) return false;
+    if (!BEMGraphRendererFillArea(renderer, style, 0, style->topColor, canvas)) return false;
+    if (!BEMGraphRendererFillArea(renderer, style, (float)canvas->height, style->bottomColor, canvas)) return false;
+
+    if (style->lineWidth > 0 && style->lineColor.alpha > 0) {
+        if (!BEMRasterStrokePath(canvas, renderer->path, style->lineWidth, style->lineColor)) return false;
+    }
+
+    if (style->dotSize > 0 && style->dotColor.alpha > 0) {
+        for (size_t i = 0; i < points->count; i++) {
+            if (BEMPointBufferIsNull(points->y[i])) continue;
+            BEMRasterFillCircle(canvas, points->x[i], points->y[i], style->dotSize / 2, style->dotColor);
+        }
+    }
+    return true;
+}
+
+bool BEMGraphRendererRender(BEMGraphRendererRef renderer, const double *values, size_t count, double nullValue, const BEMGraphStyle *style, BEMRasterCanvasRef canvas) {
+    if (!BEMGraphRendererLayout(renderer, values, count, nullValue, style, canvas->width, canvas->height)) return false;
+    return BEMGraphRendererDraw(renderer, style, canvas);
+}
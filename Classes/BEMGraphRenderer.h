@@ -0,0 +1,87 @@
+//
+//  BEMGraphRenderer.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMGraphRenderer_h
+#define BEMGraphRenderer_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "BEMPointBuffer.h"
+#include "BEMGraphLayout.h"
+#include "BEMRaster.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The appearance of a graph rendered by \p BEMGraphRendererRender. The alpha of every color includes the alpha properties of the graph view (\p alphaTop, \p alphaLine...).
+typedef struct BEMGraphStyle {
+    /// The color of the whole image before the graph is drawn
+    BEMRasterColor backgroundColor;
+    /// The color of the area above the line, \p colorTop
+    BEMRasterColor topColor;
+    /// The color of the area under the line, \p colorBottom
+    BEMRasterColor bottomColor;
+    /// The color of the line, \p colorLine
+    BEMRasterColor lineColor;
+    /// The color of the dots, \p colorPoint
+    BEMRasterColor dotColor;
+    /// The width of the line, \p widthLine
+    float lineWidth;
+    /// The diameter of the dots, \p sizePoint. 0 to hide the dots.
+    float dotSize;
+    /// The vertical room left around the points, see \p BEMGraphScaleDefaultPadding. Negative to use the default padding.
+    float padding;
+    /// The curve joining the points, \p curveInterpolation when \p enableBezierCurve is YES. BEMCurveInterpolationNone draws straight lines.
+    BEMCurveInterpolation curve;
+    /// The way the line crosses missing points, \p nullValueFill when \p interpolateNullValues is YES and BEMNullValueFillGap otherwise
+    BEMNullValueFill nullValueFill;
+} BEMGraphStyle;
+
+/// The appearance of a graph view with its default properties, on a white background. Dots are hidden, like when \p alwaysDisplayDots is NO.
+BEMGraphStyle BEMGraphStyleDefault(void);
+
+/** Renders graphs without UIKit, with the geometry of \p BEMSimpleLineGraphView and the \p BEMRasterCanvas rasterizer.
+ @discussion The renderer keeps the points and paths of the last graph, so rendering many graphs with one renderer doesn't allocate once it reached its working size. A renderer must only be used by one thread at a time, use one renderer and one canvas per thread. */
+typedef struct BEMGraphRenderer {
+    /// The points of the last graph, in the canvas' coordinate system. Missing points have a NaN y coordinate.
+    BEMPointBufferRef points;
+    /// The runs of present points of the last graph, private
+    BEMPointSegmentsRef segments;
+    /// Scratch paths of the line and of the areas around it, private
+    BEMPathRef path;
+    BEMPathRef area;
+} BEMGraphRenderer;
+
+typedef BEMGraphRenderer *BEMGraphRendererRef;
+
+
+/// Creates a renderer. Returns NULL if the memory could not be allocated.
+BEMGraphRendererRef BEMGraphRendererCreate(void);
+
+/// Frees the renderer. Passing NULL does nothing.
+void BEMGraphRendererFree(BEMGraphRendererRef renderer);
+
+/** Places the points of \p count values in \p renderer->points, for a canvas of \p width by \p height pixels. This is the first half of \p BEMGraphRendererRender.
+ @return false if the memory could not be allocated. */
+bool BEMGraphRendererLayout(BEMGraphRendererRef renderer, const double *values, size_t count, double nullValue, const BEMGraphStyle *style, size_t width, size_t height);
+
+/** Draws the points placed by the last call to \p BEMGraphRendererLayout. This is the second half of \p BEMGraphRendererRender.
+ @return false if the memory could not be allocated. */
+bool BEMGraphRendererDraw(BEMGraphRendererRef renderer, const BEMGraphStyle *style, BEMRasterCanvasRef canvas);
+
+/** Renders the graph of \p count values over the whole canvas: the area above the line, the area under the line, the line and the dots.
+ @discussion The values are scaled like a graph view with \p autoScaleYAxis, without axes. Values equal to \p nullValue (or NaN) are missing points. Graphs of less than two points only clear the canvas.
+ @return false if the memory could not be allocated. */
+bool BEMGraphRendererRender(BEMGraphRendererRef renderer, const double *values, size_t count, double nullValue, const BEMGraphStyle *style, BEMRasterCanvasRef canvas);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,90 @@
+//
+//  BEMGraphSnapshot.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+@import Foundation;
+@import UIKit;
+
+#import "BEMLine.h"
+#import "BEMPointBuffer.h"
+#import "BEMGraphLayout.h"
+#import "BEMGraphTransform.h"
+#import "BEMRangeTree.h"
+#import "BEMStatistics.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The layout of the graph the points of a snapshot are prepared for, read on the main thread when the reload starts
+typedef struct BEMGraphSnapshotLayout {
+    /// NO when the scale can't be known before the graph is laid out, for example when the delegate provides the extremes. The points are then only mapped on the main thread.
+    BOOL preparesPoints;
+    /// The scale of the graph. Its minimum and maximum values are replaced by the extremes of the snapshot.
+    BEMGraphScale scale;
+    /// The width the points are placed across
+    CGFloat width;
+    /// The number of points the width of the graph can display, 0 when the points are not decimated
+    size_t maximumDrawnCount;
+    BEMLineDecimation lineDecimation;
+    /// The size and options of the line, its paths are built for them
+    CGSize lineSize;
+    BEMCurveInterpolation curve;
+    BEMNullValueFill nullValueFill;
+    /// YES to build a min/max tree of every series, for graphs which can zoom. Points are not prepared then, they are read from the trees.
+    BOOL buildsTrees;
+} BEMGraphSnapshotLayout;
+
+
+/** The values of a graph and everything derived from them which doesn't need the main thread, prepared on a background queue and applied to the graph in one pass.
+ @discussion The values are filled through \p valuesOfSeries: right after the snapshot is created, then \p prepareWithLayout: computes the extremes, statistics, trees, points, decimation and paths. From then on the snapshot doesn't change: the graph borrows its values, trees and points for as long as it displays them, and takes over \p lineGeometry. */
+@interface BEMGraphSnapshot : NSObject
+
+/// Returns nil if the values could not be allocated
+- (nullable instancetype)initWithNumberOfPoints:(NSInteger)numberOfPoints numberOfSeries:(NSInteger)numberOfSeries NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) NSInteger numberOfPoints;
+@property (nonatomic, readonly) NSInteger numberOfSeries;
+
+/// The buffer holding the \p numberOfPoints values of a series, owned by the snapshot
+- (double *)valuesOfSeries:(NSInteger)series NS_RETURNS_INNER_POINTER;
+
+/// Computes everything the graph needs from the values, in a few passes over them
+- (void)prepareWithLayout:(BEMGraphSnapshotLayout)layout;
+
+/// The time spent fetching the values, set by the graph before preparing the snapshot, and the time spent in \p prepareWithLayout:, in seconds
+@property (nonatomic) CFTimeInterval fetchDuration;
+@property (nonatomic, readonly) CFTimeInterval preparationDuration;
+
+/// The smallest and biggest non-null values of every series
+@property (nonatomic, readonly) CGFloat minimumValue;
+@property (nonatomic, readonly) CGFloat maximumValue;
+
+/// The statistics of the first series
+@property (nonatomic, readonly) BEMStatistics statistics;
+
+/// The min/max tree of a series, NULL unless the layout builds trees
+- (nullable BEMRangeTreeRef)treeOfSeries:(NSInteger)series;
+
+/// The transform the points were mapped with. Only valid when \p linePoints isn't NULL.
+@property (nonatomic, readonly) BEMGraphTransform transform;
+
+/// The coordinates of every point of the first series, NULL unless the layout prepares points
+@property (nonatomic, readonly, nullable) BEMPointBufferRef linePoints;
+
+/// The points kept by the decimation and their index in \p linePoints, NULL when every point is drawn
+@property (nonatomic, readonly, nullable) BEMPointBufferRef decimatedPoints;
+@property (nonatomic, readonly, nullable) const size_t *decimatedIndices;
+
+/// The threshold and the algorithm of the decimation. The threshold is 0 when every point is drawn.
+@property (nonatomic, readonly) size_t decimationThreshold;
+@property (nonatomic, readonly) BEMLineDecimation lineDecimation;
+
+/// The paths of the line through the drawn points, nil unless the layout prepares points
+@property (nonatomic, readonly, nullable) BEMLineGeometry *lineGeometry;
+
+@end
+
+NS_ASSUME_NONNULL_END
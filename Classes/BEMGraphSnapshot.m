@@ -0,0 +1,137 @@
+//
+//  BEMGraphSnapshot.m
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#import "BEMGraphSnapshot.h"
+#import "BEMDecimation.h"
+
+/// Same value as BEMNullGraphValue, which can't be read from here without depending on the graph
+#define BEMGraphSnapshotNullValue CGFLOAT_MAX
+
+@interface BEMGraphSnapshot () {
+    /// The values of every series, one after the other
+    double *values;
+
+    /// One tree per series, NULL when not built
+    BEMRangeTreeRef *trees;
+
+    size_t *decimatedIndices;
+}
+
+@end
+
+@implementation BEMGraphSnapshot
+
+- (instancetype)initWithNumberOfPoints:(NSInteger)numberOfPoints numberOfSeries:(NSInteger)numberOfSeries {
+    self = [super init];
+    if (self) {
+        _numberOfPoints = MAX(numberOfPoints, 0);
+        _numberOfSeries = MAX(numberOfSeries, 1);
+        _minimumValue = INFINITY;
+        _maximumValue = -FLT_MAX;
+        values = malloc(sizeof(double) * (_numberOfPoints > 0 ? _numberOfPoints * _numberOfSeries : 1));
+        trees = calloc(_numberOfSeries, sizeof(BEMRangeTreeRef));
+        if (values == NULL || trees == NULL) return nil;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSInteger s = 0; trees != NULL && s < _numberOfSeries; s++) BEMRangeTreeFree(trees[s]);
+    free(trees);
+    free(values);
+    free(decimatedIndices);
+    BEMPointBufferRelease(_linePoints);
+    BEMPointBufferRelease(_decimatedPoints);
+}
+
+- (double *)valuesOfSeries:(NSInteger)series {
+    return values + series * _numberOfPoints;
+}
+
+- (BEMRangeTreeRef)treeOfSeries:(NSInteger)series {
+    return trees[series];
+}
+
+- (const size_t *)decimatedIndices {
+    return decimatedIndices;
+}
+
+- (void)prepareWithLayout:(BEMGraphSnapshotLayout)layout {
+    CFTimeInterval startTime = CACurrentMediaTime();
+    [self prepareValuesWithLayout:layout];
+    _preparationDuration = CACurrentMediaTime() - startTime;
+}
+
+- (void)prepareValuesWithLayout:(BEMGraphSnapshotLayout)layout {
+    size_t count = _numberOfPoints;
+
+    // Single pass over every series for the extremes, null values are skipped
+    CGFloat minimumValue = INFINITY;
+    CGFloat maximumValue = -FLT_MAX;
+    for (NSInteger s = 0; s < _numberOfSeries; s++) {
+        const double *seriesValues = [self valuesOfSeries:s];
+        for (size_t i = 0; i < count; i++) {
+            CGFloat value = seriesValues[i];
+            if (value == BEMGraphSnapshotNullValue) continue;
+            if (value < minimumValue) minimumValue = value;
+            if (value > maximumValue) maximumValue = value;
+        }
+    }
+    _minimumValue = minimumValue;
+    _maximumValue = maximumValue;
+
+    if (!BEMStatisticsCompute(values, count, BEMGraphSnapshotNullValue, &_statistics)) _statistics = (BEMStatistics){0};
+
+    // Graphs which can zoom read their points from the trees once the visible range is known
+    if (layout.buildsTrees) {
+        for (NSInteger s = 0; s < _numberOfSeries; s++) trees[s] = BEMRangeTreeCreate([self valuesOfSeries:s], count, BEMGraphSnapshotNullValue);
+        return;
+    }
+    if (!layout.preparesPoints || count <= 1) return;
+
+    // The points of the first series, with the transform the graph will compute if its layout didn't change
+    BEMGraphScale scale = layout.scale;
+    scale.minimumValue = minimumValue;
+    scale.maximumValue = maximumValue;
+    _transform = BEMGraphTransformMake(&scale, layout.width, count);
+
+    BEMPointBufferRef points = BEMPointBufferCreate(count);
+    if (points == NULL || !BEMPointBufferReserve(points, count)) {
+        BEMPointBufferRelease(points);
+        return;
+    }
+    BEMGraphTransformPoints(&_transform, values, count, BEMGraphSnapshotNullValue, 0, points->x, points->y);
+    points->count = count;
+    _linePoints = points;
+
+    size_t threshold = layout.maximumDrawnCount;
+    if (layout.lineDecimation != BEMLineDecimationNone && threshold < count && threshold >= 3) {
+        decimatedIndices = malloc(sizeof(size_t) * threshold);
+        BEMPointBufferRef keptPoints = decimatedIndices ? BEMPointBufferCreate(threshold) : NULL;
+        size_t keptCount = 0;
+        if (keptPoints) {
+            if (layout.lineDecimation == BEMLineDecimationMinMax) keptCount = BEMDecimateMinMax(points, threshold, keptPoints, decimatedIndices);
+            else keptCount = BEMDecimateLargestTriangleThreeBuckets(points, threshold, keptPoints, decimatedIndices);
+        }
+        if (keptCount > 0) {
+            _decimatedPoints = keptPoints;
+            _decimationThreshold = threshold;
+            _lineDecimation = layout.lineDecimation;
+        } else {
+            BEMPointBufferRelease(keptPoints);
+            free(decimatedIndices);
+            decimatedIndices = NULL;
+        }
+    }
+
+    // The paths are keyed by the drawn buffer, a line drawing it with the same size and options doesn't build them again
+    BEMPointBufferRef drawnPoints = _decimatedPoints ? _decimatedPoints : _linePoints;
+    _lineGeometry = [[BEMLineGeometry alloc] init];
+    [_lineGeometry updateWithPoints:drawnPoints size:layout.lineSize curve:(drawnPoints->count > 2 ? layout.curve : BEMCurveInterpolationNone) nullValueFill:layout.nullValueFill];
+}
+
+@end
@@ -0,0 +1,211 @@
+//
+//  BEMGraphTransform.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMGraphTransform.h"
+
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// The AVX kernel is compiled for every x86-64 target and only used when the processor supports it
+#if defined(__x86_64__) && defined(__GNUC__)
+#define BEMGraphTransformHasAVX 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define BEMGraphTransformHasNEON 1
+#include <arm_neon.h>
+#endif
+
+BEMGraphTransform BEMGraphTransformMake(const BEMGraphScale *scale, float width, size_t count) {
+    BEMGraphTransform transform;
+    transform.xStep = count > 1 ? (double)width / (count - 1) : 0;
+
+    // The X-Axis labels take their height at the bottom of the graph
+    double labelOffset = scale->autoScale ? scale->xAxisLabelHeight / 2.0 - scale->xAxisLabelHeight : -scale->xAxisLabelHeight;
+    if (scale->autoScale && scale->minimumValue == scale->maximumValue) {
+        // A flat graph is centered
+        transform.yOrigin = 0;
+        transform.yScale = 0;
+        transform.yOffset = scale->height / 2.0 - scale->xAxisLabelHeight;
+    } else if (scale->autoScale) {
+        // The values are spread over the height, half the padding above and under them
+        transform.yOrigin = scale->minimumValue;
+        transform.yScale = -((double)scale->height - scale->padding) / (scale->maximumValue - scale->minimumValue);
+        transform.yOffset = (scale->height - scale->padding / 2.0) + labelOffset;
+    } else {
+        // The values are the distance from the bottom of the graph
+        transform.yOrigin = 0;
+        transform.yScale = -1;
+        transform.yOffset = scale->height + labelOffset;
+    }
+    return transform;
+}
+
+//----- KERNELS -----//
+
+static void BEMGraphTransformPointsScalar(const BEMGraphTransform *transform, const double *values, size_t count, double nullValue, size_t firstIndex, float *x, float *y) {
+    for (size_t i = 0; i < count; i++) {
+        double value = values[i];
+        x[i] = (float)(transform->xStep * (double)(firstIndex + i));
+        y[i] = (value == nullValue || isnan(value)) ? BEMPointBufferNullValue : BEMGraphTransformY(transform, value);
+    }
+}
+
+#if defined(__SSE2__)
+static void BEMGraphTransformPointsSSE2(const BEMGraphTransform *transform, const double *values, size_t count, double nullValue, size_t firstIndex, float *x, float *y) {
+    const __m128d origin = _mm_set1_pd(transform->yOrigin);
+    const __m128d scale = _mm_set1_pd(transform->yScale);
+    const __m128d offset = _mm_set1_pd(transform->yOffset);
+    const __m128d null = _mm_set1_pd(nullValue);
+    const __m128d missingY = _mm_set1_pd(NAN);
+    const __m128d step = _mm_set1_pd(transform->xStep);
+    const __m128d two = _mm_set1_pd(2);
+    __m128d index = _mm_set_pd((double)firstIndex + 1, (double)firstIndex);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d value = _mm_loadu_pd(values + i);
+        __m128d missing = _mm_or_pd(_mm_cmpeq_pd(value, null), _mm_cmpunord_pd(value, value));
+        __m128d position = _mm_add_pd(offset, _mm_mul_pd(_mm_sub_pd(value, origin), scale));
+        position = _mm_or_pd(_mm_andnot_pd(missing, position), _mm_and_pd(missing, missingY));
+        _mm_storel_pi((__m64 *)(y + i), _mm_cvtpd_ps(position));
+        _mm_storel_pi((__m64 *)(x + i), _mm_cvtpd_ps(_mm_mul_pd(index, step)));
+        index = _mm_add_pd(index, two);
+    }
+    BEMGraphTransformPointsScalar(transform, values + i, count - i, nullValue, firstIndex + i, x + i, y + i);
+}
+#endif
+
+#if BEMGraphTransformHasAVX
+__attribute__((target("avx")))
+static void BEMGraphTransformPointsAVX(const BEMGraphTransform *transform, const double *values, size_t count, double nullValue, size_t firstIndex, float *x, float *y) {
+    const __m256d origin = _mm256_set1_pd(transform->yOrigin);
+    const __m256d scale = _mm256_set1_pd(transform->yScale);
+    const __m256d offset = _mm256_set1_pd(transform->yOffset);
+    const __m256d null = _mm256_set1_pd(nullValue);
+    const __m256d missingY = _mm256_set1_pd(NAN);
+    const __m256d step = _mm256_set1_pd(transform->xStep);
+    const __m256d four = _mm256_set1_pd(4);
+    __m256d index = _mm256_set_pd((double)firstIndex + 3, (double)firstIndex + 2, (double)firstIndex + 1, (double)firstIndex);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d value = _mm256_loadu_pd(values + i);
+        __m256d missing = _mm256_or_pd(_mm256_cmp_pd(value, null, _CMP_EQ_OQ), _mm256_cmp_pd(value, value, _CMP_UNORD_Q));
+        __m256d position = _mm256_add_pd(offset, _mm256_mul_pd(_mm256_sub_pd(value, origin), scale));
+        position = _mm256_or_pd(_mm256_andnot_pd(missing, position), _mm256_and_pd(missing, missingY));
+        _mm_storeu_ps(y + i, _mm256_cvtpd_ps(position));
+        _mm_storeu_ps(x + i, _mm256_cvtpd_ps(_mm256_mul_pd(index, step)));
+        index = _mm256_add_pd(index, four);
+    }
+    BEMGraphTransformPointsScalar(transform, values + i, count - i, nullValue, firstIndex + i, x + i, y + i);
+}
+#endif
+
+#if BEMGraphTransformHasNEON
+static void BEMGraphTransformPointsNEON(const BEMGraphTransform *transform, const double *values, size_t count, double nullValue, size_t firstIndex, float *x, float *y) {
+    const float64x2_t origin = vdupq_n_f64(transform->yOrigin);
+    const float64x2_t scale = vdupq_n_f64(transform->yScale);
+    const float64x2_t offset = vdupq_n_f64(transform->yOffset);
+    const float64x2_t null = vdupq_n_f64(nullValue);
+    const float64x2_t missingY = vdupq_n_f64(NAN);
+    const float64x2_t step = vdupq_n_f64(transform->xStep);
+    const float64x2_t two = vdupq_n_f64(2);
+    const double firstIndices[2] = {(double)firstIndex, (double)firstIndex + 1};
+    float64x2_t index = vld1q_f64(firstIndices);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t value = vld1q_f64(values + i);
+        // NaN is the only value which isn't equal to itself
+        uint64x2_t present = vbicq_u64(vceqq_f64(value, value), vceqq_f64(value, null));
+        float64x2_t position = vaddq_f64(offset, vmulq_f64(vsubq_f64(value, origin), scale));
+        vst1_f32(y + i, vcvt_f32_f64(vbslq_f64(present, position, missingY)));
+        vst1_f32(x + i, vcvt_f32_f64(vmulq_f64(index, step)));
+        index = vaddq_f64(index, two);
+    }
+    BEMGraphTransformPointsScalar(transform, values + i, count - i, nullValue, firstIndex + i, x + i, y + i);
+}
+#endif
+
+//----- DISPATCH -----//
+
+bool BEMGraphTransformKernelIsAvailable(BEMGraphTransformKernel kernel) {
+    switch (kernel) {
+        case BEMGraphTransformKernelScalar:
+            return true;
+        case BEMGraphTransformKernelSSE2:
+#if defined(__SSE2__)
+            return true;
+#else
+            return false;
+#endif
+        case BEMGraphTransformKernelAVX:
+#if BEMGraphTransformHasAVX
+            return __builtin_cpu_supports("avx");
+#else
+            return false;
+#endif
+        case BEMGraphTransformKernelNEON:
+#if BEMGraphTransformHasNEON
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+BEMGraphTransformKernel BEMGraphTransformFastestKernel(void) {
+    if (BEMGraphTransformKernelIsAvailable(BEMGraphTransformKernelAVX)) return BEMGraphTransformKernelAVX;
+    if (BEMGraphTransformKernelIsAvailable(BEMGraphTransformKernelSSE2)) return BEMGraphTransformKernelSSE2;
+    if (BEMGraphTransformKernelIsAvailable(BEMGraphTransformKernelNEON)) return BEMGraphTransformKernelNEON;
+    return BEMGraphTransformKernelScalar;
+}
+
+const char *BEMGraphTransformKernelName(BEMGraphTransformKernel kernel) {
+    switch (kernel) {
+        case BEMGraphTransformKernelScalar: return "scalar";
+        case BEMGraphTransformKernelSSE2: return "sse2";
+        case BEMGraphTransformKernelAVX: return "avx";
+        case BEMGraphTransformKernelNEON: return "neon";
+    }
+    return "unknown";
+}
+
+bool BEMGraphTransformPointsWithKernel(BEMGraphTransformKernel kernel, const BEMGraphTransform *transform, const double *values, size_t count, double nullValue, size_t firstIndex, float *x, float *y) {
+    if (!BEMGraphTransformKernelIsAvailable(kernel)) return false;
+
+    switch (kernel) {
+#if defined(__SSE2__)
+        case BEMGraphTransformKernelSSE2:
+            BEMGraphTransformPointsSSE2(transform, values, count, nullValue, firstIndex, x, y);
+            return true;
+#endif
+#if BEMGraphTransformHasAVX
+        case BEMGraphTransformKernelAVX:
+            BEMGraphTransformPointsAVX(transform, values, count, nullValue, firstIndex, x, y);
+            return true;
+#endif
+#if BEMGraphTransformHasNEON
+        case BEMGraphTransformKernelNEON:
+            BEMGraphTransformPointsNEON(transform, values, count, nullValue, firstIndex, x, y);
+            return true;
+#endif
+        default:
+            BEMGraphTransformPointsScalar(transform, values, count, nullValue, firstIndex, x, y);
+            return true;
+    }
+}
+
+void BEMGraphTransformPoints(const BEMGraphTransform *transform, const double *values, size_t count, double nullValue, size_t firstIndex, float *x, float *y) {
+    BEMGraphTransformPointsWithKernel(BEMGraphTransformFastestKernel(), transform, values, count, nullValue, firstIndex, x, y);
+}
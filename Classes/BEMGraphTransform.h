@@ -0,0 +1,81 @@
+//
+//  BEMGraphTransform.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMGraphTransform_h
+#define BEMGraphTransform_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "BEMGraphLayout.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Mapping from the index and the value of a point to its coordinates, computed once per layout from a \p BEMGraphScale.
+ @discussion A point at \p index with \p value is placed at x = \p xStep * index and y = \p yOffset + (value - \p yOrigin) * \p yScale. Every scale of the graph view reduces to this form, so the whole value array can be mapped by one vector kernel without looking at the scale again. */
+typedef struct BEMGraphTransform {
+    /// The horizontal distance between two consecutive points
+    double xStep;
+    /// The value placed at \p yOffset
+    double yOrigin;
+    /// The vertical distance between two values one unit apart, negative since y grows downwards
+    double yScale;
+    /// The y coordinate of \p yOrigin
+    double yOffset;
+} BEMGraphTransform;
+
+/// The vector instructions used to map the points
+typedef enum BEMGraphTransformKernel {
+    /// Plain C, available everywhere
+    BEMGraphTransformKernelScalar,
+    /// 2 values per instruction on x86
+    BEMGraphTransformKernelSSE2,
+    /// 4 values per instruction on x86 processors supporting AVX, selected at run time
+    BEMGraphTransformKernelAVX,
+    /// 2 values per instruction on 64-bit ARM
+    BEMGraphTransformKernelNEON
+} BEMGraphTransformKernel;
+
+/// The transform placing \p count points across \p width with the vertical \p scale
+BEMGraphTransform BEMGraphTransformMake(const BEMGraphScale *scale, float width, size_t count);
+
+/// Returns true if both transforms place every point at the same coordinates
+static inline bool BEMGraphTransformEqualToTransform(const BEMGraphTransform *transform, const BEMGraphTransform *otherTransform) {
+    return transform->xStep == otherTransform->xStep && transform->yOrigin == otherTransform->yOrigin && transform->yScale == otherTransform->yScale && transform->yOffset == otherTransform->yOffset;
+}
+
+/// Returns the y coordinate of \p value, which is the same as \p BEMGraphScaleYPosition for the scale of the transform
+static inline float BEMGraphTransformY(const BEMGraphTransform *transform, double value) {
+    // Separate operations, so every kernel rounds the same way and none of them fuses the multiply and the add
+    double offset = value - transform->yOrigin;
+    double distance = offset * transform->yScale;
+    return (float)(transform->yOffset + distance);
+}
+
+/** Maps \p count values to point coordinates with the fastest kernel available.
+ @discussion \p values[i] is the point at index \p firstIndex + i, so a part of the graph can be mapped on its own. Values equal to \p nullValue (or NaN) become missing points, with a NaN y coordinate, in the same pass. Every kernel writes exactly the same coordinates. */
+void BEMGraphTransformPoints(const BEMGraphTransform *transform, const double *values, size_t count, double nullValue, size_t firstIndex, float *x, float *y);
+
+/// Same as \p BEMGraphTransformPoints with a given kernel. Returns false, without writing anything, if the kernel is not available.
+bool BEMGraphTransformPointsWithKernel(BEMGraphTransformKernel kernel, const BEMGraphTransform *transform, const double *values, size_t count, double nullValue, size_t firstIndex, float *x, float *y);
+
+/// Returns true if the kernel was compiled for this target and is supported by the processor
+bool BEMGraphTransformKernelIsAvailable(BEMGraphTransformKernel kernel);
+
+/// The kernel used by \p BEMGraphTransformPoints
+BEMGraphTransformKernel BEMGraphTransformFastestKernel(void);
+
+/// The name of the kernel, for reports
+const char *BEMGraphTransformKernelName(BEMGraphTransformKernel kernel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,358 @@
+//
+//  BEMLabelLayout.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMLabelLayout.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//----- TEXT METRICS -----//
+
+/// The number of entries allocated for an empty cache
+#define BEMTextMetricsInitialCapacity 64
+
+static uint64_t BEMTextMetricsHash(uint64_t fontKey, const char *text, size_t length) {
+    // FNV-1a over the font key and the text
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < sizeof(fontKey); i++) {
+        hash ^= (fontKey >> (8 * i)) & 0xff;
+        hash *= 1099511628211ULL;
+    }
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 1099511628211ULL;
+    }
+    // 0 marks the empty entries
+    return hash ? hash : 1;
+}
+
+BEMTextMetricsCacheRef BEMTextMetricsCacheCreate(size_t maximumCount) {
+    BEMTextMetricsCacheRef cache = calloc(1, sizeof(BEMTextMetricsCache));
+    if (cache == NULL) return NULL;
+    cache->maximumCount = maximumCount > 0 ? maximumCount : 1;
+    cache->capacity = BEMTextMetricsInitialCapacity;
+    cache->entries = calloc(cache->capacity, sizeof(BEMTextMetricsEntry));
+    if (cache->entries == NULL) {
+        BEMTextMetricsCacheFree(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void BEMTextMetricsCacheFree(BEMTextMetricsCacheRef cache) {
+    if (cache == NULL) return;
+    free(cache->entries);
+    free(cache->texts);
+    free(cache);
+}
+
+void BEMTextMetricsCacheRemoveAll(BEMTextMetricsCacheRef cache) {
+    memset(cache->entries, 0, sizeof(BEMTextMetricsEntry) * cache->capacity);
+    cache->count = 0;
+    cache->textsLength = 0;
+}
+
+/// The entry holding the text, or the empty entry where it belongs
+static BEMTextMetricsEntry *BEMTextMetricsFindEntry(const BEMTextMetricsCache *cache, BEMTextMetricsEntry *entries, size_t capacity, uint64_t hash, uint64_t fontKey, const char *text, size_t length) {
+    size_t mask = capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        BEMTextMetricsEntry *entry = &entries[i];
+        if (entry->hash == 0) return entry;
+        if (entry->hash == hash && entry->fontKey == fontKey && entry->length == length && (length == 0 || memcmp(cache->texts + entry->textOffset, text, length) == 0)) return entry;
+    }
+}
+
+/// Doubles the number of entries, which keeps at least half of them empty
+static bool BEMTextMetricsGrow(BEMTextMetricsCacheRef cache) {
+    size_t capacity = cache->capacity * 2;
+    BEMTextMetricsEntry *entries = calloc(capacity, sizeof(BEMTextMetricsEntry));
+    if (entries == NULL) return false;
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        BEMTextMetricsEntry *entry = &cache->entries[i];
+        if (entry->hash == 0) continue;
+        // Every text is unique, it goes in the first empty entry without comparing texts
+        size_t j = entry->hash & mask;
+        while (entries[j].hash != 0) j = (j + 1) & mask;
+        entries[j] = *entry;
+    }
+    free(cache->entries);
+    cache->entries = entries;
+    cache->capacity = capacity;
+    return true;
+}
+
+bool BEMTextMetricsCacheMeasure(BEMTextMetricsCacheRef cache, uint64_t fontKey, const char *text, size_t length, BEMTextMeasureFunction measure, void *context, float *width, float *height) {
+    uint64_t hash = BEMTextMetricsHash(fontKey, text, length);
+    BEMTextMetricsEntry *entry = BEMTextMetricsFindEntry(cache, cache->entries, cache->capacity, hash, fontKey, text, length);
+    if (entry->hash != 0) {
+        cache->hitCount++;
+        *width = entry->width;
+        *height = entry->height;
+        return true;
+    }
+
+    cache->missCount++;
+    float measuredWidth, measuredHeight;
+    if (!measure(context, text, length, &measuredWidth, &measuredHeight)) return false;
+    *width = measuredWidth;
+    *height = measuredHeight;
+
+    // A full cache starts over, the texts displayed next are measured again
+    if (cache->count >= cache->maximumCount) BEMTextMetricsCacheRemoveAll(cache);
+    if (2 * (cache->count + 1) > cache->capacity && !BEMTextMetricsGrow(cache)) return true;
+    if (cache->textsLength + length > cache->textsCapacity) {
+        size_t textsCapacity = (cache->textsLength + length) * 2;
+        char *texts = realloc(cache->texts, textsCapacity);
+        if (texts == NULL) return true;
+        cache->texts = texts;
+        cache->textsCapacity = textsCapacity;
+    }
+
+    entry = BEMTextMetricsFindEntry(cache, cache->entries, cache->capacity, hash, fontKey, text, length);
+    if (length > 0) memcpy(cache->texts + cache->textsLength, text, length);
+    entry->hash = hash;
+    entry->fontKey = fontKey;
+    entry->textOffset = cache->textsLength;
+    entry->length = length;
+    entry->width = measuredWidth;
+    entry->height = measuredHeight;
+    cache->textsLength += length;
+    cache->count++;
+    return true;
+}
+
+//----- PLACEMENT -----//
+
+/// The extent of a label along an axis
+typedef struct BEMLabelInterval {
+    float start;
+    float end;
+} BEMLabelInterval;
+
+static inline BEMLabelInterval BEMLabelBoxInterval(BEMLabelBox box, BEMLabelAxis axis) {
+    BEMLabelInterval interval;
+    interval.start = axis == BEMLabelAxisHorizontal ? box.x : box.y;
+    interval.end = interval.start + (axis == BEMLabelAxisHorizontal ? box.width : box.height);
+    return interval;
+}
+
+static inline bool BEMLabelBoxContainsBox(BEMLabelBox bounds, BEMLabelBox box) {
+    return box.x >= bounds.x && box.y >= bounds.y && box.x + box.width <= bounds.x + bounds.width && box.y + box.height <= bounds.y + bounds.height;
+}
+
+static inline bool BEMLabelIntervalsOverlap(BEMLabelInterval a, BEMLabelInterval b, float spacing) {
+    return a.start <= b.end + spacing && b.start <= a.end + spacing;
+}
+
+size_t BEMLabelLayoutSelect(const BEMLabelBox *boxes, size_t count, BEMLabelBox bounds, BEMLabelAxis axis, float spacing, size_t *selected) {
+    // The kept labels, sorted by position. Kept labels never overlap, so they are sorted by both ends.
+    BEMLabelInterval *kept = malloc(sizeof(BEMLabelInterval) * (count > 0 ? count : 1));
+    size_t keptCount = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!BEMLabelBoxContainsBox(bounds, boxes[i])) continue;
+        BEMLabelInterval interval = BEMLabelBoxInterval(boxes[i], axis);
+
+        if (kept == NULL) {
+            // Without memory, labels are only compared with the last kept label
+            if (keptCount > 0 && BEMLabelIntervalsOverlap(BEMLabelBoxInterval(boxes[selected[keptCount - 1]], axis), interval, spacing)) continue;
+            selected[keptCount++] = i;
+            continue;
+        }
+
+        // The first kept label starting after this one, ticks in the order of the axis always land at the end
+        size_t position = keptCount;
+        if (keptCount > 0 && kept[keptCount - 1].start > interval.start) {
+            size_t low = 0, high = keptCount;
+            while (low < high) {
+                size_t middle = low + (high - low) / 2;
+                if (kept[middle].start > interval.start) high = middle;
+                else low = middle + 1;
+            }
+            position = low;
+        }
+        if (position > 0 && BEMLabelIntervalsOverlap(kept[position - 1], interval, spacing)) continue;
+        if (position < keptCount && BEMLabelIntervalsOverlap(kept[position], interval, spacing)) continue;
+
+        memmove(kept + position + 1, kept + position, sizeof(BEMLabelInterval) * (keptCount - position));
+        kept[position] = interval;
+        selected[keptCount++] = i;
+    }
+
+    free(kept);
+    return keptCount;
+}
+
+/// Popup index sorted by the left edge of its frames
+typedef struct BEMPopupOrder {
+    float x;
+    size_t index;
+} BEMPopupOrder;
+
+static int BEMPopupOrderCompare(const void *a, const void *b) {
+    const BEMPopupOrder *first = a;
+    const BEMPopupOrder *second = b;
+    if (first->x < second->x) return -1;
+    if (first->x > second->x) return 1;
+    // Popups at the same position keep their order, qsort isn't stable
+    return (first->index > second->index) - (first->index < second->index);
+}
+
+static int BEMFloatCompare(const void *a, const void *b) {
+    float first = *(const float *)a;
+    float second = *(const float *)b;
+    return (first > second) - (first < second);
+}
+
+/// The index of \p value in the sorted, unique \p values, which hold it
+static size_t BEMFloatIndex(const float *values, size_t count, float value) {
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (values[middle] < value) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+/// A placed popup under the sweep line, until the sweep line passes its right edge
+typedef struct BEMPopupExtent {
+    float right;
+    /// The indices of the top and the bottom edges of the popup in the sorted y coordinates
+    size_t top;
+    size_t bottom;
+} BEMPopupExtent;
+
+/// Min-heap of the placed popups under the sweep line, by right edge
+static void BEMPopupHeapPush(BEMPopupExtent *heap, size_t *count, BEMPopupExtent extent) {
+    size_t i = (*count)++;
+    while (i > 0 && heap[(i - 1) / 2].right > extent.right) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = extent;
+}
+
+static BEMPopupExtent BEMPopupHeapPop(BEMPopupExtent *heap, size_t *count) {
+    BEMPopupExtent top = heap[0];
+    BEMPopupExtent last = heap[--(*count)];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= *count) break;
+        if (child + 1 < *count && heap[child + 1].right < heap[child].right) child++;
+        if (heap[child].right >= last.right) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (*count > 0) heap[i] = last;
+    return top;
+}
+
+/** Number of placed popups under the sweep line covering every y coordinate, as a segment tree.
+ @discussion Every node holds the count added to its whole range and the largest count in its range, so adding a popup, removing it and finding whether any popup covers a range of y coordinates each take O(log n). */
+typedef struct BEMPopupCoverage {
+    int *added;
+    int *maximum;
+    /// The number of leaves, one per y coordinate, rounded up to a power of two
+    size_t size;
+} BEMPopupCoverage;
+
+static void BEMPopupCoverageAdd(BEMPopupCoverage *coverage, size_t node, size_t nodeStart, size_t nodeEnd, size_t start, size_t end, int count) {
+    if (end < nodeStart || nodeEnd < start) return;
+    if (start <= nodeStart && nodeEnd <= end) {
+        coverage->added[node] += count;
+        coverage->maximum[node] += count;
+        return;
+    }
+    size_t middle = nodeStart + (nodeEnd - nodeStart) / 2;
+    BEMPopupCoverageAdd(coverage, 2 * node, nodeStart, middle, start, end, count);
+    BEMPopupCoverageAdd(coverage, 2 * node + 1, middle + 1, nodeEnd, start, end, count);
+    int left = coverage->maximum[2 * node], right = coverage->maximum[2 * node + 1];
+    coverage->maximum[node] = coverage->added[node] + (left > right ? left : right);
+}
+
+static int BEMPopupCoverageMaximum(const BEMPopupCoverage *coverage, size_t node, size_t nodeStart, size_t nodeEnd, size_t start, size_t end) {
+    if (end < nodeStart || nodeEnd < start) return 0;
+    if (start <= nodeStart && nodeEnd <= end) return coverage->maximum[node];
+    size_t middle = nodeStart + (nodeEnd - nodeStart) / 2;
+    int left = BEMPopupCoverageMaximum(coverage, 2 * node, nodeStart, middle, start, end);
+    int right = BEMPopupCoverageMaximum(coverage, 2 * node + 1, middle + 1, nodeEnd, start, end);
+    return coverage->added[node] + (left > right ? left : right);
+}
+
+bool BEMLabelLayoutPlacePopups(const BEMLabelBox *aboveBoxes, const BEMLabelBox *belowBoxes, size_t count, float minimumY, bool *isBelow) {
+    for (size_t i = 0; i < count; i++) isBelow[i] = false;
+    if (count == 0) return true;
+
+    // The top and bottom edges of every frame, sorted, so the frames cover ranges of indices
+    size_t edgeCount = 4 * count;
+    size_t size = 1;
+    while (size < edgeCount) size *= 2;
+    BEMPopupOrder *order = malloc(sizeof(BEMPopupOrder) * count);
+    BEMPopupExtent *heap = malloc(sizeof(BEMPopupExtent) * count);
+    float *edges = malloc(sizeof(float) * edgeCount);
+    BEMPopupCoverage coverage = {calloc(2 * size, sizeof(int)), calloc(2 * size, sizeof(int)), size};
+    if (order == NULL || heap == NULL || edges == NULL || coverage.added == NULL || coverage.maximum == NULL) {
+        free(order);
+        free(heap);
+        free(edges);
+        free(coverage.added);
+        free(coverage.maximum);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        order[i].x = aboveBoxes[i].x;
+        order[i].index = i;
+        edges[4 * i] = aboveBoxes[i].y;
+        edges[4 * i + 1] = aboveBoxes[i].y + aboveBoxes[i].height;
+        edges[4 * i + 2] = belowBoxes[i].y;
+        edges[4 * i + 3] = belowBoxes[i].y + belowBoxes[i].height;
+    }
+    qsort(order, count, sizeof(BEMPopupOrder), BEMPopupOrderCompare);
+    qsort(edges, edgeCount, sizeof(float), BEMFloatCompare);
+    size_t uniqueCount = 1;
+    for (size_t e = 1; e < edgeCount; e++) {
+        if (edges[e] != edges[uniqueCount - 1]) edges[uniqueCount++] = edges[e];
+    }
+
+    size_t heapCount = 0;
+    for (size_t n = 0; n < count; n++) {
+        size_t i = order[n].index;
+
+        // The popups ending before the sweep line can't overlap this popup or the next ones, they are never looked at again
+        while (heapCount > 0 && heap[0].right < order[n].x) {
+            BEMPopupExtent extent = BEMPopupHeapPop(heap, &heapCount);
+            BEMPopupCoverageAdd(&coverage, 1, 0, size - 1, extent.top, extent.bottom, -1);
+        }
+
+        // Every popup left under the sweep line overlaps this popup horizontally, it overlaps it if it covers any of its y coordinates
+        BEMLabelBox above = aboveBoxes[i];
+        size_t aboveTop = BEMFloatIndex(edges, uniqueCount, above.y);
+        size_t aboveBottom = BEMFloatIndex(edges, uniqueCount, above.y + above.height);
+        bool goesBelow = above.y <= minimumY || BEMPopupCoverageMaximum(&coverage, 1, 0, size - 1, aboveTop, aboveBottom) > 0;
+        isBelow[i] = goesBelow;
+
+        BEMLabelBox placed = goesBelow ? belowBoxes[i] : above;
+        BEMPopupExtent extent = {placed.x + placed.width, aboveTop, aboveBottom};
+        if (goesBelow) {
+            extent.top = BEMFloatIndex(edges, uniqueCount, placed.y);
+            extent.bottom = BEMFloatIndex(edges, uniqueCount, placed.y + placed.height);
+        }
+        BEMPopupCoverageAdd(&coverage, 1, 0, size - 1, extent.top, extent.bottom, 1);
+        BEMPopupHeapPush(heap, &heapCount, extent);
+    }
+
+    free(order);
+    free(heap);
+    free(edges);
+    free(coverage.added);
+    free(coverage.maximum);
+    return true;
+}
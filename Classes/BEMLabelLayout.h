@@ -0,0 +1,108 @@
+//
+//  BEMLabelLayout.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMLabelLayout_h
+#define BEMLabelLayout_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//----- TEXT METRICS -----//
+
+/** Measures the size of a text, in points. Only called by the cache for texts it hasn't measured yet.
+ @param context The context passed to \p BEMTextMetricsCacheMeasure, typically the font.
+ @param text The UTF-8 text, not NUL terminated.
+ @return false if the text could not be measured, in which case nothing is cached. */
+typedef bool (*BEMTextMeasureFunction)(void *context, const char *text, size_t length, float *width, float *height);
+
+/// A measured text, private to the cache
+typedef struct BEMTextMetricsEntry {
+    uint64_t hash;
+    uint64_t fontKey;
+    size_t textOffset;
+    size_t length;
+    float width;
+    float height;
+} BEMTextMetricsEntry;
+
+/** Sizes of the texts already measured, keyed by font and string, so a label which is laid out again isn't measured again.
+ @discussion Measuring a text with the platform's text system is by far the most expensive part of laying out labels, and axes draw the same texts over and over: on every reload, resize, zoom or scroll. The cache is an open-addressing hash table with the texts packed in a single buffer. It keeps at most \p maximumCount texts and is emptied when it's full, so its memory stays bounded whatever is displayed.
+
+ A cache is not thread-safe. Only \p count, \p hitCount and \p missCount should be read, the other fields are private. */
+typedef struct BEMTextMetricsCache {
+    /// The number of texts in the cache
+    size_t count;
+    /// The number of measures answered by the cache, and the number of measures which called the measure function
+    size_t hitCount;
+    size_t missCount;
+
+    size_t maximumCount;
+    /// Power of 2, at least twice \p count
+    size_t capacity;
+    BEMTextMetricsEntry *entries;
+    char *texts;
+    size_t textsLength;
+    size_t textsCapacity;
+} BEMTextMetricsCache;
+
+typedef BEMTextMetricsCache *BEMTextMetricsCacheRef;
+
+
+/// Creates an empty cache keeping at most \p maximumCount texts. Returns NULL if the memory could not be allocated.
+BEMTextMetricsCacheRef BEMTextMetricsCacheCreate(size_t maximumCount);
+
+/// Frees the cache. Passing NULL does nothing.
+void BEMTextMetricsCacheFree(BEMTextMetricsCacheRef cache);
+
+/// Forgets every text, keeping the memory for the next ones
+void BEMTextMetricsCacheRemoveAll(BEMTextMetricsCacheRef cache);
+
+/** Returns the size of \p text in the font identified by \p fontKey, measuring it with \p measure the first time only.
+ @param fontKey Any value identifying the font and its size. Texts measured with different keys are cached separately.
+ @return false if the text wasn't cached and \p measure failed. */
+bool BEMTextMetricsCacheMeasure(BEMTextMetricsCacheRef cache, uint64_t fontKey, const char *text, size_t length, BEMTextMeasureFunction measure, void *context, float *width, float *height);
+
+//----- PLACEMENT -----//
+
+/// The frame of a label, its origin is the top left corner
+typedef struct BEMLabelBox {
+    float x;
+    float y;
+    float width;
+    float height;
+} BEMLabelBox;
+
+/// The direction along which labels are laid out
+typedef enum BEMLabelAxis {
+    /// Labels in a row, like the X-Axis
+    BEMLabelAxisHorizontal,
+    /// Labels in a column, like the Y-Axis
+    BEMLabelAxisVertical
+} BEMLabelAxis;
+
+/** Picks the labels of an axis which can be displayed without overlapping, before any view is created.
+ @discussion Labels are considered in the given order, which is their priority: a label is kept if it fits entirely in \p bounds and is more than \p spacing away from every label kept before it along \p axis. Labels touching each other overlap. The kept labels are held sorted by position, so every label is only compared with its two kept neighbors, found with a binary search: ticks given in the order of the axis are a single O(n) sweep. Any other order takes O(n log n) comparisons, but inserting a label in the middle of the kept labels moves the labels after it, so the moves are O(n k) for k kept labels: O(n^2) in the worst case, for labels given from the end of the axis to its start. k is bounded by the number of labels which fit along the axis, whatever \p count.
+ @param selected Receives the index of every kept label, in the given order. Must be able to hold \p count indices.
+ @return The number of kept labels. */
+size_t BEMLabelLayoutSelect(const BEMLabelBox *boxes, size_t count, BEMLabelBox bounds, BEMLabelAxis axis, float spacing, size_t *selected);
+
+/** Chooses, for every popup, between a frame above its point and a frame below it.
+ @discussion A popup goes below its point when the frame above reaches the top margin \p minimumY, or overlaps a popup placed before it. The frames above and below a popup must have the same x coordinate and width. The popups are swept from left to right: the popups placed under the sweep line, whose right edge is past the left edge of the current popup, are kept in a heap by right edge and counted over every y coordinate in a segment tree. A popup is tested against all of them with one query, and the popups the sweep line passed are removed once and never looked at again, so placing n popups takes O(n log n) however much they overlap.
+ @param isBelow Receives true for every popup placed below its point.
+ @return false if the memory could not be allocated, in which case every popup is placed above its point. */
+bool BEMLabelLayoutPlacePopups(const BEMLabelBox *aboveBoxes, const BEMLabelBox *belowBoxes, size_t count, float minimumY, bool *isBelow);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,6 +12,8 @@
 @import CoreGraphics;
 
 #import "BEMAverageLine.h"
+#import "BEMPointBuffer.h"
+#import "BEMGraphLayout.h"
 
 
 /// The type of animation used to display the graph
@@ -34,31 +36,71 @@ typedef NS_ENUM(NSUInteger, BEMLineGradientDirection) {
     BEMLineGradientDirectionVertical = 1
 };
 
+/// The reduction applied to the points of the line before drawing it, when the graph has more points than its width can display
+typedef NS_ENUM(NSInteger, BEMLineDecimation) {
+    /// Every point is drawn
+    BEMLineDecimationNone,
+    /// The points are reduced with the Largest-Triangle-Three-Buckets algorithm, which keeps the visual shape of the line
+    BEMLineDecimationLargestTriangleThreeBuckets,
+    /// The lowest and highest points of every column are kept, which keeps the exact vertical envelope of the line
+    BEMLineDecimationMinMax
+};
+
+
+/** The paths of the line and of the areas above and under it, kept until the points or the size change.
+ @discussion The curve is built once from the points, by the same C code as headless renders, and both fills are derived from it by adding closing segments. A graph keeps one geometry for the lines it draws, so redraws which don't change the points (a style change for example) reuse the paths as they are. Point buffers are compared by identity: the points of a buffer given to a geometry must not be modified, draw new points with a new buffer. */
+@interface BEMLineGeometry : NSObject
+
+/** Builds the paths unless they were built for the same points, size and options.
+ @return YES if the paths were built again. */
+- (BOOL)updateWithPoints:(BEMPointBufferRef)points size:(CGSize)size curve:(BEMCurveInterpolation)curve nullValueFill:(BEMNullValueFill)nullValueFill;
+
+/// The line through the points, with one subpath per run of present points when missing points leave gaps
+@property (readonly, nonatomic) CGPathRef linePath;
+/// The area between the line and the top of the line's bounds
+@property (readonly, nonatomic) CGPathRef topAreaPath;
+/// The area between the line and the bottom of the line's bounds
+@property (readonly, nonatomic) CGPathRef bottomAreaPath;
+/// The number of times the paths were built, for diagnostics
+@property (readonly, nonatomic) NSUInteger buildCount;
+
+@end
 
-/// Class to draw the line of the graph
+
+/** Class to draw the line of the graph
+ @discussion The fills, reference lines, frame, line and average line are each drawn by one layer, created with the line and updated in place at every layout pass: call \p setNeedsLayout after changing the properties of a line that is displayed. Only the values of a layer which changed are set again, so changing the color of the line for example neither creates layers nor builds the paths again. */
 @interface BEMLine : UIView
 
 
 
 //----- POINTS -----//
 
-/// All of the Y-axis values for the points
-@property (strong, nonatomic) NSArray *arrayOfPoints;
+/// The coordinates of the points, in the line's coordinate system. Missing points have a NaN y coordinate. The line retains the buffer.
+@property (assign, nonatomic) BEMPointBufferRef pointBuffer;
+
+/// The paths drawn for \p pointBuffer, which can be shared with the previous lines of the same graph to reuse their paths. Created by the line if nil.
+@property (strong, nonatomic) BEMLineGeometry *geometry;
+
+/** Builds the paths of \p geometry for the points and the curve options of the line, creating the geometry if nil.
+ @discussion The curve is only drawn for more than two points, while \p bezierCurveIsEnabled and the main line is displayed. The layout of the line calls it, and finds the paths built already when the graph called it before. */
+- (void)updateGeometry;
 
-/// All of the X-Axis coordinates used to draw vertical lines through
-@property (strong, nonatomic) NSArray *arrayOfVerticalRefrenceLinePoints;
+/** Moves the line to the left by \p removedCount points and sets \p points as its points, adding the segments to the new points to the paths instead of building them again.
+ @discussion \p points must be the previous points without the first \p removedCount ones, followed by as many new points, at the x coordinates of the previous points: this is how a window of streamed points slides. The paths keep the points which slid out, on the left of the line's bounds where they are clipped, until they hide as many points as the line displays and are built again. They are drawn instead of the paths of \p geometry until the points or the size of the line change.
+ @return NO, leaving the line unchanged, if the line can't slide: curved lines, lines crossing missing points and lines whose number of points changed are built again from their points. */
+- (BOOL)slideToPoints:(BEMPointBufferRef)points removingPoints:(NSUInteger)removedCount;
+
+/// The X-Axis coordinates (x values of the buffer) used to draw vertical lines through. The line retains the buffer.
+@property (assign, nonatomic) BEMPointBufferRef verticalReferenceLinePoints;
 
 /// The value used to offset the fringe vertical reference lines when the x-axis labels are on the edge
 @property (assign, nonatomic) CGFloat verticalReferenceHorizontalFringeNegation;
 
-/// All of the Y-Axis coordinates used to draw horizontal lines through
-@property (strong, nonatomic) NSArray *arrayOfHorizontalRefrenceLinePoints;
-
-/// All of the point values
-@property (strong, nonatomic) NSArray *arrayOfValues;
+/// The Y-Axis coordinates (y values of the buffer) used to draw horizontal lines through. The line retains the buffer.
+@property (assign, nonatomic) BEMPointBufferRef horizontalReferenceLinePoints;
 
 /** Draw thin, translucent, reference lines using the provided X-Axis and Y-Axis coordinates.
- @see Use \p arrayOfVerticalRefrenceLinePoints to specify vertical reference lines' positions. Use \p arrayOfHorizontalRefrenceLinePoints to specify horizontal reference lines' positions. */
+ @see Use \p verticalReferenceLinePoints to specify vertical reference lines' positions. Use \p horizontalReferenceLinePoints to specify horizontal reference lines' positions. */
 @property (assign, nonatomic) BOOL enableRefrenceLines;
 
 /** Draw a thin, translucent, frame on the edge of the graph to separate it from the labels on the X-Axis and the Y-Axis. */
@@ -82,8 +124,8 @@ typedef NS_ENUM(NSUInteger, BEMLineGradientDirection) {
 /** Dash pattern for the references line on the Y axis */
 @property (nonatomic, strong) NSArray *lineDashPatternForReferenceYAxisLines;
 
-/** If a null value is present, interpolation would draw a best fit line through the null point bound by its surrounding points.  Default: YES */
-@property (assign, nonatomic) BOOL interpolateNullValues;
+/** The way the line crosses missing points. BEMNullValueFillGap breaks the line and its fills around them.  Default: BEMNullValueFillLinear */
+@property (assign, nonatomic) BEMNullValueFill nullValueFill;
 
 /** Draws everything but the main line on the graph; correlates to the \p displayDotsOnly property.  Default: NO */
 @property (assign, nonatomic) BOOL disableMainLine;
@@ -146,11 +188,14 @@ typedef NS_ENUM(NSUInteger, BEMLineGradientDirection) {
 /// The line is drawn with smooth curves rather than straight lines when set to YES.
 @property (assign, nonatomic) BOOL bezierCurveIsEnabled;
 
+/// The curve drawn when \p bezierCurveIsEnabled is YES. Default value is BEMCurveInterpolationQuadratic.
+@property (assign, nonatomic) BEMCurveInterpolation curveInterpolation;
+
 
 
 //----- ANIMATION -----//
 
-/// The entrance animation period in seconds.
+/// The entrance animation period in seconds. Setting a period greater than 0 animates the next layout pass only.
 @property (assign, nonatomic) CGFloat animationTime;
 
 /// The type of entrance animation.
@@ -9,21 +9,222 @@
 
 #import "BEMLine.h"
 #import "BEMSimpleLineGraphView.h"
+#import "BEMGraphLayout.h"
+
+/// Converts a path built by the C geometry to a CGPath
+static CGPathRef BEMLineGeometryCreatePath(const BEMPath *path) {
+    CGMutablePathRef cgPath = CGPathCreateMutable();
+    const float *points = path->points;
+    for (size_t i = 0; i < path->elementCount; i++) {
+        switch ((BEMPathElement)path->elements[i]) {
+            case BEMPathElementMove:
+                CGPathMoveToPoint(cgPath, NULL, points[0], points[1]);
+                points += 2;
+                break;
+            case BEMPathElementLine:
+                CGPathAddLineToPoint(cgPath, NULL, points[0], points[1]);
+                points += 2;
+                break;
+            case BEMPathElementQuadCurve:
+                CGPathAddQuadCurveToPoint(cgPath, NULL, points[0], points[1], points[2], points[3]);
+                points += 4;
+                break;
+            case BEMPathElementCubicCurve:
+                CGPathAddCurveToPoint(cgPath, NULL, points[0], points[1], points[2], points[3], points[4], points[5]);
+                points += 6;
+                break;
+        }
+    }
+    return cgPath;
+}
 
-#if CGFLOAT_IS_DOUBLE
-#define CGFloatValue doubleValue
-#else
-#define CGFloatValue floatValue
-#endif
-
+@implementation BEMLineGeometry {
+    /// Scratch paths, kept from one build to the next
+    BEMPathRef line;
+    BEMPathRef area;
+    BEMPointSegmentsRef segments;
+
+    /// What the paths were built for
+    BEMPointBufferRef builtPoints;
+    CGSize builtSize;
+    BEMCurveInterpolation builtCurve;
+    BEMNullValueFill builtNullValueFill;
+}
 
-@interface BEMLine()
+- (void)dealloc {
+    BEMPathFree(line);
+    BEMPathFree(area);
+    BEMPointSegmentsFree(segments);
+    BEMPointBufferRelease(builtPoints);
+    CGPathRelease(_linePath);
+    CGPathRelease(_topAreaPath);
+    CGPathRelease(_bottomAreaPath);
+}
 
-@property (nonatomic, strong) NSMutableArray *points;
+- (BOOL)updateWithPoints:(BEMPointBufferRef)points size:(CGSize)size curve:(BEMCurveInterpolation)curve nullValueFill:(BEMNullValueFill)nullValueFill {
+    if (builtPoints != NULL && points == builtPoints && CGSizeEqualToSize(size, builtSize) && curve == builtCurve && nullValueFill == builtNullValueFill) return NO;
+
+    CGPathRelease(_linePath);
+    CGPathRelease(_topAreaPath);
+    CGPathRelease(_bottomAreaPath);
+    _linePath = NULL;
+    _topAreaPath = NULL;
+    _bottomAreaPath = NULL;
+    _buildCount++;
+
+    // The buffer is retained so it can't be freed and its address reused by other points while it's the key of the paths
+    BEMPointBufferRelease(builtPoints);
+    builtPoints = NULL;
+    if (points == NULL || points->count == 0) return YES;
+
+    if (line == NULL) line = BEMPathCreate();
+    if (area == NULL) area = BEMPathCreate();
+    if (segments == NULL) segments = BEMPointSegmentsCreate();
+    if (line == NULL || area == NULL || segments == NULL) return YES;
+
+    // Missing points are classified in one pass, then the curve is built once through the runs of present points
+    if (!BEMPointSegmentsClassify(segments, points->y, points->count)) return YES;
+    BEMPathRemoveAllElements(line);
+    if (!BEMPathAppendSegments(line, points->x, points->y, segments, curve, nullValueFill)) return YES;
+
+    // The fills are the same curve closed along the top and the bottom edges
+    float startX, endX;
+    BEMPathAreaBounds(points->x, segments, nullValueFill, size.width, &startX, &endX);
+    BEMPathRemoveAllElements(area);
+    if (!BEMPathAppendArea(area, line, startX, endX, 0)) return YES;
+    _topAreaPath = BEMLineGeometryCreatePath(area);
+
+    BEMPathRemoveAllElements(area);
+    if (!BEMPathAppendArea(area, line, startX, endX, size.height)) {
+        CGPathRelease(_topAreaPath);
+        _topAreaPath = NULL;
+        return YES;
+    }
+    _bottomAreaPath = BEMLineGeometryCreatePath(area);
+    _linePath = BEMLineGeometryCreatePath(line);
+
+    builtPoints = BEMPointBufferRetain(points);
+    builtSize = size;
+    builtCurve = curve;
+    builtNullValueFill = nullValueFill;
+    return YES;
+}
 
 @end
 
-@implementation BEMLine
+
+//----- SLIDING PATHS -----//
+// A line whose window of points slides appends the segments to its new points instead of building its paths again. Its areas are made of one closed trapezoid per segment, so they grow with the line without being closed again along the edges.
+
+/// Appends the segments from the point at \p start to the last point to \p line, and the area between every segment and the top and the bottom edges to the areas. \p offset is added to the x coordinates.
+static void BEMSlidingPathsAppendSegments(CGMutablePathRef line, CGMutablePathRef topArea, CGMutablePathRef bottomArea, BEMPointBufferRef points, size_t start, CGFloat offset, CGFloat height) {
+    if (CGPathIsEmpty(line)) CGPathMoveToPoint(line, NULL, points->x[start] + offset, points->y[start]);
+
+    CGMutablePathRef areas[2] = {topArea, bottomArea};
+    CGFloat edges[2] = {0, height};
+    for (size_t i = start + 1; i < points->count; i++) {
+        CGFloat startX = points->x[i - 1] + offset, startY = points->y[i - 1];
+        CGFloat endX = points->x[i] + offset, endY = points->y[i];
+        CGPathAddLineToPoint(line, NULL, endX, endY);
+        for (int a = 0; a < 2; a++) {
+            CGPathMoveToPoint(areas[a], NULL, startX, startY);
+            CGPathAddLineToPoint(areas[a], NULL, endX, endY);
+            CGPathAddLineToPoint(areas[a], NULL, endX, edges[a]);
+            CGPathAddLineToPoint(areas[a], NULL, startX, edges[a]);
+            CGPathCloseSubpath(areas[a]);
+        }
+    }
+}
+
+
+//----- LAYER UPDATES -----//
+// The layers of a line are kept from one update to the next. Only the values which changed are pushed to them, so Core Animation has nothing to commit for a layer whose style or path didn't change.
+
+static void BEMLayerSetFrame(CALayer *layer, CGRect frame) {
+    if (!CGRectEqualToRect(layer.frame, frame)) layer.frame = frame;
+}
+
+static void BEMLayerSetBoundsOrigin(CALayer *layer, CGPoint origin) {
+    CGRect bounds = layer.bounds;
+    if (CGPointEqualToPoint(bounds.origin, origin)) return;
+    bounds.origin = origin;
+    layer.bounds = bounds;
+}
+
+static void BEMLayerSetHidden(CALayer *layer, BOOL hidden) {
+    if (layer.hidden != hidden) layer.hidden = hidden;
+}
+
+static void BEMLayerSetOpacity(CALayer *layer, float opacity) {
+    if (layer.opacity != opacity) layer.opacity = opacity;
+}
+
+/// Paths rebuilt with the same elements are not pushed again
+static void BEMShapeLayerSetPath(CAShapeLayer *layer, CGPathRef path) {
+    CGPathRef currentPath = layer.path;
+    if (currentPath == path || (currentPath != NULL && path != NULL && CGPathEqualToPath(currentPath, path))) return;
+    layer.path = path;
+}
+
+static BOOL BEMColorsAreEqual(CGColorRef color, CGColorRef otherColor) {
+    return color == otherColor || (color != NULL && otherColor != NULL && CGColorEqualToColor(color, otherColor));
+}
+
+static void BEMShapeLayerSetStrokeColor(CAShapeLayer *layer, CGColorRef color) {
+    if (!BEMColorsAreEqual(layer.strokeColor, color)) layer.strokeColor = color;
+}
+
+static void BEMShapeLayerSetFillColor(CAShapeLayer *layer, CGColorRef color) {
+    if (!BEMColorsAreEqual(layer.fillColor, color)) layer.fillColor = color;
+}
+
+static void BEMShapeLayerSetLineWidth(CAShapeLayer *layer, CGFloat lineWidth) {
+    if (layer.lineWidth != lineWidth) layer.lineWidth = lineWidth;
+}
+
+static void BEMShapeLayerSetDashPattern(CAShapeLayer *layer, NSArray *dashPattern) {
+    if (layer.lineDashPattern != dashPattern && ![layer.lineDashPattern isEqualToArray:dashPattern]) layer.lineDashPattern = dashPattern;
+}
+
+
+@implementation BEMLine {
+    /// The layers of the line, from the bottom to the top. They are created with the line and updated in place, the layers which aren't displayed are hidden.
+    CAShapeLayer *topFillLayer;
+    CAShapeLayer *bottomFillLayer;
+    CALayer *topGradientLayer;
+    CALayer *bottomGradientLayer;
+    CAShapeLayer *verticalReferenceLayer;
+    CAShapeLayer *horizontalReferenceLayer;
+    CAShapeLayer *referenceFrameLayer;
+    CAShapeLayer *lineLayer;
+    /// Draws \p lineGradient through the mask of the line, instead of \p lineLayer
+    CALayer *lineGradientLayer;
+    CAShapeLayer *averageLayer;
+
+    /// What the gradient images were drawn for, they are only drawn again when one of them changes. The gradients are retained so their address can't be reused by another gradient.
+    CGGradientRef drawnTopGradient;
+    CGGradientRef drawnBottomGradient;
+    CGGradientRef drawnLineGradient;
+    CGFloat drawnTopGradientEnd;
+    CGFloat drawnBottomGradientEnd;
+    BEMLineGradientDirection drawnLineGradientDirection;
+    CGSize drawnGradientSize;
+
+    /// YES from the moment \p animationTime is set until the next update animates the layers
+    BOOL needsEntranceAnimation;
+
+    /// The paths of a sliding line, drawn instead of the paths of \p geometry while \p slidPoints and \p slidSize are the points and the size of the line. The paths are moved to the left by \p slidOffset, the width of the \p slidCount points which slid out since they were built.
+    CGMutablePathRef slidingLinePath;
+    CGMutablePathRef slidingTopAreaPath;
+    CGMutablePathRef slidingBottomAreaPath;
+    BEMPointBufferRef slidPoints;
+    CGSize slidSize;
+    NSUInteger slidCount;
+    CGFloat slidOffset;
+
+    /// Clips the paths of a sliding line to the width of the line
+    CALayer *slidingMask;
+}
 
 - (instancetype)initWithFrame:(CGRect)frame {
     self = [super initWithFrame:frame];
@@ -32,12 +233,255 @@
         self.backgroundColor = [UIColor clearColor];
         _enableLeftReferenceFrameLine = YES;
         _enableBottomReferenceFrameLine = YES;
-        _interpolateNullValues = YES;
+        _nullValueFill = BEMNullValueFillLinear;
+        _curveInterpolation = BEMCurveInterpolationQuadratic;
+
+        topFillLayer = [self addShapeLayer];
+        bottomFillLayer = [self addShapeLayer];
+        topGradientLayer = [self addGradientLayer];
+        bottomGradientLayer = [self addGradientLayer];
+        verticalReferenceLayer = [self addShapeLayer];
+        horizontalReferenceLayer = [self addShapeLayer];
+        referenceFrameLayer = [self addShapeLayer];
+        lineLayer = [self addShapeLayer];
+        lineGradientLayer = [self addGradientLayer];
+        averageLayer = [self addShapeLayer];
+
+        // The line layer is displayed through the gradient when the line has one
+        lineGradientLayer.mask = [CAShapeLayer layer];
+        lineLayer.lineJoin = kCALineJoinBevel;
+        lineLayer.lineCap = kCALineCapRound;
+        ((CAShapeLayer *)lineGradientLayer.mask).lineJoin = kCALineJoinBevel;
+        ((CAShapeLayer *)lineGradientLayer.mask).lineCap = kCALineCapRound;
     }
     return self;
 }
 
-- (void)drawRect:(CGRect)rect {
+- (CAShapeLayer *)addShapeLayer {
+    CAShapeLayer *layer = [CAShapeLayer layer];
+    layer.fillColor = nil;
+    layer.hidden = YES;
+    [self.layer addSublayer:layer];
+    return layer;
+}
+
+- (CALayer *)addGradientLayer {
+    CALayer *layer = [CALayer layer];
+    layer.mask = [CAShapeLayer layer];
+    layer.hidden = YES;
+    [self.layer addSublayer:layer];
+    return layer;
+}
+
+- (void)dealloc {
+    CGGradientRelease(drawnTopGradient);
+    CGGradientRelease(drawnBottomGradient);
+    CGGradientRelease(drawnLineGradient);
+    CGPathRelease(slidingLinePath);
+    CGPathRelease(slidingTopAreaPath);
+    CGPathRelease(slidingBottomAreaPath);
+    BEMPointBufferRelease(slidPoints);
+    BEMPointBufferRelease(_pointBuffer);
+    BEMPointBufferRelease(_verticalReferenceLinePoints);
+    BEMPointBufferRelease(_horizontalReferenceLinePoints);
+}
+
+- (void)setPointBuffer:(BEMPointBufferRef)pointBuffer {
+    BEMPointBufferRetain(pointBuffer);
+    BEMPointBufferRelease(_pointBuffer);
+    _pointBuffer = pointBuffer;
+}
+
+- (void)setVerticalReferenceLinePoints:(BEMPointBufferRef)verticalReferenceLinePoints {
+    BEMPointBufferRetain(verticalReferenceLinePoints);
+    BEMPointBufferRelease(_verticalReferenceLinePoints);
+    _verticalReferenceLinePoints = verticalReferenceLinePoints;
+}
+
+- (void)setHorizontalReferenceLinePoints:(BEMPointBufferRef)horizontalReferenceLinePoints {
+    BEMPointBufferRetain(horizontalReferenceLinePoints);
+    BEMPointBufferRelease(_horizontalReferenceLinePoints);
+    _horizontalReferenceLinePoints = horizontalReferenceLinePoints;
+}
+
+- (void)setAnimationTime:(CGFloat)animationTime {
+    _animationTime = animationTime;
+    // Only the next update is animated, the updates after it change the layers in place
+    needsEntranceAnimation = animationTime > 0;
+}
+
+- (void)layoutSubviews {
+    [super layoutSubviews];
+    [self updateLayers];
+}
+
+- (void)updateLayers {
+    // The layers are changed at once, without the implicit animations of Core Animation
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+
+    CGRect bounds = self.bounds;
+    if (!CGSizeEqualToSize(bounds.size, drawnGradientSize)) [self invalidateGradientImages];
+    for (CALayer *layer in @[topFillLayer, bottomFillLayer, topGradientLayer, topGradientLayer.mask, bottomGradientLayer, bottomGradientLayer.mask, verticalReferenceLayer, horizontalReferenceLayer, referenceFrameLayer, lineLayer, lineGradientLayer, lineGradientLayer.mask, averageLayer]) {
+        BEMLayerSetFrame(layer, bounds);
+    }
+
+    // A sliding line moves its paths to the left by the points which slid out, they are clipped to the width of the line
+    BOOL sliding = [self isSliding];
+    for (CALayer *layer in @[topFillLayer, bottomFillLayer, topGradientLayer.mask, bottomGradientLayer.mask, lineLayer, lineGradientLayer.mask]) {
+        BEMLayerSetBoundsOrigin(layer, CGPointMake(sliding ? slidOffset : 0, 0));
+    }
+    if (sliding && slidingMask == nil) {
+        slidingMask = [CALayer layer];
+        slidingMask.backgroundColor = [UIColor blackColor].CGColor;
+    }
+    if (sliding) BEMLayerSetFrame(slidingMask, CGRectInset(bounds, 0, -bounds.size.height));
+    CALayer *mask = sliding ? slidingMask : nil;
+    if (self.layer.mask != mask) self.layer.mask = mask;
+
+    [self updateFillLayers];
+    [self updateReferenceLayers];
+    [self updateLineLayers];
+    [self updateAverageLayer];
+
+    BOOL animated = needsEntranceAnimation && self.animationTime > 0;
+    needsEntranceAnimation = NO;
+    if (animated) {
+        if (self.enableRefrenceLines == YES) {
+            [self animateForLayer:verticalReferenceLayer withAnimationType:self.animationType isAnimatingReferenceLine:YES];
+            [self animateForLayer:horizontalReferenceLayer withAnimationType:self.animationType isAnimatingReferenceLine:YES];
+        }
+        [self animateForLayer:referenceFrameLayer withAnimationType:self.animationType isAnimatingReferenceLine:YES];
+        if (self.disableMainLine == NO) {
+            CAShapeLayer *drawnLineLayer = self.lineGradient ? (CAShapeLayer *)lineGradientLayer.mask : lineLayer;
+            [self animateForLayer:drawnLineLayer withAnimationType:self.animationType isAnimatingReferenceLine:NO];
+        }
+        if (self.averageLine.enableAverageLine == YES)
+            [self animateForLayer:averageLayer withAnimationType:self.animationType isAnimatingReferenceLine:NO];
+    }
+
+    [CATransaction commit];
+}
+
+/// The curve drawn through the points: only for more than two points, while the curve is enabled and the main line is displayed
+- (BEMCurveInterpolation)drawnCurve {
+    BEMPointBufferRef points = self.pointBuffer;
+    NSUInteger numberOfPoints = points ? points->count : 0;
+
+    BEMCurveInterpolation curve = self.bezierCurveIsEnabled ? self.curveInterpolation : BEMCurveInterpolationNone;
+    if (numberOfPoints <= 2) curve = BEMCurveInterpolationNone;
+    if (self.disableMainLine) curve = BEMCurveInterpolationNone;
+    return curve;
+}
+
+- (void)updateGeometry {
+    if (self.geometry == nil) self.geometry = [[BEMLineGeometry alloc] init];
+    [self.geometry updateWithPoints:self.pointBuffer size:self.frame.size curve:[self drawnCurve] nullValueFill:self.nullValueFill];
+}
+
+/// YES while the sliding paths were built for the points and the size of the line
+- (BOOL)isSliding {
+    return slidingLinePath != NULL && slidPoints == self.pointBuffer && CGSizeEqualToSize(slidSize, self.bounds.size);
+}
+
+- (BOOL)slideToPoints:(BEMPointBufferRef)points removingPoints:(NSUInteger)removedCount {
+    BEMPointBufferRef previousPoints = self.pointBuffer;
+    if (points == NULL || previousPoints == NULL || points->count < 2 || points->count != previousPoints->count) return NO;
+    if (removedCount == 0 || removedCount >= points->count || [self drawnCurve] != BEMCurveInterpolationNone) return NO;
+
+    // The segments are appended until the paths hide as many points as the line displays, the paths are then built again from every point
+    size_t count = points->count;
+    BOOL appends = [self isSliding] && slidCount + removedCount <= count;
+    size_t start = appends ? count - removedCount - 1 : 0;
+    for (size_t i = start; i < count; i++) {
+        if (BEMPointBufferIsNull(points->y[i])) return NO;
+    }
+
+    // The layers keep the previous paths, the segments are appended to copies of them
+    CGMutablePathRef line = appends ? CGPathCreateMutableCopy(slidingLinePath) : CGPathCreateMutable();
+    CGMutablePathRef topArea = appends ? CGPathCreateMutableCopy(slidingTopAreaPath) : CGPathCreateMutable();
+    CGMutablePathRef bottomArea = appends ? CGPathCreateMutableCopy(slidingBottomAreaPath) : CGPathCreateMutable();
+    if (line == NULL || topArea == NULL || bottomArea == NULL) {
+        CGPathRelease(line);
+        CGPathRelease(topArea);
+        CGPathRelease(bottomArea);
+        return NO;
+    }
+
+    slidCount = appends ? slidCount + removedCount : 0;
+    slidOffset = slidCount * (points->x[1] - points->x[0]);
+    BEMSlidingPathsAppendSegments(line, topArea, bottomArea, points, start, slidOffset, self.bounds.size.height);
+
+    CGPathRelease(slidingLinePath);
+    CGPathRelease(slidingTopAreaPath);
+    CGPathRelease(slidingBottomAreaPath);
+    slidingLinePath = line;
+    slidingTopAreaPath = topArea;
+    slidingBottomAreaPath = bottomArea;
+
+    BEMPointBufferRetain(points);
+    BEMPointBufferRelease(slidPoints);
+    slidPoints = points;
+    slidSize = self.bounds.size;
+    self.pointBuffer = points;
+    [self setNeedsLayout];
+    return YES;
+}
+
+- (void)updateFillLayers {
+    //----------------------------//
+    //------ Draw Graph Line -----//
+    //----------------------------//
+    // A sliding line draws the paths it appended to, the geometry is only built for the other points
+    BOOL sliding = [self isSliding];
+    if (!sliding) [self updateGeometry];
+    CGPathRef fillTop = sliding ? slidingTopAreaPath : self.geometry.topAreaPath;
+    CGPathRef fillBottom = sliding ? slidingBottomAreaPath : self.geometry.bottomAreaPath;
+
+    //----------------------------//
+    //----- Draw Fill Colors -----//
+    //----------------------------//
+    BEMLayerSetHidden(topFillLayer, !(fillTop && self.topColor));
+    if (!topFillLayer.hidden) {
+        BEMShapeLayerSetPath(topFillLayer, fillTop);
+        BEMShapeLayerSetFillColor(topFillLayer, self.topColor.CGColor);
+        BEMLayerSetOpacity(topFillLayer, self.topAlpha);
+    }
+
+    BEMLayerSetHidden(bottomFillLayer, !(fillBottom && self.bottomColor));
+    if (!bottomFillLayer.hidden) {
+        BEMShapeLayerSetPath(bottomFillLayer, fillBottom);
+        BEMShapeLayerSetFillColor(bottomFillLayer, self.bottomColor.CGColor);
+        BEMLayerSetOpacity(bottomFillLayer, self.bottomAlpha);
+    }
+
+    // The gradients go from the top of the line's bounds to the bottom of their area
+    BEMLayerSetHidden(topGradientLayer, !(fillTop && self.topGradient != nil));
+    if (!topGradientLayer.hidden) {
+        CGFloat end = CGRectGetMaxY(CGPathGetBoundingBox(fillTop));
+        if (self.topGradient != drawnTopGradient || end != drawnTopGradientEnd) {
+            topGradientLayer.contents = (id)[self imageOfGradient:self.topGradient from:CGPointZero to:CGPointMake(0, end)].CGImage;
+            CGGradientRelease(drawnTopGradient);
+            drawnTopGradient = CGGradientRetain(self.topGradient);
+            drawnTopGradientEnd = end;
+        }
+        BEMShapeLayerSetPath((CAShapeLayer *)topGradientLayer.mask, fillTop);
+    }
+
+    BEMLayerSetHidden(bottomGradientLayer, !(fillBottom && self.bottomGradient != nil));
+    if (!bottomGradientLayer.hidden) {
+        CGFloat end = CGRectGetMaxY(CGPathGetBoundingBox(fillBottom));
+        if (self.bottomGradient != drawnBottomGradient || end != drawnBottomGradientEnd) {
+            bottomGradientLayer.contents = (id)[self imageOfGradient:self.bottomGradient from:CGPointZero to:CGPointMake(0, end)].CGImage;
+            CGGradientRelease(drawnBottomGradient);
+            drawnBottomGradient = CGGradientRetain(self.bottomGradient);
+            drawnBottomGradientEnd = end;
+        }
+        BEMShapeLayerSetPath((CAShapeLayer *)bottomGradientLayer.mask, fillBottom);
+    }
+}
+
+- (void)updateReferenceLayers {
     //----------------------------//
     //---- Draw Refrence Lines ---//
     //----------------------------//
@@ -45,15 +489,6 @@
     UIBezierPath *horizontalReferenceLinesPath = [UIBezierPath bezierPath];
     UIBezierPath *referenceFramePath = [UIBezierPath bezierPath];
 
-    verticalReferenceLinesPath.lineCapStyle = kCGLineCapButt;
-    verticalReferenceLinesPath.lineWidth = 0.7;
-
-    horizontalReferenceLinesPath.lineCapStyle = kCGLineCapButt;
-    horizontalReferenceLinesPath.lineWidth = 0.7;
-
-    referenceFramePath.lineCapStyle = kCGLineCapButt;
-    referenceFramePath.lineWidth = 0.7;
-
     if (self.enableRefrenceFrame == YES) {
         if (self.enableBottomReferenceFrameLine) {
             // Bottom Line
@@ -81,16 +516,17 @@
     }
 
     if (self.enableRefrenceLines == YES) {
-        if (self.arrayOfVerticalRefrenceLinePoints.count > 0) {
-            for (NSNumber *xNumber in self.arrayOfVerticalRefrenceLinePoints) {
-                CGFloat xValue;
+        BEMPointBufferRef verticalPoints = self.verticalReferenceLinePoints;
+        if (verticalPoints && verticalPoints->count > 0) {
+            for (size_t i = 0; i < verticalPoints->count; i++) {
+                CGFloat xValue = verticalPoints->x[i];
                 if (self.verticalReferenceHorizontalFringeNegation != 0.0) {
-                    if ([self.arrayOfVerticalRefrenceLinePoints indexOfObject:xNumber] == 0) { // far left reference line
-                        xValue = [xNumber floatValue] + self.verticalReferenceHorizontalFringeNegation;
-                    } else if ([self.arrayOfVerticalRefrenceLinePoints indexOfObject:xNumber] == [self.arrayOfVerticalRefrenceLinePoints count]-1) { // far right reference line
-                        xValue = [xNumber floatValue] - self.verticalReferenceHorizontalFringeNegation;
-                    } else xValue = [xNumber floatValue];
-                } else xValue = [xNumber floatValue];
+                    if (i == 0) { // far left reference line
+                        xValue += self.verticalReferenceHorizontalFringeNegation;
+                    } else if (i == verticalPoints->count-1) { // far right reference line
+                        xValue -= self.verticalReferenceHorizontalFringeNegation;
+                    }
+                }
 
                 CGPoint initialPoint = CGPointMake(xValue, self.frame.size.height);
                 CGPoint finalPoint = CGPointMake(xValue, 0);
@@ -100,10 +536,11 @@
             }
         }
 
-        if (self.arrayOfHorizontalRefrenceLinePoints.count > 0) {
-            for (NSNumber *yNumber in self.arrayOfHorizontalRefrenceLinePoints) {
-                CGPoint initialPoint = CGPointMake(0, [yNumber floatValue]);
-                CGPoint finalPoint = CGPointMake(self.frame.size.width, [yNumber floatValue]);
+        BEMPointBufferRef horizontalPoints = self.horizontalReferenceLinePoints;
+        if (horizontalPoints && horizontalPoints->count > 0) {
+            for (size_t i = 0; i < horizontalPoints->count; i++) {
+                CGPoint initialPoint = CGPointMake(0, horizontalPoints->y[i]);
+                CGPoint finalPoint = CGPointMake(self.frame.size.width, horizontalPoints->y[i]);
 
                 [horizontalReferenceLinesPath moveToPoint:initialPoint];
                 [horizontalReferenceLinesPath addLineToPoint:finalPoint];
@@ -111,252 +548,72 @@
         }
     }
 
-
-    //----------------------------//
-    //----- Draw Average Line ----//
-    //----------------------------//
-    UIBezierPath *averageLinePath = [UIBezierPath bezierPath];
-    if (self.averageLine.enableAverageLine == YES) {
-        averageLinePath.lineCapStyle = kCGLineCapButt;
-        averageLinePath.lineWidth = self.averageLine.width;
-
-        CGPoint initialPoint = CGPointMake(0, self.averageLineYCoordinate);
-        CGPoint finalPoint = CGPointMake(self.frame.size.width, self.averageLineYCoordinate);
-
-        [averageLinePath moveToPoint:initialPoint];
-        [averageLinePath addLineToPoint:finalPoint];
+    // Every reference layer has the same style, only their paths and dash patterns differ
+    CGColorRef referenceColor = self.refrenceLineColor ? self.refrenceLineColor.CGColor : self.color.CGColor;
+    float referenceOpacity = self.lineAlpha == 0 ? 0.1 : self.lineAlpha/2;
+    for (CAShapeLayer *layer in @[verticalReferenceLayer, horizontalReferenceLayer, referenceFrameLayer]) {
+        BEMLayerSetOpacity(layer, referenceOpacity);
+        BEMShapeLayerSetLineWidth(layer, self.referenceLineWidth/2);
+        BEMShapeLayerSetStrokeColor(layer, referenceColor);
     }
 
+    BEMLayerSetHidden(verticalReferenceLayer, !self.enableRefrenceLines);
+    BEMLayerSetHidden(horizontalReferenceLayer, !self.enableRefrenceLines);
+    BEMLayerSetHidden(referenceFrameLayer, NO);
+    BEMShapeLayerSetPath(verticalReferenceLayer, verticalReferenceLinesPath.CGPath);
+    BEMShapeLayerSetPath(horizontalReferenceLayer, horizontalReferenceLinesPath.CGPath);
+    BEMShapeLayerSetPath(referenceFrameLayer, referenceFramePath.CGPath);
+    BEMShapeLayerSetDashPattern(verticalReferenceLayer, self.lineDashPatternForReferenceYAxisLines);
+    BEMShapeLayerSetDashPattern(horizontalReferenceLayer, self.lineDashPatternForReferenceXAxisLines);
+}
 
-    //----------------------------//
-    //------ Draw Graph Line -----//
-    //----------------------------//
-    // LINE
-    UIBezierPath *line = [UIBezierPath bezierPath];
-    UIBezierPath *fillTop;
-    UIBezierPath *fillBottom;
-
-    CGFloat xIndexScale = self.frame.size.width/([self.arrayOfPoints count] - 1);
-
-    self.points = [NSMutableArray arrayWithCapacity:self.arrayOfPoints.count];
-    for (int i = 0; i < self.arrayOfPoints.count; i++) {
-        CGPoint value = CGPointMake(xIndexScale * i, [self.arrayOfPoints[i] CGFloatValue]);
-        if (value.y != BEMNullGraphValue || !self.interpolateNullValues) {
-            [self.points addObject:[NSValue valueWithCGPoint:value]];
-        }
-    }
-
-    BOOL bezierStatus = self.bezierCurveIsEnabled;
-    if (self.arrayOfPoints.count <= 2 && self.bezierCurveIsEnabled == YES) bezierStatus = NO;
-    
-    if (!self.disableMainLine && bezierStatus) {
-        line = [BEMLine quadCurvedPathWithPoints:self.points];
-        fillBottom = [BEMLine quadCurvedPathWithPoints:self.bottomPointsArray];
-        fillTop = [BEMLine quadCurvedPathWithPoints:self.topPointsArray];
-    } else if (!self.disableMainLine && !bezierStatus) {
-        line = [BEMLine linesToPoints:self.points];
-        fillBottom = [BEMLine linesToPoints:self.bottomPointsArray];
-        fillTop = [BEMLine linesToPoints:self.topPointsArray];
-    } else {
-        fillBottom = [BEMLine linesToPoints:self.bottomPointsArray];
-        fillTop = [BEMLine linesToPoints:self.topPointsArray];
-    }
-
-    //----------------------------//
-    //----- Draw Fill Colors -----//
-    //----------------------------//
-    [self.topColor set];
-    [fillTop fillWithBlendMode:kCGBlendModeNormal alpha:self.topAlpha];
-
-    [self.bottomColor set];
-    [fillBottom fillWithBlendMode:kCGBlendModeNormal alpha:self.bottomAlpha];
-
-    CGContextRef ctx = UIGraphicsGetCurrentContext();
-    if (self.topGradient != nil) {
-        CGContextSaveGState(ctx);
-        CGContextAddPath(ctx, [fillTop CGPath]);
-        CGContextClip(ctx);
-        CGContextDrawLinearGradient(ctx, self.topGradient, CGPointZero, CGPointMake(0, CGRectGetMaxY(fillTop.bounds)), 0);
-        CGContextRestoreGState(ctx);
-    }
-
-    if (self.bottomGradient != nil) {
-        CGContextSaveGState(ctx);
-        CGContextAddPath(ctx, [fillBottom CGPath]);
-        CGContextClip(ctx);
-        CGContextDrawLinearGradient(ctx, self.bottomGradient, CGPointZero, CGPointMake(0, CGRectGetMaxY(fillBottom.bounds)), 0);
-        CGContextRestoreGState(ctx);
-    }
-
-
-    //----------------------------//
-    //------ Animate Drawing -----//
-    //----------------------------//
-    if (self.enableRefrenceLines == YES) {
-        CAShapeLayer *verticalReferenceLinesPathLayer = [CAShapeLayer layer];
-        verticalReferenceLinesPathLayer.frame = self.bounds;
-        verticalReferenceLinesPathLayer.path = verticalReferenceLinesPath.CGPath;
-        verticalReferenceLinesPathLayer.opacity = self.lineAlpha == 0 ? 0.1 : self.lineAlpha/2;
-        verticalReferenceLinesPathLayer.fillColor = nil;
-        verticalReferenceLinesPathLayer.lineWidth = self.referenceLineWidth/2;
-        
-        if (self.lineDashPatternForReferenceYAxisLines) {
-            verticalReferenceLinesPathLayer.lineDashPattern = self.lineDashPatternForReferenceYAxisLines;
-        }
-
-        if (self.refrenceLineColor) {
-            verticalReferenceLinesPathLayer.strokeColor = self.refrenceLineColor.CGColor;
-        } else {
-            verticalReferenceLinesPathLayer.strokeColor = self.color.CGColor;
-        }
-
-        if (self.animationTime > 0)
-            [self animateForLayer:verticalReferenceLinesPathLayer withAnimationType:self.animationType isAnimatingReferenceLine:YES];
-        [self.layer addSublayer:verticalReferenceLinesPathLayer];
-
-
-        CAShapeLayer *horizontalReferenceLinesPathLayer = [CAShapeLayer layer];
-        horizontalReferenceLinesPathLayer.frame = self.bounds;
-        horizontalReferenceLinesPathLayer.path = horizontalReferenceLinesPath.CGPath;
-        horizontalReferenceLinesPathLayer.opacity = self.lineAlpha == 0 ? 0.1 : self.lineAlpha/2;
-        horizontalReferenceLinesPathLayer.fillColor = nil;
-        horizontalReferenceLinesPathLayer.lineWidth = self.referenceLineWidth/2;
-        if(self.lineDashPatternForReferenceXAxisLines) {
-            horizontalReferenceLinesPathLayer.lineDashPattern = self.lineDashPatternForReferenceXAxisLines;
-        }
-
-        if (self.refrenceLineColor) {
-            horizontalReferenceLinesPathLayer.strokeColor = self.refrenceLineColor.CGColor;
+- (void)updateLineLayers {
+    BOOL hasGradient = self.lineGradient != nil;
+    BEMLayerSetHidden(lineLayer, self.disableMainLine || hasGradient);
+    BEMLayerSetHidden(lineGradientLayer, self.disableMainLine || !hasGradient);
+    if (self.disableMainLine) return;
+
+    // With a gradient, the line is the mask of the gradient
+    CAShapeLayer *drawnLineLayer = hasGradient ? (CAShapeLayer *)lineGradientLayer.mask : lineLayer;
+    BEMShapeLayerSetPath(drawnLineLayer, [self isSliding] ? slidingLinePath : self.geometry.linePath);
+    BEMShapeLayerSetStrokeColor(drawnLineLayer, self.color.CGColor);
+    BEMLayerSetOpacity(drawnLineLayer, self.lineAlpha);
+    BEMShapeLayerSetLineWidth(drawnLineLayer, self.lineWidth);
+    if (!hasGradient) return;
+
+    if (self.lineGradient != drawnLineGradient || self.lineGradientDirection != drawnLineGradientDirection) {
+        CGRect bounds = self.bounds;
+        CGPoint start, end;
+        if (self.lineGradientDirection == BEMLineGradientDirectionHorizontal) {
+            start = CGPointMake(0, CGRectGetMidY(bounds));
+            end = CGPointMake(CGRectGetMaxX(bounds), CGRectGetMidY(bounds));
         } else {
-            horizontalReferenceLinesPathLayer.strokeColor = self.color.CGColor;
+            start = CGPointMake(CGRectGetMidX(bounds), 0);
+            end = CGPointMake(CGRectGetMidX(bounds), CGRectGetMaxY(bounds));
         }
-
-        if (self.animationTime > 0)
-            [self animateForLayer:horizontalReferenceLinesPathLayer withAnimationType:self.animationType isAnimatingReferenceLine:YES];
-        [self.layer addSublayer:horizontalReferenceLinesPathLayer];
-    }
-
-    CAShapeLayer *referenceLinesPathLayer = [CAShapeLayer layer];
-    referenceLinesPathLayer.frame = self.bounds;
-    referenceLinesPathLayer.path = referenceFramePath.CGPath;
-    referenceLinesPathLayer.opacity = self.lineAlpha == 0 ? 0.1 : self.lineAlpha/2;
-    referenceLinesPathLayer.fillColor = nil;
-    referenceLinesPathLayer.lineWidth = self.referenceLineWidth/2;
-
-    if (self.refrenceLineColor) referenceLinesPathLayer.strokeColor = self.refrenceLineColor.CGColor;
-    else referenceLinesPathLayer.strokeColor = self.color.CGColor;
-
-    if (self.animationTime > 0)
-        [self animateForLayer:referenceLinesPathLayer withAnimationType:self.animationType isAnimatingReferenceLine:YES];
-    [self.layer addSublayer:referenceLinesPathLayer];
-
-    if (self.disableMainLine == NO) {
-        CAShapeLayer *pathLayer = [CAShapeLayer layer];
-        pathLayer.frame = self.bounds;
-        pathLayer.path = line.CGPath;
-        pathLayer.strokeColor = self.color.CGColor;
-        pathLayer.fillColor = nil;
-        pathLayer.opacity = self.lineAlpha;
-        pathLayer.lineWidth = self.lineWidth;
-        pathLayer.lineJoin = kCALineJoinBevel;
-        pathLayer.lineCap = kCALineCapRound;
-        if (self.animationTime > 0) [self animateForLayer:pathLayer withAnimationType:self.animationType isAnimatingReferenceLine:NO];
-        if (self.lineGradient) [self.layer addSublayer:[self backgroundGradientLayerForLayer:pathLayer]];
-        else [self.layer addSublayer:pathLayer];
-    }
-
-    if (self.averageLine.enableAverageLine == YES) {
-        CAShapeLayer *averageLinePathLayer = [CAShapeLayer layer];
-        averageLinePathLayer.frame = self.bounds;
-        averageLinePathLayer.path = averageLinePath.CGPath;
-        averageLinePathLayer.opacity = self.averageLine.alpha;
-        averageLinePathLayer.fillColor = nil;
-        averageLinePathLayer.lineWidth = self.averageLine.width;
-
-        if (self.averageLine.dashPattern) averageLinePathLayer.lineDashPattern = self.averageLine.dashPattern;
-
-        if (self.averageLine.color) averageLinePathLayer.strokeColor = self.averageLine.color.CGColor;
-        else averageLinePathLayer.strokeColor = self.color.CGColor;
-
-        if (self.animationTime > 0)
-            [self animateForLayer:averageLinePathLayer withAnimationType:self.animationType isAnimatingReferenceLine:NO];
-        [self.layer addSublayer:averageLinePathLayer];
-    }
-}
-
-- (NSArray *)topPointsArray {
-    CGPoint topPointZero = CGPointMake(0,0);
-    CGPoint topPointFull = CGPointMake(self.frame.size.width, 0);
-    NSMutableArray *topPoints = [NSMutableArray arrayWithArray:self.points];
-    [topPoints insertObject:[NSValue valueWithCGPoint:topPointZero] atIndex:0];
-    [topPoints addObject:[NSValue valueWithCGPoint:topPointFull]];
-    return topPoints;
-}
-
-- (NSArray *)bottomPointsArray {
-    CGPoint bottomPointZero = CGPointMake(0, self.frame.size.height);
-    CGPoint bottomPointFull = CGPointMake(self.frame.size.width, self.frame.size.height);
-    NSMutableArray *bottomPoints = [NSMutableArray arrayWithArray:self.points];
-    [bottomPoints insertObject:[NSValue valueWithCGPoint:bottomPointZero] atIndex:0];
-    [bottomPoints addObject:[NSValue valueWithCGPoint:bottomPointFull]];
-    return bottomPoints;
-}
-
-+ (UIBezierPath *)linesToPoints:(NSArray *)points {
-    UIBezierPath *path = [UIBezierPath bezierPath];
-    NSValue *value = points[0];
-    CGPoint p1 = [value CGPointValue];
-    [path moveToPoint:p1];
-
-    for (NSUInteger i = 1; i < points.count; i++) {
-        value = points[i];
-        CGPoint p2 = [value CGPointValue];
-        [path addLineToPoint:p2];
+        lineGradientLayer.contents = (id)[self imageOfGradient:self.lineGradient from:start to:end].CGImage;
+        CGGradientRelease(drawnLineGradient);
+        drawnLineGradient = CGGradientRetain(self.lineGradient);
+        drawnLineGradientDirection = self.lineGradientDirection;
     }
-    return path;
 }
 
-+ (UIBezierPath *)quadCurvedPathWithPoints:(NSArray *)points {
-    UIBezierPath *path = [UIBezierPath bezierPath];
-
-    NSValue *value = points[0];
-    CGPoint p1 = [value CGPointValue];
-    [path moveToPoint:p1];
-
-    if (points.count == 2) {
-        value = points[1];
-        CGPoint p2 = [value CGPointValue];
-        [path addLineToPoint:p2];
-        return path;
-    }
-
-    for (NSUInteger i = 1; i < points.count; i++) {
-        value = points[i];
-        CGPoint p2 = [value CGPointValue];
-
-        CGPoint midPoint = midPointForPoints(p1, p2);
-        [path addQuadCurveToPoint:midPoint controlPoint:controlPointForPoints(midPoint, p1)];
-        [path addQuadCurveToPoint:p2 controlPoint:controlPointForPoints(midPoint, p2)];
-
-        p1 = p2;
-    }
-    return path;
-}
-
-static CGPoint midPointForPoints(CGPoint p1, CGPoint p2) {
-    return CGPointMake((p1.x + p2.x) / 2, (p1.y + p2.y) / 2);
-}
-
-static CGPoint controlPointForPoints(CGPoint p1, CGPoint p2) {
-    CGPoint controlPoint = midPointForPoints(p1, p2);
-    CGFloat diffY = fabs(p2.y - controlPoint.y);
-
-    if (p1.y < p2.y)
-        controlPoint.y += diffY;
-    else if (p1.y > p2.y)
-        controlPoint.y -= diffY;
+- (void)updateAverageLayer {
+    //----------------------------//
+    //----- Draw Average Line ----//
+    //----------------------------//
+    BEMLayerSetHidden(averageLayer, self.averageLine.enableAverageLine == NO);
+    if (averageLayer.hidden) return;
 
-    return controlPoint;
+    UIBezierPath *averageLinePath = [UIBezierPath bezierPath];
+    [averageLinePath moveToPoint:CGPointMake(0, self.averageLineYCoordinate)];
+    [averageLinePath addLineToPoint:CGPointMake(self.frame.size.width, self.averageLineYCoordinate)];
+
+    BEMShapeLayerSetPath(averageLayer, averageLinePath.CGPath);
+    BEMLayerSetOpacity(averageLayer, self.averageLine.alpha);
+    BEMShapeLayerSetLineWidth(averageLayer, self.averageLine.width);
+    BEMShapeLayerSetDashPattern(averageLayer, self.averageLine.dashPattern);
+    BEMShapeLayerSetStrokeColor(averageLayer, self.averageLine.color ? self.averageLine.color.CGColor : self.color.CGColor);
 }
 
 - (void)animateForLayer:(CAShapeLayer *)shapeLayer withAnimationType:(BEMLineAnimation)animationType isAnimatingReferenceLine:(BOOL)shouldHalfOpacity {
@@ -389,26 +646,25 @@ static CGPoint controlPointForPoints(CGPoint p1, CGPoint p2) {
     }
 }
 
-- (CALayer *)backgroundGradientLayerForLayer:(CAShapeLayer *)shapeLayer {
+/// The gradient images have the size of the line, they are all drawn again when it changes
+- (void)invalidateGradientImages {
+    CGGradientRelease(drawnTopGradient);
+    CGGradientRelease(drawnBottomGradient);
+    CGGradientRelease(drawnLineGradient);
+    drawnTopGradient = NULL;
+    drawnBottomGradient = NULL;
+    drawnLineGradient = NULL;
+    drawnGradientSize = self.bounds.size;
+}
+
+/// An image of the size of the line with \p gradient drawn from \p start to \p end
+- (UIImage *)imageOfGradient:(CGGradientRef)gradient from:(CGPoint)start to:(CGPoint)end {
     UIGraphicsBeginImageContext(self.bounds.size);
     CGContextRef imageCtx = UIGraphicsGetCurrentContext();
-    CGPoint start, end;
-    if (self.lineGradientDirection == BEMLineGradientDirectionHorizontal) {
-        start = CGPointMake(0, CGRectGetMidY(shapeLayer.bounds));
-        end = CGPointMake(CGRectGetMaxX(shapeLayer.bounds), CGRectGetMidY(shapeLayer.bounds));
-    } else {
-        start = CGPointMake(CGRectGetMidX(shapeLayer.bounds), 0);
-        end = CGPointMake(CGRectGetMidX(shapeLayer.bounds), CGRectGetMaxY(shapeLayer.bounds));
-    }
-
-    CGContextDrawLinearGradient(imageCtx, self.lineGradient, start, end, 0);
+    CGContextDrawLinearGradient(imageCtx, gradient, start, end, 0);
     UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
     UIGraphicsEndImageContext();
-    CALayer *gradientLayer = [CALayer layer];
-    gradientLayer.frame = self.bounds;
-    gradientLayer.contents = (id)image.CGImage;
-    gradientLayer.mask = shapeLayer;
-    return gradientLayer;
+    return image;
 }
 
 @end
@@ -0,0 +1,91 @@
+//
+//  BEMPointBuffer.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMPointBuffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// Number of reserved slots around the points: one before the first point, one after the last point
+#define BEMPointBufferReservedSlots 2
+
+static bool BEMPointBufferAllocateStorage(BEMPointBufferRef buffer, size_t capacity) {
+    float *x = malloc(sizeof(float) * (capacity + BEMPointBufferReservedSlots));
+    float *y = malloc(sizeof(float) * (capacity + BEMPointBufferReservedSlots));
+    if (x == NULL || y == NULL) {
+        free(x);
+        free(y);
+        return false;
+    }
+
+    if (buffer->x != NULL) {
+        memcpy(x + 1, buffer->x, sizeof(float) * buffer->count);
+        memcpy(y + 1, buffer->y, sizeof(float) * buffer->count);
+        free(buffer->x - 1);
+        free(buffer->y - 1);
+    }
+
+    buffer->x = x + 1;
+    buffer->y = y + 1;
+    buffer->capacity = capacity;
+    return true;
+}
+
+BEMPointBufferRef BEMPointBufferCreate(size_t capacity) {
+    BEMPointBufferRef buffer = calloc(1, sizeof(BEMPointBuffer));
+    if (buffer == NULL) return NULL;
+
+    if (!BEMPointBufferAllocateStorage(buffer, capacity)) {
+        free(buffer);
+        return NULL;
+    }
+
+    buffer->referenceCount = 1;
+    return buffer;
+}
+
+BEMPointBufferRef BEMPointBufferRetain(BEMPointBufferRef buffer) {
+    if (buffer != NULL) __atomic_add_fetch(&buffer->referenceCount, 1, __ATOMIC_RELAXED);
+    return buffer;
+}
+
+void BEMPointBufferRelease(BEMPointBufferRef buffer) {
+    if (buffer == NULL) return;
+    if (__atomic_sub_fetch(&buffer->referenceCount, 1, __ATOMIC_ACQ_REL) > 0) return;
+
+    free(buffer->x - 1);
+    free(buffer->y - 1);
+    free(buffer);
+}
+
+bool BEMPointBufferReserve(BEMPointBufferRef buffer, size_t capacity) {
+    if (capacity <= buffer->capacity) return true;
+    return BEMPointBufferAllocateStorage(buffer, capacity);
+}
+
+void BEMPointBufferRemoveAllPoints(BEMPointBufferRef buffer) {
+    buffer->count = 0;
+}
+
+bool BEMPointBufferAppendPoint(BEMPointBufferRef buffer, float x, float y) {
+    if (buffer->count == buffer->capacity) {
+        size_t capacity = buffer->capacity < 8 ? 16 : buffer->capacity * 2;
+        if (!BEMPointBufferAllocateStorage(buffer, capacity)) return false;
+    }
+
+    buffer->x[buffer->count] = x;
+    buffer->y[buffer->count] = y;
+    buffer->count++;
+    return true;
+}
+
+void BEMPointBufferSetEndpoints(BEMPointBufferRef buffer, float firstX, float firstY, float lastX, float lastY) {
+    buffer->x[-1] = firstX;
+    buffer->y[-1] = firstY;
+    buffer->x[buffer->count] = lastX;
+    buffer->y[buffer->count] = lastY;
+}
@@ -0,0 +1,72 @@
+//
+//  BEMPointBuffer.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMPointBuffer_h
+#define BEMPointBuffer_h
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Packed buffer of points, stored as a struct of arrays (one array of x coordinates and one array of y coordinates).
+ @discussion The buffer is plain C and has no dependency on Foundation or UIKit. One slot before the first point (\p x[-1], \p y[-1]) and one slot after the last point (\p x[count], \p y[count]) are always reserved, so endpoints can be placed around the points without copying them. Missing points are stored with a NaN y coordinate.
+
+ Buffers are reference counted: use \p BEMPointBufferRetain and \p BEMPointBufferRelease to share a buffer between objects. */
+typedef struct BEMPointBuffer {
+    /// The x coordinates of the points
+    float *x;
+    /// The y coordinates of the points. NaN for missing points.
+    float *y;
+    /// The number of points in the buffer
+    size_t count;
+    /// The number of points the buffer can hold without reallocating
+    size_t capacity;
+    /// The reference count of the buffer. Do not modify directly.
+    long referenceCount;
+} BEMPointBuffer;
+
+typedef BEMPointBuffer *BEMPointBufferRef;
+
+
+/// Creates an empty buffer able to hold \p capacity points without reallocating. Returns NULL if the memory could not be allocated. The buffer has a reference count of 1.
+BEMPointBufferRef BEMPointBufferCreate(size_t capacity);
+
+/// Increments the reference count of the buffer. Returns the buffer.
+BEMPointBufferRef BEMPointBufferRetain(BEMPointBufferRef buffer);
+
+/// Decrements the reference count of the buffer and frees it when it reaches 0. Passing NULL does nothing.
+void BEMPointBufferRelease(BEMPointBufferRef buffer);
+
+/// Grows the buffer so it can hold at least \p capacity points. Returns false if the memory could not be allocated, in which case the buffer is left untouched.
+bool BEMPointBufferReserve(BEMPointBufferRef buffer, size_t capacity);
+
+/// Removes every point from the buffer, keeping its capacity.
+void BEMPointBufferRemoveAllPoints(BEMPointBufferRef buffer);
+
+/// Appends a point at the end of the buffer, growing it if needed. Returns false if the memory could not be allocated.
+bool BEMPointBufferAppendPoint(BEMPointBufferRef buffer, float x, float y);
+
+/// Writes the two endpoints in the reserved slots around the points. After this call the points from index -1 to \p count (included) form the closed outline.
+void BEMPointBufferSetEndpoints(BEMPointBufferRef buffer, float firstX, float firstY, float lastX, float lastY);
+
+/// The value stored as the y coordinate of a missing point
+#define BEMPointBufferNullValue ((float)NAN)
+
+/// Returns true if the y coordinate belongs to a missing point
+static inline bool BEMPointBufferIsNull(float y) {
+    return isnan(y);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
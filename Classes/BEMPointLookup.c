@@ -0,0 +1,92 @@
+//
+//  BEMPointLookup.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMPointLookup.h"
+
+#include <stdlib.h>
+
+typedef struct BEMPointLookupEntry {
+    float x;
+    size_t index;
+} BEMPointLookupEntry;
+
+static int BEMPointLookupCompareEntries(const void *a, const void *b) {
+    const BEMPointLookupEntry *first = a;
+    const BEMPointLookupEntry *second = b;
+    if (first->x < second->x) return -1;
+    if (first->x > second->x) return 1;
+    // Keep the order of the points for equal coordinates, qsort isn't stable
+    return (first->index > second->index) - (first->index < second->index);
+}
+
+BEMPointLookupRef BEMPointLookupCreate(const BEMPointBuffer *points) {
+    BEMPointLookupRef lookup = calloc(1, sizeof(BEMPointLookup));
+    size_t capacity = points->count > 0 ? points->count : 1;
+    if (lookup) {
+        lookup->x = malloc(sizeof(float) * capacity);
+        lookup->indices = malloc(sizeof(size_t) * capacity);
+    }
+    if (lookup == NULL || lookup->x == NULL || lookup->indices == NULL) {
+        BEMPointLookupFree(lookup);
+        return NULL;
+    }
+
+    bool isSorted = true;
+    for (size_t i = 0; i < points->count; i++) {
+        if (BEMPointBufferIsNull(points->y[i])) continue;
+        if (lookup->count > 0 && points->x[i] < lookup->x[lookup->count - 1]) isSorted = false;
+        lookup->x[lookup->count] = points->x[i];
+        lookup->indices[lookup->count] = i;
+        lookup->count++;
+    }
+    if (isSorted) return lookup;
+
+    BEMPointLookupEntry *entries = malloc(sizeof(BEMPointLookupEntry) * lookup->count);
+    if (entries == NULL) {
+        BEMPointLookupFree(lookup);
+        return NULL;
+    }
+    for (size_t i = 0; i < lookup->count; i++) {
+        entries[i].x = lookup->x[i];
+        entries[i].index = lookup->indices[i];
+    }
+    qsort(entries, lookup->count, sizeof(BEMPointLookupEntry), BEMPointLookupCompareEntries);
+    for (size_t i = 0; i < lookup->count; i++) {
+        lookup->x[i] = entries[i].x;
+        lookup->indices[i] = entries[i].index;
+    }
+    free(entries);
+    return lookup;
+}
+
+void BEMPointLookupFree(BEMPointLookupRef lookup) {
+    if (lookup == NULL) return;
+    free(lookup->x);
+    free(lookup->indices);
+    free(lookup);
+}
+
+size_t BEMPointLookupFindClosest(const BEMPointLookup *lookup, float x) {
+    if (lookup == NULL || lookup->count == 0) return BEMPointLookupNotFound;
+
+    // First coordinate greater than or equal to x
+    size_t low = 0;
+    size_t high = lookup->count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (lookup->x[middle] < x) low = middle + 1;
+        else high = middle;
+    }
+
+    if (low == lookup->count) return lookup->indices[lookup->count - 1];
+    if (low == 0) return lookup->indices[0];
+
+    // The closest point is either the first one at or after x, or the last one before x
+    size_t before = low - 1;
+    if (x - lookup->x[before] <= lookup->x[low] - x) return lookup->indices[before];
+    return lookup->indices[low];
+}
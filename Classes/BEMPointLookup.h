@@ -0,0 +1,50 @@
+//
+//  BEMPointLookup.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMPointLookup_h
+#define BEMPointLookup_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "BEMPointBuffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Returned by \p BEMPointLookupFindClosest when the lookup has no points
+#define BEMPointLookupNotFound SIZE_MAX
+
+/** Sorted index of the x coordinates of a point buffer, answering nearest-point queries with a binary search.
+ @discussion The lookup is built once from a point buffer and doesn't keep a reference to it. Missing points are left out, so a query always returns a point that can be displayed. */
+typedef struct BEMPointLookup {
+    /// The x coordinates of the points, in ascending order
+    float *x;
+    /// The index in the point buffer of every x coordinate
+    size_t *indices;
+    /// The number of points in the lookup
+    size_t count;
+} BEMPointLookup;
+
+typedef BEMPointLookup *BEMPointLookupRef;
+
+
+/// Creates the lookup of every non-missing point of \p points. The points are sorted by x coordinate unless they already are. Returns NULL if the memory could not be allocated.
+BEMPointLookupRef BEMPointLookupCreate(const BEMPointBuffer *points);
+
+/// Frees the lookup. Passing NULL does nothing.
+void BEMPointLookupFree(BEMPointLookupRef lookup);
+
+/// Returns the index in the point buffer of the point whose x coordinate is the closest to \p x, or BEMPointLookupNotFound if the lookup has no points. When two points are equally close, the one on the left is returned.
+size_t BEMPointLookupFindClosest(const BEMPointLookup *lookup, float x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+//
+//  BEMPointSegments.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMPointSegments.h"
+#include "BEMPointBuffer.h"
+
+#include <stdlib.h>
+
+BEMPointSegmentsRef BEMPointSegmentsCreate(void) {
+    return calloc(1, sizeof(BEMPointSegments));
+}
+
+void BEMPointSegmentsFree(BEMPointSegmentsRef segments) {
+    if (segments == NULL) return;
+    free(segments->segments);
+    free(segments);
+}
+
+static bool BEMPointSegmentsAppend(BEMPointSegmentsRef segments, size_t start, size_t count) {
+    if (segments->count == segments->capacity) {
+        size_t capacity = segments->capacity < 8 ? 16 : segments->capacity * 2;
+        BEMPointSegment *grownSegments = realloc(segments->segments, sizeof(BEMPointSegment) * capacity);
+        if (grownSegments == NULL) return false;
+        segments->segments = grownSegments;
+        segments->capacity = capacity;
+    }
+    segments->segments[segments->count++] = (BEMPointSegment){start, count};
+    segments->pointCount += count;
+    return true;
+}
+
+bool BEMPointSegmentsClassify(BEMPointSegmentsRef segments, const float *y, size_t count) {
+    segments->count = 0;
+    segments->pointCount = 0;
+    segments->totalCount = count;
+
+    size_t i = 0;
+    while (i < count) {
+        while (i < count && BEMPointBufferIsNull(y[i])) i++;
+        if (i == count) break;
+
+        size_t start = i;
+        while (i < count && !BEMPointBufferIsNull(y[i])) i++;
+        if (!BEMPointSegmentsAppend(segments, start, i - start)) {
+            segments->count = 0;
+            segments->pointCount = 0;
+            return false;
+        }
+    }
+    return true;
+}
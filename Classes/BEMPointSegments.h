@@ -0,0 +1,66 @@
+//
+//  BEMPointSegments.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMPointSegments_h
+#define BEMPointSegments_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The way a line crosses missing points
+typedef enum BEMNullValueFill {
+    /// The line stops at the point before missing points and starts again at the point after them, leaving a gap
+    BEMNullValueFillGap,
+    /// The line joins the points on both sides of missing points, as if they were on the line between them
+    BEMNullValueFillLinear,
+    /// Missing points keep the value of the point before them: the line stays flat up to the last missing point, then joins the next point
+    BEMNullValueFillPrevious
+} BEMNullValueFill;
+
+/// A run of consecutive points which are not missing
+typedef struct BEMPointSegment {
+    /// The index of the first point of the run
+    size_t start;
+    /// The number of points in the run, at least 1
+    size_t count;
+} BEMPointSegment;
+
+/** The runs of present points of a line, found in a single pass over its y coordinates.
+ @discussion Runs are in order and separated by at least one missing point, so the gaps between them are the runs of missing points. The path builder reads the points through the runs rather than testing every point, and never needs a coordinate for a missing point. */
+typedef struct BEMPointSegments {
+    BEMPointSegment *segments;
+    /// The number of runs
+    size_t count;
+    size_t capacity;
+    /// The number of points which were classified
+    size_t totalCount;
+    /// The number of points which are not missing, the sum of the counts of the runs
+    size_t pointCount;
+} BEMPointSegments;
+
+typedef BEMPointSegments *BEMPointSegmentsRef;
+
+
+/// Creates an empty list of runs. Returns NULL if the memory could not be allocated.
+BEMPointSegmentsRef BEMPointSegmentsCreate(void);
+
+/// Frees the list. Passing NULL does nothing.
+void BEMPointSegmentsFree(BEMPointSegmentsRef segments);
+
+/** Replaces the runs with the runs of present points of \p y, missing points being the NaN coordinates of \p BEMPointBuffer.
+ @return false if the memory could not be allocated, in which case the list is empty. */
+bool BEMPointSegmentsClassify(BEMPointSegmentsRef segments, const float *y, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,175 @@
+//
+//  BEMRangeTree.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMRangeTree.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/// Index stored for nodes which only cover missing values
+#define BEMRangeTreeMissing UINT32_MAX
+
+static inline bool BEMRangeTreeIsMissing(const BEMRangeTree *tree, double value) {
+    return value == tree->nullValue || isnan(value);
+}
+
+/// The index of the lowest of two values, the first one when they are equal
+static inline uint32_t BEMRangeTreeLowest(const BEMRangeTree *tree, uint32_t a, uint32_t b) {
+    if (a == BEMRangeTreeMissing) return b;
+    if (b == BEMRangeTreeMissing) return a;
+    double first = tree->values[a];
+    double second = tree->values[b];
+    if (second < first || (second == first && b < a)) return b;
+    return a;
+}
+
+/// The index of the highest of two values, the first one when they are equal
+static inline uint32_t BEMRangeTreeHighest(const BEMRangeTree *tree, uint32_t a, uint32_t b) {
+    if (a == BEMRangeTreeMissing) return b;
+    if (b == BEMRangeTreeMissing) return a;
+    double first = tree->values[a];
+    double second = tree->values[b];
+    if (second > first || (second == first && b < a)) return b;
+    return a;
+}
+
+/// Reads the values of [start, end) one by one, for the parts of a range which don't cover a whole leaf
+static void BEMRangeTreeScan(const BEMRangeTree *tree, size_t start, size_t end, uint32_t *minimum, uint32_t *maximum) {
+    for (size_t i = start; i < end; i++) {
+        if (BEMRangeTreeIsMissing(tree, tree->values[i])) continue;
+        *minimum = BEMRangeTreeLowest(tree, *minimum, (uint32_t)i);
+        *maximum = BEMRangeTreeHighest(tree, *maximum, (uint32_t)i);
+    }
+}
+
+BEMRangeTreeRef BEMRangeTreeCreate(const double *values, size_t count, double nullValue) {
+    if (count >= BEMRangeTreeMissing) return NULL;
+
+    BEMRangeTreeRef tree = calloc(1, sizeof(BEMRangeTree));
+    if (tree == NULL) return NULL;
+    tree->count = count;
+    tree->values = values;
+    tree->nullValue = nullValue;
+    tree->leafCount = (count + BEMRangeTreeBlockSize - 1) / BEMRangeTreeBlockSize;
+    tree->ownsNodes = true;
+
+    size_t nodeCount = BEMRangeTreeNodeCount(count);
+    tree->minimumIndices = malloc(sizeof(uint32_t) * nodeCount);
+    tree->maximumIndices = malloc(sizeof(uint32_t) * nodeCount);
+    if (tree->minimumIndices == NULL || tree->maximumIndices == NULL) {
+        BEMRangeTreeFree(tree);
+        return NULL;
+    }
+
+    // Node 0 isn't used, it is only set so that the nodes can be stored as they are
+    tree->minimumIndices[0] = BEMRangeTreeMissing;
+    tree->maximumIndices[0] = BEMRangeTreeMissing;
+
+    // Leaves first, then every node from the extremes of its children
+    for (size_t leaf = 0; leaf < tree->leafCount; leaf++) {
+        uint32_t minimum = BEMRangeTreeMissing;
+        uint32_t maximum = BEMRangeTreeMissing;
+        size_t start = leaf * BEMRangeTreeBlockSize;
+        size_t end = start + BEMRangeTreeBlockSize < count ? start + BEMRangeTreeBlockSize : count;
+        BEMRangeTreeScan(tree, start, end, &minimum, &maximum);
+        tree->minimumIndices[tree->leafCount + leaf] = minimum;
+        tree->maximumIndices[tree->leafCount + leaf] = maximum;
+    }
+    for (size_t node = tree->leafCount; node-- > 1;) {
+        tree->minimumIndices[node] = BEMRangeTreeLowest(tree, tree->minimumIndices[2 * node], tree->minimumIndices[2 * node + 1]);
+        tree->maximumIndices[node] = BEMRangeTreeHighest(tree, tree->maximumIndices[2 * node], tree->maximumIndices[2 * node + 1]);
+    }
+    return tree;
+}
+
+BEMRangeTreeRef BEMRangeTreeCreateWithNodes(const double *values, size_t count, double nullValue, const uint32_t *minimumIndices, const uint32_t *maximumIndices) {
+    if (count >= BEMRangeTreeMissing) return NULL;
+
+    BEMRangeTreeRef tree = calloc(1, sizeof(BEMRangeTree));
+    if (tree == NULL) return NULL;
+    tree->count = count;
+    tree->values = values;
+    tree->nullValue = nullValue;
+    tree->leafCount = (count + BEMRangeTreeBlockSize - 1) / BEMRangeTreeBlockSize;
+    // Queries only read the nodes, borrowed nodes can be read-only memory
+    tree->minimumIndices = (uint32_t *)minimumIndices;
+    tree->maximumIndices = (uint32_t *)maximumIndices;
+    tree->ownsNodes = false;
+    return tree;
+}
+
+size_t BEMRangeTreeNodeCount(size_t count) {
+    size_t leafCount = (count + BEMRangeTreeBlockSize - 1) / BEMRangeTreeBlockSize;
+    return leafCount > 0 ? 2 * leafCount : 1;
+}
+
+void BEMRangeTreeFree(BEMRangeTreeRef tree) {
+    if (tree == NULL) return;
+    if (tree->ownsNodes) {
+        free(tree->minimumIndices);
+        free(tree->maximumIndices);
+    }
+    free(tree);
+}
+
+bool BEMRangeTreeFindExtremes(const BEMRangeTree *tree, size_t start, size_t end, size_t *minimumIndex, size_t *maximumIndex) {
+    uint32_t minimum = BEMRangeTreeMissing;
+    uint32_t maximum = BEMRangeTreeMissing;
+    if (end > tree->count) end = tree->count;
+
+    if (start < end) {
+        // The whole leaves inside of the range come from the tree, the values at both ends are read
+        size_t firstLeaf = (start + BEMRangeTreeBlockSize - 1) / BEMRangeTreeBlockSize;
+        size_t endLeaf = end / BEMRangeTreeBlockSize;
+        if (firstLeaf >= endLeaf) {
+            BEMRangeTreeScan(tree, start, end, &minimum, &maximum);
+        } else {
+            BEMRangeTreeScan(tree, start, firstLeaf * BEMRangeTreeBlockSize, &minimum, &maximum);
+            for (size_t left = firstLeaf + tree->leafCount, right = endLeaf + tree->leafCount; left < right; left /= 2, right /= 2) {
+                if (left & 1) {
+                    minimum = BEMRangeTreeLowest(tree, minimum, tree->minimumIndices[left]);
+                    maximum = BEMRangeTreeHighest(tree, maximum, tree->maximumIndices[left]);
+                    left++;
+                }
+                if (right & 1) {
+                    right--;
+                    minimum = BEMRangeTreeLowest(tree, minimum, tree->minimumIndices[right]);
+                    maximum = BEMRangeTreeHighest(tree, maximum, tree->maximumIndices[right]);
+                }
+            }
+            BEMRangeTreeScan(tree, endLeaf * BEMRangeTreeBlockSize, end, &minimum, &maximum);
+        }
+    }
+
+    if (minimumIndex) *minimumIndex = minimum == BEMRangeTreeMissing ? BEMRangeTreeNotFound : minimum;
+    if (maximumIndex) *maximumIndex = maximum == BEMRangeTreeMissing ? BEMRangeTreeNotFound : maximum;
+    return minimum != BEMRangeTreeMissing;
+}
+
+size_t BEMRangeTreeEnvelope(const BEMRangeTree *tree, size_t start, size_t end, size_t columnCount, size_t *indices) {
+    if (end > tree->count) end = tree->count;
+    if (start >= end || columnCount == 0) return 0;
+
+    size_t length = end - start;
+    size_t keptCount = 0;
+    for (size_t column = 0; column < columnCount; column++) {
+        size_t columnStart = start + length * column / columnCount;
+        size_t columnEnd = start + length * (column + 1) / columnCount;
+        if (columnStart >= columnEnd) continue;
+
+        size_t minimum, maximum;
+        if (!BEMRangeTreeFindExtremes(tree, columnStart, columnEnd, &minimum, &maximum)) {
+            indices[keptCount++] = columnStart;
+        } else if (minimum == maximum) {
+            indices[keptCount++] = minimum;
+        } else {
+            indices[keptCount++] = minimum < maximum ? minimum : maximum;
+            indices[keptCount++] = minimum < maximum ? maximum : minimum;
+        }
+    }
+    return keptCount;
+}
@@ -0,0 +1,79 @@
+//
+//  BEMRangeTree.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMRangeTree_h
+#define BEMRangeTree_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Returned instead of an index when a range only holds missing values
+#define BEMRangeTreeNotFound SIZE_MAX
+
+/// The number of values summarized by every leaf of the tree
+#define BEMRangeTreeBlockSize 16
+
+/** Min/max segment tree over a series, answering "where are the lowest and highest values between two indexes" in O(log n) whatever the length of the range.
+ @discussion Every leaf keeps the index of the lowest and highest value of \p BEMRangeTreeBlockSize consecutive values, and every node the extremes of its two children, so the tree takes a small fraction of the memory of the values. Queries combine O(log n) nodes with the values of the two partial blocks at the ends of the range. Missing values (equal to the null value, or NaN) are never returned.
+
+ The tree borrows the values, which must stay valid and unchanged while the tree is used. Only \p count should be read, the other fields are private. */
+typedef struct BEMRangeTree {
+    /// The number of values in the tree
+    size_t count;
+
+    const double *values;
+    double nullValue;
+    /// The number of leaves, every node \p i has its children at 2i and 2i+1, and leaf \p i is node \p leafCount + i
+    size_t leafCount;
+    /// The index of the lowest and highest value under every node, UINT32_MAX for missing values only
+    uint32_t *minimumIndices;
+    uint32_t *maximumIndices;
+    /// false when the nodes were given to \p BEMRangeTreeCreateWithNodes, they are not freed with the tree
+    bool ownsNodes;
+} BEMRangeTree;
+
+typedef BEMRangeTree *BEMRangeTreeRef;
+
+
+/// Builds the tree of \p count values in O(n). Returns NULL if the memory could not be allocated, or if \p count doesn't fit in 32 bits.
+BEMRangeTreeRef BEMRangeTreeCreate(const double *values, size_t count, double nullValue);
+
+/** Wraps nodes built by an earlier tree of the same values, for example stored in a file next to them, without reading them.
+ @discussion The nodes are borrowed like the values: they must stay valid and unchanged while the tree is used, and are not freed with it. They are trusted: an index past \p count makes queries read outside of the values.
+ @param minimumIndices The \p BEMRangeTreeNodeCount(count) indices of the lowest value under every node, as in the \p minimumIndices of a tree.
+ @param maximumIndices The indices of the highest value under every node.
+ @return NULL if the memory could not be allocated, or if \p count doesn't fit in 32 bits. */
+BEMRangeTreeRef BEMRangeTreeCreateWithNodes(const double *values, size_t count, double nullValue, const uint32_t *minimumIndices, const uint32_t *maximumIndices);
+
+/// The number of nodes of the tree of \p count values, the length of its \p minimumIndices and \p maximumIndices
+size_t BEMRangeTreeNodeCount(size_t count);
+
+/// Frees the tree, not the values. Passing NULL does nothing.
+void BEMRangeTreeFree(BEMRangeTreeRef tree);
+
+/** Finds the lowest and highest values of the range [start, end) in O(log n).
+ @param minimumIndex Receives the index of the lowest value, or BEMRangeTreeNotFound. Can be NULL.
+ @param maximumIndex Receives the index of the highest value, or BEMRangeTreeNotFound. Can be NULL.
+ @return false if the range only holds missing values. */
+bool BEMRangeTreeFindExtremes(const BEMRangeTree *tree, size_t start, size_t end, size_t *minimumIndex, size_t *maximumIndex);
+
+/** Reduces the range [start, end) to its vertical envelope in O(columnCount log n), the same points as \p BEMDecimateMinMax keeps without reading every value.
+ @discussion The range is split in \p columnCount columns of equal length. The lowest and highest value of every column are kept in their original order, once if they are the same value, and a column made only of missing values keeps its first index so gaps survive the reduction.
+ @param indices Receives the index of every kept value, in ascending order. Must be able to hold 2 * \p columnCount indices.
+ @return The number of indices written. */
+size_t BEMRangeTreeEnvelope(const BEMRangeTree *tree, size_t start, size_t end, size_t columnCount, size_t *indices);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
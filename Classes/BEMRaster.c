@@ -0,0 +1,525 @@
+//
+//  BEMRaster.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMRaster.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Number of scanlines sampled in every row of pixels when filling paths
+#define BEMRasterSubsamples 4
+
+/// Maximum distance between a curve and the segments drawn in its place, in pixels
+#define BEMRasterFlatteningTolerance 0.1f
+
+/// An edge of a filled polygon, always going downwards
+typedef struct BEMRasterEdge {
+    float x0, y0;
+    float y1;
+    float slope;
+    int winding;
+} BEMRasterEdge;
+
+BEMRasterCanvasRef BEMRasterCanvasCreate(uint8_t *pixels, size_t width, size_t height, size_t bytesPerRow) {
+    BEMRasterCanvasRef canvas = calloc(1, sizeof(BEMRasterCanvas));
+    if (canvas == NULL) return NULL;
+
+    canvas->pixels = pixels;
+    canvas->width = width;
+    canvas->height = height;
+    canvas->bytesPerRow = bytesPerRow;
+    canvas->coverage = calloc(width * height > 0 ? width * height : 1, sizeof(float));
+    if (canvas->coverage == NULL) {
+        BEMRasterCanvasFree(canvas);
+        return NULL;
+    }
+    return canvas;
+}
+
+void BEMRasterCanvasFree(BEMRasterCanvasRef canvas) {
+    if (canvas == NULL) return;
+    free(canvas->coverage);
+    free(canvas->outline);
+    free(canvas->edges);
+    free(canvas->activeEdges);
+    free(canvas->crossings);
+    free(canvas);
+}
+
+void BEMRasterCanvasSetPixels(BEMRasterCanvasRef canvas, uint8_t *pixels, size_t bytesPerRow) {
+    canvas->pixels = pixels;
+    canvas->bytesPerRow = bytesPerRow;
+}
+
+static inline uint8_t BEMRasterByte(float component) {
+    if (component <= 0) return 0;
+    if (component >= 1) return 255;
+    return (uint8_t)(component * 255 + 0.5f);
+}
+
+void BEMRasterClear(BEMRasterCanvasRef canvas, BEMRasterColor color) {
+    uint8_t pixel[4] = {BEMRasterByte(color.red), BEMRasterByte(color.green), BEMRasterByte(color.blue), BEMRasterByte(color.alpha)};
+    for (size_t y = 0; y < canvas->height; y++) {
+        uint8_t *row = canvas->pixels + y * canvas->bytesPerRow;
+        for (size_t x = 0; x < canvas->width; x++) memcpy(row + 4 * x, pixel, 4);
+    }
+}
+
+/// Draws \p color over a pixel with the source-over operator, \p coverage being the part of the pixel covered
+static inline void BEMRasterBlend(uint8_t *pixel, BEMRasterColor color, float coverage) {
+    float alpha = color.alpha * (coverage > 1 ? 1 : coverage);
+    if (alpha <= 0) return;
+
+    // Opaque pixels, the most common case, don't need to weight the destination by its alpha
+    if (pixel[3] == 255) {
+        float destinationWeight = (1 - alpha) / 255.0f;
+        pixel[0] = BEMRasterByte(color.red * alpha + pixel[0] * destinationWeight);
+        pixel[1] = BEMRasterByte(color.green * alpha + pixel[1] * destinationWeight);
+        pixel[2] = BEMRasterByte(color.blue * alpha + pixel[2] * destinationWeight);
+        return;
+    }
+
+    float destinationAlpha = pixel[3] / 255.0f;
+    float destinationWeight = destinationAlpha * (1 - alpha);
+    float resultAlpha = alpha + destinationWeight;
+    float red = (color.red * alpha + pixel[0] / 255.0f * destinationWeight) / resultAlpha;
+    float green = (color.green * alpha + pixel[1] / 255.0f * destinationWeight) / resultAlpha;
+    float blue = (color.blue * alpha + pixel[2] / 255.0f * destinationWeight) / resultAlpha;
+    pixel[0] = BEMRasterByte(red);
+    pixel[1] = BEMRasterByte(green);
+    pixel[2] = BEMRasterByte(blue);
+    pixel[3] = BEMRasterByte(resultAlpha);
+}
+
+/// Blends the coverage of the pixels from \p minimumX to \p maximumX of a row, and resets it
+static void BEMRasterBlendRow(BEMRasterCanvasRef canvas, size_t y, float *coverage, size_t minimumX, size_t maximumX, BEMRasterColor color) {
+    uint8_t *row = canvas->pixels + y * canvas->bytesPerRow;
+    for (size_t x = minimumX; x <= maximumX; x++) {
+        if (coverage[x] > 0) BEMRasterBlend(row + 4 * x, color, coverage[x]);
+        coverage[x] = 0;
+    }
+}
+
+/// Flattens the path in the canvas' outline. Returns false if the memory could not be allocated.
+static bool BEMRasterFlattenPath(BEMRasterCanvasRef canvas, const BEMPath *path, size_t *count) {
+    *count = BEMPathFlatten(path, BEMRasterFlatteningTolerance, &canvas->outline, &canvas->outlineCapacity);
+    return *count > 0 || path->elementCount == 0;
+}
+
+//----- FILL -----//
+
+static int BEMRasterCompareEdges(const void *a, const void *b) {
+    const BEMRasterEdge *first = a;
+    const BEMRasterEdge *second = b;
+    return (first->y0 > second->y0) - (first->y0 < second->y0);
+}
+
+static inline void BEMRasterAddEdge(BEMRasterEdge *edges, size_t *edgeCount, float x0, float y0, float x1, float y1) {
+    if (y0 == y1) return;
+    BEMRasterEdge *edge = &edges[(*edgeCount)++];
+    edge->winding = 1;
+    if (y0 > y1) {
+        float x = x0, y = y0;
+        x0 = x1; y0 = y1;
+        x1 = x; y1 = y;
+        edge->winding = -1;
+    }
+    edge->x0 = x0;
+    edge->y0 = y0;
+    edge->y1 = y1;
+    edge->slope = (x1 - x0) / (y1 - y0);
+}
+
+/// Adds \p weight times the horizontal coverage of the span from \p start to \p end to a row
+static inline void BEMRasterAddSpan(float *coverage, float start, float end, size_t width, float weight, size_t *minimumX, size_t *maximumX) {
+    if (start < 0) start = 0;
+    if (end > width) end = width;
+    if (end <= start) return;
+
+    // Pixels partly covered at both ends of the span
+    size_t first = (size_t)start;
+    size_t last = (size_t)ceilf(end) - 1;
+    if (first < *minimumX) *minimumX = first;
+    if (last > *maximumX) *maximumX = last;
+
+    if (first == last) {
+        coverage[first] += (end - start) * weight;
+        return;
+    }
+    coverage[first] += (first + 1 - start) * weight;
+    for (size_t x = first + 1; x < last; x++) coverage[x] += weight;
+    coverage[last] += (end - last) * weight;
+}
+
+bool BEMRasterFillPath(BEMRasterCanvasRef canvas, const BEMPath *path, BEMRasterColor color) {
+    size_t count;
+    if (!BEMRasterFlattenPath(canvas, path, &count)) return false;
+    if (count == 0 || canvas->width == 0 || canvas->height == 0) return true;
+
+    // Every subpath is closed by one more edge
+    if (count + 1 > canvas->edgeCapacity) {
+        size_t capacity = count + 1 > 2 * canvas->edgeCapacity ? count + 1 : 2 * canvas->edgeCapacity;
+        BEMRasterEdge *edges = malloc(sizeof(BEMRasterEdge) * capacity);
+        size_t *activeEdges = malloc(sizeof(size_t) * capacity);
+        float *crossings = malloc(sizeof(float) * 2 * capacity);
+        if (edges == NULL || activeEdges == NULL || crossings == NULL) {
+            free(edges);
+            free(activeEdges);
+            free(crossings);
+            return false;
+        }
+        free(canvas->edges);
+        free(canvas->activeEdges);
+        free(canvas->crossings);
+        canvas->edges = edges;
+        canvas->activeEdges = activeEdges;
+        canvas->crossings = crossings;
+        canvas->edgeCapacity = capacity;
+    }
+
+    BEMRasterEdge *edges = canvas->edges;
+    size_t edgeCount = 0;
+    const float *outline = canvas->outline;
+    size_t subpathStart = 0;
+    for (size_t i = 0; i <= count; i++) {
+        bool isSubpathEnd = i == count || isnan(outline[2 * i]);
+        if (!isSubpathEnd) {
+            if (i > subpathStart) BEMRasterAddEdge(edges, &edgeCount, outline[2 * (i - 1)], outline[2 * (i - 1) + 1], outline[2 * i], outline[2 * i + 1]);
+            continue;
+        }
+        if (i > subpathStart) BEMRasterAddEdge(edges, &edgeCount, outline[2 * (i - 1)], outline[2 * (i - 1) + 1], outline[2 * subpathStart], outline[2 * subpathStart + 1]);
+        subpathStart = i + 1;
+    }
+    if (edgeCount == 0) return true;
+    qsort(edges, edgeCount, sizeof(BEMRasterEdge), BEMRasterCompareEdges);
+
+    float bottom = edges[0].y1;
+    for (size_t i = 1; i < edgeCount; i++) if (edges[i].y1 > bottom) bottom = edges[i].y1;
+    size_t firstRow = edges[0].y0 > 0 ? (size_t)edges[0].y0 : 0;
+    size_t lastRow = bottom < canvas->height ? (size_t)ceilf(bottom) : canvas->height;
+
+    float *coverage = canvas->coverage;
+    size_t *activeEdges = canvas->activeEdges;
+    size_t activeCount = 0;
+    size_t nextEdge = 0;
+    float *crossings = canvas->crossings;
+
+    for (size_t y = firstRow; y < lastRow; y++) {
+        size_t minimumX = canvas->width, maximumX = 0;
+        for (int s = 0; s < BEMRasterSubsamples; s++) {
+            float scanline = y + (s + 0.5f) / BEMRasterSubsamples;
+
+            // Edges start being crossed in the order they were sorted, and stop at their bottom end
+            while (nextEdge < edgeCount && edges[nextEdge].y0 <= scanline) activeEdges[activeCount++] = nextEdge++;
+            size_t crossingCount = 0;
+            for (size_t a = 0; a < activeCount;) {
+                const BEMRasterEdge *edge = &edges[activeEdges[a]];
+                if (edge->y1 <= scanline) {
+                    activeEdges[a] = activeEdges[--activeCount];
+                    continue;
+                }
+
+                // Insertion sort, the crossings of consecutive scanlines are in almost the same order
+                float x = edge->x0 + (scanline - edge->y0) * edge->slope;
+                size_t c = crossingCount++;
+                while (c > 0 && crossings[2 * (c - 1)] > x) {
+                    crossings[2 * c] = crossings[2 * (c - 1)];
+                    crossings[2 * c + 1] = crossings[2 * (c - 1) + 1];
+                    c--;
+                }
+                crossings[2 * c] = x;
+                crossings[2 * c + 1] = edge->winding;
+                a++;
+            }
+
+            int winding = 0;
+            float spanStart = 0;
+            for (size_t c = 0; c < crossingCount; c++) {
+                int previousWinding = winding;
+                winding += (int)crossings[2 * c + 1];
+                if (previousWinding == 0 && winding != 0) spanStart = crossings[2 * c];
+                else if (previousWinding != 0 && winding == 0) BEMRasterAddSpan(coverage, spanStart, crossings[2 * c], canvas->width, 1.0f / BEMRasterSubsamples, &minimumX, &maximumX);
+            }
+        }
+        if (minimumX <= maximumX) BEMRasterBlendRow(canvas, y, coverage, minimumX, maximumX, color);
+    }
+    return true;
+}
+
+//----- STROKE -----//
+
+/// Coverage of a pixel whose center is at \p distance from the middle of a line of \p lineWidth. Lines thinner than a pixel are drawn as 1 pixel wide lines with a lower coverage.
+static inline float BEMRasterLineCoverage(float distance, float lineWidth) {
+    if (lineWidth < 1) {
+        float coverage = 1 - distance;
+        return coverage > 0 ? coverage * lineWidth : 0;
+    }
+    float coverage = lineWidth / 2 + 0.5f - distance;
+    if (coverage <= 0) return 0;
+    return coverage > 1 ? 1 : coverage;
+}
+
+bool BEMRasterStrokePath(BEMRasterCanvasRef canvas, const BEMPath *path, float lineWidth, BEMRasterColor color) {
+    size_t count;
+    if (!BEMRasterFlattenPath(canvas, path, &count)) return false;
+    if (count == 0 || canvas->width == 0 || canvas->height == 0 || lineWidth <= 0) return true;
+
+    // Overlapping segments keep the highest coverage of every pixel, so joints are not drawn twice
+    float reach = (lineWidth < 1 ? 1 : lineWidth / 2 + 0.5f);
+    float *coverage = canvas->coverage;
+    size_t canvasWidth = canvas->width;
+    long minimumX = (long)canvas->width, maximumX = -1, minimumY = (long)canvas->height, maximumY = -1;
+    const float *outline = canvas->outline;
+
+    for (size_t i = 0; i < count; i++) {
+        if (isnan(outline[2 * i])) continue;
+        // A subpath of a single point is drawn as a dot, like a round cap
+        bool isSubpathStart = i == 0 || isnan(outline[2 * (i - 1)]);
+        bool isSubpathEnd = i + 1 == count || isnan(outline[2 * (i + 1)]);
+        if (isSubpathStart && !isSubpathEnd) continue;
+
+        float bx = outline[2 * i], by = outline[2 * i + 1];
+        float ax = isSubpathStart ? bx : outline[2 * (i - 1)];
+        float ay = isSubpathStart ? by : outline[2 * (i - 1) + 1];
+        long left = (long)floorf(fminf(ax, bx) - reach), right = (long)ceilf(fmaxf(ax, bx) + reach);
+        long top = (long)floorf(fminf(ay, by) - reach), bottom = (long)ceilf(fmaxf(ay, by) + reach);
+        if (left < 0) left = 0;
+        if (top < 0) top = 0;
+        if (right >= (long)canvas->width) right = (long)canvas->width - 1;
+        if (bottom >= (long)canvas->height) bottom = (long)canvas->height - 1;
+        if (left > right || top > bottom) continue;
+        if (left < minimumX) minimumX = left;
+        if (right > maximumX) maximumX = right;
+        if (top < minimumY) minimumY = top;
+        if (bottom > maximumY) maximumY = bottom;
+
+        float dx = bx - ax, dy = by - ay;
+        float lengthSquared = dx * dx + dy * dy;
+        for (long y = top; y <= bottom; y++) {
+            float *row = coverage + y * canvasWidth;
+            float py = y + 0.5f - ay;
+            for (long x = left; x <= right; x++) {
+                float px = x + 0.5f - ax;
+                float t = lengthSquared > 0 ? (px * dx + py * dy) / lengthSquared : 0;
+                if (t < 0) t = 0;
+                else if (t > 1) t = 1;
+                float distance = hypotf(px - t * dx, py - t * dy);
+                float pixelCoverage = BEMRasterLineCoverage(distance, lineWidth);
+                if (pixelCoverage > row[x]) row[x] = pixelCoverage;
+            }
+        }
+    }
+
+    for (long y = minimumY; y <= maximumY; y++) {
+        BEMRasterBlendRow(canvas, (size_t)y, coverage + y * canvasWidth, (size_t)minimumX, (size_t)maximumX, color);
+    }
+    return true;
+}
+
+void BEMRasterFillCircle(BEMRasterCanvasRef canvas, float x, float y, float radius, BEMRasterColor color) {
+    if (radius <= 0) return;
+    long left = (long)floorf(x - radius - 1), right = (long)ceilf(x + radius + 1);
+    long top = (long)floorf(y - radius - 1), bottom = (long)ceilf(y + radius + 1);
+    if (left < 0) left = 0;
+    if (top < 0) top = 0;
+    if (right >= (long)canvas->width) right = (long)canvas->width - 1;
+    if (bottom >= (long)canvas->height) bottom = (long)canvas->height - 1;
+
+    for (long py = top; py <= bottom; py++) {
+        uint8_t *row = canvas->pixels + py * canvas->bytesPerRow;
+        for (long px = left; px <= right; px++) {
+            float coverage = radius + 0.5f - hypotf(px + 0.5f - x, py + 0.5f - y);
+            if (coverage > 0) BEMRasterBlend(row + 4 * px, color, coverage);
+        }
+    }
+}
+
+//----- ENCODING -----//
+
+/// Length of the PPM header, without the terminating null character
+static size_t BEMRasterPPMHeader(size_t width, size_t height, char *header, size_t capacity) {
+    int length = snprintf(header, capacity, "P6\n%zu %zu\n255\n", width, height);
+    return length > 0 ? (size_t)length : 0;
+}
+
+size_t BEMRasterPPMSize(size_t width, size_t height) {
+    char header[64];
+    return BEMRasterPPMHeader(width, height, header, sizeof(header)) + width * height * 3;
+}
+
+size_t BEMRasterEncodePPM(const BEMRasterCanvas *canvas, uint8_t *buffer, size_t capacity) {
+    size_t size = BEMRasterPPMSize(canvas->width, canvas->height);
+    if (capacity < size) return 0;
+
+    char header[64];
+    size_t headerLength = BEMRasterPPMHeader(canvas->width, canvas->height, header, sizeof(header));
+    memcpy(buffer, header, headerLength);
+    uint8_t *output = buffer + headerLength;
+    for (size_t y = 0; y < canvas->height; y++) {
+        const uint8_t *row = canvas->pixels + y * canvas->bytesPerRow;
+        for (size_t x = 0; x < canvas->width; x++) {
+            *output++ = row[4 * x];
+            *output++ = row[4 * x + 1];
+            *output++ = row[4 * x + 2];
+        }
+    }
+    return size;
+}
+
+/// Maximum number of bytes in a stored deflate block
+#define BEMRasterStoredBlockSize 65535
+
+/// CRC-32 of PNG chunks, computed a byte at a time
+static uint32_t BEMRasterCRC(uint32_t crc, const uint8_t *bytes, size_t length) {
+    static const uint32_t table[256] = {
+        0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3,
+        0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988, 0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91,
+        0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
+        0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9, 0xfa0f3d63, 0x8d080df5,
+        0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172, 0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b,
+        0x35b5a8fa, 0x42b2986c, 0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
+        0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423, 0xcfba9599, 0xb8bda50f,
+        0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924, 0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d,
+        0x76dc4190, 0x01db7106, 0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
+        0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d, 0x91646c97, 0xe6635c01,
+        0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e, 0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457,
+        0x65b0d9c6, 0x12b7e950, 0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
+        0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2, 0x4adfa541, 0x3dd895d7, 0xa4d1c46d, 0xd3d6f4fb,
+        0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0, 0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9,
+        0x5005713c, 0x270241aa, 0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
+        0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81, 0xb7bd5c3b, 0xc0ba6cad,
+        0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a, 0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683,
+        0xe3630b12, 0x94643b84, 0x0d6d6a3e, 0x7a6a5aa8, 0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
+        0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb, 0x196c3671, 0x6e6b06e7,
+        0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc, 0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5,
+        0xd6d6a3e8, 0xa1d1937e, 0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
+        0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55, 0x316e8eef, 0x4669be79,
+        0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236, 0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f,
+        0xc5ba3bbe, 0xb2bd0b28, 0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
+        0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f, 0x72076785, 0x05005713,
+        0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38, 0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21,
+        0x86d3d2d4, 0xf1d4e242, 0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
+        0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c, 0x8f659eff, 0xf862ae69, 0x616bffd3, 0x166ccf45,
+        0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2, 0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db,
+        0xaed16a4a, 0xd9d65adc, 0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
+        0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf,
+        0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) crc = (crc >> 8) ^ table[(crc ^ bytes[i]) & 0xff];
+    return ~crc;
+}
+
+/// Adds bytes to an Adler-32 checksum, taking the modulo only when the sums could overflow
+static void BEMRasterAdler(uint32_t *a, uint32_t *b, const uint8_t *bytes, size_t length) {
+    while (length > 0) {
+        size_t chunk = length < 5552 ? length : 5552;
+        length -= chunk;
+        for (size_t i = 0; i < chunk; i++) {
+            *a += bytes[i];
+            *b += *a;
+        }
+        bytes += chunk;
+        *a %= 65521;
+        *b %= 65521;
+    }
+}
+
+static inline uint8_t *BEMRasterWriteUInt32(uint8_t *output, uint32_t value) {
+    output[0] = (uint8_t)(value >> 24);
+    output[1] = (uint8_t)(value >> 16);
+    output[2] = (uint8_t)(value >> 8);
+    output[3] = (uint8_t)value;
+    return output + 4;
+}
+
+/// Size of the zlib stream holding \p rawSize bytes in stored blocks
+static size_t BEMRasterZlibSize(size_t rawSize) {
+    size_t blockCount = (rawSize + BEMRasterStoredBlockSize - 1) / BEMRasterStoredBlockSize;
+    return 2 + rawSize + 5 * blockCount + 4;
+}
+
+size_t BEMRasterPNGSize(size_t width, size_t height) {
+    size_t rawSize = height * (1 + 4 * width);
+    // Signature, IHDR chunk, IDAT chunk, IEND chunk
+    return 8 + (12 + 13) + (12 + BEMRasterZlibSize(rawSize)) + 12;
+}
+
+size_t BEMRasterEncodePNG(const BEMRasterCanvas *canvas, uint8_t *buffer, size_t capacity) {
+    size_t size = BEMRasterPNGSize(canvas->width, canvas->height);
+    if (capacity < size || canvas->width == 0 || canvas->height == 0 || canvas->width > 0x7fffffff || canvas->height > 0x7fffffff) return 0;
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    uint8_t *output = buffer;
+    memcpy(output, signature, 8);
+    output += 8;
+
+    // Header: 8 bits per channel, RGBA, no interlacing
+    uint8_t *chunk = output;
+    output = BEMRasterWriteUInt32(output, 13);
+    memcpy(output, "IHDR", 4);
+    output = BEMRasterWriteUInt32(output + 4, (uint32_t)canvas->width);
+    output = BEMRasterWriteUInt32(output, (uint32_t)canvas->height);
+    *output++ = 8;
+    *output++ = 6;
+    *output++ = 0;
+    *output++ = 0;
+    *output++ = 0;
+    output = BEMRasterWriteUInt32(output, BEMRasterCRC(0, chunk + 4, 17));
+
+    // Image data: every row starts with its filter type, none
+    size_t rawSize = canvas->height * (1 + 4 * canvas->width);
+    size_t zlibSize = BEMRasterZlibSize(rawSize);
+    chunk = output;
+    output = BEMRasterWriteUInt32(output, (uint32_t)zlibSize);
+    memcpy(output, "IDAT", 4);
+    output += 4;
+    *output++ = 0x78;
+    *output++ = 0x01;
+
+    uint32_t adlerA = 1, adlerB = 0;
+    size_t blockRemaining = 0;
+    size_t rawRemaining = rawSize;
+    const uint8_t filterType = 0;
+    for (size_t y = 0; y < canvas->height; y++) {
+        // A row and its filter type may be split across blocks
+        const uint8_t *parts[2] = {&filterType, canvas->pixels + y * canvas->bytesPerRow};
+        size_t lengths[2] = {1, 4 * canvas->width};
+        for (int p = 0; p < 2; p++) {
+            const uint8_t *bytes = parts[p];
+            size_t length = lengths[p];
+            while (length > 0) {
+                if (blockRemaining == 0) {
+                    blockRemaining = rawRemaining < BEMRasterStoredBlockSize ? rawRemaining : BEMRasterStoredBlockSize;
+                    *output++ = rawRemaining == blockRemaining ? 1 : 0;
+                    *output++ = (uint8_t)blockRemaining;
+                    *output++ = (uint8_t)(blockRemaining >> 8);
+                    *output++ = (uint8_t)~blockRemaining;
+                    *output++ = (uint8_t)(~blockRemaining >> 8);
+                }
+                size_t copied = length < blockRemaining ? length : blockRemaining;
+                memcpy(output, bytes, copied);
+                BEMRasterAdler(&adlerA, &adlerB, bytes, copied);
+                output += copied;
+                bytes += copied;
+                length -= copied;
+                blockRemaining -= copied;
+                rawRemaining -= copied;
+            }
+        }
+    }
+    output = BEMRasterWriteUInt32(output, (adlerB << 16) | adlerA);
+    output = BEMRasterWriteUInt32(output, BEMRasterCRC(0, chunk + 4, 4 + zlibSize));
+
+    chunk = output;
+    output = BEMRasterWriteUInt32(output, 0);
+    memcpy(output, "IEND", 4);
+    output = BEMRasterWriteUInt32(output + 4, BEMRasterCRC(0, chunk + 4, 4));
+    return (size_t)(output - buffer);
+}
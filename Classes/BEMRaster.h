@@ -0,0 +1,97 @@
+//
+//  BEMRaster.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMRaster_h
+#define BEMRaster_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "BEMGraphLayout.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// A color with components between 0 and 1, not premultiplied
+typedef struct BEMRasterColor {
+    float red;
+    float green;
+    float blue;
+    float alpha;
+} BEMRasterColor;
+
+/** Anti-aliased CPU rasterizer drawing into RGBA pixels owned by the caller.
+ @discussion The canvas is plain C and has no dependency on CoreGraphics, so graphs can be rendered by any process, for example to generate thumbnails on a server. Pixels are stored row by row, 4 bytes per pixel in RGBA order, not premultiplied, with the origin at the top left corner like UIKit.
+
+ The canvas owns the scratch memory used to rasterize, so a canvas reused for many images doesn't allocate once it reached its working size. A canvas must only be used by one thread at a time. */
+typedef struct BEMRasterCanvas {
+    /// The pixels drawn into, owned by the caller
+    uint8_t *pixels;
+    size_t width;
+    size_t height;
+    size_t bytesPerRow;
+
+    /// Scratch memory, private
+    float *coverage;
+    float *outline;
+    size_t outlineCapacity;
+    void *edges;
+    size_t edgeCapacity;
+    size_t *activeEdges;
+    float *crossings;
+    size_t crossingCapacity;
+} BEMRasterCanvas;
+
+typedef BEMRasterCanvas *BEMRasterCanvasRef;
+
+
+/// Creates a canvas drawing into \p pixels, which must hold \p height rows of \p bytesPerRow bytes (at least 4 bytes per pixel). Returns NULL if the memory could not be allocated.
+BEMRasterCanvasRef BEMRasterCanvasCreate(uint8_t *pixels, size_t width, size_t height, size_t bytesPerRow);
+
+/// Frees the canvas and its scratch memory, but not the pixels. Passing NULL does nothing.
+void BEMRasterCanvasFree(BEMRasterCanvasRef canvas);
+
+/// Makes the canvas draw into other pixels of the same size, keeping its scratch memory.
+void BEMRasterCanvasSetPixels(BEMRasterCanvasRef canvas, uint8_t *pixels, size_t bytesPerRow);
+
+/// Sets every pixel to \p color
+void BEMRasterClear(BEMRasterCanvasRef canvas, BEMRasterColor color);
+
+/// Fills the inside of every subpath of \p path with \p color, with the non-zero winding rule. Returns false if the memory could not be allocated.
+bool BEMRasterFillPath(BEMRasterCanvasRef canvas, const BEMPath *path, BEMRasterColor color);
+
+/// Strokes \p path with round joins and caps. Returns false if the memory could not be allocated.
+bool BEMRasterStrokePath(BEMRasterCanvasRef canvas, const BEMPath *path, float lineWidth, BEMRasterColor color);
+
+/// Fills the disc centered on (\p x, \p y)
+void BEMRasterFillCircle(BEMRasterCanvasRef canvas, float x, float y, float radius, BEMRasterColor color);
+
+
+//----- ENCODING -----//
+
+/// The size in bytes of the binary PPM image of a canvas of \p width by \p height pixels
+size_t BEMRasterPPMSize(size_t width, size_t height);
+
+/** Writes the canvas as a binary PPM (P6) image. The alpha channel is dropped, clear the canvas with an opaque color first.
+ @return The number of bytes written, or 0 if \p capacity is smaller than \p BEMRasterPPMSize. */
+size_t BEMRasterEncodePPM(const BEMRasterCanvas *canvas, uint8_t *buffer, size_t capacity);
+
+/// The size in bytes of the PNG image of a canvas of \p width by \p height pixels written by \p BEMRasterEncodePNG
+size_t BEMRasterPNGSize(size_t width, size_t height);
+
+/** Writes the canvas as an RGBA PNG image.
+ @discussion The image data is stored without compression, which makes encoding as fast as a copy and the size known in advance. Recompress the images with any PNG optimizer if they are kept.
+ @return The number of bytes written, or 0 if \p capacity is smaller than \p BEMRasterPNGSize or the canvas is empty. */
+size_t BEMRasterEncodePNG(const BEMRasterCanvas *canvas, uint8_t *buffer, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
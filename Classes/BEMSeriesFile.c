@@ -0,0 +1,216 @@
+//
+//  BEMSeriesFile.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMSeriesFile.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BEMSeriesFileMagic "BEMGRAPH"
+#define BEMSeriesFileByteOrder 0x01020304u
+
+/// The number of values converted and written at once
+#define BEMSeriesFileChunkSize 8192
+
+//----- READING -----//
+
+/// Checks the header against the size of the file
+static bool BEMSeriesFileHeaderIsValid(const BEMSeriesFileHeader *header, size_t fileSize) {
+    if (memcmp(header->magic, BEMSeriesFileMagic, sizeof(header->magic)) != 0) return false;
+    if (header->version != BEMSeriesFileVersion || header->byteOrder != BEMSeriesFileByteOrder) return false;
+    if (header->count > SIZE_MAX / sizeof(double)) return false;
+
+    uint64_t valuesSize = header->count * sizeof(double);
+    if (header->valuesOffset < sizeof(BEMSeriesFileHeader) || header->valuesOffset % sizeof(double) != 0) return false;
+    if (header->valuesOffset > fileSize || valuesSize > fileSize - header->valuesOffset) return false;
+
+    if (header->treeOffset == 0) return true;
+    if (header->count >= UINT32_MAX || header->treeOffset % sizeof(uint32_t) != 0) return false;
+    uint64_t treeSize = 2 * BEMRangeTreeNodeCount((size_t)header->count) * sizeof(uint32_t);
+    return header->treeOffset >= header->valuesOffset + valuesSize && header->treeOffset <= fileSize && treeSize <= fileSize - header->treeOffset;
+}
+
+BEMSeriesFileRef BEMSeriesFileOpen(const char *path) {
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) return NULL;
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        int error = errno;
+        close(descriptor);
+        errno = error;
+        return NULL;
+    }
+    if (status.st_size < (off_t)sizeof(BEMSeriesFileHeader) || (uint64_t)status.st_size > SIZE_MAX) {
+        close(descriptor);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    // The mapping keeps the file open, the descriptor isn't needed anymore
+    size_t size = (size_t)status.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    int error = errno;
+    close(descriptor);
+    if (mapping == MAP_FAILED) {
+        errno = error;
+        return NULL;
+    }
+
+    BEMSeriesFileHeader header;
+    memcpy(&header, mapping, sizeof(header));
+    BEMSeriesFileRef file = NULL;
+    if (!BEMSeriesFileHeaderIsValid(&header, size)) error = EINVAL;
+    else if ((file = calloc(1, sizeof(BEMSeriesFile))) == NULL) error = ENOMEM;
+    if (file == NULL) {
+        munmap(mapping, size);
+        errno = error;
+        return NULL;
+    }
+
+    file->mapping = mapping;
+    file->mappingSize = size;
+    file->count = (size_t)header.count;
+    file->values = (const double *)((const uint8_t *)mapping + header.valuesOffset);
+    file->minimumValue = header.minimumValue;
+    file->maximumValue = header.maximumValue;
+    if (header.treeOffset != 0) {
+        const uint32_t *minimumIndices = (const uint32_t *)((const uint8_t *)mapping + header.treeOffset);
+        const uint32_t *maximumIndices = minimumIndices + BEMRangeTreeNodeCount(file->count);
+        file->tree = BEMRangeTreeCreateWithNodes(file->values, file->count, BEMSeriesFileNullValue, minimumIndices, maximumIndices);
+        if (file->tree == NULL) {
+            BEMSeriesFileClose(file);
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+    return file;
+}
+
+void BEMSeriesFileClose(BEMSeriesFileRef file) {
+    if (file == NULL) return;
+    BEMRangeTreeFree(file->tree);
+    munmap(file->mapping, file->mappingSize);
+    free(file);
+}
+
+bool BEMSeriesFileVerify(const BEMSeriesFile *file) {
+    if (file->tree == NULL) return true;
+
+    size_t nodeCount = BEMRangeTreeNodeCount(file->count);
+    const BEMRangeTree *tree = file->tree;
+    for (size_t node = 1; node < nodeCount; node++) {
+        uint32_t minimum = tree->minimumIndices[node];
+        uint32_t maximum = tree->maximumIndices[node];
+        if ((minimum != UINT32_MAX && minimum >= file->count) || (maximum != UINT32_MAX && maximum >= file->count)) return false;
+    }
+    return true;
+}
+
+
+//----- WRITING -----//
+
+/// Writes the whole buffer, returns false with errno set otherwise
+static bool BEMSeriesFileWriteBytes(FILE *stream, const void *bytes, size_t size) {
+    if (size == 0 || fwrite(bytes, 1, size, stream) == size) return true;
+    if (errno == 0) errno = EIO;
+    return false;
+}
+
+/// The value stored for a value of the caller: \p BEMSeriesFileNullValue for the missing ones
+static inline double BEMSeriesFileStoredValue(double value, double nullValue) {
+    return (value == nullValue || isnan(value)) ? BEMSeriesFileNullValue : value;
+}
+
+/// Writes the values with the missing ones replaced, and finds their extremes
+static bool BEMSeriesFileWriteValues(FILE *stream, const double *values, size_t count, double nullValue, double *minimumValue, double *maximumValue) {
+    double chunk[BEMSeriesFileChunkSize];
+    double minimum = INFINITY;
+    double maximum = -INFINITY;
+    for (size_t start = 0; start < count; start += BEMSeriesFileChunkSize) {
+        size_t chunkCount = count - start < BEMSeriesFileChunkSize ? count - start : BEMSeriesFileChunkSize;
+        for (size_t i = 0; i < chunkCount; i++) {
+            double value = BEMSeriesFileStoredValue(values[start + i], nullValue);
+            chunk[i] = value;
+            if (value == BEMSeriesFileNullValue) continue;
+            if (value < minimum) minimum = value;
+            if (value > maximum) maximum = value;
+        }
+        if (!BEMSeriesFileWriteBytes(stream, chunk, sizeof(double) * chunkCount)) return false;
+    }
+    *minimumValue = minimum;
+    *maximumValue = maximum;
+    return true;
+}
+
+/// Writes the file once it is open, returns false with errno set otherwise
+static bool BEMSeriesFileWriteStream(FILE *stream, const double *values, size_t count, double nullValue, bool includesTree) {
+    // The tree is built from the values as they are stored, so its extremes are never at a value the file reads back as missing
+    BEMRangeTreeRef tree = NULL;
+    double *storedValues = NULL;
+    if (includesTree && count < UINT32_MAX) {
+        storedValues = malloc(sizeof(double) * (count > 0 ? count : 1));
+        if (storedValues) {
+            for (size_t i = 0; i < count; i++) storedValues[i] = BEMSeriesFileStoredValue(values[i], nullValue);
+            tree = BEMRangeTreeCreate(storedValues, count, BEMSeriesFileNullValue);
+        }
+        if (tree == NULL) {
+            free(storedValues);
+            errno = ENOMEM;
+            return false;
+        }
+        values = storedValues;
+        nullValue = BEMSeriesFileNullValue;
+    }
+
+    BEMSeriesFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BEMSeriesFileMagic, sizeof(header.magic));
+    header.version = BEMSeriesFileVersion;
+    header.byteOrder = BEMSeriesFileByteOrder;
+    header.count = count;
+    header.valuesOffset = sizeof(BEMSeriesFileHeader);
+    header.treeOffset = tree ? header.valuesOffset + sizeof(double) * (uint64_t)count : 0;
+
+    // The extremes are only known after the values, the header is written again at the end
+    bool didWrite = BEMSeriesFileWriteBytes(stream, &header, sizeof(header));
+    didWrite = didWrite && BEMSeriesFileWriteValues(stream, values, count, nullValue, &header.minimumValue, &header.maximumValue);
+    if (tree) {
+        size_t nodeCount = BEMRangeTreeNodeCount(count);
+        didWrite = didWrite && BEMSeriesFileWriteBytes(stream, tree->minimumIndices, sizeof(uint32_t) * nodeCount);
+        didWrite = didWrite && BEMSeriesFileWriteBytes(stream, tree->maximumIndices, sizeof(uint32_t) * nodeCount);
+        BEMRangeTreeFree(tree);
+    }
+    free(storedValues);
+    if (didWrite && fseek(stream, 0, SEEK_SET) != 0) didWrite = false;
+    return didWrite && BEMSeriesFileWriteBytes(stream, &header, sizeof(header));
+}
+
+bool BEMSeriesFileWrite(const char *path, const double *values, size_t count, double nullValue, bool includesTree) {
+    FILE *stream = fopen(path, "wb");
+    if (stream == NULL) return false;
+
+    errno = 0;
+    bool didWrite = BEMSeriesFileWriteStream(stream, values, count, nullValue, includesTree);
+    int error = errno;
+    if (fclose(stream) != 0 && didWrite) {
+        didWrite = false;
+        error = errno;
+    }
+    if (!didWrite) {
+        remove(path);
+        errno = error;
+    }
+    return didWrite;
+}
@@ -0,0 +1,97 @@
+//
+//  BEMSeriesFile.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMSeriesFile_h
+#define BEMSeriesFile_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <float.h>
+
+#include "BEMRangeTree.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The value missing points are stored as, the value of BEMNullGraphValue
+#define BEMSeriesFileNullValue DBL_MAX
+
+/// The version of the format written by \p BEMSeriesFileWrite
+#define BEMSeriesFileVersion 1
+
+/** The header at the start of a series file, followed by the values and the nodes of their min/max tree.
+ @discussion A series file holds one series in the byte order of the machine which wrote it, little endian on every Apple and Android device:
+ - the header, 64 bytes;
+ - the values, \p count doubles at \p valuesOffset, a multiple of 8. Missing values are stored as \p BEMSeriesFileNullValue;
+ - when \p treeOffset isn't 0, the nodes of the min/max tree of the values at \p treeOffset, a multiple of 4: the \p BEMRangeTreeNodeCount(count) minimum indices then as many maximum indices, as 32 bits integers. They are the decimation levels of the series: the lowest and highest value of every block of 16, 32, 64... values.
+
+ Files are read by mapping them, the values and the nodes are used where they are in the file. */
+typedef struct BEMSeriesFileHeader {
+    /// "BEMGRAPH"
+    char magic[8];
+    uint32_t version;
+    /// 0x01020304 written in the byte order of the file, files in another byte order than the machine's are rejected
+    uint32_t byteOrder;
+    uint64_t count;
+    /// The smallest and biggest non-missing values. The minimum is bigger than the maximum when every value is missing.
+    double minimumValue;
+    double maximumValue;
+    uint64_t valuesOffset;
+    uint64_t treeOffset;
+    uint64_t reserved;
+} BEMSeriesFileHeader;
+
+
+//----- READING -----//
+
+/** A series file mapped in memory. Only \p count, \p values, \p minimumValue, \p maximumValue and \p tree should be read, the other fields are private.
+ @discussion Opening a file only maps it and checks its header, whatever its size: the pages of the values are read from disk when they are first accessed, and can be dropped by the system under memory pressure since they are backed by the file. The file must not be truncated or modified while it is open, accessing pages past its new end crashes the process. */
+typedef struct BEMSeriesFile {
+    size_t count;
+    /// The values, in the mapped file
+    const double *values;
+    /// The extremes of the values, read from the header. The minimum is bigger than the maximum when every value is missing.
+    double minimumValue;
+    double maximumValue;
+    /// The min/max tree of the values, borrowing the nodes mapped from the file. NULL when the file has no tree.
+    BEMRangeTreeRef tree;
+
+    void *mapping;
+    size_t mappingSize;
+} BEMSeriesFile;
+
+typedef BEMSeriesFile *BEMSeriesFileRef;
+
+
+/** Maps the series file at \p path.
+ @discussion Only the header is read, and checked against the size of the file. The tree is trusted, call \p BEMSeriesFileVerify for files which may not have been written by \p BEMSeriesFileWrite.
+ @return NULL with errno set if the file could not be opened or mapped, or to EINVAL if it isn't a series file of a supported version and byte order. */
+BEMSeriesFileRef BEMSeriesFileOpen(const char *path);
+
+/// Unmaps the file. The values and the tree must not be used anymore. Passing NULL does nothing.
+void BEMSeriesFileClose(BEMSeriesFileRef file);
+
+/** Checks every node of the tree of the file in O(n / 8), which reads about an eighth of the size of the values.
+ @return false if an index of the tree is past the last value. */
+bool BEMSeriesFileVerify(const BEMSeriesFile *file);
+
+
+//----- WRITING -----//
+
+/** Writes \p count values to a new series file at \p path, replacing any file there.
+ @discussion Values equal to \p nullValue, or NaN, are written as \p BEMSeriesFileNullValue. The extremes are computed while writing.
+ @param includesTree true to store the min/max tree of the values, which takes an eighth of their size. Graphs opening the file can then zoom without building it. The tree is built from the values as they are stored, which are copied once for it. Series of 2^32 values or more have no tree.
+ @return false with errno set if the file could not be written, in which case it is removed. */
+bool BEMSeriesFileWrite(const char *path, const double *values, size_t count, double nullValue, bool includesTree);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,9 +12,12 @@
 @import CoreGraphics;
 
 #import "BEMCircle.h"
+#import "BEMDotsLayer.h"
 #import "BEMLine.h"
 #import "BEMPermanentPopupView.h"
 #import "BEMAverageLine.h"
+#import "BEMViewReusePool.h"
+#import "BEMGraphMetrics.h"
 
 @protocol BEMSimpleLineGraphDelegate;
 @protocol BEMSimpleLineGraphDataSource;
@@ -23,6 +26,22 @@
 
 extern const CGFloat BEMNullGraphValue;
 
+/// The stages of the graph's layout, which can be invalidated separately with \p setNeedsUpdateOfStages:
+typedef NS_OPTIONS(NSUInteger, BEMGraphStage) {
+    BEMGraphStageNone = 0,
+    /// The values and X-Axis labels asked to the data source. Updating the data updates every other stage.
+    BEMGraphStageData = 1 << 0,
+    /// The minimum and maximum values and the width of the Y-Axis labels. The geometry and axes are only updated when they change.
+    BEMGraphStageScale = 1 << 1,
+    /// The labels and backgrounds of the X-Axis and Y-Axis
+    BEMGraphStageAxes = 1 << 2,
+    /// The colors, alphas and widths of the line and the dots
+    BEMGraphStageStyle = 1 << 3,
+    /// The positions of the points, the line and the dots. Updated along the axes when the size of the graph changes.
+    BEMGraphStageGeometry = 1 << 4,
+    BEMGraphStageAll = BEMGraphStageData | BEMGraphStageScale | BEMGraphStageAxes | BEMGraphStageStyle | BEMGraphStageGeometry
+};
+
 // Tell the compiler to assume that no method should have a NULL value
 NS_ASSUME_NONNULL_BEGIN
 
@@ -66,6 +85,70 @@ IB_DESIGNABLE @interface BEMSimpleLineGraphView : UIView <UIGestureRecognizerDel
 - (void)reloadGraph;
 
 
+/** Reloads the graph without blocking the main thread while the values are fetched and prepared.
+ @discussion The number of points, the number of series and the values are asked to the data source on a background queue: the data source methods providing them must then be safe to call from any thread, and the buffers returned by \p valuesForLineGraph: and \p lineGraph:valuesForSeries: are copied before the method returns. The extremes, statistics, min/max trees, points, decimation and line paths are computed on the same queue into a snapshot, which is applied on the main thread in one pass, along with the labels, dots and delegate calls. The points and paths are only prepared ahead when the scale of the graph can be known before it's laid out, they are mapped on the main thread otherwise.
+ 
+ A reload started while another one is being prepared supersedes it: the previous snapshot is dropped without being applied. \p reloadGraph supersedes every pending reload too.
+ @param completion Called on the main thread with YES once the graph displays the new values, or with NO if the reload was superseded. May be nil. */
+- (void)reloadGraphAsynchronouslyWithCompletion:(nullable void (^)(BOOL applied))completion;
+
+
+/// Same as \p reloadGraphAsynchronouslyWithCompletion: without a completion
+- (void)reloadGraphAsynchronously;
+
+
+/** Draws the series stored in a file written by \p BEMSeriesFileWrite, without copying it.
+ @discussion The file is mapped and its values are used where they are: opening it only reads its header, whatever the number of points, and the system reads the pages of the values from disk as they are drawn. The extremes are read from the header, and the min/max tree stored in the file, if any, is used for zooming instead of being built. From then on the data source isn't asked for values anymore, only for labels, until \p unloadSeriesFile is called. \p reloadGraph draws the file again, and \p appendPoints: copies its values into a streaming window and unloads it.
+ 
+ The file must not be modified while it is loaded.
+ @param path The path of the file.
+ @param error Set to an error of the NSPOSIXErrorDomain domain if the file could not be mapped, with the code EINVAL if it isn't a series file this version can read. May be NULL.
+ @return NO if the file could not be loaded, the graph is left unchanged then. */
+- (BOOL)loadSeriesFileAtPath:(NSString *)path error:(NSError **)error;
+
+
+/// Unmaps the file loaded by \p loadSeriesFileAtPath:error: and draws the values of the data source again
+- (void)unloadSeriesFile;
+
+
+/** Marks stages of the graph as stale, only these stages are updated in the next layout pass instead of rebuilding the whole graph.
+ @discussion Use this instead of \p reloadGraph when the data didn't change. The drawing properties of the graph mark their own stages: changing \p colorLine marks the style, \p labelFont the scale, geometry and axes, and \p enableBezierCurve the geometry. Call it for the changes the graph can't see, like the answers of delegate methods (\p BEMGraphStageAxes after changing the number of Y-Axis labels, for example). Stages which depend on a stale stage are updated along. Layout passes that find no stale stage, like the ones triggered while scrolling a table view, don't redraw anything.
+ @param stages The stale stages. */
+- (void)setNeedsUpdateOfStages:(BEMGraphStage)stages;
+
+
+/// The stages updated during the last layout pass, for debugging. BEMGraphStageNone if the last layout pass didn't have to update anything.
+@property (nonatomic, readonly) BEMGraphStage stagesUpdatedInLastLayout;
+
+
+/// The number of stages updated during the last layout pass, for debugging.
+@property (nonatomic, readonly) NSUInteger numberOfStagesUpdatedInLastLayout;
+
+
+/** The axis labels, permanent popups and dots removed from the graph, reconfigured the next time the graph draws them instead of allocating new views.
+ @discussion \p reloadGraph and every stage drawing these views put the previous ones in the pool, so a graph reloaded with the same shape doesn't allocate views anymore. Views previously returned by \p graphLabelsForXAxis may be reused for other labels. */
+@property (strong, nonatomic, readonly) BEMViewReusePool *viewReusePool;
+
+
+/** Appends points at the end of the graph, for live time-series.
+ @discussion The first call moves the values of the last load into a window owned by the graph: from then on the data source isn't asked for values anymore, until \p reloadGraph is called. The values and the extremes of the window are updated right away, in constant time, and the points are drawn in the next layout pass, once for all the points appended and removed until then. As long as the extremes don't change the scale, the points already in the graph keep their positions and are drawn without animation: when as many points were appended as removed, the line only adds the segments to the new points and moves to the left, unless it is curved, decimated or crosses missing points. X-Axis labels are still asked to the data source, with indexes relative to the first point in the graph. Use \p BEMDotRenderingLayer to keep updates cheap with many points.
+ @param points The values of the new points, \p BEMNullGraphValue for missing points. */
+- (void)appendPoints:(NSArray<NSNumber *> *)points;
+
+
+/** Removes the oldest points of the graph, for live time-series. Usually called along \p appendPoints: to slide a window of fixed size.
+ @discussion Like \p appendPoints:, this moves the graph into streaming mode. The remaining points slide to the left and keep their vertical position unless the scale changes. Call it in the same pass as \p appendPoints: so the window slides without changing the spacing of the points.
+ @param count The number of points to remove from the start of the graph. Removing more points than the graph has empties it. */
+- (void)removePointsFromStart:(NSInteger)count;
+
+
+/** Finds the point whose horizontal position is the closest to a position on the graph.
+ @discussion The positions of the points are indexed once per layout, so the lookup is a binary search which can be called for every touch event, whatever the number of points. Null points are never returned.
+ @param x The horizontal position, in the coordinate system of the graph.
+ @return The index of the closest point, or NSNotFound if the graph has no points. */
+- (NSInteger)indexOfPointClosestToX:(CGFloat)x;
+
+
 /** Calculates the distance between the touch input and the closest point on the graph.
  @return The distance between the touch input and the closest point on the graph. */
 - (CGFloat)distanceToClosestPoint __deprecated;
@@ -127,6 +210,17 @@ IB_DESIGNABLE @interface BEMSimpleLineGraphView : UIView <UIGestureRecognizerDel
 - (nullable NSArray *)graphValuesForDataPoints;
 
 
+/// The number of series drawn on the graph, as returned by \p numberOfSeriesInLineGraph: during the last load. 1 while streaming.
+@property (nonatomic, readonly) NSInteger numberOfSeries;
+
+
+/** The value of a point of any series, as read during the last load.
+ @param index The index of the point.
+ @param series The index of the series.
+ @return The value, \p BEMNullGraphValue for a missing point, or NAN if the index or the series is out of range. */
+- (CGFloat)valueForPointAtIndex:(NSInteger)index inSeries:(NSInteger)series;
+
+
 /** All the labels of the X-Axis.
  @return An array of UILabels, one for each displayed X-Axis label. The array is sorted from the left side of the graph to the right side. */
 - (nullable NSArray *)graphLabelsForXAxis;
@@ -168,6 +262,11 @@ IB_DESIGNABLE @interface BEMSimpleLineGraphView : UIView <UIGestureRecognizerDel
 @property (nonatomic) IBInspectable BOOL enableBezierCurve;
 
 
+/** The curve joining the points when \p enableBezierCurve is YES. Default value is BEMCurveInterpolationQuadratic.
+ @discussion The quadratic curve is made of two curves per segment, flat at every point. The monotone cubic and Catmull-Rom curves have a single curve per segment, which halves the size of the paths, and never go above or below the points they join: the line stays within the range of the values. The monotone cubic curve also keeps flat runs flat and the extrema of the line on the points. */
+@property (nonatomic) BEMCurveInterpolation curveInterpolation;
+
+
 /** Show Y-Axis label on the side. Default value is NO.
  @todo Could enhance further by specifying the position of Y-Axis, i.e. Left or Right of the view.  Also auto detection on label overlapping. */
 @property (nonatomic) IBInspectable BOOL enableYAxisLabel;
@@ -182,6 +281,11 @@ IB_DESIGNABLE @interface BEMSimpleLineGraphView : UIView <UIGestureRecognizerDel
 @property (nonatomic) BOOL autoScaleYAxis;
 
 
+/** When set to YES, the labels of an auto-scaled Y-Axis are placed on round values, 1, 2 or 5 times a power of 10, rather than on the smallest value, the biggest value and evenly between them. Default value is NO.
+ @discussion About \p numberOfYAxisLabelsOnLineGraph: labels are drawn, within the range of the values. The step between labels is never smaller than the decimals shown by \p formatStringForValues, so no two labels read the same. Ignored when the delegate provides \p baseValueForYAxisOnLineGraph: and \p incrementValueForYAxisOnLineGraph:. */
+@property (nonatomic) BOOL enableNiceYAxisValues;
+
+
 /// The horizontal line across the graph at the average value.
 @property (strong, nonatomic) BEMAverageLine *averageLine;
 
@@ -350,14 +454,58 @@ IB_DESIGNABLE @interface BEMSimpleLineGraphView : UIView <UIGestureRecognizerDel
 @property (nonatomic, strong) NSString *formatStringForValues;
 
 
-/** If a null value is present, interpolation would draw a best fit line through the null point bound by its surrounding points.  Default: YES*/
+/** If a null value is present, interpolation would draw a best fit line through the null point bound by its surrounding points. When set to NO, the line and its fills stop around null values and leave a gap.  Default: YES*/
 @property (nonatomic) BOOL interpolateNullValues;
 
 
+/** The way null values are filled when \p interpolateNullValues is YES. Default value is BEMNullValueFillLinear.
+ @discussion BEMNullValueFillLinear joins the points on both sides of null values. BEMNullValueFillPrevious keeps the value before null values until the next point, which suits sensors that only report changes. BEMNullValueFillGap leaves a gap, like setting \p interpolateNullValues to NO. */
+@property (nonatomic) BEMNullValueFill nullValueFill;
+
+
 /// When set to YES, dots will be displayed at full opacity and no line will be drawn through the dots. Default value is NO.
 @property (nonatomic) BOOL displayDotsOnly;
 
 
+/** The way the dots are rendered. Default value is BEMDotRenderingViews.
+ @discussion With BEMDotRenderingViews every dot is a BEMCircle view added to the graph. With BEMDotRenderingLayer every dot is drawn in a single BEMDotsLayer, which is much lighter for graphs with many points. In both modes, touch and popup reports use the index of the closest point, whatever the number of points. */
+@property (nonatomic) BEMDotRendering dotRendering;
+
+
+/** The reduction applied to the points before drawing the line and the dots. Default value is BEMLineDecimationNone.
+ @discussion When the graph has more points than twice its drawable width, the points are reduced to about twice the drawable width before the line is built, and dots are only created for the points that are kept. Touch reports and popups still use the index of the point in the data source. */
+@property (nonatomic) BEMLineDecimation lineDecimation;
+
+
+/** The range of points displayed across the width of the graph. Default value is every point.
+ @discussion Only the visible points are drawn, and the Y-Axis scales to them. The range is clamped to the points of the graph and shows at least 2 points, setting a range of length 0 shows every point again. Changing it only updates the scale, the axes and the line in the next layout pass. When the range has more points than twice the drawable width, the line is built from a min/max tree over the values, whatever \p lineDecimation, so each update costs about the drawable width, whatever the number of points. Touch reports and popups still use the index of the point in the data source. */
+@property (nonatomic) NSRange visibleIndexRange;
+
+
+/** If set to YES, pinching zooms and panning scrolls \p visibleIndexRange. Default value is NO.
+ @discussion Panning takes 2 fingers while the touch report or the popup report is enabled, so it doesn't conflict with the touch input line. */
+@property (nonatomic) BOOL enableZooming;
+
+
+/** If set to YES, every reload records how long each of its stages took, along with the number of points, labels, views and allocations. Default value is NO.
+ @discussion The metrics of a reload are complete once the Core Animation commit displaying it ends, they are then stored in \p lastMetrics and in a history of the last \p metricsHistoryLength reloads, and sent to \p lineGraph:didRecordMetrics:. Each reload is also marked with signposts, displayed by Instruments on iOS 12 and later. The allocations are read from the statistics of the whole process heap, so they include the allocations made by every other thread during the reload, the reload queue of \p reloadGraphAsynchronously included. */
+@property (nonatomic) BOOL enablePerformanceMetrics;
+
+
+/// The number of reloads aggregated by \p metricsSummaryForStage:. Default value is 100. Changing it empties the history.
+@property (nonatomic) NSUInteger metricsHistoryLength;
+
+
+/// The metrics of the last reload recorded while \p enablePerformanceMetrics was YES
+@property (nonatomic, readonly) BEMGraphMetrics lastMetrics;
+
+
+/** The typical and worst durations of a stage over the last reloads recorded while \p enablePerformanceMetrics was YES.
+ @param stage The stage, or BEMGraphMetricsStageTotal for whole reloads.
+ @return The mean, median, 99th percentile and maximum durations in seconds. Every field is 0 when no reload was recorded. */
+- (BEMGraphMetricsSummary)metricsSummaryForStage:(BEMGraphMetricsStage)stage;
+
+
 @end
 
 
@@ -395,6 +543,39 @@ IB_DESIGNABLE @interface BEMSimpleLineGraphView : UIView <UIGestureRecognizerDel
 @optional
 
 
+//------- DATA POINTS -------//
+
+/** A contiguous buffer holding the value of every point on the graph. Implement this method instead of relying on \p lineGraph:valueForPointAtIndex: when the graph displays a large number of points.
+ @discussion When this method returns a buffer, the graph reads all of its values from it in a single pass and \p lineGraph:valueForPointAtIndex: is not called. The buffer is borrowed, not copied: it must hold at least as many values as returned by \p numberOfPointsInLineGraph:, and it must stay valid and unchanged until the graph is reloaded or deallocated. Use \p BEMNullGraphValue for missing values.
+ @param graph The graph object requesting the values.
+ @return A pointer to the first value of the graph, or NULL to fall back on \p lineGraph:valueForPointAtIndex:. */
+- (nullable const double *)valuesForLineGraph:(BEMSimpleLineGraphView *)graph;
+
+
+//------- SERIES -------//
+
+/** The number of lines drawn on the graph. Defaults to 1 when not implemented.
+ @discussion Every series has \p numberOfPointsInLineGraph: points and is drawn with the same scale, axes and touch report: series 0 is the one described by \p lineGraph:valueForPointAtIndex: and \p valuesForLineGraph:, and gets the dots, fills, popups and average line. The other series are drawn as lines on top of it, with the color returned by \p lineGraph:colorForLineOfSeries:. Adding a series costs one more line, the axes and the touch lookup are shared.
+ @param graph The graph object requesting the number of series.
+ @return The number of series, at least 1. */
+- (NSInteger)numberOfSeriesInLineGraph:(BEMSimpleLineGraphView *)graph;
+
+
+/** The value of a point of a series. Called for series 0 too, instead of \p lineGraph:valueForPointAtIndex:, when implemented.
+ @param graph The graph object requesting the point value.
+ @param index The index from left to right of a given point (X-axis). The first value for the index is 0.
+ @param series The index of the series, from 0 to \p numberOfSeriesInLineGraph: - 1.
+ @return The Y-axis value at a given index, or \p BEMNullGraphValue for a missing point. */
+- (CGFloat)lineGraph:(BEMSimpleLineGraphView *)graph valueForPointAtIndex:(NSInteger)index inSeries:(NSInteger)series;
+
+
+/** A contiguous buffer holding the value of every point of a series, with the same rules as \p valuesForLineGraph:.
+ @param graph The graph object requesting the values.
+ @param series The index of the series.
+ @return A pointer to the first value of the series, or NULL to fall back on \p lineGraph:valueForPointAtIndex:inSeries:. */
+- (nullable const double *)lineGraph:(BEMSimpleLineGraphView *)graph valuesForSeries:(NSInteger)series;
+
+
 //------- X AXIS -------//
 
 /** The string to display on the label on the X-axis at a given index.
@@ -404,6 +585,13 @@ IB_DESIGNABLE @interface BEMSimpleLineGraphView : UIView <UIGestureRecognizerDel
 - (nullable NSString *)lineGraph:(nonnull BEMSimpleLineGraphView *)graph labelOnXAxisForIndex:(NSInteger)index;
 
 
+/** A contiguous buffer holding the time of every point on the graph, in seconds since 1970 like \p NSDate.timeIntervalSince1970. Implement this method to place the points at the position of their time instead of evenly spacing them by index.
+ @discussion The times must be in increasing order. The buffer is borrowed with the same rules as \p valuesForLineGraph:: it must hold at least as many times as returned by \p numberOfPointsInLineGraph:, and stay valid and unchanged until the graph is reloaded or deallocated. The X-Axis is then labeled by the graph itself, with ticks every few seconds, minutes, hours, days, weeks, months or years depending on the visible times, on round times of the default time zone and formatted for the current locale. \p lineGraph:labelOnXAxisForIndex: and the delegate methods spacing the X-Axis labels are not called. Streamed graphs and series files always space their points evenly.
+ @param graph The graph object requesting the times.
+ @return A pointer to the time of the first point, or NULL to space the points evenly. */
+- (nullable const double *)timestampsForLineGraph:(nonnull BEMSimpleLineGraphView *)graph;
+
+
 @end
 
 
@@ -510,6 +698,13 @@ IB_DESIGNABLE @interface BEMSimpleLineGraphView : UIView <UIGestureRecognizerDel
 - (void)lineGraph:(BEMSimpleLineGraphView *)graph modifyPopupView:(UIView *)popupView forIndex:(NSUInteger)index;
 
 
+/** The color of the line of a series drawn in addition to the first one.
+ @param graph The graph object requesting the color.
+ @param series The index of the series, from 1 to \p numberOfSeriesInLineGraph: - 1.
+ @return The color of the line. \p colorLine is used when this method isn't implemented. */
+- (UIColor *)lineGraph:(BEMSimpleLineGraphView *)graph colorForLineOfSeries:(NSInteger)series;
+
+
 //----- TOUCH EVENTS -----//
 
 
@@ -525,6 +720,19 @@ IB_DESIGNABLE @interface BEMSimpleLineGraphView : UIView <UIGestureRecognizerDel
 - (void)lineGraph:(BEMSimpleLineGraphView *)graph didReleaseTouchFromGraphWithClosestIndex:(CGFloat)index;
 
 
+/** Sent to the delegate when the user zooms or scrolls the graph. The property 'enableZooming' must be set to YES.
+ @param graph The graph object which was zoomed or scrolled by the user.
+ @param range The new \p visibleIndexRange of the graph. */
+- (void)lineGraph:(BEMSimpleLineGraphView *)graph didChangeVisibleIndexRange:(NSRange)range;
+
+
+/** Sent to the delegate once a reload is displayed, when \p enablePerformanceMetrics is YES.
+ @discussion Unlike \p lineGraphDidFinishDrawing:, this is sent as soon as the commit displaying the reload ends, whatever the entrance animation.
+ @param graph The graph object which was reloaded.
+ @param metrics The duration of every stage of the reload and what it drew. */
+- (void)lineGraph:(BEMSimpleLineGraphView *)graph didRecordMetrics:(BEMGraphMetrics)metrics;
+
+
 //----- X AXIS -----//
 
 
@@ -8,6 +8,24 @@
 //
 
 #import "BEMSimpleLineGraphView.h"
+#import "BEMStatistics.h"
+#import "BEMDecimation.h"
+#import "BEMPointLookup.h"
+#import "BEMValueWindow.h"
+#import "BEMGraphLayout.h"
+#import "BEMGraphTransform.h"
+#import "BEMRangeTree.h"
+#import "BEMLabelLayout.h"
+#import "BEMGraphSnapshot.h"
+#import "BEMSeriesFile.h"
+#import "BEMAxisTicks.h"
+#import "BEMTimeAxis.h"
+
+#include <malloc/malloc.h>
+#if __has_include(<os/signpost.h>)
+#include <os/signpost.h>
+#define BEM_HAS_SIGNPOSTS 1
+#endif
 
 const CGFloat BEMNullGraphValue = CGFLOAT_MAX;
 
@@ -20,6 +38,94 @@ const CGFloat BEMNullGraphValue = CGFLOAT_MAX;
 #define SYSTEM_VERSION_GREATER_THAN_OR_EQUAL_TO(v)  ([[[UIDevice currentDevice] systemVersion] compare:v options:NSNumericSearch] != NSOrderedAscending)
 #define DEFAULT_FONT_NAME @"HelveticaNeue-Light"
 
+/// The number of label texts whose size is remembered, shared by every graph
+#define BEMTextMetricsCacheSize 4096
+
+/// The order of the run loop observer ending the metrics of a reload, right after the one committing Core Animation transactions (2000000)
+#define BEMMetricsCommitObserverOrder 2000001
+
+
+/// A series drawn in addition to the first one, with the same scale and x positions
+typedef struct BEMAdditionalSeries {
+    /// The values of the series. Either borrowed from the data source or pointing to \p ownedValues
+    const double *values;
+    double *ownedValues;
+    NSInteger ownedValuesCapacity;
+    /// The coordinates of the drawn points of the series, decimated like the first series
+    BEMPointBufferRef points;
+    /// Min/max tree of \p values, built along the tree of the first series
+    BEMRangeTreeRef tree;
+} BEMAdditionalSeries;
+
+
+/// Widens \p minValue and \p maxValue to the non-null values of \p values
+static void BEMExtendExtremes(const double *values, NSInteger count, CGFloat *minValue, CGFloat *maxValue) {
+    CGFloat min = *minValue;
+    CGFloat max = *maxValue;
+    for (NSInteger i = 0; i < count; i++) {
+        CGFloat value = values[i];
+        if (value == BEMNullGraphValue) continue;
+        if (value < min) min = value;
+        if (value > max) max = value;
+    }
+    *minValue = min;
+    *maxValue = max;
+}
+
+/// Widens \p minValue and \p maxValue to the non-null values of \p values between \p start and \p start + \p count, in O(log n) with a tree
+static void BEMExtendExtremesInRange(const double *values, BEMRangeTreeRef tree, NSInteger start, NSInteger count, CGFloat *minValue, CGFloat *maxValue) {
+    if (tree == NULL) {
+        BEMExtendExtremes(values + start, count, minValue, maxValue);
+        return;
+    }
+    size_t minimumIndex, maximumIndex;
+    if (!BEMRangeTreeFindExtremes(tree, start, start + count, &minimumIndex, &maximumIndex)) return;
+    if (values[minimumIndex] < *minValue) *minValue = values[minimumIndex];
+    if (values[maximumIndex] > *maxValue) *maxValue = values[maximumIndex];
+}
+
+/// Measures a label text with the font passed as context, only called for the texts missing from the cache
+static bool BEMMeasureLabelText(void *context, const char *text, size_t length, float *width, float *height) {
+    NSString *string = [[NSString alloc] initWithBytes:text length:length encoding:NSUTF8StringEncoding];
+    if (string == nil) return false;
+    UIFont *font = (__bridge UIFont *)context;
+    CGRect rect = [string boundingRectWithSize:CGSizeMake(CGFLOAT_MAX, CGFLOAT_MAX) options:NSStringDrawingUsesLineFragmentOrigin attributes:@{NSFontAttributeName: font} context:nil];
+    *width = rect.size.width;
+    *height = rect.size.height;
+    return true;
+}
+
+/// The sizes of the label texts measured by every graph. Labels are laid out on the main thread only.
+static BEMTextMetricsCacheRef BEMSharedTextMetricsCache(void) {
+    static BEMTextMetricsCacheRef cache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = BEMTextMetricsCacheCreate(BEMTextMetricsCacheSize);
+    });
+    return cache;
+}
+
+static inline BEMLabelBox BEMLabelBoxFromRect(CGRect rect) {
+    BEMLabelBox box = {(float)rect.origin.x, (float)rect.origin.y, (float)rect.size.width, (float)rect.size.height};
+    return box;
+}
+
+static inline CGRect BEMRectFromLabelBox(BEMLabelBox box) {
+    return CGRectMake(box.x, box.y, box.width, box.height);
+}
+
+#if BEM_HAS_SIGNPOSTS
+/// The log of the signposts marking every reload in Instruments
+static os_log_t BEMMetricsLog(void) API_AVAILABLE(ios(12.0)) {
+    static os_log_t log;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        log = os_log_create("BEMSimpleLineGraph", "Reload");
+    });
+    return log;
+}
+#endif
+
 
 typedef NS_ENUM(NSInteger, BEMInternalTags)
 {
@@ -35,35 +141,194 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     /// The number of Points in the Graph
     NSInteger numberOfPoints;
     
-    /// The closest point to the touch point
-    BEMCircle *closestDot;
-    CGFloat currentlyCloser;
+    /// The index in the drawn points of the closest point to the touch point, or NSNotFound
+    NSInteger closestDrawnIndex;
+    
+    /// The dot of every drawn point when the dots are rendered with views, NSNull for null points
+    NSMutableArray *dotViews;
     
     /// All of the X-Axis Values
     NSMutableArray *xAxisValues;
     
-    /// All of the X-Axis Label Points
-    NSMutableArray *xAxisLabelPoints;
+    /// All of the X-Axis Label Points (x values of the buffer)
+    BEMPointBufferRef xAxisLabelPoints;
     
     /// All of the X-Axis Label Points
     CGFloat xAxisHorizontalFringeNegationValue;
     
-    /// All of the Y-Axis Label Points
-    NSMutableArray *yAxisLabelPoints;
+    /// All of the Y-Axis Label Points (y values of the buffer)
+    BEMPointBufferRef yAxisLabelPoints;
+    
+    /// The coordinates of every point in the line's coordinate system. Null points have a NaN y coordinate.
+    BEMPointBufferRef linePoints;
+    
+    /// The points kept by the decimation, drawn instead of \p linePoints. NULL when every point is drawn.
+    BEMPointBufferRef decimatedPoints;
+    
+    /// The index in \p linePoints of every point of \p decimatedPoints
+    size_t *decimatedIndices;
+    
+    /// YES when \p linePoints only holds the envelope of the visible points, read from \p valueTree. \p envelopeIndices then holds the index of every point in \p values.
+    BOOL linePointsAreEnvelope;
+    size_t *envelopeIndices;
+    
+    /// Min/max tree of \p values, built once per load when the graph can zoom. NULL otherwise.
+    BEMRangeTreeRef valueTree;
+    
+    /// YES when \p valueTree and the trees of the additional series belong to \p graphSnapshot or \p seriesFile
+    BOOL valueTreesAreBorrowed;
+    
+    /// The first point and the number of points of \p visibleIndexRange, resolved against the loaded points. \p linePoints start at \p visibleStart.
+    NSInteger visibleStart;
+    NSInteger visibleCount;
+    
+    /// The smallest and biggest non-null values of the visible points of every series
+    CGFloat visibleMinValue;
+    CGFloat visibleMaxValue;
+    
+    /// The visible range when the current zoom or pan gesture began
+    NSRange gestureStartRange;
     
-    /// All of the Y-Axis Values
-    NSMutableArray *yAxisValues;
+    /// The paths of the line, kept from one line to the next so redraws with the same points don't build them again
+    BEMLineGeometry *lineGeometry;
     
-    /// All of the Data Points
-    NSMutableArray *dataPoints;
+    /// The mapping from values to point positions, computed once per layout with the scale
+    BEMGraphTransform pointTransform;
+    
+    /// Sorted x coordinates of \p linePoints, built once per layout to find the closest point to a position
+    BEMPointLookupRef pointLookup;
+    
+    /// Sorted x coordinates of \p decimatedPoints. NULL when every point is drawn.
+    BEMPointLookupRef drawnPointLookup;
+    
+    /// Contiguous buffer of every value in the graph. Either borrowed from the data source or pointing to \p ownedValues
+    const double *values;
+    
+    /// Buffer owned by the graph and filled through \p lineGraph:valueForPointAtIndex: when the data source doesn't provide its own buffer
+    double *ownedValues;
+    NSInteger ownedValuesCapacity;
+    
+    /// The series drawn in addition to the one of \p values, \p numberOfSeries - 1 of them. Kept from one load to the next to reuse their buffers.
+    BEMAdditionalSeries *additionalSeries;
+    NSInteger additionalSeriesCapacity;
+    
+    /// The paths of the line of every additional series
+    NSMutableArray<BEMLineGeometry *> *additionalLineGeometries;
+    
+    /// The line of the first series and the lines of the additional series, kept from one draw to the next so their layers are updated in place
+    BEMLine *graphLine;
+    NSMutableArray<BEMLine *> *additionalLines;
+    
+    /// The smallest and biggest non-null values of \p values and of every additional series, computed while fetching the values
+    CGFloat dataMinValue;
+    CGFloat dataMaxValue;
+    
+    /// The snapshot of the last asynchronous reload, whose values and trees are borrowed by the graph. nil after a synchronous load.
+    BEMGraphSnapshot *graphSnapshot;
+    
+    /// The snapshot being applied, nil outside of \p applyGraphSnapshot:generation:completion:
+    BEMGraphSnapshot *appliedSnapshot;
+    
+    /// The metrics of the reload being recorded, and the time its reload and its current stage began
+    BEMGraphMetrics reloadMetrics;
+    CFTimeInterval reloadStartTime;
+    CFTimeInterval metricsStageStartTime;
+    
+    /// YES from the start of a recorded reload to the end of its last stage, only these stages are measured
+    BOOL metricsStagesAreOpen;
+    
+    /// The heap and the number of views created when the recorded reload began
+    malloc_statistics_t reloadStartHeap;
+    NSUInteger reloadStartCreationCount;
+    
+    /// The observer waiting for the end of the commit displaying the recorded reload, NULL when no reload is waiting
+    CFRunLoopObserverRef metricsCommitObserver;
+    
+    /// The metrics of the last \p metricsHistoryLength reloads
+    BEMGraphMetricsHistoryRef metricsHistory;
+    
+    /// Incremented by every reload. An asynchronous reload is dropped if another reload started after it. Written on the main thread, read on \p reloadQueue.
+    NSUInteger reloadGeneration;
+    
+    /// Serial queue fetching and preparing the values of asynchronous reloads, so the data source is never asked for values from two threads at once
+    dispatch_queue_t reloadQueue;
+    
+    /// The values appended through \p appendPoints:, owned by the graph. NULL unless the graph is streaming.
+    BEMValueWindowRef streamedValues;
+    
+    /// The number of points removed from the start since the points were last packed. Only used while updating streamed points.
+    NSInteger streamedRemovedCount;
+    
+    /// The file mapped by \p loadSeriesFileAtPath:error:, whose values and tree are used in place. NULL unless a file is loaded.
+    BEMSeriesFileRef seriesFile;
+    
+    /// The stages which must be updated in the next layout pass
+    BEMGraphStage dirtyStages;
+    
+    /// YES while the points are packed again after a streaming update which didn't change the scale, the y positions of the previous points can be reused
+    BOOL isUpdatingStreamedPoints;
+    
+    /// YES once points were appended or removed until they are drawn, at the next layout pass or before a point is looked up. \p pendingStreamedRemovedCount points were removed from the start meanwhile.
+    BOOL streamedPointsNeedUpdate;
+    NSInteger pendingStreamedRemovedCount;
+    
+    /// Whether every point was drawn before the first of the pending streaming changes, so the positions of the previous points can be reused
+    BOOL streamedPointsWereDrawn;
+    
+    /// Statistics of \p values, computed on demand and kept until the values change
+    BEMStatistics statistics;
+    BOOL statisticsAreValid;
     
     /// All of the X-Axis Labels
     NSMutableArray *xAxisLabels;
+    
+    /// The frame of every X-Axis label text in xAxisValues, including the labels which aren't displayed
+    BEMLabelBox *xAxisLabelBoxes;
+    size_t xAxisLabelBoxesCapacity;
+    
+    /// YES when the X-Axis only has its first and last labels, aligned to the sides of the graph
+    BOOL xAxisLabelsAreFringes;
+    
+    /// The values of the auto-scaled Y-Axis labels, computed by \p layoutYAxisValues
+    double *yAxisValues;
+    size_t yAxisValueCount;
+    size_t yAxisValuesCapacity;
+    
+    /// The text of every Y-Axis value formatted so far, with the format, prefix and suffix they were formatted with
+    NSMutableDictionary<NSNumber *, NSString *> *yAxisTextCache;
+    NSString *yAxisTextCacheFormat;
+    NSString *yAxisTextCachePrefix;
+    NSString *yAxisTextCacheSuffix;
+    
+    /// The smallest step between the nice values of the Y-Axis, the smallest difference \p formatStringForValues shows
+    double yAxisMinimumStep;
+    
+    /// The time of every point, borrowed from \p timestampsForLineGraph:. NULL when the points are evenly spaced by index.
+    const double *timestamps;
+    
+    /// The mapping from the time of a point to its x coordinate, computed with the scale when the points have \p timestamps
+    BEMTimeAxis timeAxis;
+    
+    /// The ticks of the timestamped X-Axis
+    double *timeTicks;
+    size_t timeTicksCapacity;
+    
+    /// The date formatter of every tick level unit, created the first time the unit labels the X-Axis
+    NSMutableDictionary<NSNumber *, NSDateFormatter *> *timeTickFormatters;
 }
 
+@property (strong, nonatomic, readwrite) BEMViewReusePool *viewReusePool;
+
+/// Gestures changing \p visibleIndexRange when zooming is enabled
+@property (strong, nonatomic) UIPinchGestureRecognizer *zoomPinchGesture;
+@property (strong, nonatomic) UIPanGestureRecognizer *zoomPanGesture;
+
 /// The vertical line which appears when the user drags across the graph
 @property (strong, nonatomic) UIView *touchInputLine;
 
+/// The layer drawing every dot when the dots are rendered with a layer
+@property (strong, nonatomic) BEMDotsLayer *dotsLayer;
+
 /// View for picking up pan gesture
 @property (strong, nonatomic, readwrite) UIView *panView;
 
@@ -100,8 +365,8 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
 /// The smallest value out of all of the data points
 @property (nonatomic) CGFloat minValue;
 
-/// Find which point is currently the closest to the vertical line
-- (BEMCircle *)closestDotFromtouchInputLine:(UIView *)touchInputLine;
+/// Find which drawn point is currently the closest to the vertical line
+- (NSInteger)closestDrawnIndexFromTouchInputLine:(UIView *)touchInputLine;
 
 /// Determines the biggest Y-axis value from all the points
 - (CGFloat)maxValue;
@@ -118,6 +383,9 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
 // Stores the background X Axis view
 @property (nonatomic) UIView *backgroundXAxis;
 
+// Stores the background Y Axis view
+@property (nonatomic) UIView *backgroundYAxis;
+
 @end
 
 @implementation BEMSimpleLineGraphView
@@ -177,29 +445,65 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     _touchReportFingersRequired = 1;
     _enablePopUpReport = NO;
     _enableBezierCurve = NO;
+    _curveInterpolation = BEMCurveInterpolationQuadratic;
     _enableXAxisLabel = YES;
     _enableYAxisLabel = NO;
     _YAxisLabelXOffset = 0;
     _autoScaleYAxis = YES;
+    _enableNiceYAxisValues = NO;
     _alwaysDisplayDots = NO;
     _alwaysDisplayPopUpLabels = NO;
     _enableLeftReferenceAxisFrameLine = YES;
     _enableBottomReferenceAxisFrameLine = YES;
     _formatStringForValues = @"%.0f";
     _interpolateNullValues = YES;
+    _nullValueFill = BEMNullValueFillLinear;
     _displayDotsOnly = NO;
+    _dotRendering = BEMDotRenderingViews;
+    closestDrawnIndex = NSNotFound;
+    dirtyStages = BEMGraphStageAll;
     
     // Initialize the various arrays
     xAxisValues = [NSMutableArray array];
     xAxisHorizontalFringeNegationValue = 0.0;
-    xAxisLabelPoints = [NSMutableArray array];
-    yAxisLabelPoints = [NSMutableArray array];
-    dataPoints = [NSMutableArray array];
+    xAxisLabelPoints = BEMPointBufferCreate(0);
+    yAxisLabelPoints = BEMPointBufferCreate(0);
     xAxisLabels = [NSMutableArray array];
-    yAxisValues = [NSMutableArray array];
+    _viewReusePool = [[BEMViewReusePool alloc] init];
+    dotViews = [NSMutableArray array];
 
     // Initialize BEM Objects
     _averageLine = [[BEMAverageLine alloc] init];
+    _numberOfSeries = 1;
+    _metricsHistoryLength = 100;
+}
+
+- (void)dealloc {
+    if (metricsCommitObserver) {
+        CFRunLoopObserverInvalidate(metricsCommitObserver);
+        CFRelease(metricsCommitObserver);
+    }
+    BEMGraphMetricsHistoryFree(metricsHistory);
+    free(ownedValues);
+    for (NSInteger i = 0; i < additionalSeriesCapacity; i++) {
+        free(additionalSeries[i].ownedValues);
+        BEMPointBufferRelease(additionalSeries[i].points);
+    }
+    free(additionalSeries);
+    free(decimatedIndices);
+    free(envelopeIndices);
+    free(xAxisLabelBoxes);
+    free(yAxisValues);
+    free(timeTicks);
+    [self freeValueTrees];
+    BEMValueWindowFree(streamedValues);
+    BEMSeriesFileClose(seriesFile);
+    BEMPointLookupFree(pointLookup);
+    BEMPointLookupFree(drawnPointLookup);
+    BEMPointBufferRelease(linePoints);
+    BEMPointBufferRelease(decimatedPoints);
+    BEMPointBufferRelease(xAxisLabelPoints);
+    BEMPointBufferRelease(yAxisLabelPoints);
 }
 
 - (void)prepareForInterfaceBuilder {
@@ -218,10 +522,13 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     if ([self.delegate respondsToSelector:@selector(lineGraphDidBeginLoading:)])
         [self.delegate lineGraphDidBeginLoading:self];
     
+    [self beginMetrics];
+    
     // Get the number of points in the graph
     [self layoutNumberOfPoints];
     
     if (numberOfPoints <= 1) {
+        [self endMetricsStages];
         return;
     } else {
         // Draw the graph
@@ -229,6 +536,8 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
         
         // Setup the touch report
         [self layoutTouchReport];
+        [self layoutZoomGestures];
+        [self endMetricsStages];
         
         // Let the delegate know that the graph finished updates
         if ([self.delegate respondsToSelector:@selector(lineGraphDidFinishLoading:)])
@@ -240,15 +549,106 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
 - (void)layoutSubviews {
     [super layoutSubviews];
     
-    if (CGSizeEqualToSize(self.currentViewSize, self.bounds.size))  return;
-    self.currentViewSize = self.bounds.size;
+    // A new size moves every point, the data and the scale are still valid
+    if (!CGSizeEqualToSize(self.currentViewSize, self.bounds.size)) {
+        self.currentViewSize = self.bounds.size;
+        dirtyStages |= BEMGraphStageGeometry;
+        
+        // Without auto scaling, the width of the Y-Axis labels depends on the height of the graph
+        if (!self.autoScaleYAxis) dirtyStages |= BEMGraphStageScale;
+    }
+    
+    [self updateStaleStages];
+    [self updateStreamedPointsIfNeeded];
+}
 
-    [self drawGraph];
+- (void)setNeedsUpdateOfStages:(BEMGraphStage)stages {
+    dirtyStages |= stages;
+    [self setNeedsLayout];
+}
+
+- (NSUInteger)numberOfStagesUpdatedInLastLayout {
+    return __builtin_popcountl(self.stagesUpdatedInLastLayout);
+}
+
+- (void)updateStaleStages {
+    BEMGraphStage stages = dirtyStages;
+    _stagesUpdatedInLastLayout = stages;
+    if (stages == BEMGraphStageNone) return;
+    
+    // Every stage depends on the values, which must be loaded at least once
+    if ((stages & BEMGraphStageData) || linePoints == NULL || values == NULL || numberOfPoints <= 1) {
+        _stagesUpdatedInLastLayout = BEMGraphStageAll;
+        [self redrawGraph];
+        return;
+    }
+    dirtyStages = BEMGraphStageNone;
+    
+    // The geometry and axes only depend on the scale if it actually changed
+    if (stages & BEMGraphStageScale) {
+        CGFloat previousMaxValue = self.maxValue;
+        CGFloat previousMinValue = self.minValue;
+        CGFloat previousYAxisLabelXOffset = self.YAxisLabelXOffset;
+        [self layoutVisibleRange];
+        [self layoutScale];
+        if (self.maxValue != previousMaxValue || self.minValue != previousMinValue || self.YAxisLabelXOffset != previousYAxisLabelXOffset) {
+            stages |= BEMGraphStageGeometry | BEMGraphStageAxes;
+        }
+    }
+    
+    // The X-Axis labels are placed under the points and the Y-Axis labels along the height
+    if (stages & BEMGraphStageGeometry) stages |= BEMGraphStageAxes;
+    _stagesUpdatedInLastLayout = stages;
+    
+    // Only the entrance of a new graph is animated
+    CGFloat animationGraphEntranceTime = self.animationGraphEntranceTime;
+    _animationGraphEntranceTime = 0;
+    
+    if (stages & BEMGraphStageAxes) [self drawXAxis];
+    
+    if (stages & BEMGraphStageGeometry) {
+        // The dots and the line are drawn with the current style
+        closestDrawnIndex = NSNotFound;
+        [self drawDots];
+        self.touchInputLine.frame = CGRectMake(self.touchInputLine.frame.origin.x, 0, self.widthTouchInputLine, self.frame.size.height);
+        self.panView.frame = CGRectMake(10, 10, self.viewForBaselineLayout.frame.size.width, self.viewForBaselineLayout.frame.size.height);
+    } else if (stages & BEMGraphStageStyle) [self updateStyle];
+    
+    if (stages & BEMGraphStageAxes) [self drawYAxis];
+    
+    _animationGraphEntranceTime = animationGraphEntranceTime;
+}
+
+/// Applies the current colors, alphas and widths to the line and the dots without moving them
+- (void)updateStyle {
+    [self drawLine];
+    
+    self.dotsLayer.dotColor = self.colorPoint;
+    for (BEMCircle *dot in dotViews) {
+        if (![dot isKindOfClass:[BEMCircle class]]) continue;
+        dot.Pointcolor = self.colorPoint;
+        [dot setNeedsDisplay];
+    }
 }
 
 - (void)layoutNumberOfPoints {
-    // Get the total number of data points from the delegate
-    if ([self.dataSource respondsToSelector:@selector(numberOfPointsInLineGraph:)]) {
+    // The values of the previous load may no longer be valid
+    values = NULL;
+    statisticsAreValid = NO;
+    closestDrawnIndex = NSNotFound;
+    
+    // Get the total number of data points from the delegate, streamed points are owned by the graph
+    if (appliedSnapshot) {
+        numberOfPoints = appliedSnapshot.numberOfPoints;
+        
+    } else if (streamedValues) {
+        numberOfPoints = streamedValues->count;
+        values = streamedValues->values;
+        
+    } else if (seriesFile) {
+        numberOfPoints = (NSInteger)seriesFile->count;
+        
+    } else if ([self.dataSource respondsToSelector:@selector(numberOfPointsInLineGraph:)]) {
         numberOfPoints = [self.dataSource numberOfPointsInLineGraph:self];
         
     } else if ([self.delegate respondsToSelector:@selector(numberOfPointsInGraph)]) {
@@ -319,6 +719,241 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     }
 }
 
+- (void)layoutValues {
+    // The trees borrow the previous values
+    [self freeValueTrees];
+    values = NULL;
+    statisticsAreValid = NO;
+    graphSnapshot = nil;
+    
+    // An asynchronous reload fetched the values and prepared what depends on them already
+    if (appliedSnapshot) {
+        [self layoutSnapshotValues];
+        return;
+    }
+    
+    // Streamed values are owned by the graph, the data source is not asked again
+    if (streamedValues) {
+        [self layoutStreamedValues];
+        return;
+    }
+    
+    // The values of a series file are read where they are mapped
+    if (seriesFile) {
+        [self layoutSeriesFileValues];
+        return;
+    }
+    
+#if !TARGET_INTERFACE_BUILDER
+    // Borrow the data source's buffer when it provides one, no copy is made
+    if ([self.dataSource respondsToSelector:@selector(valuesForLineGraph:)]) {
+        values = [self.dataSource valuesForLineGraph:self];
+    }
+    if (values == NULL && [self.dataSource respondsToSelector:@selector(lineGraph:valuesForSeries:)]) {
+        values = [self.dataSource lineGraph:self valuesForSeries:0];
+    }
+#endif
+    
+    if (values == NULL) {
+        if (ownedValuesCapacity < numberOfPoints) {
+            free(ownedValues);
+            ownedValues = malloc(sizeof(double) * numberOfPoints);
+            ownedValuesCapacity = ownedValues ? numberOfPoints : 0;
+            if (ownedValues == NULL) {
+                numberOfPoints = 0;
+                [self layoutVisibleRange];
+                return;
+            }
+        }
+        
+#if !TARGET_INTERFACE_BUILDER
+        if ([self.dataSource respondsToSelector:@selector(lineGraph:valueForPointAtIndex:inSeries:)]) {
+            for (NSInteger i = 0; i < numberOfPoints; i++) {
+                ownedValues[i] = [self.dataSource lineGraph:self valueForPointAtIndex:i inSeries:0];
+            }
+            
+        } else if ([self.dataSource respondsToSelector:@selector(lineGraph:valueForPointAtIndex:)]) {
+            for (NSInteger i = 0; i < numberOfPoints; i++) {
+                ownedValues[i] = [self.dataSource lineGraph:self valueForPointAtIndex:i];
+            }
+            
+        } else if ([self.delegate respondsToSelector:@selector(valueForIndex:)]) {
+            [self printDeprecationWarningForOldMethod:@"valueForIndex:" andReplacementMethod:@"lineGraph:valueForPointAtIndex:"];
+            
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+            for (NSInteger i = 0; i < numberOfPoints; i++) {
+                ownedValues[i] = [self.delegate valueForIndex:i];
+            }
+#pragma clang diagnostic pop
+            
+        } else if ([self.delegate respondsToSelector:@selector(lineGraph:valueForPointAtIndex:)]) {
+            [self printDeprecationAndUnavailableWarningForOldMethod:@"lineGraph:valueForPointAtIndex:"];
+            NSException *exception = [NSException exceptionWithName:@"Implementing Unavailable Delegate Method" reason:@"lineGraph:valueForPointAtIndex: is no longer available on the delegate. It must be implemented on the data source." userInfo:nil];
+            [exception raise];
+            
+        } else [NSException raise:@"lineGraph:valueForPointAtIndex: protocol method is not implemented in the data source. Throwing exception here before the system throws a CALayerInvalidGeometry Exception." format:@"Value for point %f at index %lu is invalid. CALayer position may contain NaN: [0 nan]", 0.0, (unsigned long)0];
+#else
+        for (NSInteger i = 0; i < numberOfPoints; i++) {
+            ownedValues[i] = (int)(arc4random() % 10000);
+        }
+#endif
+        values = ownedValues;
+    }
+    
+    [self layoutAdditionalSeries];
+    [self finishMetricsStage:BEMGraphMetricsStageDataFetch];
+    
+    // Single pass over every buffer for the extremes, null values are skipped. The series share the scale.
+    dataMinValue = INFINITY;
+    dataMaxValue = -FLT_MAX;
+    BEMExtendExtremes(values, numberOfPoints, &dataMinValue, &dataMaxValue);
+    for (NSInteger s = 0; s < _numberOfSeries - 1; s++) {
+        BEMExtendExtremes(additionalSeries[s].values, numberOfPoints, &dataMinValue, &dataMaxValue);
+    }
+    
+    [self layoutVisibleRange];
+}
+
+/// Borrows the time of every point from the data source, the points are evenly spaced by index without them
+- (void)layoutTimestamps {
+    timestamps = NULL;
+#if !TARGET_INTERFACE_BUILDER
+    // Streamed values and series files are not read from the data source
+    if (streamedValues || seriesFile || numberOfPoints <= 0) return;
+    if (![self.dataSource respondsToSelector:@selector(timestampsForLineGraph:)]) return;
+    
+    const double *times = [self.dataSource timestampsForLineGraph:self];
+    if (times == NULL) return;
+    if (!BEMTimeAxisTimesAreSorted(times, numberOfPoints)) {
+        NSLog(@"[BEMSimpleLineGraph] The timestamps are not in increasing order, the points are evenly spaced instead");
+        return;
+    }
+    timestamps = times;
+#endif
+}
+
+/// Fetches the values of every series after the first one, in a single pass each. Their extremes are computed along the first series.
+- (void)layoutAdditionalSeries {
+    _numberOfSeries = 1;
+#if !TARGET_INTERFACE_BUILDER
+    if ([self.dataSource respondsToSelector:@selector(numberOfSeriesInLineGraph:)]) {
+        _numberOfSeries = MAX(1, [self.dataSource numberOfSeriesInLineGraph:self]);
+    }
+#endif
+    
+    NSInteger count = _numberOfSeries - 1;
+    if (![self reserveAdditionalSeries:count]) {
+        _numberOfSeries = 1;
+        return;
+    }
+    
+#if !TARGET_INTERFACE_BUILDER
+    for (NSInteger s = 0; s < count; s++) {
+        BEMAdditionalSeries *series = &additionalSeries[s];
+        series->values = NULL;
+        if ([self.dataSource respondsToSelector:@selector(lineGraph:valuesForSeries:)]) {
+            series->values = [self.dataSource lineGraph:self valuesForSeries:s + 1];
+        }
+        
+        if (series->values == NULL) {
+            if (![self.dataSource respondsToSelector:@selector(lineGraph:valueForPointAtIndex:inSeries:)]) {
+                [NSException raise:@"lineGraph:valueForPointAtIndex:inSeries: protocol method is not implemented in the data source." format:@"The data source returned %ld series from numberOfSeriesInLineGraph: but provides no values for series %ld.", (long)_numberOfSeries, (long)(s + 1)];
+            }
+            
+            if (series->ownedValuesCapacity < numberOfPoints) {
+                free(series->ownedValues);
+                series->ownedValues = malloc(sizeof(double) * numberOfPoints);
+                series->ownedValuesCapacity = series->ownedValues ? numberOfPoints : 0;
+                if (series->ownedValues == NULL) {
+                    // The series which could be fetched are still drawn
+                    _numberOfSeries = s + 1;
+                    return;
+                }
+            }
+            for (NSInteger i = 0; i < numberOfPoints; i++) {
+                series->ownedValues[i] = [self.dataSource lineGraph:self valueForPointAtIndex:i inSeries:s + 1];
+            }
+            series->values = series->ownedValues;
+        }
+    }
+#else
+    _numberOfSeries = 1;
+#endif
+}
+
+/// Grows \p additionalSeries so it can hold \p count series. Returns NO if the memory could not be allocated.
+- (BOOL)reserveAdditionalSeries:(NSInteger)count {
+    if (count <= additionalSeriesCapacity) return YES;
+    
+    BEMAdditionalSeries *series = realloc(additionalSeries, sizeof(BEMAdditionalSeries) * count);
+    if (series == NULL) return NO;
+    memset(series + additionalSeriesCapacity, 0, sizeof(BEMAdditionalSeries) * (count - additionalSeriesCapacity));
+    additionalSeries = series;
+    additionalSeriesCapacity = count;
+    return YES;
+}
+
+/// Borrows the values, extremes, statistics and trees of the snapshot being applied instead of fetching the values
+- (void)layoutSnapshotValues {
+    BEMGraphSnapshot *snapshot = appliedSnapshot;
+    graphSnapshot = snapshot;
+    values = [snapshot valuesOfSeries:0];
+    
+    _numberOfSeries = snapshot.numberOfSeries;
+    if (![self reserveAdditionalSeries:_numberOfSeries - 1]) _numberOfSeries = 1;
+    for (NSInteger s = 0; s < _numberOfSeries - 1; s++) {
+        additionalSeries[s].values = [snapshot valuesOfSeries:s + 1];
+    }
+    
+    // The trees are only borrowed if every one of them could be built, the graph builds its own otherwise
+    BOOL hasEveryTree = YES;
+    for (NSInteger s = 0; s < _numberOfSeries; s++) {
+        if ([snapshot treeOfSeries:s] == NULL) hasEveryTree = NO;
+    }
+    if (hasEveryTree) {
+        valueTree = [snapshot treeOfSeries:0];
+        for (NSInteger s = 0; s < _numberOfSeries - 1; s++) additionalSeries[s].tree = [snapshot treeOfSeries:s + 1];
+        valueTreesAreBorrowed = YES;
+    }
+    
+    // The values were fetched and their extremes computed on the reload queue
+    [self finishMetricsStage:BEMGraphMetricsStageDataFetch];
+    if (metricsStagesAreOpen) {
+        reloadMetrics.isAsynchronous = YES;
+        reloadMetrics.durations[BEMGraphMetricsStageDataFetch] += snapshot.fetchDuration;
+        reloadMetrics.durations[BEMGraphMetricsStageMinMax] += snapshot.preparationDuration;
+    }
+    
+    dataMinValue = snapshot.minimumValue;
+    dataMaxValue = snapshot.maximumValue;
+    statistics = snapshot.statistics;
+    statisticsAreValid = YES;
+    
+    [self layoutVisibleRange];
+}
+
+/// Uses the values, extremes and tree of the series file in place instead of fetching the values
+- (void)layoutSeriesFileValues {
+    values = seriesFile->values;
+    _numberOfSeries = 1;
+    if (seriesFile->tree) {
+        valueTree = seriesFile->tree;
+        valueTreesAreBorrowed = YES;
+    }
+    [self finishMetricsStage:BEMGraphMetricsStageDataFetch];
+    
+    // The extremes were computed when the file was written
+    if (seriesFile->minimumValue <= seriesFile->maximumValue) {
+        dataMinValue = seriesFile->minimumValue;
+        dataMaxValue = seriesFile->maximumValue;
+    } else {
+        dataMinValue = INFINITY;
+        dataMaxValue = -FLT_MAX;
+    }
+    [self layoutVisibleRange];
+}
+
 - (void)layoutTouchReport {
     // If the touch report is enabled, set it up
     if (self.enableTouchReport == YES || self.enablePopUpReport == YES) {
@@ -415,165 +1050,405 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     // The following method calls are in this specific order for a reason
     // Changing the order of the method calls below can result in drawing glitches and even crashes
     
+    // Fetch every value once, the rest of the drawing pipeline reads from the values buffer
+    [self layoutValues];
+    [self layoutTimestamps];
+    
+    // Compute the scale and the room taken by the Y-Axis
+    [self layoutScale];
+    [self finishMetricsStage:BEMGraphMetricsStageMinMax];
+    
+    // Draw the X-Axis
+    [self drawXAxis];
+    [self finishMetricsStage:BEMGraphMetricsStageXAxis];
+    
+    // Draw the graph
+    [self drawDots];
+    
+    // Draw the Y-Axis
+    if (self.enableYAxisLabel) [self drawYAxis];
+    [self finishMetricsStage:BEMGraphMetricsStageYAxis];
+}
+
+- (void)layoutScale {
     self.maxValue = [self getMaximumValue];
     self.minValue = [self getMinimumValue];
     
     // Set the Y-Axis Offset if the Y-Axis is enabled. The offset is relative to the size of the longest label on the Y-Axis.
     if (self.enableYAxisLabel) {
-        NSDictionary *attributes = @{NSFontAttributeName: self.labelFont};
         if (self.autoScaleYAxis == YES){
-            NSString *maxValueString = [NSString stringWithFormat:self.formatStringForValues, self.maxValue];
-            NSString *minValueString = [NSString stringWithFormat:self.formatStringForValues, self.minValue];
-            
-            NSString *longestString = @"";
-            if (maxValueString.length > minValueString.length) longestString = maxValueString;
-            else longestString = minValueString;
-            
-            NSString *prefix = @"";
-            NSString *suffix = @"";
-            
-            if ([self.delegate respondsToSelector:@selector(yAxisPrefixOnLineGraph:)]) {
-                prefix = [self.delegate yAxisPrefixOnLineGraph:self];
-            }
-            
-            if ([self.delegate respondsToSelector:@selector(yAxisSuffixOnLineGraph:)]) {
-                suffix = [self.delegate yAxisSuffixOnLineGraph:self];
+            // The labels are measured as they will be drawn. Their texts and sizes are cached, so an unchanged axis isn't formatted nor measured again.
+            CGFloat widestLabel = 0;
+            if ([self layoutYAxisValues]) {
+                for (size_t i = 0; i < yAxisValueCount; i++) widestLabel = MAX(widestLabel, [self sizeOfLabelText:[self yAxisTextForValue:yAxisValues[i]]].width);
             }
-            
-            NSString *mString = [longestString stringByReplacingOccurrencesOfString:@"[0-9-]" withString:@"N" options:NSRegularExpressionSearch range:NSMakeRange(0, [longestString length])];
-            NSString *fullString = [NSString stringWithFormat:@"%@%@%@", prefix, mString, suffix];
-            self.YAxisLabelXOffset = [fullString sizeWithAttributes:attributes].width + 2;//MAX([maxValueString sizeWithAttributes:attributes].width + 10,
-                                     //    [minValueString sizeWithAttributes:attributes].width) + 5;
+            // The labels are 5 points narrower than the axis
+            self.YAxisLabelXOffset = ceil(widestLabel) + 7;
         } else {
             NSString *longestString = [NSString stringWithFormat:@"%i", (int)self.frame.size.height];
-            self.YAxisLabelXOffset = [longestString sizeWithAttributes:attributes].width + 5;
+            self.YAxisLabelXOffset = [self sizeOfLabelText:longestString].width + 5;
         }
     } else self.YAxisLabelXOffset = 0;
-
-    // Draw the X-Axis
-    [self drawXAxis];
-
-    // Draw the graph
-    [self drawDots];
-
-    // Draw the Y-Axis
-    if (self.enableYAxisLabel) [self drawYAxis];
+    
+    // The first and last visible times are placed at the edges of the graph
+    if (timestamps && visibleCount > 0) {
+        timeAxis = BEMTimeAxisMake(timestamps[visibleStart], timestamps[visibleStart + visibleCount - 1], self.frame.size.width - self.YAxisLabelXOffset);
+    }
 }
 
 - (void)drawDots {
-    CGFloat positionOnXAxis; // The position on the X-axis of the point currently being created.
-    CGFloat positionOnYAxis; // The position on the Y-axis of the point currently being created.
+    // Without memory for the points, the graph keeps its dots, the previous points, and the lookups and line built from them
+    BEMPointBufferRef mappedPoints = BEMPointBufferCreate(visibleCount);
+    if (mappedPoints == NULL) return;
     
-    // Remove all dots that were previously on the graph
+    // Remove all dots that were previously on the graph, they are reused below
     for (UIView *subview in [self subviews]) {
-        if ([subview isKindOfClass:[BEMCircle class]] || [subview isKindOfClass:[BEMPermanentPopupView class]] || [subview isKindOfClass:[BEMPermanentPopupLabel class]])
-            [subview removeFromSuperview];
+        NSInteger kind = [self reusableKindOfView:subview];
+        if (kind == BEMReusableViewKindDot || kind == BEMReusableViewKindPopUpView || kind == BEMReusableViewKindPopUpLabel)
+            [self.viewReusePool enqueueView:subview ofKind:kind];
+    }
+    [dotViews removeAllObjects];
+    [self.dotsLayer removeFromSuperlayer];
+    self.dotsLayer = nil;
+    
+    // The previous line may still retain the previous buffer, the points are packed in a new one
+    BEMPointBufferRef previousLinePoints = linePoints;
+    linePoints = NULL;
+    
+    // The scale is computed once, then every visible value is mapped to its position in the line's coordinate system in one pass
+    BEMGraphScale scale = [self graphScale];
+    pointTransform = BEMGraphTransformMake(&scale, self.frame.size.width - self.YAxisLabelXOffset, visibleCount);
+    
+    // With more visible points than the width can display, the envelope is read from the tree instead of mapping every visible value, whatever the decimation
+    size_t envelopeThreshold = valueTree ? [self pointBudget] : 0;
+    linePointsAreEnvelope = NO;
+    if (envelopeThreshold > 0) {
+        size_t *indices = realloc(envelopeIndices, sizeof(size_t) * envelopeThreshold);
+        if (indices) {
+            envelopeIndices = indices;
+            linePoints = [self envelopePointsOfValues:values tree:valueTree threshold:envelopeThreshold indices:envelopeIndices];
+            linePointsAreEnvelope = linePoints != NULL;
+        }
+    }
+    
+    // An asynchronous reload may have mapped and decimated the points already
+    BOOL pointsAreAdopted = !linePointsAreEnvelope && [self adoptSnapshotPoints];
+    if (!linePointsAreEnvelope && !pointsAreAdopted) {
+        linePoints = mappedPoints;
+        mappedPoints = NULL;
+        
+        // After a streaming update the scale didn't change, the points which were already in the graph keep their y position
+        NSInteger reusedCount = 0;
+        if (isUpdatingStreamedPoints && previousLinePoints) {
+            reusedCount = MAX(0, MIN((NSInteger)previousLinePoints->count - streamedRemovedCount, visibleCount));
+        }
+        for (NSInteger i = 0; i < reusedCount; i++) {
+            BEMPointBufferAppendPoint(linePoints, pointTransform.xStep * i, previousLinePoints->y[i + streamedRemovedCount]);
+        }
+        BEMGraphTransformPoints(&pointTransform, values + visibleStart + reusedCount, visibleCount - reusedCount, BEMNullGraphValue, reusedCount, linePoints->x + reusedCount, linePoints->y + reusedCount);
+        linePoints->count = visibleCount;
+        
+        // Timestamped points keep the spacing of their times
+        if (timestamps) BEMTimeAxisPlacePoints(&timeAxis, timestamps + visibleStart, linePoints->count, linePoints->x);
+    }
+    BEMPointBufferRelease(previousLinePoints);
+    BEMPointBufferRelease(mappedPoints);
+    
+    // Every point was placed, the streaming changes with them
+    streamedPointsNeedUpdate = NO;
+    pendingStreamedRemovedCount = 0;
+    
+    // Reduce the points to what the width of the graph can display
+    if (!pointsAreAdopted) [self decimateLinePoints];
+    
+    // Index the x coordinates once, touches then find the closest point with a binary search
+    BEMPointLookupFree(pointLookup);
+    BEMPointLookupFree(drawnPointLookup);
+    pointLookup = BEMPointLookupCreate(linePoints);
+    drawnPointLookup = decimatedPoints ? BEMPointLookupCreate(decimatedPoints) : NULL;
+    
+    [self drawAdditionalSeriesPoints];
+    
+    if (self.dotRendering == BEMDotRenderingLayer) [self drawDotsInLayer];
+    else [self drawDotViews];
+    
+    // Permanent popups are displayed above the dots
+    if (self.alwaysDisplayPopUpLabels == YES) {
+        BEMPointBufferRef drawnPoints = [self drawnPoints];
+        NSInteger *drawnIndices = malloc(sizeof(NSInteger) * (drawnPoints->count > 0 ? drawnPoints->count : 1));
+        NSInteger popUpCount = 0;
+        for (NSInteger n = 0; drawnIndices != NULL && n < (NSInteger)drawnPoints->count; n++) {
+            if (BEMPointBufferIsNull(drawnPoints->y[n])) continue;
+            
+            if ([self.delegate respondsToSelector:@selector(lineGraph:alwaysDisplayPopUpAtIndex:)]) {
+                if ([self.delegate lineGraph:self alwaysDisplayPopUpAtIndex:[self indexOfDrawnPoint:n]] == YES) {
+                    drawnIndices[popUpCount++] = n;
+                }
+            } else drawnIndices[popUpCount++] = n;
+        }
+        [self displayPermanentLabelsForDrawnPoints:drawnIndices count:popUpCount];
+        free(drawnIndices);
     }
     
-    // Remove all data points before adding them to the array
-    [dataPoints removeAllObjects];
+    [self finishMetricsStage:BEMGraphMetricsStageDots];
     
-    // Remove all yAxis values before adding them to the array
-    [yAxisValues removeAllObjects];
+    // CREATION OF THE LINE AND BOTTOM AND TOP FILL
+    [self drawLine];
+    [self finishMetricsStage:BEMGraphMetricsStageLine];
+}
+
+- (void)drawDotViews {
+    BEMPointBufferRef drawnPoints = [self drawnPoints];
+    NSInteger numberOfDrawnPoints = drawnPoints->count;
     
-    // Loop through each point and add it to the graph
+    // Loop through each drawn point and add its dot to the graph
     @autoreleasepool {
-        for (int i = 0; i < numberOfPoints; i++) {
-            CGFloat dotValue = 0;
-            
-#if !TARGET_INTERFACE_BUILDER
-            if ([self.dataSource respondsToSelector:@selector(lineGraph:valueForPointAtIndex:)]) {
-                dotValue = [self.dataSource lineGraph:self valueForPointAtIndex:i];
-                
-            } else if ([self.delegate respondsToSelector:@selector(valueForIndex:)]) {
-                [self printDeprecationWarningForOldMethod:@"valueForIndex:" andReplacementMethod:@"lineGraph:valueForPointAtIndex:"];
-                
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-                dotValue = [self.delegate valueForIndex:i];
-#pragma clang diagnostic pop
-                
-            } else if ([self.delegate respondsToSelector:@selector(lineGraph:valueForPointAtIndex:)]) {
-                [self printDeprecationAndUnavailableWarningForOldMethod:@"lineGraph:valueForPointAtIndex:"];
-                NSException *exception = [NSException exceptionWithName:@"Implementing Unavailable Delegate Method" reason:@"lineGraph:valueForPointAtIndex: is no longer available on the delegate. It must be implemented on the data source." userInfo:nil];
-                [exception raise];
-                
-                
-            } else [NSException raise:@"lineGraph:valueForPointAtIndex: protocol method is not implemented in the data source. Throwing exception here before the system throws a CALayerInvalidGeometry Exception." format:@"Value for point %f at index %lu is invalid. CALayer position may contain NaN: [0 nan]", dotValue, (unsigned long)i];
-#else
-            dotValue = (int)(arc4random() % 10000);
-#endif
-            [dataPoints addObject:@(dotValue)];
+        for (NSInteger n = 0; n < numberOfDrawnPoints; n++) {
+            NSInteger i = [self indexOfDrawnPoint:n];
+            CGFloat dotValue = values[i];
             
-            if (self.positionYAxisRight) {
-                positionOnXAxis = (((self.frame.size.width - self.YAxisLabelXOffset) / (numberOfPoints - 1)) * i);
-            } else {
-                positionOnXAxis = (((self.frame.size.width - self.YAxisLabelXOffset) / (numberOfPoints - 1)) * i) + self.YAxisLabelXOffset;
+            // If we're dealing with an null value, don't draw the dot
+            if (dotValue == BEMNullGraphValue) {
+                [dotViews addObject:[NSNull null]];
+                continue;
             }
             
-            positionOnYAxis = [self yPositionForDotValue:dotValue];
+            BEMCircle *circleDot = [self.viewReusePool dequeueViewOfKind:BEMReusableViewKindDot class:[BEMCircle class]];
+            circleDot.frame = CGRectMake(0, 0, self.sizePoint, self.sizePoint);
+            circleDot.center = [self centerOfDrawnPoint:n];
+            // Dots are found through their index, the tag is only set while it doesn't collide with the other internal tags
+            circleDot.tag = i + DotFirstTag100 < DotLastTag1000 ? i + DotFirstTag100 : 0;
+            circleDot.alpha = 0;
+            circleDot.absoluteValue = dotValue;
+            circleDot.Pointcolor = self.colorPoint;
             
-            [yAxisValues addObject:@(positionOnYAxis)];
+            [self addSubview:circleDot];
+            [dotViews addObject:circleDot];
             
-            
-            // If we're dealing with an null value, don't draw the dot
-            
-            if (dotValue != BEMNullGraphValue) {
-                BEMCircle *circleDot = [[BEMCircle alloc] initWithFrame:CGRectMake(0, 0, self.sizePoint, self.sizePoint)];
-                circleDot.center = CGPointMake(positionOnXAxis, positionOnYAxis);
-                circleDot.tag = i+ DotFirstTag100;
-                circleDot.alpha = 0;
-                circleDot.absoluteValue = dotValue;
-                circleDot.Pointcolor = self.colorPoint;
-                
-                [self addSubview:circleDot];
-                if (self.alwaysDisplayPopUpLabels == YES) {
-                    if ([self.delegate respondsToSelector:@selector(lineGraph:alwaysDisplayPopUpAtIndex:)]) {
-                        if ([self.delegate lineGraph:self alwaysDisplayPopUpAtIndex:i] == YES) {
-                            [self displayPermanentLabelForPoint:circleDot];
-                        }
-                    } else [self displayPermanentLabelForPoint:circleDot];
+            // Dot entrance animation
+            if (self.animationGraphEntranceTime == 0) {
+                if (self.displayDotsOnly == YES) circleDot.alpha = 1.0;
+                else {
+                    if (self.alwaysDisplayDots == NO) circleDot.alpha = 0;
+                    else circleDot.alpha = 1.0;
                 }
-                
-                // Dot entrance animation
-                if (self.animationGraphEntranceTime == 0) {
-                    if (self.displayDotsOnly == YES) circleDot.alpha = 1.0;
-                    else {
-                        if (self.alwaysDisplayDots == NO) circleDot.alpha = 0;
-                        else circleDot.alpha = 1.0;
-                    }
-                } else {
-                    if (self.displayDotsWhileAnimating) {
-                        [UIView animateWithDuration:(float)self.animationGraphEntranceTime/numberOfPoints delay:(float)i*((float)self.animationGraphEntranceTime/numberOfPoints) options:UIViewAnimationOptionCurveLinear animations:^{
-                            circleDot.alpha = 1.0;
-                        } completion:^(BOOL finished) {
-                            if (self.alwaysDisplayDots == NO && self.displayDotsOnly == NO) {
-                                [UIView animateWithDuration:0.3 delay:0 options:UIViewAnimationOptionCurveEaseOut animations:^{
-                                    circleDot.alpha = 0;
-                                } completion:nil];
-                            }
-                        }];
-                    }
+            } else {
+                if (self.displayDotsWhileAnimating) {
+                    [UIView animateWithDuration:(float)self.animationGraphEntranceTime/numberOfDrawnPoints delay:(float)n*((float)self.animationGraphEntranceTime/numberOfDrawnPoints) options:UIViewAnimationOptionCurveLinear animations:^{
+                        circleDot.alpha = 1.0;
+                    } completion:^(BOOL finished) {
+                        // A dot whose animation was stopped may already be reused by the next draw
+                        if (finished && self.alwaysDisplayDots == NO && self.displayDotsOnly == NO) {
+                            [UIView animateWithDuration:0.3 delay:0 options:UIViewAnimationOptionCurveEaseOut animations:^{
+                                circleDot.alpha = 0;
+                            } completion:nil];
+                        }
+                    }];
                 }
             }
         }
     }
+}
+
+- (void)drawDotsInLayer {
+    BEMDotsLayer *dotsLayer = [BEMDotsLayer layer];
+    dotsLayer.frame = self.bounds;
+    dotsLayer.pointOffset = CGPointMake(self.positionYAxisRight ? 0 : self.YAxisLabelXOffset, 0);
+    dotsLayer.dotSize = self.sizePoint;
+    dotsLayer.dotColor = self.colorPoint;
+    dotsLayer.pointBuffer = [self drawnPoints];
+    [self.layer addSublayer:dotsLayer];
+    self.dotsLayer = dotsLayer;
+    
+    BOOL dotsAreDisplayed = self.alwaysDisplayDots == YES || self.displayDotsOnly == YES;
+    [dotsLayer setAlphaForAllDots:dotsAreDisplayed ? 1.0 : 0];
+    
+    // Dot entrance animation. The whole layer fades in during the entrance animation, instead of one dot after the other.
+    if (self.animationGraphEntranceTime == 0 || !self.displayDotsWhileAnimating) return;
+    
+    [dotsLayer setAlphaForAllDots:1.0];
+    CABasicAnimation *fadeIn = [CABasicAnimation animationWithKeyPath:@"opacity"];
+    fadeIn.fromValue = @0;
+    fadeIn.toValue = @1;
+    fadeIn.duration = self.animationGraphEntranceTime;
+    
+    __weak BEMDotsLayer *weakDotsLayer = dotsLayer;
+    [CATransaction begin];
+    [CATransaction setCompletionBlock:^{
+        if (dotsAreDisplayed) return;
+        CABasicAnimation *fadeOut = [CABasicAnimation animationWithKeyPath:@"opacity"];
+        fadeOut.fromValue = @1;
+        fadeOut.toValue = @0;
+        fadeOut.duration = 0.3;
+        fadeOut.timingFunction = [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionEaseOut];
+        [weakDotsLayer addAnimation:fadeOut forKey:@"fadeOut"];
+        [weakDotsLayer setAlphaForAllDots:0];
+    }];
+    [dotsLayer addAnimation:fadeIn forKey:@"fadeIn"];
+    [CATransaction commit];
+}
+
+/// Adopts the points and the decimation the snapshot being applied prepared on the reload queue. Returns NO if they were prepared for another transform or decimation, the points are then mapped again.
+- (BOOL)adoptSnapshotPoints {
+    BEMGraphSnapshot *snapshot = appliedSnapshot;
+    if (snapshot.linePoints == NULL || isUpdatingStreamedPoints || visibleStart != 0 || visibleCount != snapshot.numberOfPoints) return NO;
+    
+    // The snapshot's points are evenly spaced by index
+    if (timestamps) return NO;
+    
+    BEMGraphTransform transform = snapshot.transform;
+    if (!BEMGraphTransformEqualToTransform(&transform, &pointTransform) || snapshot.decimationThreshold != [self decimationThreshold]) return NO;
+    if (snapshot.decimatedPoints && snapshot.lineDecimation != self.lineDecimation) return NO;
+    
+    // The previous line may still retain the previous buffer
+    BEMPointBufferRelease(decimatedPoints);
+    decimatedPoints = NULL;
+    if (snapshot.decimatedPoints) {
+        size_t *indices = realloc(decimatedIndices, sizeof(size_t) * snapshot.decimationThreshold);
+        if (indices == NULL) return NO;
+        decimatedIndices = indices;
+        memcpy(decimatedIndices, snapshot.decimatedIndices, sizeof(size_t) * snapshot.decimatedPoints->count);
+        decimatedPoints = BEMPointBufferRetain(snapshot.decimatedPoints);
+    }
+    linePoints = BEMPointBufferRetain(snapshot.linePoints);
+    return YES;
+}
+
+- (BEMPointBufferRef)drawnPoints {
+    return decimatedPoints ? decimatedPoints : linePoints;
+}
+
+- (NSInteger)indexOfDrawnPoint:(NSInteger)drawnIndex {
+    return [self indexOfLinePoint:decimatedPoints ? (NSInteger)decimatedIndices[drawnIndex] : drawnIndex];
+}
+
+/// The index in \p values of a point of \p linePoints
+- (NSInteger)indexOfLinePoint:(NSInteger)linePointIndex {
+    return linePointsAreEnvelope ? (NSInteger)envelopeIndices[linePointIndex] : visibleStart + linePointIndex;
+}
+
+- (CGPoint)centerOfDrawnPoint:(NSInteger)drawnIndex {
+    BEMPointBufferRef drawnPoints = [self drawnPoints];
+    return CGPointMake(drawnPoints->x[drawnIndex] + (self.positionYAxisRight ? 0 : self.YAxisLabelXOffset), drawnPoints->y[drawnIndex]);
+}
+
+- (void)setDotAtDrawnIndex:(NSInteger)drawnIndex highlighted:(BOOL)highlighted {
+    if (drawnIndex == NSNotFound) return;
     
-    // CREATION OF THE LINE AND BOTTOM AND TOP FILL
-    [self drawLine];
+    // Dots which are always displayed stay displayed
+    if (highlighted == NO && (self.alwaysDisplayDots == YES || self.displayDotsOnly == YES)) return;
+    
+    if (self.dotRendering == BEMDotRenderingLayer) {
+        self.dotsLayer.highlightedIndex = highlighted ? drawnIndex : NSNotFound;
+    } else if (drawnIndex < (NSInteger)dotViews.count) {
+        BEMCircle *dot = dotViews[drawnIndex];
+        if ([dot isKindOfClass:[BEMCircle class]]) dot.alpha = highlighted ? 0.8 : 0;
+    }
 }
 
-- (void)drawLine {
-    for (UIView *subview in [self subviews]) {
-        if ([subview isKindOfClass:[BEMLine class]])
-            [subview removeFromSuperview];
+/// The number of points the width of the graph can display, twice its width, or 0 when every visible point fits
+- (size_t)pointBudget {
+    size_t threshold = (size_t)(2 * [self drawableGraphArea].size.width);
+    if ((NSInteger)threshold >= visibleCount || threshold < 3) return 0;
+    return threshold;
+}
+
+- (size_t)decimationThreshold {
+    return self.lineDecimation == BEMLineDecimationNone ? 0 : [self pointBudget];
+}
+
+/// Returns a new buffer with the points of \p points kept by the decimation, or NULL if it could not be allocated. \p indices must hold \p threshold indices.
+- (BEMPointBufferRef)decimatePoints:(BEMPointBufferRef)points threshold:(size_t)threshold indices:(size_t *)indices {
+    BEMPointBufferRef keptPoints = BEMPointBufferCreate(threshold);
+    if (keptPoints == NULL) return NULL;
+    
+    size_t keptCount;
+    if (self.lineDecimation == BEMLineDecimationMinMax) keptCount = BEMDecimateMinMax(points, threshold, keptPoints, indices);
+    else keptCount = BEMDecimateLargestTriangleThreeBuckets(points, threshold, keptPoints, indices);
+    
+    if (keptCount == 0) {
+        BEMPointBufferRelease(keptPoints);
+        return NULL;
+    }
+    return keptPoints;
+}
+
+- (void)decimateLinePoints {
+    // The previous line may still retain the previous buffer, the kept points are packed in a new one
+    BEMPointBufferRelease(decimatedPoints);
+    decimatedPoints = NULL;
+    
+    size_t threshold = [self decimationThreshold];
+    if (threshold == 0 || linePoints->count <= threshold) return;
+    
+    size_t *indices = realloc(decimatedIndices, sizeof(size_t) * threshold);
+    if (indices == NULL) return;
+    decimatedIndices = indices;
+    
+    decimatedPoints = [self decimatePoints:linePoints threshold:threshold indices:decimatedIndices];
+}
+
+/// Returns a new buffer with the envelope of the visible points of \p seriesValues read from \p tree, or NULL if it could not be allocated. \p indices receives the index of every point and must hold \p threshold indices.
+- (BEMPointBufferRef)envelopePointsOfValues:(const double *)seriesValues tree:(BEMRangeTreeRef)tree threshold:(size_t)threshold indices:(size_t *)indices {
+    size_t count = BEMRangeTreeEnvelope(tree, visibleStart, visibleStart + visibleCount, threshold / 2, indices);
+    BEMPointBufferRef points = BEMPointBufferCreate(count);
+    if (points == NULL) return NULL;
+    
+    for (size_t i = 0; i < count; i++) {
+        double value = seriesValues[indices[i]];
+        float y = (value == BEMNullGraphValue || isnan(value)) ? BEMPointBufferNullValue : BEMGraphTransformY(&pointTransform, value);
+        float x = timestamps ? BEMTimeAxisX(&timeAxis, timestamps[indices[i]]) : pointTransform.xStep * (indices[i] - visibleStart);
+        BEMPointBufferAppendPoint(points, x, y);
     }
+    return points;
+}
+
+/// Maps every additional series with the transform of the first one, so the K series cost K passes over their values and share everything else
+- (void)drawAdditionalSeriesPoints {
+    NSInteger count = self.numberOfSeries - 1;
+    size_t threshold = linePointsAreEnvelope ? [self pointBudget] : (decimatedPoints ? [self decimationThreshold] : 0);
+    size_t *indices = threshold > 0 && count > 0 ? malloc(sizeof(size_t) * threshold) : NULL;
     
-    BEMLine *line = [[BEMLine alloc] initWithFrame:[self drawableGraphArea]];
+    for (NSInteger s = 0; s < count; s++) {
+        BEMAdditionalSeries *series = &additionalSeries[s];
+        
+        // The previous line may still retain the previous buffer
+        BEMPointBufferRelease(series->points);
+        series->points = NULL;
+        if (linePointsAreEnvelope && series->tree && indices) {
+            series->points = [self envelopePointsOfValues:series->values tree:series->tree threshold:threshold indices:indices];
+            continue;
+        }
+        
+        series->points = BEMPointBufferCreate(visibleCount);
+        if (series->points == NULL || !BEMPointBufferReserve(series->points, visibleCount)) continue;
+        BEMGraphTransformPoints(&pointTransform, series->values + visibleStart, visibleCount, BEMNullGraphValue, 0, series->points->x, series->points->y);
+        series->points->count = visibleCount;
+        if (timestamps) BEMTimeAxisPlacePoints(&timeAxis, timestamps + visibleStart, visibleCount, series->points->x);
+        
+        // Decimated with the same threshold as the first series, each series keeps its own extremes
+        if (indices) {
+            BEMPointBufferRef keptPoints = [self decimatePoints:series->points threshold:threshold indices:indices];
+            if (keptPoints) {
+                BEMPointBufferRelease(series->points);
+                series->points = keptPoints;
+            }
+        }
+    }
+    free(indices);
+}
+
+- (void)drawLine {
+    // The line is created once, every draw updates its layers
+    if (graphLine == nil) {
+        graphLine = [[BEMLine alloc] initWithFrame:[self drawableGraphArea]];
+        graphLine.opaque = NO;
+        graphLine.backgroundColor = [UIColor clearColor];
+    }
+    BEMLine *line = graphLine;
     
-    line.opaque = NO;
+    line.frame = [self drawableGraphArea];
     line.alpha = 1;
-    line.backgroundColor = [UIColor clearColor];
     line.topColor = self.colorTop;
     line.bottomColor = self.colorBottom;
     line.topAlpha = self.alphaTop;
@@ -584,11 +1459,15 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     line.referenceLineWidth = self.widthReferenceLines?self.widthReferenceLines:(self.widthLine/2);
     line.lineAlpha = self.alphaLine;
     line.bezierCurveIsEnabled = self.enableBezierCurve;
-    line.arrayOfPoints = yAxisValues;
-    line.arrayOfValues = self.graphValuesForDataPoints;
+    line.curveInterpolation = self.curveInterpolation;
+    line.pointBuffer = decimatedPoints ? decimatedPoints : linePoints;
+    // The paths built on the reload queue are kept for the next lines
+    if (appliedSnapshot.lineGeometry) lineGeometry = appliedSnapshot.lineGeometry;
+    else if (lineGeometry == nil) lineGeometry = [[BEMLineGeometry alloc] init];
+    line.geometry = lineGeometry;
     line.lineDashPatternForReferenceYAxisLines = self.lineDashPatternForReferenceYAxisLines;
     line.lineDashPatternForReferenceXAxisLines = self.lineDashPatternForReferenceXAxisLines;
-    line.interpolateNullValues = self.interpolateNullValues;
+    line.nullValueFill = [self drawnNullValueFill];
     
     line.enableRefrenceFrame = self.enableReferenceAxisFrame;
     line.enableRightReferenceFrameLine = self.enableRightReferenceAxisFrameLine;
@@ -596,13 +1475,11 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     line.enableLeftReferenceFrameLine = self.enableLeftReferenceAxisFrameLine;
     line.enableBottomReferenceFrameLine = self.enableBottomReferenceAxisFrameLine;
     
-    if (self.enableReferenceXAxisLines || self.enableReferenceYAxisLines) {
-        line.enableRefrenceLines = YES;
-        line.refrenceLineColor = self.colorReferenceLines;
-        line.verticalReferenceHorizontalFringeNegation = xAxisHorizontalFringeNegationValue;
-        line.arrayOfVerticalRefrenceLinePoints = self.enableReferenceXAxisLines ? xAxisLabelPoints : nil;
-        line.arrayOfHorizontalRefrenceLinePoints = self.enableReferenceYAxisLines ? yAxisLabelPoints : nil;
-    }
+    line.enableRefrenceLines = self.enableReferenceXAxisLines || self.enableReferenceYAxisLines;
+    line.refrenceLineColor = self.colorReferenceLines;
+    line.verticalReferenceHorizontalFringeNegation = xAxisHorizontalFringeNegationValue;
+    line.verticalReferenceLinePoints = self.enableReferenceXAxisLines ? xAxisLabelPoints : NULL;
+    line.horizontalReferenceLinePoints = self.enableReferenceYAxisLines ? yAxisLabelPoints : NULL;
     
     line.color = self.colorLine;
     line.lineGradient = self.gradientLine;
@@ -618,78 +1495,125 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     
     line.disableMainLine = self.displayDotsOnly;
     
-    [self addSubview:line];
+    // While recording metrics, the paths are built now so the line stage measures them instead of the layout of the line
+    if (metricsStagesAreOpen) [line updateGeometry];
+    
+    // The layers are updated in the next layout pass, once for all the properties set above
+    [line setNeedsLayout];
+    if (line.superview != self) [self addSubview:line];
     [self sendSubviewToBack:line];
     [self sendSubviewToBack:self.backgroundXAxis];
     
+    [self drawAdditionalSeriesLinesAboveLine:line];
+    
     [self didFinishDrawingIncludingYAxis:NO];
 }
 
-- (void)drawXAxis {
-    if (!self.enableXAxisLabel) return;
-    if (![self.dataSource respondsToSelector:@selector(lineGraph:labelOnXAxisForIndex:)]) return;
+/// The way the lines cross null values: \p nullValueFill, or gaps when null values are not interpolated
+- (BEMNullValueFill)drawnNullValueFill {
+    return self.interpolateNullValues ? self.nullValueFill : BEMNullValueFillGap;
+}
+
+/// Adds one line without fills, reference lines or average line for every additional series, in order above \p line
+- (void)drawAdditionalSeriesLinesAboveLine:(BEMLine *)line {
+    if (additionalLineGeometries == nil) additionalLineGeometries = [NSMutableArray array];
+    if (additionalLines == nil) additionalLines = [NSMutableArray array];
     
-    for (UIView *subview in [self subviews]) {
-        if ([subview isKindOfClass:[UILabel class]] && subview.tag == DotLastTag1000) [subview removeFromSuperview];
-        else if ([subview isKindOfClass:[UIView class]] && subview.tag == BackgroundXAxisTag2200) [subview removeFromSuperview];
+    // The lines of the series which are gone are dropped
+    NSInteger count = self.numberOfSeries - 1;
+    while ((NSInteger)additionalLines.count > MAX(count, 0)) {
+        [additionalLines.lastObject removeFromSuperview];
+        [additionalLines removeLastObject];
+    }
+    
+    BEMLine *previousLine = line;
+    for (NSInteger s = 0; s < count; s++) {
+        // Every series keeps its line from one redraw to the next
+        if ((NSInteger)additionalLines.count <= s) {
+            BEMLine *newLine = [[BEMLine alloc] initWithFrame:line.frame];
+            newLine.opaque = NO;
+            newLine.backgroundColor = [UIColor clearColor];
+            [additionalLines addObject:newLine];
+        }
+        BEMLine *seriesLine = additionalLines[s];
+        if (additionalSeries[s].points == NULL) {
+            [seriesLine removeFromSuperview];
+            continue;
+        }
+        
+        seriesLine.frame = line.frame;
+        seriesLine.lineWidth = line.lineWidth;
+        seriesLine.lineAlpha = line.lineAlpha;
+        seriesLine.bezierCurveIsEnabled = line.bezierCurveIsEnabled;
+        seriesLine.curveInterpolation = line.curveInterpolation;
+        seriesLine.nullValueFill = line.nullValueFill;
+        seriesLine.animationTime = line.animationTime;
+        seriesLine.animationType = line.animationType;
+        seriesLine.disableMainLine = line.disableMainLine;
+        seriesLine.pointBuffer = additionalSeries[s].points;
+        
+        // Every series keeps its own paths from one redraw to the next
+        while ((NSInteger)additionalLineGeometries.count <= s) [additionalLineGeometries addObject:[[BEMLineGeometry alloc] init]];
+        seriesLine.geometry = additionalLineGeometries[s];
+        
+        seriesLine.color = nil;
+        if ([self.delegate respondsToSelector:@selector(lineGraph:colorForLineOfSeries:)]) {
+            seriesLine.color = [self.delegate lineGraph:self colorForLineOfSeries:s + 1];
+        }
+        if (seriesLine.color == nil) seriesLine.color = self.colorLine;
+        if (metricsStagesAreOpen) [seriesLine updateGeometry];
+        
+        [seriesLine setNeedsLayout];
+        [self insertSubview:seriesLine aboveSubview:previousLine];
+        previousLine = seriesLine;
+    }
+}
+
+- (void)drawXAxis {
+    [self recycleXAxisLabels];
+    if (!self.enableXAxisLabel || (!timestamps && ![self.dataSource respondsToSelector:@selector(lineGraph:labelOnXAxisForIndex:)])) {
+        [self.backgroundXAxis removeFromSuperview];
+        return;
     }
     
     // Remove all X-Axis Labels before adding them to the array
     [xAxisValues removeAllObjects];
-    [xAxisLabels removeAllObjects];
-    [xAxisLabelPoints removeAllObjects];
+    BEMPointBufferRemoveAllPoints(xAxisLabelPoints);
     xAxisHorizontalFringeNegationValue = 0.0;
+    xAxisLabelsAreFringes = NO;
     
-    // Draw X-Axis Background Area
-    self.backgroundXAxis = [[UIView alloc] initWithFrame:[self drawableXAxisArea]];
-    self.backgroundXAxis.tag = BackgroundXAxisTag2200;
+    // Draw X-Axis Background Area, the view is created once and updated in place. Adding it again only brings it to the front.
+    if (self.backgroundXAxis == nil) {
+        self.backgroundXAxis = [[UIView alloc] init];
+        self.backgroundXAxis.tag = BackgroundXAxisTag2200;
+    }
+    self.backgroundXAxis.frame = [self drawableXAxisArea];
     if (self.colorBackgroundXaxis == nil) self.backgroundXAxis.backgroundColor = self.colorBottom;
     else self.backgroundXAxis.backgroundColor = self.colorBackgroundXaxis;
     self.backgroundXAxis.alpha = self.alphaBackgroundXaxis;
     [self addSubview:self.backgroundXAxis];
     
-    if ([self.delegate respondsToSelector:@selector(incrementPositionsForXAxisOnLineGraph:)]) {
+    // Only the frames of the labels are computed here, the views are created once the overlapping labels are removed
+    if (timestamps) {
+        [self addTimeAxisLabels];
+    } else if ([self.delegate respondsToSelector:@selector(incrementPositionsForXAxisOnLineGraph:)]) {
         NSArray *axisValues = [self.delegate incrementPositionsForXAxisOnLineGraph:self];
         for (NSNumber *increment in axisValues) {
-            NSInteger index = increment.integerValue;
-            NSString *xAxisLabelText = [self xAxisTextForIndex:index];
-            
-            UILabel *labelXAxis = [self xAxisLabelWithText:xAxisLabelText atIndex:index];
-            [xAxisLabels addObject:labelXAxis];
-            
-            if (self.positionYAxisRight) {
-                NSNumber *xAxisLabelCoordinate = [NSNumber numberWithFloat:labelXAxis.center.x];
-                [xAxisLabelPoints addObject:xAxisLabelCoordinate];
-            } else {
-                NSNumber *xAxisLabelCoordinate = [NSNumber numberWithFloat:labelXAxis.center.x-self.YAxisLabelXOffset];
-                [xAxisLabelPoints addObject:xAxisLabelCoordinate];
-            }
-            
-            [self addSubview:labelXAxis];
-            [xAxisValues addObject:xAxisLabelText];
+            // The labels of the points scrolled out of the view are skipped
+            NSInteger index = increment.integerValue - visibleStart;
+            if (index < 0 || index >= visibleCount) continue;
+            NSString *xAxisLabelText = [self xAxisTextForIndex:visibleStart + index];
+            [self addXAxisLabelWithText:xAxisLabelText frame:[self xAxisLabelFrameForText:xAxisLabelText atIndex:index]];
         }
     } else if ([self.delegate respondsToSelector:@selector(baseIndexForXAxisOnLineGraph:)] && [self.delegate respondsToSelector:@selector(incrementIndexForXAxisOnLineGraph:)]) {
         NSInteger baseIndex = [self.delegate baseIndexForXAxisOnLineGraph:self];
         NSInteger increment = [self.delegate incrementIndexForXAxisOnLineGraph:self];
         
         NSInteger startingIndex = baseIndex;
-        while (startingIndex < numberOfPoints) {
-            
+        if (startingIndex < visibleStart && increment > 0) startingIndex += (visibleStart - startingIndex + increment - 1) / increment * increment;
+        while (startingIndex < visibleStart + visibleCount) {
             NSString *xAxisLabelText = [self xAxisTextForIndex:startingIndex];
-            
-            UILabel *labelXAxis = [self xAxisLabelWithText:xAxisLabelText atIndex:startingIndex];
-            [xAxisLabels addObject:labelXAxis];
-            
-            if (self.positionYAxisRight) {
-                NSNumber *xAxisLabelCoordinate = [NSNumber numberWithFloat:labelXAxis.center.x];
-                [xAxisLabelPoints addObject:xAxisLabelCoordinate];
-            } else {
-                NSNumber *xAxisLabelCoordinate = [NSNumber numberWithFloat:labelXAxis.center.x-self.YAxisLabelXOffset];
-                [xAxisLabelPoints addObject:xAxisLabelCoordinate];
-            }
-            
-            [self addSubview:labelXAxis];
-            [xAxisValues addObject:xAxisLabelText];
+            [self addXAxisLabelWithText:xAxisLabelText frame:[self xAxisLabelFrameForText:xAxisLabelText atIndex:startingIndex - visibleStart]];
             
             startingIndex += increment;
         }
@@ -711,9 +1635,9 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
             numberOfGaps = 1;
         }
         
-        if (numberOfGaps >= (numberOfPoints - 1)) {
-            NSString *firstXLabel = [self xAxisTextForIndex:0];
-            NSString *lastXLabel = [self xAxisTextForIndex:numberOfPoints - 1];
+        if (numberOfGaps >= (visibleCount - 1)) {
+            NSString *firstXLabel = [self xAxisTextForIndex:visibleStart];
+            NSString *lastXLabel = [self xAxisTextForIndex:visibleStart + visibleCount - 1];
             
             CGFloat viewWidth = self.frame.size.width - self.YAxisLabelXOffset;
             
@@ -726,82 +1650,87 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
                 xAxisXPositionFirstOffset = 3+self.YAxisLabelXOffset;
                 xAxisXPositionLastOffset = viewWidth/2 + xAxisXPositionFirstOffset + 1;
             }
-            UILabel *firstLabel = [self xAxisLabelWithText:firstXLabel atIndex:0];
-            firstLabel.frame = CGRectMake(xAxisXPositionFirstOffset, self.frame.size.height-20, viewWidth/2, 20);
-            
-            firstLabel.textAlignment = NSTextAlignmentLeft;
-            [self addSubview:firstLabel];
-            [xAxisValues addObject:firstXLabel];
-            [xAxisLabels addObject:firstLabel];
             
-            UILabel *lastLabel = [self xAxisLabelWithText:lastXLabel atIndex:numberOfPoints - 1];
-            lastLabel.frame = CGRectMake(xAxisXPositionLastOffset, self.frame.size.height-20, viewWidth/2 - 4, 20);
-            lastLabel.textAlignment = NSTextAlignmentRight;
-            [self addSubview:lastLabel];
-            [xAxisValues addObject:lastXLabel];
-            [xAxisLabels addObject:lastLabel];
-            
-            if (self.positionYAxisRight) {
-                NSNumber *xFirstAxisLabelCoordinate = @(firstLabel.center.x);
-                NSNumber *xLastAxisLabelCoordinate = @(lastLabel.center.x);
-                [xAxisLabelPoints addObject:xFirstAxisLabelCoordinate];
-                [xAxisLabelPoints addObject:xLastAxisLabelCoordinate];
-            } else {
-                NSNumber *xFirstAxisLabelCoordinate = @(firstLabel.center.x - self.YAxisLabelXOffset);
-                NSNumber *xLastAxisLabelCoordinate = @(lastLabel.center.x - self.YAxisLabelXOffset);
-                [xAxisLabelPoints addObject:xFirstAxisLabelCoordinate];
-                [xAxisLabelPoints addObject:xLastAxisLabelCoordinate];
-            }
+            // The labels take half of the axis each, the reference lines are still translated like centered labels
+            [self xAxisLabelFrameForText:firstXLabel atIndex:0];
+            [self xAxisLabelFrameForText:lastXLabel atIndex:visibleCount - 1];
+            xAxisLabelsAreFringes = YES;
+            [self addXAxisLabelWithText:firstXLabel frame:CGRectMake(xAxisXPositionFirstOffset, self.frame.size.height-20, viewWidth/2, 20)];
+            [self addXAxisLabelWithText:lastXLabel frame:CGRectMake(xAxisXPositionLastOffset, self.frame.size.height-20, viewWidth/2 - 4, 20)];
         } else {
-            @autoreleasepool {
-                NSInteger offset = [self offsetForXAxisWithNumberOfGaps:numberOfGaps]; // The offset (if possible and necessary) used to shift the Labels on the X-Axis for them to be centered.
-                
-                for (int i = 1; i <= (numberOfPoints/numberOfGaps); i++) {
-                    NSInteger index = i *numberOfGaps - 1 - offset;
-                    NSString *xAxisLabelText = [self xAxisTextForIndex:index];
-                    
-                    UILabel *labelXAxis = [self xAxisLabelWithText:xAxisLabelText atIndex:index];
-                    [xAxisLabels addObject:labelXAxis];
-                    
-                    if (self.positionYAxisRight) {
-                        NSNumber *xAxisLabelCoordinate = [NSNumber numberWithFloat:labelXAxis.center.x];
-                        [xAxisLabelPoints addObject:xAxisLabelCoordinate];
-                    } else {
-                        NSNumber *xAxisLabelCoordinate = [NSNumber numberWithFloat:labelXAxis.center.x - self.YAxisLabelXOffset];
-                        [xAxisLabelPoints addObject:xAxisLabelCoordinate];
-                    }
-                    
-                    [self addSubview:labelXAxis];
-                    [xAxisValues addObject:xAxisLabelText];
-                }
-                
+            NSInteger offset = [self offsetForXAxisWithNumberOfGaps:numberOfGaps]; // The offset (if possible and necessary) used to shift the Labels on the X-Axis for them to be centered.
+            
+            for (int i = 1; i <= (visibleCount/numberOfGaps); i++) {
+                NSInteger index = i *numberOfGaps - 1 - offset;
+                NSString *xAxisLabelText = [self xAxisTextForIndex:visibleStart + index];
+                [self addXAxisLabelWithText:xAxisLabelText frame:[self xAxisLabelFrameForText:xAxisLabelText atIndex:index]];
             }
         }
     }
-    __block NSUInteger lastMatchIndex;
-    
-    NSMutableArray *overlapLabels = [NSMutableArray arrayWithCapacity:0];
-    [xAxisLabels enumerateObjectsUsingBlock:^(UILabel *label, NSUInteger idx, BOOL *stop) {
-        if (idx == 0) {
-            lastMatchIndex = 0;
-        } else { // Skip first one
-            UILabel *prevLabel = [xAxisLabels objectAtIndex:lastMatchIndex];
-            CGRect r = CGRectIntersection(prevLabel.frame, label.frame);
-            if (CGRectIsNull(r)) lastMatchIndex = idx;
-            else [overlapLabels addObject:label]; // Overlapped
-        }
-        
-        BOOL fullyContainsLabel = CGRectContainsRect(self.bounds, label.frame);
-        if (!fullyContainsLabel) {
-            [overlapLabels addObject:label];
-        }
-    }];
     
-    for (UILabel *l in overlapLabels) {
-        [l removeFromSuperview];
+    // Only the labels which fit in the view without overlapping the labels before them get a view
+    size_t count = xAxisValues.count;
+    for (size_t i = 0; i < count; i++) [xAxisLabels addObject:[NSNull null]];
+    size_t *selected = count > 0 ? malloc(sizeof(size_t) * count) : NULL;
+    if (selected == NULL) return;
+    
+    size_t keptCount = BEMLabelLayoutSelect(xAxisLabelBoxes, count, BEMLabelBoxFromRect(self.bounds), BEMLabelAxisHorizontal, 0, selected);
+    for (size_t n = 0; n < keptCount; n++) {
+        [self addSubview:[self xAxisLabelAtIndex:selected[n]]];
+    }
+    free(selected);
+}
+
+/// Puts every X-Axis label in the reuse pool, including the labels which were only created for \p graphLabelsForXAxis
+- (void)recycleXAxisLabels {
+    for (id label in xAxisLabels) {
+        if (label != [NSNull null]) [self.viewReusePool enqueueView:label ofKind:BEMReusableViewKindXAxisLabel];
+    }
+    [xAxisLabels removeAllObjects];
+}
+
+/// Adds a label to the X-Axis, with its reference line. Its view is only created if it's displayed or requested.
+- (void)addXAxisLabelWithText:(NSString *)text frame:(CGRect)frame {
+    NSUInteger count = xAxisValues.count;
+    if (count == xAxisLabelBoxesCapacity) {
+        size_t capacity = xAxisLabelBoxesCapacity > 0 ? 2 * xAxisLabelBoxesCapacity : 16;
+        BEMLabelBox *boxes = realloc(xAxisLabelBoxes, sizeof(BEMLabelBox) * capacity);
+        if (boxes == NULL) return;
+        xAxisLabelBoxes = boxes;
+        xAxisLabelBoxesCapacity = capacity;
+    }
+    xAxisLabelBoxes[count] = BEMLabelBoxFromRect(frame);
+    [xAxisValues addObject:text];
+    
+    if (self.positionYAxisRight) {
+        BEMPointBufferAppendPoint(xAxisLabelPoints, CGRectGetMidX(frame), 0);
+    } else {
+        BEMPointBufferAppendPoint(xAxisLabelPoints, CGRectGetMidX(frame) - self.YAxisLabelXOffset, 0);
     }
 }
 
+/// The label of the X-Axis text at \p labelIndex in xAxisValues, created the first time it's needed
+- (UILabel *)xAxisLabelAtIndex:(NSUInteger)labelIndex {
+    id label = xAxisLabels[labelIndex];
+    if (label != [NSNull null]) return label;
+    
+    UILabel *labelXAxis = [self.viewReusePool dequeueViewOfKind:BEMReusableViewKindXAxisLabel class:[UILabel class]];
+    labelXAxis.frame = BEMRectFromLabelBox(xAxisLabelBoxes[labelIndex]);
+    labelXAxis.text = xAxisValues[labelIndex];
+    labelXAxis.font = self.labelFont;
+    if (xAxisLabelsAreFringes) labelXAxis.textAlignment = labelIndex == 0 ? NSTextAlignmentLeft : NSTextAlignmentRight;
+    else labelXAxis.textAlignment = NSTextAlignmentCenter;
+    labelXAxis.textColor = self.colorXaxisLabel;
+    labelXAxis.backgroundColor = [UIColor clearColor];
+    labelXAxis.tag = DotLastTag1000;
+    
+    // Add support multi-line, but this might overlap with the graph line if text have too many lines
+    labelXAxis.numberOfLines = 0;
+    
+    xAxisLabels[labelIndex] = labelXAxis;
+    return labelXAxis;
+}
+
 - (NSString *)xAxisTextForIndex:(NSInteger)index {
     NSString *xAxisLabelText = @"";
     
@@ -828,69 +1757,211 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     return xAxisLabelText;
 }
 
-- (UILabel *)xAxisLabelWithText:(NSString *)text atIndex:(NSInteger)index {
-    UILabel *labelXAxis = [[UILabel alloc] init];
-    labelXAxis.text = text;
-    labelXAxis.font = self.labelFont;
-    labelXAxis.textAlignment = 1;
-    labelXAxis.textColor = self.colorXaxisLabel;
-    labelXAxis.backgroundColor = [UIColor clearColor];
-    labelXAxis.tag = DotLastTag1000;
-    
-    // Add support multi-line, but this might overlap with the graph line if text have too many lines
-    labelXAxis.numberOfLines = 0;
-    CGRect lRect = [labelXAxis.text boundingRectWithSize:self.viewForBaselineLayout.frame.size options:NSStringDrawingUsesLineFragmentOrigin attributes:@{NSFontAttributeName:labelXAxis.font} context:nil];
-    
-    CGPoint center;
-    
-    /* OLD LABEL GENERATION CODE
-    CGFloat availablePositionRoom = self.viewForBaselineLayout.frame.size.width; // Get view width of view
-    CGFloat positioningDivisor = (float)index / numberOfPoints; // Generate relative position of point based on current index and total
-    CGFloat horizontalTranslation = self.YAxisLabelXOffset + lRect.size.width;
-    CGFloat xPosition = (availablePositionRoom * positioningDivisor) + horizontalTranslation;
-    // NSLog(@"availablePositionRoom: %f, positioningDivisor: %f, horizontalTranslation: %f, xPosition: %f", availablePositionRoom, positioningDivisor, horizontalTranslation, xPosition); // Uncomment for debugging */
+- (CGRect)xAxisLabelFrameForText:(NSString *)text atIndex:(NSInteger)index {
+    CGSize labelSize = [self sizeOfLabelText:text];
     
     // Determine the horizontal translation to perform on the far left and far right labels
     // This property is negated when calculating the position of reference frames
     CGFloat horizontalTranslation;
     if (index == 0) {
-        horizontalTranslation = lRect.size.width/2;
-    } else if (index+1 == numberOfPoints) {
-        horizontalTranslation = -lRect.size.width/2;
+        horizontalTranslation = labelSize.width/2;
+    } else if (index+1 == visibleCount) {
+        horizontalTranslation = -labelSize.width/2;
     } else horizontalTranslation = 0;
     xAxisHorizontalFringeNegationValue = horizontalTranslation;
     
     // Determine the final x-axis position
-    CGFloat positionOnXAxis;
-    if (self.positionYAxisRight) {
-        positionOnXAxis = (((self.frame.size.width - self.YAxisLabelXOffset) / (numberOfPoints - 1)) * index) + horizontalTranslation;
-    } else {
-        positionOnXAxis = (((self.frame.size.width - self.YAxisLabelXOffset) / (numberOfPoints - 1)) * index) + self.YAxisLabelXOffset + horizontalTranslation;
+    CGFloat positionOnXAxis = (((self.frame.size.width - self.YAxisLabelXOffset) / (visibleCount - 1)) * index) + horizontalTranslation;
+    return [self xAxisLabelFrameForSize:labelSize centeredAt:positionOnXAxis];
+}
+
+/// The frame of a label of \p labelSize centered on \p position at the bottom of the graph. \p position is in the line's coordinate system.
+- (CGRect)xAxisLabelFrameForSize:(CGSize)labelSize centeredAt:(CGFloat)position {
+    CGFloat positionOnXAxis = self.positionYAxisRight ? position : position + self.YAxisLabelXOffset;
+    return CGRectMake(positionOnXAxis - labelSize.width/2, self.frame.size.height - labelSize.height, labelSize.width, labelSize.height);
+}
+
+/// Offset of the time zone given as context, for the time axis
+static double BEMOffsetOfTimeZone(void *context, double time) {
+    NSTimeZone *timeZone = (__bridge NSTimeZone *)context;
+    return [timeZone secondsFromGMTForDate:[NSDate dateWithTimeIntervalSince1970:time]];
+}
+
+/// Labels the X-Axis of timestamped points with calendar ticks. The ticks are formatted by the graph, the data source is not asked for any text.
+- (void)addTimeAxisLabels {
+    if (visibleCount <= 0) return;
+    
+    // About one tick every 80 points, the labels which still overlap are removed with the others
+    CGFloat width = self.frame.size.width - self.YAxisLabelXOffset;
+    size_t targetCount = MAX((size_t)2, (size_t)(width / 80));
+    
+    // The closest level may have a few times more ticks than requested
+    size_t capacity = 4 * targetCount + 2;
+    if (timeTicksCapacity < capacity) {
+        double *ticks = realloc(timeTicks, sizeof(double) * capacity);
+        if (ticks == NULL) return;
+        timeTicks = ticks;
+        timeTicksCapacity = capacity;
     }
     
-    // Set the final center point of the x-axis labels
-    if (self.positionYAxisRight) {
-        center = CGPointMake(positionOnXAxis, self.frame.size.height - lRect.size.height/2);
+    // The ticks fall on the wall clock of the time zone they are formatted in, with the offset of each tick across daylight saving time changes
+    double startTime = timestamps[visibleStart];
+    double endTime = timestamps[visibleStart + visibleCount - 1];
+    NSTimeZone *timeZone = [NSTimeZone defaultTimeZone];
+    
+    BEMTimeTickLevel level;
+    size_t count = BEMTimeTicksMake(startTime, endTime, targetCount, BEMOffsetOfTimeZone, (__bridge void *)timeZone, &level, timeTicks, timeTicksCapacity);
+    NSDateFormatter *formatter = [self formatterForTimeUnit:level.unit timeZone:timeZone];
+    for (size_t i = 0; i < count; i++) {
+        NSString *text = [formatter stringFromDate:[NSDate dateWithTimeIntervalSince1970:timeTicks[i]]];
+        [self addXAxisLabelWithText:text frame:[self xAxisLabelFrameForSize:[self sizeOfLabelText:text] centeredAt:BEMTimeAxisX(&timeAxis, timeTicks[i])]];
+    }
+}
+
+/// The formatter of the ticks of \p unit, created once for each unit
+- (NSDateFormatter *)formatterForTimeUnit:(BEMTimeUnit)unit timeZone:(NSTimeZone *)timeZone {
+    if (timeTickFormatters == nil) timeTickFormatters = [NSMutableDictionary dictionary];
+    NSDateFormatter *formatter = timeTickFormatters[@(unit)];
+    if (formatter == nil) {
+        formatter = [[NSDateFormatter alloc] init];
+        switch (unit) {
+            case BEMTimeUnitSecond: [formatter setLocalizedDateFormatFromTemplate:@"jms"]; break;
+            case BEMTimeUnitMinute:
+            case BEMTimeUnitHour: [formatter setLocalizedDateFormatFromTemplate:@"jm"]; break;
+            case BEMTimeUnitDay:
+            case BEMTimeUnitWeek: [formatter setLocalizedDateFormatFromTemplate:@"MMMd"]; break;
+            case BEMTimeUnitMonth: [formatter setLocalizedDateFormatFromTemplate:@"yMMM"]; break;
+            case BEMTimeUnitYear: [formatter setLocalizedDateFormatFromTemplate:@"y"]; break;
+        }
+        timeTickFormatters[@(unit)] = formatter;
+    }
+    if (![formatter.timeZone isEqualToTimeZone:timeZone]) formatter.timeZone = timeZone;
+    return formatter;
+}
+
+/// The size of a text in the label font. Every text is only measured once for each font.
+- (CGSize)sizeOfLabelText:(NSString *)text {
+    UIFont *font = self.labelFont;
+    BEMTextMetricsCacheRef cache = BEMSharedTextMetricsCache();
+    const char *utf8Text = text.UTF8String;
+    
+    // The font is identified by its name and size
+    uint64_t fontKey = ((uint64_t)font.fontName.hash << 16) ^ (uint64_t)(font.pointSize * 64);
+    float width, height;
+    if (cache != NULL && utf8Text != NULL && BEMTextMetricsCacheMeasure(cache, fontKey, utf8Text, strlen(utf8Text), BEMMeasureLabelText, (__bridge void *)font, &width, &height)) {
+        return CGSizeMake(width, height);
+    }
+    return [text boundingRectWithSize:CGSizeMake(CGFLOAT_MAX, CGFLOAT_MAX) options:NSStringDrawingUsesLineFragmentOrigin attributes:@{NSFontAttributeName: font} context:nil].size;
+}
+
+/// Computes the values of the labels of an auto-scaled Y-Axis in \p yAxisValues. Returns NO if the axis has no labels.
+- (BOOL)layoutYAxisValues {
+    yAxisValueCount = 0;
+    [self validateYAxisTextCache];
+    // The labels span the data: the extremes of every series over the visible points
+    double minimumValue = visibleMinValue;
+    double maximumValue = visibleMaxValue;
+    if (!(minimumValue <= maximumValue)) minimumValue = maximumValue = 0;
+
+    NSInteger numberOfLabels;
+    if ([self.delegate respondsToSelector:@selector(numberOfYAxisLabelsOnLineGraph:)]) {
+        numberOfLabels = [self.delegate numberOfYAxisLabelsOnLineGraph:self];
+    } else numberOfLabels = 3;
+
+    BEMAxisTicks ticks;
+    BOOL isLinear = NO;
+    if ([self.delegate respondsToSelector:@selector(baseValueForYAxisOnLineGraph:)] && [self.delegate respondsToSelector:@selector(incrementValueForYAxisOnLineGraph:)]) {
+        CGFloat baseValue = [self.delegate baseValueForYAxisOnLineGraph:self];
+        CGFloat increment = [self.delegate incrementValueForYAxisOnLineGraph:self];
+        if (!(increment > 0) || baseValue + increment * 100 < maximumValue) {
+            NSLog(@"[BEMSimpleLineGraph] Increment does not properly lay out Y axis, bailing early");
+            return NO;
+        }
+
+        ticks.first = baseValue;
+        ticks.step = increment;
+        ticks.count = 0;
+        while (BEMAxisTickValue(&ticks, ticks.count) < maximumValue + increment) ticks.count++;
+    } else if (numberOfLabels <= 0) return NO;
+    else if (numberOfLabels == 1) {
+        ticks.first = ((NSInteger)minimumValue + (NSInteger)maximumValue) / 2;
+        ticks.step = 0;
+        ticks.count = 1;
+    } else if (self.enableNiceYAxisValues) {
+        if (!BEMAxisTicksMake(minimumValue, maximumValue, numberOfLabels, yAxisMinimumStep, &ticks)) return NO;
     } else {
-        center = CGPointMake(positionOnXAxis, self.frame.size.height - lRect.size.height/2);
+        ticks.first = minimumValue;
+        ticks.step = (maximumValue - minimumValue) / (numberOfLabels - 1);
+        ticks.count = numberOfLabels;
+        isLinear = YES;
+    }
+
+    if (ticks.count > yAxisValuesCapacity) {
+        double *grownValues = realloc(yAxisValues, sizeof(double) * ticks.count);
+        if (grownValues == NULL) return NO;
+        yAxisValues = grownValues;
+        yAxisValuesCapacity = ticks.count;
     }
+    for (size_t i = 0; i < ticks.count; i++) yAxisValues[i] = BEMAxisTickValue(&ticks, i);
+    yAxisValueCount = ticks.count;
     
-    CGRect rect = labelXAxis.frame;
-    rect.size = lRect.size;
-    labelXAxis.frame = rect;
-    labelXAxis.center = center;
-    return labelXAxis;
+    // Linear labels are laid out extremes first, so the labels between them are the ones removed when they overlap
+    if (isLinear && ticks.count > 2) {
+        memmove(yAxisValues + 2, yAxisValues + 1, sizeof(double) * (ticks.count - 2));
+        yAxisValues[1] = maximumValue;
+    }
+    return YES;
+}
+
+/// Forgets the cached Y-Axis texts when the format, prefix or suffix they were formatted with changed
+- (void)validateYAxisTextCache {
+    NSString *prefix = @"";
+    NSString *suffix = @"";
+    if ([self.delegate respondsToSelector:@selector(yAxisPrefixOnLineGraph:)]) prefix = [self.delegate yAxisPrefixOnLineGraph:self] ?: @"";
+    if ([self.delegate respondsToSelector:@selector(yAxisSuffixOnLineGraph:)]) suffix = [self.delegate yAxisSuffixOnLineGraph:self] ?: @"";
+    NSString *format = self.formatStringForValues;
+
+    if (yAxisTextCache && [format isEqualToString:yAxisTextCacheFormat] && [prefix isEqualToString:yAxisTextCachePrefix] && [suffix isEqualToString:yAxisTextCacheSuffix]) return;
+    yAxisTextCache = [NSMutableDictionary dictionary];
+    yAxisTextCacheFormat = [format copy];
+    yAxisTextCachePrefix = [prefix copy];
+    yAxisTextCacheSuffix = [suffix copy];
+
+    // Nice values closer than the decimals shown by the format would have the same text
+    NSString *zero = [NSString stringWithFormat:format, 0.0];
+    NSRange decimalSeparator = [zero rangeOfString:@"."];
+    NSUInteger decimals = 0;
+    if (decimalSeparator.location != NSNotFound) {
+        for (NSUInteger i = NSMaxRange(decimalSeparator); i < zero.length && [[NSCharacterSet decimalDigitCharacterSet] characterIsMember:[zero characterAtIndex:i]]; i++) decimals++;
+    }
+    yAxisMinimumStep = pow(10, -(double)decimals);
+}
+
+/// The text of the Y-Axis label of \p value, formatted once for as long as the format, prefix and suffix don't change. Only valid after \p layoutYAxisValues.
+- (NSString *)yAxisTextForValue:(double)value {
+    NSNumber *key = @(value);
+    NSString *text = yAxisTextCache[key];
+    if (text) return text;
+
+    // Bounded, a zoomed or streamed axis goes through many values
+    if (yAxisTextCache.count >= 1024) [yAxisTextCache removeAllObjects];
+    text = [NSString stringWithFormat:@"%@%@%@", yAxisTextCachePrefix, [NSString stringWithFormat:yAxisTextCacheFormat, value], yAxisTextCacheSuffix];
+    yAxisTextCache[key] = text;
+    return text;
 }
 
 - (void)drawYAxis {
     for (UIView *subview in [self subviews]) {
-        if ([subview isKindOfClass:[UILabel class]] && subview.tag == LabelYAxisTag2000 ) {
-            [subview removeFromSuperview];
-        } else if ([subview isKindOfClass:[UIView class]] && subview.tag == BackgroundYAxisTag2100 ) {
-            [subview removeFromSuperview];
+        if ([self reusableKindOfView:subview] == BEMReusableViewKindYAxisLabel) {
+            [self.viewReusePool enqueueView:subview ofKind:BEMReusableViewKindYAxisLabel];
         }
     }
     
+    if (!self.enableYAxisLabel) {
+        [self.backgroundYAxis removeFromSuperview];
+        return;
+    }
+    
     CGRect frameForBackgroundYAxis;
     CGRect frameForLabelYAxis;
     CGFloat xValueForCenterLabelYAxis;
@@ -908,78 +1979,27 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
         textAlignmentForLabelYAxis = NSTextAlignmentRight;
     }
     
-    UIView *backgroundYaxis = [[UIView alloc] initWithFrame:frameForBackgroundYAxis];
-    backgroundYaxis.tag = BackgroundYAxisTag2100;
-    if (self.colorBackgroundYaxis == nil) backgroundYaxis.backgroundColor = self.colorTop;
-    else backgroundYaxis.backgroundColor = self.colorBackgroundYaxis;
-    backgroundYaxis.alpha = self.alphaBackgroundYaxis;
-    [self addSubview:backgroundYaxis];
-    
-    NSMutableArray *yAxisLabels = [NSMutableArray arrayWithCapacity:0];
-    [yAxisLabelPoints removeAllObjects];
-    
-    NSString *yAxisSuffix = @"";
-    NSString *yAxisPrefix = @"";
+    // Draw Y-Axis Background Area, kept like the X-Axis background
+    if (self.backgroundYAxis == nil) {
+        self.backgroundYAxis = [[UIView alloc] init];
+        self.backgroundYAxis.tag = BackgroundYAxisTag2100;
+    }
+    self.backgroundYAxis.frame = frameForBackgroundYAxis;
+    if (self.colorBackgroundYaxis == nil) self.backgroundYAxis.backgroundColor = self.colorTop;
+    else self.backgroundYAxis.backgroundColor = self.colorBackgroundYaxis;
+    self.backgroundYAxis.alpha = self.alphaBackgroundYaxis;
+    [self addSubview:self.backgroundYAxis];
     
-    if ([self.delegate respondsToSelector:@selector(yAxisPrefixOnLineGraph:)]) yAxisPrefix = [self.delegate yAxisPrefixOnLineGraph:self];
-    if ([self.delegate respondsToSelector:@selector(yAxisSuffixOnLineGraph:)]) yAxisSuffix = [self.delegate yAxisSuffixOnLineGraph:self];
+    // The text and vertical center of every label, the views are created once the overlapping labels are removed
+    NSMutableArray<NSString *> *yAxisTexts = [NSMutableArray array];
+    NSMutableArray<NSNumber *> *yAxisCenters = [NSMutableArray array];
     
     if (self.autoScaleYAxis) {
         // Plot according to min-max range
-        NSNumber *minimumValue;
-        NSNumber *maximumValue;
-
-        minimumValue = [self calculateMinimumPointValue];
-        maximumValue = [self calculateMaximumPointValue];
-        
-        CGFloat numberOfLabels;
-        if ([self.delegate respondsToSelector:@selector(numberOfYAxisLabelsOnLineGraph:)]) {
-            numberOfLabels = [self.delegate numberOfYAxisLabelsOnLineGraph:self];
-        } else numberOfLabels = 3;
-        
-        NSMutableArray *dotValues = [[NSMutableArray alloc] initWithCapacity:numberOfLabels];
-        if ([self.delegate respondsToSelector:@selector(baseValueForYAxisOnLineGraph:)] && [self.delegate respondsToSelector:@selector(incrementValueForYAxisOnLineGraph:)]) {
-            CGFloat baseValue = [self.delegate baseValueForYAxisOnLineGraph:self];
-            CGFloat increment = [self.delegate incrementValueForYAxisOnLineGraph:self];
-            
-            float yAxisPosition = baseValue;
-            if (baseValue + increment * 100 < maximumValue.doubleValue) {
-                NSLog(@"[BEMSimpleLineGraph] Increment does not properly lay out Y axis, bailing early");
-                return;
-            }
-            
-            while(yAxisPosition < maximumValue.floatValue + increment) {
-                [dotValues addObject:@(yAxisPosition)];
-                yAxisPosition += increment;
-            }
-        } else if (numberOfLabels <= 0) return;
-        else if (numberOfLabels == 1) {
-            [dotValues removeAllObjects];
-            [dotValues addObject:[NSNumber numberWithInt:(minimumValue.intValue + maximumValue.intValue)/2]];
-        } else {
-            [dotValues addObject:minimumValue];
-            [dotValues addObject:maximumValue];
-            for (int i=1; i<numberOfLabels-1; i++) {
-                [dotValues addObject:[NSNumber numberWithFloat:(minimumValue.doubleValue + ((maximumValue.doubleValue - minimumValue.doubleValue)/(numberOfLabels-1))*i)]];
-            }
-        }
-        
-        for (NSNumber *dotValue in dotValues) {
-            CGFloat yAxisPosition = [self yPositionForDotValue:dotValue.floatValue];
-            UILabel *labelYAxis = [[UILabel alloc] initWithFrame:frameForLabelYAxis];
-            NSString *formattedValue = [NSString stringWithFormat:self.formatStringForValues, dotValue.doubleValue];
-            labelYAxis.text = [NSString stringWithFormat:@"%@%@%@", yAxisPrefix, formattedValue, yAxisSuffix];
-            labelYAxis.textAlignment = textAlignmentForLabelYAxis;
-            labelYAxis.font = self.labelFont;
-            labelYAxis.textColor = self.colorYaxisLabel;
-            labelYAxis.backgroundColor = [UIColor clearColor];
-            labelYAxis.tag = LabelYAxisTag2000;
-            labelYAxis.center = CGPointMake(xValueForCenterLabelYAxis, yAxisPosition);
-            [self addSubview:labelYAxis];
-            [yAxisLabels addObject:labelYAxis];
-            
-            NSNumber *yAxisLabelCoordinate = @(labelYAxis.center.y);
-            [yAxisLabelPoints addObject:yAxisLabelCoordinate];
+        if (![self layoutYAxisValues]) return;
+        for (size_t i = 0; i < yAxisValueCount; i++) {
+            [yAxisTexts addObject:[self yAxisTextForValue:yAxisValues[i]]];
+            [yAxisCenters addObject:@([self yPositionForDotValue:yAxisValues[i]])];
         }
     } else {
         NSInteger numberOfLabels;
@@ -994,49 +2014,44 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
         for (NSInteger i = numberOfLabels; i > 0; i--) {
             yAxisPosition -= graphSpacing;
             
-            UILabel *labelYAxis = [[UILabel alloc] initWithFrame:frameForLabelYAxis];
-            labelYAxis.center = CGPointMake(xValueForCenterLabelYAxis, yAxisPosition);
-            labelYAxis.text = [NSString stringWithFormat:self.formatStringForValues, (graphHeight - self.XAxisLabelYOffset - yAxisPosition)];
-            labelYAxis.font = self.labelFont;
-            labelYAxis.textAlignment = textAlignmentForLabelYAxis;
-            labelYAxis.textColor = self.colorYaxisLabel;
-            labelYAxis.backgroundColor = [UIColor clearColor];
-            labelYAxis.tag = LabelYAxisTag2000;
-            
-            [self addSubview:labelYAxis];
-            
-            [yAxisLabels addObject:labelYAxis];
-            
-            NSNumber *yAxisLabelCoordinate = @(labelYAxis.center.y);
-            [yAxisLabelPoints addObject:yAxisLabelCoordinate];
+            [yAxisTexts addObject:[NSString stringWithFormat:self.formatStringForValues, (graphHeight - self.XAxisLabelYOffset - yAxisPosition)]];
+            [yAxisCenters addObject:@(yAxisPosition)];
         }
     }
     
-    // Detect overlapped labels
-    __block NSUInteger lastMatchIndex = 0;
-    NSMutableArray *overlapLabels = [NSMutableArray arrayWithCapacity:0];
-    
-    [yAxisLabels enumerateObjectsUsingBlock:^(UILabel *label, NSUInteger idx, BOOL *stop) {
-        
-        if (idx==0) lastMatchIndex = 0;
-        else { // Skip first one
-            UILabel *prevLabel = yAxisLabels[lastMatchIndex];
-            CGRect r = CGRectIntersection(prevLabel.frame, label.frame);
-            if (CGRectIsNull(r)) lastMatchIndex = idx;
-            else [overlapLabels addObject:label]; // overlapped
+    NSUInteger count = yAxisTexts.count;
+    BEMLabelBox *boxes = malloc(sizeof(BEMLabelBox) * (count > 0 ? count : 1));
+    size_t *selected = malloc(sizeof(size_t) * (count > 0 ? count : 1));
+    size_t keptCount = 0;
+    BEMPointBufferRemoveAllPoints(yAxisLabelPoints);
+    if (boxes != NULL && selected != NULL) {
+        for (NSUInteger i = 0; i < count; i++) {
+            CGRect frame = frameForLabelYAxis;
+            frame.origin.x = xValueForCenterLabelYAxis - frame.size.width/2;
+            frame.origin.y = yAxisCenters[i].doubleValue - frame.size.height/2;
+            boxes[i] = BEMLabelBoxFromRect(frame);
+            
+            // Only keep the reference points of the labels that fit into the view
+            if (CGRectContainsRect(self.bounds, frame)) BEMPointBufferAppendPoint(yAxisLabelPoints, 0, CGRectGetMidY(frame));
         }
         
-        // Axis should fit into our own view
-        BOOL fullyContainsLabel = CGRectContainsRect(self.bounds, label.frame);
-        if (!fullyContainsLabel) {
-            [overlapLabels addObject:label];
-            [yAxisLabelPoints removeObject:@(label.center.y)];
-        }
-    }];
+        // Axis should fit into our own view, and a label overlapping the labels added before it is removed
+        keptCount = BEMLabelLayoutSelect(boxes, count, BEMLabelBoxFromRect(self.bounds), BEMLabelAxisVertical, 0, selected);
+    }
     
-    for (UILabel *label in overlapLabels) {
-        [label removeFromSuperview];
+    for (size_t n = 0; n < keptCount; n++) {
+        UILabel *labelYAxis = [self.viewReusePool dequeueViewOfKind:BEMReusableViewKindYAxisLabel class:[UILabel class]];
+        labelYAxis.frame = BEMRectFromLabelBox(boxes[selected[n]]);
+        labelYAxis.text = yAxisTexts[selected[n]];
+        labelYAxis.textAlignment = textAlignmentForLabelYAxis;
+        labelYAxis.font = self.labelFont;
+        labelYAxis.textColor = self.colorYaxisLabel;
+        labelYAxis.backgroundColor = [UIColor clearColor];
+        labelYAxis.tag = LabelYAxisTag2000;
+        [self addSubview:labelYAxis];
     }
+    free(boxes);
+    free(selected);
     
     [self didFinishDrawingIncludingYAxis:YES];  
 }
@@ -1064,7 +2079,7 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
 /// Calculates the optimum offset needed for the Labels to be centered on the X-Axis.
 - (NSInteger)offsetForXAxisWithNumberOfGaps:(NSInteger)numberOfGaps {
     NSInteger leftGap = numberOfGaps - 1;
-    NSInteger rightGap = numberOfPoints - (numberOfGaps*(numberOfPoints/numberOfGaps));
+    NSInteger rightGap = visibleCount - (numberOfGaps*(visibleCount/numberOfGaps));
     NSInteger offset = 0;
     
     if (leftGap != rightGap) {
@@ -1078,13 +2093,9 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     return offset;
 }
 
-- (void)displayPermanentLabelForPoint:(BEMCircle *)circleDot {
+- (void)displayPermanentLabelsForDrawnPoints:(const NSInteger *)drawnIndices count:(NSInteger)count {
+    if (count == 0) return;
     self.enablePopUpReport = NO;
-    self.xCenterLabel = circleDot.center.x;
-    
-    BEMPermanentPopupLabel *permanentPopUpLabel = [[BEMPermanentPopupLabel alloc] init];
-    permanentPopUpLabel.textAlignment = NSTextAlignmentCenter;
-    permanentPopUpLabel.numberOfLines = 0;
     
     NSString *prefix = @"";
     NSString *suffix = @"";
@@ -1094,70 +2105,83 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
 
     if ([self.delegate respondsToSelector:@selector(popUpPrefixForlineGraph:)])
         prefix = [self.delegate popUpPrefixForlineGraph:self];
-
-    int index = (int)(circleDot.tag - DotFirstTag100);
-    NSNumber *value = dataPoints[index]; // @((NSInteger) circleDot.absoluteValue)
-    NSString *formattedValue = [NSString stringWithFormat:self.formatStringForValues, value.doubleValue];
-    permanentPopUpLabel.text = [NSString stringWithFormat:@"%@%@%@", prefix, formattedValue, suffix];
-    
-    permanentPopUpLabel.font = self.labelFont;
-    permanentPopUpLabel.backgroundColor = [UIColor clearColor];
-    [permanentPopUpLabel sizeToFit];
-    permanentPopUpLabel.center = CGPointMake(self.xCenterLabel, circleDot.center.y - circleDot.frame.size.height/2 - 15);
-    permanentPopUpLabel.alpha = 0;
-    
-    BEMPermanentPopupView *permanentPopUpView = [[BEMPermanentPopupView alloc] initWithFrame:CGRectMake(0, 0, permanentPopUpLabel.frame.size.width + 7, permanentPopUpLabel.frame.size.height + 2)];
-    permanentPopUpView.backgroundColor = self.colorBackgroundPopUplabel;
-    permanentPopUpView.alpha = 0;
-    permanentPopUpView.layer.cornerRadius = 3;
-    permanentPopUpView.tag = PermanentPopUpViewTag3100;
-    permanentPopUpView.center = permanentPopUpLabel.center;
-    
-    if (permanentPopUpLabel.frame.origin.x <= 0) {
-        self.xCenterLabel = permanentPopUpLabel.frame.size.width/2 + 4;
-        permanentPopUpLabel.center = CGPointMake(self.xCenterLabel, circleDot.center.y - circleDot.frame.size.height/2 - 15);
-    } else if (self.enableYAxisLabel == YES && permanentPopUpLabel.frame.origin.x <= self.YAxisLabelXOffset) {
-        self.xCenterLabel = permanentPopUpLabel.frame.size.width/2 + 4;
-        permanentPopUpLabel.center = CGPointMake(self.xCenterLabel + self.YAxisLabelXOffset, circleDot.center.y - circleDot.frame.size.height/2 - 15);
-    } else if ((permanentPopUpLabel.frame.origin.x + permanentPopUpLabel.frame.size.width) >= self.frame.size.width) {
-        self.xCenterLabel = self.frame.size.width - permanentPopUpLabel.frame.size.width/2 - 4;
-        permanentPopUpLabel.center = CGPointMake(self.xCenterLabel, circleDot.center.y - circleDot.frame.size.height/2 - 15);
-    }
     
-    if (permanentPopUpLabel.frame.origin.y <= 2) {
-        permanentPopUpLabel.center = CGPointMake(self.xCenterLabel, circleDot.center.y + circleDot.frame.size.height/2 + 15);
+    // The frames of every popup above and below its point are computed first, then placed together without overlapping
+    NSMutableArray<NSString *> *texts = [NSMutableArray arrayWithCapacity:count];
+    BEMLabelBox *aboveBoxes = malloc(sizeof(BEMLabelBox) * count);
+    BEMLabelBox *belowBoxes = malloc(sizeof(BEMLabelBox) * count);
+    bool *isBelow = malloc(sizeof(bool) * count);
+    if (aboveBoxes == NULL || belowBoxes == NULL || isBelow == NULL) {
+        free(aboveBoxes);
+        free(belowBoxes);
+        free(isBelow);
+        return;
     }
     
-    if ([self checkOverlapsForView:permanentPopUpView] == YES) {
-        permanentPopUpLabel.center = CGPointMake(self.xCenterLabel, circleDot.center.y + circleDot.frame.size.height/2 + 15);
+    for (NSInteger n = 0; n < count; n++) {
+        CGPoint dotCenter = [self centerOfDrawnPoint:drawnIndices[n]];
+        NSInteger index = [self indexOfDrawnPoint:drawnIndices[n]];
+        NSString *formattedValue = [NSString stringWithFormat:self.formatStringForValues, values[index]];
+        NSString *text = [NSString stringWithFormat:@"%@%@%@", prefix, formattedValue, suffix];
+        [texts addObject:text];
+        
+        // The popup is the label with a margin, kept inside of the graph horizontally
+        CGSize labelSize = [self sizeOfLabelText:text];
+        CGSize popUpSize = CGSizeMake(ceil(labelSize.width) + 7, ceil(labelSize.height) + 2);
+        CGFloat xCenter = dotCenter.x;
+        if (xCenter - ceil(labelSize.width)/2 <= 0) {
+            xCenter = ceil(labelSize.width)/2 + 4;
+        } else if (self.enableYAxisLabel == YES && xCenter - ceil(labelSize.width)/2 <= self.YAxisLabelXOffset) {
+            xCenter = ceil(labelSize.width)/2 + 4 + self.YAxisLabelXOffset;
+        } else if (xCenter + ceil(labelSize.width)/2 >= self.frame.size.width) {
+            xCenter = self.frame.size.width - ceil(labelSize.width)/2 - 4;
+        }
+        
+        CGPoint aboveCenter = CGPointMake(xCenter, dotCenter.y - self.sizePoint/2 - 15);
+        CGPoint belowCenter = CGPointMake(xCenter, dotCenter.y + self.sizePoint/2 + 15);
+        aboveBoxes[n] = BEMLabelBoxFromRect(CGRectMake(aboveCenter.x - popUpSize.width/2, aboveCenter.y - popUpSize.height/2, popUpSize.width, popUpSize.height));
+        belowBoxes[n] = BEMLabelBoxFromRect(CGRectMake(belowCenter.x - popUpSize.width/2, belowCenter.y - popUpSize.height/2, popUpSize.width, popUpSize.height));
     }
     
-    permanentPopUpView.center = permanentPopUpLabel.center;
-    
-    [self addSubview:permanentPopUpView];
-    [self addSubview:permanentPopUpLabel];
+    // A popup goes below its point when its label would touch the top of the graph, or overlap a popup on its left
+    BEMLabelLayoutPlacePopups(aboveBoxes, belowBoxes, count, 1, isBelow);
     
-    if (self.animationGraphEntranceTime == 0) {
-        permanentPopUpLabel.alpha = 1;
-        permanentPopUpView.alpha = 0.7;
-    } else {
-        [UIView animateWithDuration:0.5 delay:self.animationGraphEntranceTime options:UIViewAnimationOptionCurveLinear animations:^{
+    for (NSInteger n = 0; n < count; n++) {
+        CGRect popUpFrame = BEMRectFromLabelBox(isBelow[n] ? belowBoxes[n] : aboveBoxes[n]);
+        
+        BEMPermanentPopupView *permanentPopUpView = [self.viewReusePool dequeueViewOfKind:BEMReusableViewKindPopUpView class:[BEMPermanentPopupView class]];
+        permanentPopUpView.frame = popUpFrame;
+        permanentPopUpView.backgroundColor = self.colorBackgroundPopUplabel;
+        permanentPopUpView.alpha = 0;
+        permanentPopUpView.layer.cornerRadius = 3;
+        permanentPopUpView.tag = PermanentPopUpViewTag3100;
+        
+        BEMPermanentPopupLabel *permanentPopUpLabel = [self.viewReusePool dequeueViewOfKind:BEMReusableViewKindPopUpLabel class:[BEMPermanentPopupLabel class]];
+        permanentPopUpLabel.frame = CGRectInset(popUpFrame, 3.5, 1);
+        permanentPopUpLabel.textAlignment = NSTextAlignmentCenter;
+        permanentPopUpLabel.numberOfLines = 0;
+        permanentPopUpLabel.text = texts[n];
+        permanentPopUpLabel.font = self.labelFont;
+        permanentPopUpLabel.backgroundColor = [UIColor clearColor];
+        permanentPopUpLabel.alpha = 0;
+        
+        [self addSubview:permanentPopUpView];
+        [self addSubview:permanentPopUpLabel];
+        
+        if (self.animationGraphEntranceTime == 0) {
             permanentPopUpLabel.alpha = 1;
             permanentPopUpView.alpha = 0.7;
-        } completion:nil];
-    }
-}
-
-- (BOOL)checkOverlapsForView:(UIView *)view {
-    for (UIView *viewForLabel in [self subviews]) {
-        if ([viewForLabel isKindOfClass:[UIView class]] && viewForLabel.tag == PermanentPopUpViewTag3100 ) {
-            if ((viewForLabel.frame.origin.x + viewForLabel.frame.size.width) >= view.frame.origin.x) {
-                if (viewForLabel.frame.origin.y >= view.frame.origin.y && viewForLabel.frame.origin.y <= view.frame.origin.y + view.frame.size.height) return YES;
-                else if (viewForLabel.frame.origin.y + viewForLabel.frame.size.height >= view.frame.origin.y && viewForLabel.frame.origin.y + viewForLabel.frame.size.height <= view.frame.origin.y + view.frame.size.height) return YES;
-            }
+        } else {
+            [UIView animateWithDuration:0.5 delay:self.animationGraphEntranceTime options:UIViewAnimationOptionCurveLinear animations:^{
+                permanentPopUpLabel.alpha = 1;
+                permanentPopUpView.alpha = 0.7;
+            } completion:nil];
         }
     }
-    return NO;
+    
+    free(aboveBoxes);
+    free(belowBoxes);
+    free(isBelow);
 }
 
 - (UIImage *)graphSnapshotImage {
@@ -1179,95 +2203,691 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
 #pragma mark - Data Source
 
 - (void)reloadGraph {
-    for (UIView *subviews in self.subviews) {
-        [subviews removeFromSuperview];
-    }
-    [self drawGraph];
-//    [self setNeedsLayout];
+    // The asynchronous reloads in progress would apply older values
+    __atomic_add_fetch(&reloadGeneration, 1, __ATOMIC_RELAXED);
+    
+    // The data source provides the values again
+    BEMValueWindowFree(streamedValues);
+    streamedValues = NULL;
+    
+    [self redrawGraph];
 }
 
-#pragma mark - Calculations
-
-- (NSArray *)calculationDataPoints {
-    NSPredicate *filter = [NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
-        NSNumber *value = (NSNumber *)evaluatedObject;
-        BOOL retVal = ![value isEqualToNumber:@(BEMNullGraphValue)];
-        return retVal;
-    }];
-    NSArray *filteredArray = [dataPoints filteredArrayUsingPredicate:filter];
-    return filteredArray;
+- (void)reloadGraphAsynchronously {
+    [self reloadGraphAsynchronouslyWithCompletion:nil];
 }
 
-- (NSNumber *)calculatePointValueAverage {
-    NSArray *filteredArray = [self calculationDataPoints];
-    if (filteredArray.count == 0) return [NSNumber numberWithInt:0];
+- (BOOL)loadSeriesFileAtPath:(NSString *)path error:(NSError **)error {
+    BEMSeriesFileRef file = BEMSeriesFileOpen(path.fileSystemRepresentation);
+    if (file == NULL) {
+        if (error) *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSFilePathErrorKey: path}];
+        return NO;
+    }
     
-    NSExpression *expression = [NSExpression expressionForFunction:@"average:" arguments:@[[NSExpression expressionForConstantValue:filteredArray]]];
-    NSNumber *value = [expression expressionValueWithObject:nil context:nil];
+    // The asynchronous reloads in progress would replace the file, and the trees may borrow the previous one
+    __atomic_add_fetch(&reloadGeneration, 1, __ATOMIC_RELAXED);
+    BEMValueWindowFree(streamedValues);
+    streamedValues = NULL;
+    [self closeSeriesFile];
+    seriesFile = file;
     
-    return value;
+    [self redrawGraph];
+    return YES;
 }
 
-- (NSNumber *)calculatePointValueSum {
-    NSArray *filteredArray = [self calculationDataPoints];
-    if (filteredArray.count == 0) return [NSNumber numberWithInt:0];
-    
-    NSExpression *expression = [NSExpression expressionForFunction:@"sum:" arguments:@[[NSExpression expressionForConstantValue:filteredArray]]];
-    NSNumber *value = [expression expressionValueWithObject:nil context:nil];
-    
-    return value;
+- (void)unloadSeriesFile {
+    if (seriesFile == NULL) return;
+    [self closeSeriesFile];
+    [self redrawGraph];
 }
 
-- (NSNumber *)calculatePointValueMedian {
-    NSArray *filteredArray = [self calculationDataPoints];
-    if (filteredArray.count == 0) return [NSNumber numberWithInt:0];
-    
-    NSExpression *expression = [NSExpression expressionForFunction:@"median:" arguments:@[[NSExpression expressionForConstantValue:filteredArray]]];
-    NSNumber *value = [expression expressionValueWithObject:nil context:nil];
-    
-    return value;
+/// Unmaps the series file, once nothing reads from it anymore
+- (void)closeSeriesFile {
+    if (seriesFile == NULL) return;
+    if (values == seriesFile->values) values = NULL;
+    [self freeValueTrees];
+    BEMSeriesFileClose(seriesFile);
+    seriesFile = NULL;
 }
 
-- (NSNumber *)calculatePointValueMode {
-    NSArray *filteredArray = [self calculationDataPoints];
-    if (filteredArray.count == 0) return [NSNumber numberWithInt:0];
-    
-    NSExpression *expression = [NSExpression expressionForFunction:@"mode:" arguments:@[[NSExpression expressionForConstantValue:filteredArray]]];
-    NSMutableArray *value = [expression expressionValueWithObject:nil context:nil];
+- (void)reloadGraphAsynchronouslyWithCompletion:(void (^)(BOOL applied))completion {
+    // The reloads started before this one are dropped when they are done
+    NSUInteger generation = __atomic_add_fetch(&reloadGeneration, 1, __ATOMIC_RELAXED);
     
-    return [value firstObject];
-}
-
-- (NSNumber *)calculateLineGraphStandardDeviation {
-    NSArray *filteredArray = [self calculationDataPoints];
-    if (filteredArray.count == 0) return [NSNumber numberWithInt:0];
+#if !TARGET_INTERFACE_BUILDER
+    // The deprecated delegate methods are only supported by the synchronous reload
+    id<BEMSimpleLineGraphDataSource> dataSource = self.dataSource;
+    BOOL dataSourceProvidesValues = [dataSource respondsToSelector:@selector(numberOfPointsInLineGraph:)] && ([dataSource respondsToSelector:@selector(lineGraph:valueForPointAtIndex:)] || [dataSource respondsToSelector:@selector(lineGraph:valueForPointAtIndex:inSeries:)]);
+#else
+    BOOL dataSourceProvidesValues = NO;
+#endif
+    if (!dataSourceProvidesValues || seriesFile) {
+        [self reloadGraph];
+        if (completion) completion(YES);
+        return;
+    }
     
-    NSExpression *expression = [NSExpression expressionForFunction:@"stddev:" arguments:@[[NSExpression expressionForConstantValue:filteredArray]]];
-    NSNumber *value = [expression expressionValueWithObject:nil context:nil];
+    BEMGraphSnapshotLayout layout = [self snapshotLayout];
+    if (reloadQueue == nil) {
+        reloadQueue = dispatch_queue_create("BEMSimpleLineGraph.reload", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0));
+    }
     
-    return value;
+    __weak BEMSimpleLineGraphView *weakSelf = self;
+    dispatch_async(reloadQueue, ^{
+        BEMSimpleLineGraphView *graph = weakSelf;
+        BEMGraphSnapshot *snapshot = [graph snapshotWithLayout:layout generation:generation];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (graph) [graph applyGraphSnapshot:snapshot generation:generation completion:completion];
+            else if (completion) completion(NO);
+        });
+    });
 }
 
-- (NSNumber *)calculateMinimumPointValue {
-    NSArray *filteredArray = [self calculationDataPoints];
-    if (filteredArray.count == 0) return [NSNumber numberWithInt:0];
-    
-    NSExpression *expression = [NSExpression expressionForFunction:@"min:" arguments:@[[NSExpression expressionForConstantValue:filteredArray]]];
-    NSNumber *value = [expression expressionValueWithObject:nil context:nil];
-    return value;
+/// YES if a reload started after the reload of \p generation. Called on the reload queue.
+- (BOOL)reloadIsSuperseded:(NSUInteger)generation {
+    return __atomic_load_n(&reloadGeneration, __ATOMIC_RELAXED) != generation;
 }
 
-- (NSNumber *)calculateMaximumPointValue {
-    NSArray *filteredArray = [self calculationDataPoints];
-    if (filteredArray.count == 0) return [NSNumber numberWithInt:0];
+/// The layout the points of an asynchronous reload are prepared for, which is the current layout of the graph. Called on the main thread.
+- (BEMGraphSnapshotLayout)snapshotLayout {
+    BEMGraphSnapshotLayout layout = {0};
+    layout.buildsTrees = self.enableZooming || _visibleIndexRange.length > 0;
+    
+    // Extremes provided by the delegate may depend on the new values, the scale is only known once they are applied
+    layout.preparesPoints = ![self.delegate respondsToSelector:@selector(maxValueForLineGraph:)] && ![self.delegate respondsToSelector:@selector(minValueForLineGraph:)];
+    layout.scale = [self graphScale];
     
-    NSExpression *expression = [NSExpression expressionForFunction:@"max:" arguments:@[[NSExpression expressionForConstantValue:filteredArray]]];
-    NSNumber *value = [expression expressionValueWithObject:nil context:nil];
+    // Before the first load, the X-Axis labels are expected to be one line high
+    if (xAxisValues.count == 0 && self.enableXAxisLabel && ([self.dataSource respondsToSelector:@selector(lineGraph:labelOnXAxisForIndex:)] || [self.dataSource respondsToSelector:@selector(labelOnXAxisForIndex:)])) {
+        layout.scale.xAxisLabelHeight = [self sizeOfLabelText:@"0"].height + self.widthLine;
+    }
     
-    return value;
+    CGRect graphArea = [self drawableGraphArea];
+    layout.width = self.frame.size.width - self.YAxisLabelXOffset;
+    layout.maximumDrawnCount = (size_t)MAX(2 * graphArea.size.width, 0);
+    layout.lineDecimation = self.lineDecimation;
+    layout.lineSize = graphArea.size;
+    layout.curve = (self.enableBezierCurve && !self.displayDotsOnly) ? self.curveInterpolation : BEMCurveInterpolationNone;
+    layout.nullValueFill = [self drawnNullValueFill];
+    return layout;
 }
 
-
+/// Fetches the values from the data source and prepares everything derived from them. Called on the reload queue. Returns nil if the reload was superseded, or if the values can only be fetched by the synchronous reload.
+- (BEMGraphSnapshot *)snapshotWithLayout:(BEMGraphSnapshotLayout)layout generation:(NSUInteger)generation {
+    id<BEMSimpleLineGraphDataSource> dataSource = self.dataSource;
+    if (dataSource == nil || [self reloadIsSuperseded:generation]) return nil;
+    CFTimeInterval fetchStartTime = CACurrentMediaTime();
+    
+    NSInteger count = MAX([dataSource numberOfPointsInLineGraph:self], 0);
+    NSInteger seriesCount = 1;
+    if ([dataSource respondsToSelector:@selector(numberOfSeriesInLineGraph:)]) {
+        seriesCount = MAX(1, [dataSource numberOfSeriesInLineGraph:self]);
+    }
+    BEMGraphSnapshot *snapshot = [[BEMGraphSnapshot alloc] initWithNumberOfPoints:count numberOfSeries:seriesCount];
+    if (snapshot == nil) return nil;
+    
+    // The buffers of the data source are copied, they may change as soon as this method returns
+    for (NSInteger s = 0; s < seriesCount; s++) {
+        if ([self reloadIsSuperseded:generation]) return nil;
+        
+        double *seriesValues = [snapshot valuesOfSeries:s];
+        const double *buffer = NULL;
+        if (s == 0 && [dataSource respondsToSelector:@selector(valuesForLineGraph:)]) {
+            buffer = [dataSource valuesForLineGraph:self];
+        }
+        if (buffer == NULL && [dataSource respondsToSelector:@selector(lineGraph:valuesForSeries:)]) {
+            buffer = [dataSource lineGraph:self valuesForSeries:s];
+        }
+        
+        if (buffer) {
+            if (count > 0) memcpy(seriesValues, buffer, sizeof(double) * count);
+        } else if ([dataSource respondsToSelector:@selector(lineGraph:valueForPointAtIndex:inSeries:)]) {
+            for (NSInteger i = 0; i < count; i++) {
+                seriesValues[i] = [dataSource lineGraph:self valueForPointAtIndex:i inSeries:s];
+            }
+        } else if (s == 0) {
+            for (NSInteger i = 0; i < count; i++) {
+                seriesValues[i] = [dataSource lineGraph:self valueForPointAtIndex:i];
+            }
+        } else return nil;
+    }
+    
+    if ([self reloadIsSuperseded:generation]) return nil;
+    snapshot.fetchDuration = CACurrentMediaTime() - fetchStartTime;
+    [snapshot prepareWithLayout:layout];
+    return snapshot;
+}
+
+/// Draws the graph with the values of a snapshot in one pass, unless a later reload superseded it. Called on the main thread.
+- (void)applyGraphSnapshot:(BEMGraphSnapshot *)snapshot generation:(NSUInteger)generation completion:(void (^)(BOOL applied))completion {
+    if (generation != reloadGeneration) {
+        if (completion) completion(NO);
+        return;
+    }
+    
+    if (snapshot) {
+        BEMValueWindowFree(streamedValues);
+        streamedValues = NULL;
+        
+        appliedSnapshot = snapshot;
+        [self redrawGraph];
+        appliedSnapshot = nil;
+    } else {
+        // The synchronous reload fetches the values the reload queue couldn't, and reports the missing data source methods
+        [self reloadGraph];
+    }
+    if (completion) completion(YES);
+}
+
+/// The kind of a view drawn by the graph which can be reused, or NSNotFound
+- (NSInteger)reusableKindOfView:(UIView *)view {
+    if ([view isKindOfClass:[BEMCircle class]]) return BEMReusableViewKindDot;
+    if ([view isKindOfClass:[BEMPermanentPopupView class]]) return BEMReusableViewKindPopUpView;
+    if ([view isKindOfClass:[BEMPermanentPopupLabel class]]) return BEMReusableViewKindPopUpLabel;
+    if ([view isMemberOfClass:[UILabel class]] && view.tag == DotLastTag1000) return BEMReusableViewKindXAxisLabel;
+    if ([view isMemberOfClass:[UILabel class]] && view.tag == LabelYAxisTag2000) return BEMReusableViewKindYAxisLabel;
+    return NSNotFound;
+}
+
+- (void)redrawGraph {
+    // Every stage is drawn again
+    dirtyStages = BEMGraphStageNone;
+    
+    // The labels, popups and dots are kept to be reconfigured by the stages drawing them
+    [self recycleXAxisLabels];
+    for (UIView *subview in self.subviews) {
+        NSInteger kind = [self reusableKindOfView:subview];
+        if (kind != NSNotFound) [self.viewReusePool enqueueView:subview ofKind:kind];
+        else [subview removeFromSuperview];
+    }
+    [dotViews removeAllObjects];
+    [self.dotsLayer removeFromSuperlayer];
+    self.dotsLayer = nil;
+    [self drawGraph];
+//    [self setNeedsLayout];
+}
+
+#pragma mark - Streaming
+
+- (void)appendPoints:(NSArray<NSNumber *> *)points {
+    if (points.count == 0) return;
+    if (![self startStreaming]) return;
+    
+    double *appendedValues = malloc(sizeof(double) * points.count);
+    if (appendedValues == NULL) return;
+    for (NSUInteger i = 0; i < points.count; i++) {
+        appendedValues[i] = points[i].doubleValue;
+    }
+    BOOL didAppend = BEMValueWindowAppendValues(streamedValues, appendedValues, points.count);
+    free(appendedValues);
+    
+    if (didAppend) [self setNeedsUpdateOfStreamedPointsRemovingPoints:0];
+}
+
+- (void)removePointsFromStart:(NSInteger)count {
+    if (count <= 0) return;
+    if (![self startStreaming]) return;
+    
+    NSInteger removedCount = MIN(count, (NSInteger)streamedValues->count);
+    BEMValueWindowRemoveValuesFromStart(streamedValues, removedCount);
+    [self setNeedsUpdateOfStreamedPointsRemovingPoints:removedCount];
+}
+
+/// Moves the values of the last load into a window owned by the graph. Returns NO if the memory could not be allocated.
+- (BOOL)startStreaming {
+    if (streamedValues) return YES;
+    
+    // Values are only fetched while drawing, a graph which wasn't drawn yet streams from an empty window
+    NSInteger loadedCount = values ? numberOfPoints : 0;
+    streamedValues = BEMValueWindowCreate(MAX(loadedCount, 16), BEMNullGraphValue);
+    if (streamedValues == NULL) return NO;
+    if (loadedCount > 0 && !BEMValueWindowAppendValues(streamedValues, values, loadedCount)) {
+        BEMValueWindowFree(streamedValues);
+        streamedValues = NULL;
+        return NO;
+    }
+    values = streamedValues->values;
+    
+    // The values of a series file were copied, the window replaces it
+    [self closeSeriesFile];
+    return YES;
+}
+
+- (void)layoutStreamedValues {
+    // The trees borrow the previous values, and streamed graphs show every point
+    [self freeValueTrees];
+    values = streamedValues->values;
+    timestamps = NULL;
+    
+    // Only the first series is streamed
+    _numberOfSeries = 1;
+    
+    double minValue, maxValue;
+    if (BEMValueWindowGetExtremes(streamedValues, &minValue, &maxValue)) {
+        dataMinValue = minValue;
+        dataMaxValue = maxValue;
+    } else {
+        dataMinValue = INFINITY;
+        dataMaxValue = -FLT_MAX;
+    }
+    [self layoutVisibleRange];
+}
+
+/// Updates the values, the statistics and the visible extremes for the points appended or removed, and draws the points at the next layout pass. Points appended and removed in the same pass are drawn at once.
+- (void)setNeedsUpdateOfStreamedPointsRemovingPoints:(NSInteger)removedCount {
+    // The positions of the previous points can only be reused if every point was mapped
+    if (!streamedPointsNeedUpdate) {
+        streamedPointsWereDrawn = linePoints != NULL && values != NULL && !linePointsAreEnvelope && visibleStart == 0 && visibleCount == numberOfPoints;
+    }
+    streamedPointsNeedUpdate = YES;
+    pendingStreamedRemovedCount += removedCount;
+    
+    numberOfPoints = streamedValues->count;
+    statisticsAreValid = NO;
+    closestDrawnIndex = NSNotFound;
+    [self layoutStreamedValues];
+    [self setNeedsLayout];
+}
+
+/// Draws the points appended or removed since the streamed points were last drawn. As long as the scale doesn't change, the y positions of the points already in the graph are reused: the points slide when as many points were appended as removed, otherwise they are packed again and the line, the dots and the X-Axis are drawn again, without animation. A new scale updates the scale, geometry and axes stages.
+- (void)updateStreamedPointsIfNeeded {
+    if (!streamedPointsNeedUpdate) return;
+    NSInteger removedCount = pendingStreamedRemovedCount;
+    streamedPointsNeedUpdate = NO;
+    pendingStreamedRemovedCount = 0;
+    
+    // A reload drew the values of the data source again
+    if (streamedValues == NULL) return;
+    
+    if (!streamedPointsWereDrawn || linePoints == NULL || linePoints->count <= 1 || numberOfPoints <= 1) {
+        [self redrawGraph];
+        return;
+    }
+    
+    // A new scale moves every point: the stale stages map the points again and lay out the axes, the graph isn't reloaded
+    if ([self getMaximumValue] != self.maxValue || [self getMinimumValue] != self.minValue) {
+        dirtyStages |= BEMGraphStageScale;
+        [self updateStaleStages];
+        return;
+    }
+    
+    // The points slide to the left, there is nothing to animate in
+    CGFloat animationGraphEntranceTime = self.animationGraphEntranceTime;
+    _animationGraphEntranceTime = 0;
+    
+    if (![self slideStreamedPointsRemovingPoints:removedCount]) {
+        isUpdatingStreamedPoints = YES;
+        streamedRemovedCount = removedCount;
+        
+        [self drawXAxis];
+        [self drawDots];
+        
+        isUpdatingStreamedPoints = NO;
+        streamedRemovedCount = 0;
+    }
+    _animationGraphEntranceTime = animationGraphEntranceTime;
+}
+
+/** Slides the drawn points to the left after as many points were appended as removed, which keeps the transform of the points. Returns NO, leaving the graph unchanged, if the points must be packed again.
+ @discussion The points left keep their position in a new buffer and only the new points are placed. The line appends the segments to the new points and moves its paths to the left, the dots of the points which slid out are moved to the new points. */
+- (BOOL)slideStreamedPointsRemovingPoints:(NSInteger)removedCount {
+    NSInteger count = linePoints->count;
+    if (removedCount <= 0 || removedCount >= count || count != visibleCount || decimatedPoints || timestamps) return NO;
+    if (self.dotRendering == BEMDotRenderingViews && (NSInteger)dotViews.count != count) return NO;
+    
+    // Permanent popups, the average line and the lines of other series are placed from every point
+    if (self.alwaysDisplayPopUpLabels || self.averageLine.enableAverageLine || additionalLines.count > 0) return NO;
+    
+    BEMGraphScale scale = [self graphScale];
+    BEMGraphTransform transform = BEMGraphTransformMake(&scale, self.frame.size.width - self.YAxisLabelXOffset, visibleCount);
+    if (!BEMGraphTransformEqualToTransform(&transform, &pointTransform)) return NO;
+    
+    NSInteger keptCount = count - removedCount;
+    BEMPointBufferRef slidPoints = BEMPointBufferCreate(count);
+    if (slidPoints == NULL) return NO;
+    memcpy(slidPoints->x, linePoints->x, sizeof(float) * count);
+    memcpy(slidPoints->y, linePoints->y + removedCount, sizeof(float) * keptCount);
+    BEMGraphTransformPoints(&pointTransform, values + visibleStart + keptCount, removedCount, BEMNullGraphValue, keptCount, slidPoints->x + keptCount, slidPoints->y + keptCount);
+    slidPoints->count = count;
+    
+    // The line keeps its points when it can't slide, they are then packed again
+    if (![graphLine slideToPoints:slidPoints removingPoints:removedCount]) {
+        BEMPointBufferRelease(slidPoints);
+        return NO;
+    }
+    BEMPointBufferRelease(linePoints);
+    linePoints = slidPoints;
+    
+    // The x coordinates didn't change, the lookup is only built again if it left out missing points which slid out, a line which slides has none
+    if (pointLookup == NULL || pointLookup->count != (size_t)count) {
+        BEMPointLookupFree(pointLookup);
+        pointLookup = BEMPointLookupCreate(linePoints);
+    }
+    
+    BOOL dotsAreDisplayed = self.alwaysDisplayDots == YES || self.displayDotsOnly == YES;
+    if (self.dotRendering == BEMDotRenderingLayer) {
+        self.dotsLayer.pointBuffer = linePoints;
+        [self.dotsLayer setAlphaForAllDots:dotsAreDisplayed ? 1.0 : 0];
+    } else {
+        // No dot is created or removed, the dots of the points which slid out are moved to the new points
+        NSRange removedRange = NSMakeRange(0, removedCount);
+        NSArray *slidOutDots = [dotViews subarrayWithRange:removedRange];
+        [dotViews removeObjectsInRange:removedRange];
+        [dotViews addObjectsFromArray:slidOutDots];
+        for (NSInteger n = 0; n < count; n++) {
+            NSInteger i = visibleStart + n;
+            BEMCircle *dot = dotViews[n];
+            if (![dot isKindOfClass:[BEMCircle class]]) {
+                // The point which slid out was missing
+                dot = [self.viewReusePool dequeueViewOfKind:BEMReusableViewKindDot class:[BEMCircle class]];
+                dot.frame = CGRectMake(0, 0, self.sizePoint, self.sizePoint);
+                dot.Pointcolor = self.colorPoint;
+                [self addSubview:dot];
+                dotViews[n] = dot;
+            }
+            if (n >= keptCount) {
+                dot.absoluteValue = values[i];
+                dot.alpha = dotsAreDisplayed ? 1.0 : 0;
+            }
+            dot.center = [self centerOfDrawnPoint:n];
+            dot.tag = i + DotFirstTag100 < DotLastTag1000 ? i + DotFirstTag100 : 0;
+        }
+    }
+    
+    // The X-Axis labels are asked by index, their texts change as the points slide
+    if (self.enableXAxisLabel) {
+        [self drawXAxis];
+        [self sendSubviewToBack:self.backgroundXAxis];
+    }
+    
+    [self didFinishDrawingIncludingYAxis:NO];
+    return YES;
+}
+
+#pragma mark - Viewport
+
+- (NSRange)visibleIndexRange {
+    return [self clampedVisibleIndexRange:_visibleIndexRange];
+}
+
+- (void)setVisibleIndexRange:(NSRange)visibleIndexRange {
+    _visibleIndexRange = visibleIndexRange;
+    
+    // The data didn't change, only the visible slice is drawn again
+    [self setNeedsUpdateOfStages:BEMGraphStageScale | BEMGraphStageGeometry | BEMGraphStageAxes];
+}
+
+/// The range of points actually displayed for a requested range: every point for a range of length 0 or while streaming, at least 2 points, and never past the last point
+- (NSRange)clampedVisibleIndexRange:(NSRange)range {
+    NSInteger count = MAX(numberOfPoints, 0);
+    if (streamedValues || range.length == 0 || count <= 2) return NSMakeRange(0, count);
+    
+    NSInteger length = MIN(MAX((NSInteger)MIN(range.length, (NSUInteger)NSIntegerMax), 2), count);
+    NSInteger location = MIN((NSInteger)MIN(range.location, (NSUInteger)NSIntegerMax), count - length);
+    return NSMakeRange(location, length);
+}
+
+/// Resolves the visible range against the loaded points, and finds the extremes of the visible points of every series
+- (void)layoutVisibleRange {
+    NSRange range = self.visibleIndexRange;
+    visibleStart = range.location;
+    visibleCount = range.length;
+    
+    // The trees are built once per load, the first time the graph can zoom
+    if (valueTree == NULL && values != NULL && streamedValues == NULL && (self.enableZooming || visibleCount < numberOfPoints)) {
+        [self buildValueTrees];
+    }
+    
+    visibleMinValue = dataMinValue;
+    visibleMaxValue = dataMaxValue;
+    if (visibleCount == numberOfPoints || values == NULL) return;
+    
+    // O(log n) per series with the trees, whatever the number of visible points
+    CGFloat minValue = INFINITY;
+    CGFloat maxValue = -FLT_MAX;
+    BEMExtendExtremesInRange(values, valueTree, visibleStart, visibleCount, &minValue, &maxValue);
+    for (NSInteger s = 0; s < self.numberOfSeries - 1; s++) {
+        BEMExtendExtremesInRange(additionalSeries[s].values, additionalSeries[s].tree, visibleStart, visibleCount, &minValue, &maxValue);
+    }
+    visibleMinValue = minValue;
+    visibleMaxValue = maxValue;
+}
+
+- (void)buildValueTrees {
+    valueTreesAreBorrowed = NO;
+    valueTree = BEMRangeTreeCreate(values, numberOfPoints, BEMNullGraphValue);
+    for (NSInteger s = 0; s < self.numberOfSeries - 1; s++) {
+        additionalSeries[s].tree = BEMRangeTreeCreate(additionalSeries[s].values, numberOfPoints, BEMNullGraphValue);
+    }
+}
+
+- (void)freeValueTrees {
+    // The trees of an asynchronous reload belong to its snapshot
+    if (!valueTreesAreBorrowed) BEMRangeTreeFree(valueTree);
+    valueTree = NULL;
+    for (NSInteger s = 0; s < additionalSeriesCapacity; s++) {
+        if (!valueTreesAreBorrowed) BEMRangeTreeFree(additionalSeries[s].tree);
+        additionalSeries[s].tree = NULL;
+    }
+    valueTreesAreBorrowed = NO;
+}
+
+- (void)layoutZoomGestures {
+    if (self.enableZooming && self.zoomPinchGesture == nil) {
+        self.zoomPinchGesture = [[UIPinchGestureRecognizer alloc] initWithTarget:self action:@selector(handleZoomPinchGesture:)];
+        [self addGestureRecognizer:self.zoomPinchGesture];
+        
+        self.zoomPanGesture = [[UIPanGestureRecognizer alloc] initWithTarget:self action:@selector(handleZoomPanGesture:)];
+        [self addGestureRecognizer:self.zoomPanGesture];
+    }
+    
+    // A single finger reports touches when the touch report is enabled
+    self.zoomPanGesture.minimumNumberOfTouches = (self.enableTouchReport || self.enablePopUpReport) ? 2 : 1;
+    self.zoomPinchGesture.enabled = self.enableZooming;
+    self.zoomPanGesture.enabled = self.enableZooming;
+}
+
+- (void)handleZoomPinchGesture:(UIPinchGestureRecognizer *)recognizer {
+    if (recognizer.state == UIGestureRecognizerStateBegan) gestureStartRange = self.visibleIndexRange;
+    if (recognizer.state != UIGestureRecognizerStateChanged || recognizer.scale <= 0 || gestureStartRange.length < 2) return;
+    
+    // The point under the fingers stays under the fingers
+    CGRect graphArea = [self drawableGraphArea];
+    if (graphArea.size.width <= 0) return;
+    CGFloat anchor = MIN(MAX(([recognizer locationInView:self].x - graphArea.origin.x) / graphArea.size.width, 0), 1);
+    CGFloat anchorIndex = gestureStartRange.location + anchor * (gestureStartRange.length - 1);
+    if (timestamps) {
+        // Timestamped points are not evenly spaced, the point under the fingers is found from its time
+        double startTime = timestamps[gestureStartRange.location];
+        double anchorTime = startTime + anchor * (timestamps[NSMaxRange(gestureStartRange) - 1] - startTime);
+        anchorIndex = BEMTimeAxisIndexOfTime(timestamps, numberOfPoints, anchorTime);
+    }
+    NSInteger length = MIN(MAX((NSInteger)round(gestureStartRange.length / recognizer.scale), 2), numberOfPoints);
+    NSInteger location = (NSInteger)round(anchorIndex - anchor * (length - 1));
+    [self changeVisibleIndexRangeFromGesture:NSMakeRange(MAX(location, 0), length)];
+}
+
+- (void)handleZoomPanGesture:(UIPanGestureRecognizer *)recognizer {
+    if (recognizer.state == UIGestureRecognizerStateBegan) gestureStartRange = self.visibleIndexRange;
+    if (recognizer.state != UIGestureRecognizerStateChanged || gestureStartRange.length < 2) return;
+    
+    // Dragging to the right brings the previous points into view
+    CGFloat width = [self drawableGraphArea].size.width;
+    if (width <= 0) return;
+    CGFloat shift = -[recognizer translationInView:self].x / width * (gestureStartRange.length - 1);
+    NSInteger location = MAX((NSInteger)round(gestureStartRange.location + shift), 0);
+    [self changeVisibleIndexRangeFromGesture:NSMakeRange(location, gestureStartRange.length)];
+}
+
+/// Sets the visible range and lets the delegate know, unless the clamped range didn't change
+- (void)changeVisibleIndexRangeFromGesture:(NSRange)range {
+    NSRange visibleRange = [self clampedVisibleIndexRange:range];
+    if (NSEqualRanges(visibleRange, self.visibleIndexRange)) return;
+    
+    self.visibleIndexRange = visibleRange;
+    if ([self.delegate respondsToSelector:@selector(lineGraph:didChangeVisibleIndexRange:)]) {
+        [self.delegate lineGraph:self didChangeVisibleIndexRange:visibleRange];
+    }
+}
+
+#pragma mark - Performance Metrics
+
+- (void)setEnablePerformanceMetrics:(BOOL)enablePerformanceMetrics {
+    _enablePerformanceMetrics = enablePerformanceMetrics;
+    
+    // The reload waiting for its commit is still reported
+    if (!enablePerformanceMetrics) metricsStagesAreOpen = NO;
+}
+
+- (void)setMetricsHistoryLength:(NSUInteger)metricsHistoryLength {
+    _metricsHistoryLength = MAX(metricsHistoryLength, 1);
+    BEMGraphMetricsHistoryFree(metricsHistory);
+    metricsHistory = NULL;
+}
+
+- (BEMGraphMetricsSummary)metricsSummaryForStage:(BEMGraphMetricsStage)stage {
+    BEMGraphMetricsSummary summary = {0};
+    if (metricsHistory) BEMGraphMetricsHistorySummarize(metricsHistory, stage, &summary);
+    return summary;
+}
+
+/// Starts recording the metrics of a reload when they are enabled
+- (void)beginMetrics {
+    if (!self.enablePerformanceMetrics) return;
+    
+    // A reload started before the previous one was displayed reports the previous one without waiting for its commit
+    if (metricsCommitObserver) [self finishMetricsCommit];
+    
+    memset(&reloadMetrics, 0, sizeof(BEMGraphMetrics));
+    malloc_zone_statistics(NULL, &reloadStartHeap);
+    reloadStartCreationCount = self.viewReusePool.creationCount;
+    reloadStartTime = CACurrentMediaTime();
+    metricsStageStartTime = reloadStartTime;
+    metricsStagesAreOpen = YES;
+    
+#if BEM_HAS_SIGNPOSTS
+    if (@available(iOS 12.0, *)) {
+        os_signpost_interval_begin(BEMMetricsLog(), os_signpost_id_make_with_pointer(BEMMetricsLog(), (__bridge void *)self), "Reload");
+    }
+#endif
+}
+
+/// Adds the time elapsed since the end of the previous stage to \p stage, if a reload is being recorded
+- (void)finishMetricsStage:(BEMGraphMetricsStage)stage {
+    if (!metricsStagesAreOpen) return;
+    
+    CFTimeInterval now = CACurrentMediaTime();
+    reloadMetrics.durations[stage] += now - metricsStageStartTime;
+    metricsStageStartTime = now;
+    
+#if BEM_HAS_SIGNPOSTS
+    if (@available(iOS 12.0, *)) {
+        os_signpost_event_emit(BEMMetricsLog(), os_signpost_id_make_with_pointer(BEMMetricsLog(), (__bridge void *)self), "Stage", "%{public}s", BEMGraphMetricsStageName(stage));
+    }
+#endif
+}
+
+/// Counts what the recorded reload drew, then waits for the commit displaying it
+- (void)endMetricsStages {
+    if (!metricsStagesAreOpen) return;
+    metricsStagesAreOpen = NO;
+    
+    reloadMetrics.pointCount = MAX(numberOfPoints, 0);
+    BEMPointBufferRef drawnPoints = [self drawnPoints];
+    reloadMetrics.drawnPointCount = values && drawnPoints ? drawnPoints->count : 0;
+    for (UIView *subview in self.subviews) {
+        NSInteger kind = [self reusableKindOfView:subview];
+        if (kind == BEMReusableViewKindXAxisLabel || kind == BEMReusableViewKindYAxisLabel) reloadMetrics.labelCount++;
+    }
+    reloadMetrics.createdViewCount = self.viewReusePool.creationCount - reloadStartCreationCount;
+    
+    malloc_statistics_t heap;
+    malloc_zone_statistics(NULL, &heap);
+    reloadMetrics.allocationCount = (int64_t)heap.blocks_in_use - (int64_t)reloadStartHeap.blocks_in_use;
+    reloadMetrics.allocatedBytes = (int64_t)heap.size_in_use - (int64_t)reloadStartHeap.size_in_use;
+    
+    // Core Animation commits when the run loop is about to wait, the observer runs right after it
+    metricsStageStartTime = CACurrentMediaTime();
+    __weak BEMSimpleLineGraphView *weakSelf = self;
+    metricsCommitObserver = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, kCFRunLoopBeforeWaiting | kCFRunLoopExit, false, BEMMetricsCommitObserverOrder, ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+        [weakSelf finishMetricsCommit];
+    });
+    if (metricsCommitObserver) CFRunLoopAddObserver(CFRunLoopGetMain(), metricsCommitObserver, kCFRunLoopCommonModes);
+    else [self finishMetricsCommit];
+}
+
+/// Completes the metrics of the recorded reload, keeps them and sends them to the delegate
+- (void)finishMetricsCommit {
+    if (metricsCommitObserver) {
+        CFRunLoopObserverInvalidate(metricsCommitObserver);
+        CFRelease(metricsCommitObserver);
+        metricsCommitObserver = NULL;
+    }
+    
+    CFTimeInterval now = CACurrentMediaTime();
+    reloadMetrics.durations[BEMGraphMetricsStageCommit] = now - metricsStageStartTime;
+    reloadMetrics.durations[BEMGraphMetricsStageTotal] = now - reloadStartTime;
+    if (reloadMetrics.isAsynchronous) {
+        // The time spent on the reload queue is part of the reload too
+        reloadMetrics.durations[BEMGraphMetricsStageTotal] += graphSnapshot.fetchDuration + graphSnapshot.preparationDuration;
+    }
+    
+#if BEM_HAS_SIGNPOSTS
+    if (@available(iOS 12.0, *)) {
+        os_signpost_interval_end(BEMMetricsLog(), os_signpost_id_make_with_pointer(BEMMetricsLog(), (__bridge void *)self), "Reload", "%lu points, %lu drawn", (unsigned long)reloadMetrics.pointCount, (unsigned long)reloadMetrics.drawnPointCount);
+    }
+#endif
+    
+    _lastMetrics = reloadMetrics;
+    if (metricsHistory == NULL) metricsHistory = BEMGraphMetricsHistoryCreate(self.metricsHistoryLength);
+    if (metricsHistory) BEMGraphMetricsHistoryAdd(metricsHistory, &reloadMetrics);
+    
+    if ([self.delegate respondsToSelector:@selector(lineGraph:didRecordMetrics:)])
+        [self.delegate lineGraph:self didRecordMetrics:reloadMetrics];
+}
+
+#pragma mark - Calculations
+
+- (BEMStatistics *)calculationStatistics {
+    if (statisticsAreValid) return &statistics;
+    
+    // Every statistic is computed in a single pass over the values, null values are skipped
+    if (values == NULL || !BEMStatisticsCompute(values, numberOfPoints, BEMNullGraphValue, &statistics)) {
+        statistics = (BEMStatistics){0};
+    }
+    statisticsAreValid = YES;
+    return &statistics;
+}
+
+- (NSNumber *)calculatePointValueAverage {
+    return @([self calculationStatistics]->average);
+}
+
+- (NSNumber *)calculatePointValueSum {
+    return @([self calculationStatistics]->sum);
+}
+
+- (NSNumber *)calculatePointValueMedian {
+    return @([self calculationStatistics]->median);
+}
+
+- (NSNumber *)calculatePointValueMode {
+    return @([self calculationStatistics]->mode);
+}
+
+- (NSNumber *)calculateLineGraphStandardDeviation {
+    return @([self calculationStatistics]->standardDeviation);
+}
+
+- (NSNumber *)calculateMinimumPointValue {
+    return @([self calculationStatistics]->minimum);
+}
+
+- (NSNumber *)calculateMaximumPointValue {
+    return @([self calculationStatistics]->maximum);
+}
+
+
 #pragma mark - Values
 
 - (NSArray *)graphValuesForXAxis {
@@ -1275,10 +2895,25 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
 }
 
 - (NSArray *)graphValuesForDataPoints {
+    // The values are only boxed when they are requested
+    if (values == NULL) return @[];
+    NSMutableArray *dataPoints = [NSMutableArray arrayWithCapacity:numberOfPoints];
+    for (NSInteger i = 0; i < numberOfPoints; i++) {
+        [dataPoints addObject:@((CGFloat)values[i])];
+    }
     return dataPoints;
 }
 
+- (CGFloat)valueForPointAtIndex:(NSInteger)index inSeries:(NSInteger)series {
+    if (index < 0 || index >= numberOfPoints || series < 0 || series >= self.numberOfSeries) return NAN;
+    const double *seriesValues = series == 0 ? values : additionalSeries[series - 1].values;
+    if (seriesValues == NULL) return NAN;
+    return seriesValues[index];
+}
+
 - (NSArray *)graphLabelsForXAxis {
+    // The views of the labels which aren't displayed are only created when they are requested
+    for (NSUInteger i = 0; i < xAxisLabels.count; i++) [self xAxisLabelAtIndex:i];
     return xAxisLabels;
 }
 
@@ -1318,24 +2953,27 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     
     self.touchInputLine.alpha = self.alphaTouchInputLine;
     
-    closestDot = [self closestDotFromtouchInputLine:self.touchInputLine];
-    closestDot.alpha = 0.8;
+    NSInteger previousDrawnIndex = closestDrawnIndex;
+    closestDrawnIndex = [self closestDrawnIndexFromTouchInputLine:self.touchInputLine];
+    if (closestDrawnIndex != previousDrawnIndex) [self setDotAtDrawnIndex:previousDrawnIndex highlighted:NO];
+    [self setDotAtDrawnIndex:closestDrawnIndex highlighted:YES];
+    NSInteger closestIndex = closestDrawnIndex == NSNotFound ? NSNotFound : [self indexOfDrawnPoint:closestDrawnIndex];
     
     
-    if (self.enablePopUpReport == YES && closestDot.tag >= DotFirstTag100 && closestDot.tag < DotLastTag1000 && [closestDot isKindOfClass:[BEMCircle class]] && self.alwaysDisplayPopUpLabels == NO) {
-        [self setUpPopUpLabelAbovePoint:closestDot];
+    if (self.enablePopUpReport == YES && closestDrawnIndex != NSNotFound && self.alwaysDisplayPopUpLabels == NO) {
+        [self setUpPopUpLabelAboveDrawnPoint:closestDrawnIndex];
     }
     
-    if (closestDot.tag >= DotFirstTag100 && closestDot.tag < DotLastTag1000 && [closestDot isMemberOfClass:[BEMCircle class]]) {
+    if (closestDrawnIndex != NSNotFound) {
         if ([self.delegate respondsToSelector:@selector(lineGraph:didTouchGraphWithClosestIndex:)] && self.enableTouchReport == YES) {
-            [self.delegate lineGraph:self didTouchGraphWithClosestIndex:((NSInteger)closestDot.tag - DotFirstTag100)];
+            [self.delegate lineGraph:self didTouchGraphWithClosestIndex:closestIndex];
             
         } else if ([self.delegate respondsToSelector:@selector(didTouchGraphWithClosestIndex:)] && self.enableTouchReport == YES) {
             [self printDeprecationWarningForOldMethod:@"didTouchGraphWithClosestIndex:" andReplacementMethod:@"lineGraph:didTouchGraphWithClosestIndex:"];
             
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
-            [self.delegate didTouchGraphWithClosestIndex:((int)closestDot.tag - DotFirstTag100)];
+            [self.delegate didTouchGraphWithClosestIndex:(int)closestIndex];
 #pragma clang diagnostic pop
         }
     }
@@ -1343,21 +2981,19 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     // ON RELEASE
     if (recognizer.state == UIGestureRecognizerStateEnded) {
         if ([self.delegate respondsToSelector:@selector(lineGraph:didReleaseTouchFromGraphWithClosestIndex:)]) {
-            [self.delegate lineGraph:self didReleaseTouchFromGraphWithClosestIndex:(closestDot.tag - DotFirstTag100)];
+            [self.delegate lineGraph:self didReleaseTouchFromGraphWithClosestIndex:closestIndex];
             
         } else if ([self.delegate respondsToSelector:@selector(didReleaseGraphWithClosestIndex:)]) {
             [self printDeprecationWarningForOldMethod:@"didReleaseGraphWithClosestIndex:" andReplacementMethod:@"lineGraph:didReleaseTouchFromGraphWithClosestIndex:"];
             
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
-            [self.delegate didReleaseGraphWithClosestIndex:(closestDot.tag - DotFirstTag100)];
+            [self.delegate didReleaseGraphWithClosestIndex:(float)closestIndex];
 #pragma clang diagnostic pop
         }
         
         [UIView animateWithDuration:0.2 delay:0 options:UIViewAnimationOptionCurveEaseOut animations:^{
-            if (self.alwaysDisplayDots == NO && self.displayDotsOnly == NO) {
-                closestDot.alpha = 0;
-            }
+            [self setDotAtDrawnIndex:closestDrawnIndex highlighted:NO];
             
             self.touchInputLine.alpha = 0;
             if (self.enablePopUpReport == YES) {
@@ -1370,21 +3006,23 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
 }
 
 - (CGFloat)distanceToClosestPoint {
-    return sqrt(pow(closestDot.center.x - self.touchInputLine.center.x, 2));
+    if (closestDrawnIndex == NSNotFound) return CGFLOAT_MAX;
+    return fabs([self centerOfDrawnPoint:closestDrawnIndex].x - self.touchInputLine.center.x);
 }
 
-- (void)setUpPopUpLabelAbovePoint:(BEMCircle *)closestPoint {
-    self.xCenterLabel = closestDot.center.x;
-    self.yCenterLabel = closestDot.center.y - closestDot.frame.size.height/2 - 15;
+- (void)setUpPopUpLabelAboveDrawnPoint:(NSInteger)drawnIndex {
+    CGPoint dotCenter = [self centerOfDrawnPoint:drawnIndex];
+    self.xCenterLabel = dotCenter.x;
+    self.yCenterLabel = dotCenter.y - self.sizePoint/2 - 15;
     self.popUpView.center = CGPointMake(self.xCenterLabel, self.yCenterLabel);
     self.popUpLabel.center = self.popUpView.center;
-    int index = (int)(closestDot.tag - DotFirstTag100);
+    NSInteger index = [self indexOfDrawnPoint:drawnIndex];
 
     if ([self.delegate respondsToSelector:@selector(lineGraph:modifyPopupView:forIndex:)]) {
         [self.delegate lineGraph:self modifyPopupView:self.popUpView forIndex:index];
     }
-    self.xCenterLabel = closestDot.center.x;
-    self.yCenterLabel = closestDot.center.y - closestDot.frame.size.height/2 - 15;
+    self.xCenterLabel = dotCenter.x;
+    self.yCenterLabel = dotCenter.y - self.sizePoint/2 - 15;
     self.popUpView.center = CGPointMake(self.xCenterLabel, self.yCenterLabel);
 
     self.popUpView.alpha = 1.0;
@@ -1392,9 +3030,9 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     CGPoint popUpViewCenter = CGPointZero;
     
     if ([self.delegate respondsToSelector:@selector(popUpSuffixForlineGraph:)])
-        self.popUpLabel.text = [NSString stringWithFormat:@"%li%@", (long)[dataPoints[(NSInteger) closestDot.tag - DotFirstTag100] integerValue], [self.delegate popUpSuffixForlineGraph:self]];
+        self.popUpLabel.text = [NSString stringWithFormat:@"%li%@", (long)values[index], [self.delegate popUpSuffixForlineGraph:self]];
     else
-        self.popUpLabel.text = [NSString stringWithFormat:@"%li", (long)[dataPoints[(NSInteger) closestDot.tag - DotFirstTag100] integerValue]];
+        self.popUpLabel.text = [NSString stringWithFormat:@"%li", (long)values[index]];
     
     if (self.enableYAxisLabel == YES && self.popUpView.frame.origin.x <= self.YAxisLabelXOffset && !self.positionYAxisRight) {
         self.xCenterLabel = self.popUpView.frame.size.width/2;
@@ -1411,8 +3049,8 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     }
     
     if (self.popUpView.frame.origin.y <= 2) {
-        self.yCenterLabel = closestDot.center.y + closestDot.frame.size.height/2 + 15;
-        popUpViewCenter = CGPointMake(self.xCenterLabel, closestDot.center.y + closestDot.frame.size.height/2 + 15);
+        self.yCenterLabel = dotCenter.y + self.sizePoint/2 + 15;
+        popUpViewCenter = CGPointMake(self.xCenterLabel, dotCenter.y + self.sizePoint/2 + 15);
     }
 
     if (!CGPointEqualToPoint(popUpViewCenter, CGPointZero)) {
@@ -1432,8 +3070,7 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
         if ([self.delegate respondsToSelector:@selector(popUpPrefixForlineGraph:)]) {
             prefix = [self.delegate popUpPrefixForlineGraph:self];
         }
-        NSNumber *value = dataPoints[index];
-        NSString *formattedValue = [NSString stringWithFormat:self.formatStringForValues, value.doubleValue];
+        NSString *formattedValue = [NSString stringWithFormat:self.formatStringForValues, values[index]];
         self.popUpLabel.text = [NSString stringWithFormat:@"%@%@%@", prefix, formattedValue, suffix];
         self.popUpLabel.center = self.popUpView.center;
     }
@@ -1441,136 +3078,316 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
 
 #pragma mark - Graph Calculations
 
-- (BEMCircle *)closestDotFromtouchInputLine:(UIView *)touchInputLine {
-    currentlyCloser = CGFLOAT_MAX;
-    for (BEMCircle *point in self.subviews) {
-        if (point.tag >= DotFirstTag100 && point.tag < DotLastTag1000 && [point isMemberOfClass:[BEMCircle class]]) {
-            if (self.alwaysDisplayDots == NO && self.displayDotsOnly == NO) {
-                point.alpha = 0;
-            }
-            if (pow(((point.center.x) - touchInputLine.center.x), 2) < currentlyCloser) {
-                currentlyCloser = pow(((point.center.x) - touchInputLine.center.x), 2);
-                closestDot = point;
-            }
-        }
-    }
-    return closestDot;
+- (NSInteger)closestDrawnIndexFromTouchInputLine:(UIView *)touchInputLine {
+    [self updateStreamedPointsIfNeeded];
+    if (numberOfPoints < 2) return NSNotFound;
+    
+    BEMPointLookupRef lookup = decimatedPoints ? drawnPointLookup : pointLookup;
+    size_t closestIndex = BEMPointLookupFindClosest(lookup, touchInputLine.center.x - (self.positionYAxisRight ? 0 : self.YAxisLabelXOffset));
+    return closestIndex == BEMPointLookupNotFound ? NSNotFound : (NSInteger)closestIndex;
+}
+
+- (NSInteger)indexOfPointClosestToX:(CGFloat)x {
+    // The points appended or removed since the last layout are looked up too
+    [self updateStreamedPointsIfNeeded];
+    if (numberOfPoints < 2) return NSNotFound;
+    
+    size_t closestIndex = BEMPointLookupFindClosest(pointLookup, x - (self.positionYAxisRight ? 0 : self.YAxisLabelXOffset));
+    return closestIndex == BEMPointLookupNotFound ? NSNotFound : [self indexOfLinePoint:closestIndex];
 }
 
 - (CGFloat)getMaximumValue {
     if ([self.delegate respondsToSelector:@selector(maxValueForLineGraph:)]) {
         return [self.delegate maxValueForLineGraph:self];
-    } else {
-        CGFloat dotValue;
-        CGFloat maxValue = -FLT_MAX;
-        
-        @autoreleasepool {
-            for (int i = 0; i < numberOfPoints; i++) {
-                if ([self.dataSource respondsToSelector:@selector(lineGraph:valueForPointAtIndex:)]) {
-                    dotValue = [self.dataSource lineGraph:self valueForPointAtIndex:i];
-                    
-                } else if ([self.delegate respondsToSelector:@selector(valueForIndex:)]) {
-                    [self printDeprecationWarningForOldMethod:@"valueForIndex:" andReplacementMethod:@"lineGraph:valueForPointAtIndex:"];
-                    
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-                    dotValue = [self.delegate valueForIndex:i];
-#pragma clang diagnostic pop
-                    
-                } else if ([self.delegate respondsToSelector:@selector(lineGraph:valueForPointAtIndex:)]) {
-                    [self printDeprecationAndUnavailableWarningForOldMethod:@"lineGraph:valueForPointAtIndex:"];
-                    NSException *exception = [NSException exceptionWithName:@"Implementing Unavailable Delegate Method" reason:@"lineGraph:valueForPointAtIndex: is no longer available on the delegate. It must be implemented on the data source." userInfo:nil];
-                    [exception raise];
-                    
-                } else {
-                    dotValue = 0;
-                }
-                if (dotValue == BEMNullGraphValue) {
-                    continue;
-                }
-                
-                if (dotValue > maxValue) {
-                    maxValue = dotValue;
-                }
-            }
-        }
-        return maxValue;
-    }
+    } else return visibleMaxValue;
 }
 
 - (CGFloat)getMinimumValue {
     if ([self.delegate respondsToSelector:@selector(minValueForLineGraph:)]) {
         return [self.delegate minValueForLineGraph:self];
-    } else {
-        CGFloat dotValue;
-        CGFloat minValue = INFINITY;
-        
-        @autoreleasepool {
-            for (int i = 0; i < numberOfPoints; i++) {
-                if ([self.dataSource respondsToSelector:@selector(lineGraph:valueForPointAtIndex:)]) {
-                    dotValue = [self.dataSource lineGraph:self valueForPointAtIndex:i];
-                    
-                } else if ([self.delegate respondsToSelector:@selector(valueForIndex:)]) {
-                    [self printDeprecationWarningForOldMethod:@"valueForIndex:" andReplacementMethod:@"lineGraph:valueForPointAtIndex:"];
-                    
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-                    dotValue = [self.delegate valueForIndex:i];
-#pragma clang diagnostic pop
-                    
-                } else if ([self.delegate respondsToSelector:@selector(lineGraph:valueForPointAtIndex:)]) {
-                    [self printDeprecationAndUnavailableWarningForOldMethod:@"lineGraph:valueForPointAtIndex:"];
-                    NSException *exception = [NSException exceptionWithName:@"Implementing Unavailable Delegate Method" reason:@"lineGraph:valueForPointAtIndex: is no longer available on the delegate. It must be implemented on the data source." userInfo:nil];
-                    [exception raise];
-                    
-                } else dotValue = 0;
-                
-                if (dotValue == BEMNullGraphValue) {
-                    continue;
-                }
-                if (dotValue < minValue) {
-                    minValue = dotValue;
-                }
-            }
-        }
-        return minValue;
-    }
+    } else return visibleMinValue;
 }
 
-- (CGFloat)yPositionForDotValue:(CGFloat)dotValue {
-    if (dotValue == BEMNullGraphValue) {
-        return BEMNullGraphValue;
-    }
+- (BEMGraphScale)graphScale {
+    BEMGraphScale scale;
+    scale.minimumValue = self.minValue;
+    scale.maximumValue = self.maxValue;
+    scale.height = self.frame.size.height;
+    scale.autoScale = self.autoScaleYAxis;
     
-    CGFloat positionOnYAxis; // The position on the Y-axis of the point currently being created.
-    CGFloat padding = self.frame.size.height/2;
-    if (padding > 90.0) {
-        padding = 90.0;
-    }
-
     if ([self.delegate respondsToSelector:@selector(staticPaddingForLineGraph:)])
-        padding = [self.delegate staticPaddingForLineGraph:self];
+        scale.padding = [self.delegate staticPaddingForLineGraph:self];
+    else scale.padding = BEMGraphScaleDefaultPadding(scale.height);
 
     if (self.enableXAxisLabel) {
         if ([self.dataSource respondsToSelector:@selector(lineGraph:labelOnXAxisForIndex:)] || [self.dataSource respondsToSelector:@selector(labelOnXAxisForIndex:)]) {
-            if ([xAxisLabels count] > 0) {
-                UILabel *label = [xAxisLabels objectAtIndex:0];
-                self.XAxisLabelYOffset = label.frame.size.height + self.widthLine;
+            if ([xAxisValues count] > 0) {
+                self.XAxisLabelYOffset = xAxisLabelBoxes[0].height + self.widthLine;
             }
         }
     }
+    scale.xAxisLabelHeight = self.XAxisLabelYOffset;
     
-    if (self.minValue == self.maxValue && self.autoScaleYAxis == YES) positionOnYAxis = self.frame.size.height/2;
-    else if (self.autoScaleYAxis == YES) positionOnYAxis = ((self.frame.size.height - padding/2) - ((dotValue - self.minValue) / ((self.maxValue - self.minValue) / (self.frame.size.height - padding)))) + self.XAxisLabelYOffset/2;
-    else positionOnYAxis = ((self.frame.size.height) - dotValue);
-    
-    positionOnYAxis -= self.XAxisLabelYOffset;
+    return scale;
+}
+
+- (CGFloat)yPositionForDotValue:(CGFloat)dotValue {
+    if (dotValue == BEMNullGraphValue) {
+        return BEMNullGraphValue;
+    }
     
-    return positionOnYAxis;
+    return BEMGraphTransformY(&pointTransform, dotValue);
 }
 
 #pragma mark - Customization Methods
 
+// The colors and alphas only update the style of the line and the dots
+
+- (void)setColorTop:(UIColor *)colorTop {
+    _colorTop = colorTop;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setColorBottom:(UIColor *)colorBottom {
+    _colorBottom = colorBottom;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setAlphaTop:(CGFloat)alphaTop {
+    _alphaTop = alphaTop;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setAlphaBottom:(CGFloat)alphaBottom {
+    _alphaBottom = alphaBottom;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setGradientTop:(CGGradientRef)gradientTop {
+    _gradientTop = gradientTop;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setGradientBottom:(CGGradientRef)gradientBottom {
+    _gradientBottom = gradientBottom;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setColorLine:(UIColor *)colorLine {
+    _colorLine = colorLine;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setGradientLine:(CGGradientRef)gradientLine {
+    _gradientLine = gradientLine;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setGradientLineDirection:(BEMLineGradientDirection)gradientLineDirection {
+    _gradientLineDirection = gradientLineDirection;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setAlphaLine:(CGFloat)alphaLine {
+    _alphaLine = alphaLine;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setWidthReferenceLines:(CGFloat)widthReferenceLines {
+    _widthReferenceLines = widthReferenceLines;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setColorReferenceLines:(UIColor *)colorReferenceLines {
+    _colorReferenceLines = colorReferenceLines;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setColorPoint:(UIColor *)colorPoint {
+    _colorPoint = colorPoint;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setLineDashPatternForReferenceXAxisLines:(NSArray *)lineDashPatternForReferenceXAxisLines {
+    _lineDashPatternForReferenceXAxisLines = lineDashPatternForReferenceXAxisLines;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setLineDashPatternForReferenceYAxisLines:(NSArray *)lineDashPatternForReferenceYAxisLines {
+    _lineDashPatternForReferenceYAxisLines = lineDashPatternForReferenceYAxisLines;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+- (void)setAverageLine:(BEMAverageLine *)averageLine {
+    _averageLine = averageLine;
+    [self setNeedsUpdateOfStages:BEMGraphStageStyle];
+}
+
+// The reference lines are placed along the axes and drawn with the line
+
+- (void)setEnableReferenceXAxisLines:(BOOL)enableReferenceXAxisLines {
+    _enableReferenceXAxisLines = enableReferenceXAxisLines;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes | BEMGraphStageStyle];
+}
+
+- (void)setEnableReferenceYAxisLines:(BOOL)enableReferenceYAxisLines {
+    _enableReferenceYAxisLines = enableReferenceYAxisLines;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes | BEMGraphStageStyle];
+}
+
+- (void)setEnableReferenceAxisFrame:(BOOL)enableReferenceAxisFrame {
+    _enableReferenceAxisFrame = enableReferenceAxisFrame;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes | BEMGraphStageStyle];
+}
+
+- (void)setEnableLeftReferenceAxisFrameLine:(BOOL)enableLeftReferenceAxisFrameLine {
+    _enableLeftReferenceAxisFrameLine = enableLeftReferenceAxisFrameLine;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes | BEMGraphStageStyle];
+}
+
+- (void)setEnableBottomReferenceAxisFrameLine:(BOOL)enableBottomReferenceAxisFrameLine {
+    _enableBottomReferenceAxisFrameLine = enableBottomReferenceAxisFrameLine;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes | BEMGraphStageStyle];
+}
+
+- (void)setEnableRightReferenceAxisFrameLine:(BOOL)enableRightReferenceAxisFrameLine {
+    _enableRightReferenceAxisFrameLine = enableRightReferenceAxisFrameLine;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes | BEMGraphStageStyle];
+}
+
+- (void)setEnableTopReferenceAxisFrameLine:(BOOL)enableTopReferenceAxisFrameLine {
+    _enableTopReferenceAxisFrameLine = enableTopReferenceAxisFrameLine;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes | BEMGraphStageStyle];
+}
+
+// The colors of the axes only update their labels and backgrounds
+
+- (void)setColorXaxisLabel:(UIColor *)colorXaxisLabel {
+    _colorXaxisLabel = colorXaxisLabel;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes];
+}
+
+- (void)setColorYaxisLabel:(UIColor *)colorYaxisLabel {
+    _colorYaxisLabel = colorYaxisLabel;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes];
+}
+
+- (void)setColorBackgroundXaxis:(UIColor *)colorBackgroundXaxis {
+    _colorBackgroundXaxis = colorBackgroundXaxis;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes];
+}
+
+- (void)setAlphaBackgroundXaxis:(CGFloat)alphaBackgroundXaxis {
+    _alphaBackgroundXaxis = alphaBackgroundXaxis;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes];
+}
+
+- (void)setColorBackgroundYaxis:(UIColor *)colorBackgroundYaxis {
+    _colorBackgroundYaxis = colorBackgroundYaxis;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes];
+}
+
+- (void)setAlphaBackgroundYaxis:(CGFloat)alphaBackgroundYaxis {
+    _alphaBackgroundYaxis = alphaBackgroundYaxis;
+    [self setNeedsUpdateOfStages:BEMGraphStageAxes];
+}
+
+// The Y-Axis labels set the width of the axis, the points only move if it changes
+
+- (void)setFormatStringForValues:(NSString *)formatStringForValues {
+    _formatStringForValues = formatStringForValues;
+    [self setNeedsUpdateOfStages:BEMGraphStageScale | BEMGraphStageAxes];
+}
+
+- (void)setEnableYAxisLabel:(BOOL)enableYAxisLabel {
+    _enableYAxisLabel = enableYAxisLabel;
+    [self setNeedsUpdateOfStages:BEMGraphStageScale | BEMGraphStageAxes];
+}
+
+- (void)setAutoScaleYAxis:(BOOL)autoScaleYAxis {
+    _autoScaleYAxis = autoScaleYAxis;
+    [self setNeedsUpdateOfStages:BEMGraphStageScale | BEMGraphStageAxes];
+}
+
+- (void)setEnableNiceYAxisValues:(BOOL)enableNiceYAxisValues {
+    _enableNiceYAxisValues = enableNiceYAxisValues;
+    [self setNeedsUpdateOfStages:BEMGraphStageScale | BEMGraphStageAxes];
+}
+
+// The font also sets the height of the X-Axis labels, above which the points are placed
+
+- (void)setLabelFont:(UIFont *)labelFont {
+    _labelFont = labelFont;
+    [self setNeedsUpdateOfStages:BEMGraphStageScale | BEMGraphStageGeometry | BEMGraphStageAxes];
+}
+
+// The X-Axis labels, the curve, the null values, the dots and the decimation move the points, the line and the dots
+
+- (void)setEnableXAxisLabel:(BOOL)enableXAxisLabel {
+    _enableXAxisLabel = enableXAxisLabel;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setWidthLine:(CGFloat)widthLine {
+    _widthLine = widthLine;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setPositionYAxisRight:(BOOL)positionYAxisRight {
+    _positionYAxisRight = positionYAxisRight;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setEnableBezierCurve:(BOOL)enableBezierCurve {
+    _enableBezierCurve = enableBezierCurve;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setCurveInterpolation:(BEMCurveInterpolation)curveInterpolation {
+    _curveInterpolation = curveInterpolation;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setSizePoint:(CGFloat)sizePoint {
+    _sizePoint = sizePoint;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setAlwaysDisplayDots:(BOOL)alwaysDisplayDots {
+    _alwaysDisplayDots = alwaysDisplayDots;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setAlwaysDisplayPopUpLabels:(BOOL)alwaysDisplayPopUpLabels {
+    _alwaysDisplayPopUpLabels = alwaysDisplayPopUpLabels;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setInterpolateNullValues:(BOOL)interpolateNullValues {
+    _interpolateNullValues = interpolateNullValues;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setNullValueFill:(BEMNullValueFill)nullValueFill {
+    _nullValueFill = nullValueFill;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setDisplayDotsOnly:(BOOL)displayDotsOnly {
+    _displayDotsOnly = displayDotsOnly;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setDotRendering:(BEMDotRendering)dotRendering {
+    _dotRendering = dotRendering;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
+- (void)setLineDecimation:(BEMLineDecimation)lineDecimation {
+    _lineDecimation = lineDecimation;
+    [self setNeedsUpdateOfStages:BEMGraphStageGeometry];
+}
+
 - (void)setColorTouchInputLine:(UIColor *)colorTouchInputLine {
     _colorTouchInputLine = colorTouchInputLine;
 }
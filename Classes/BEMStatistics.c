@@ -0,0 +1,126 @@
+//
+//  BEMStatistics.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMStatistics.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct BEMStatisticsBucket {
+    double value;
+    size_t count;
+} BEMStatisticsBucket;
+
+static inline uint64_t BEMStatisticsHash(double value) {
+    // -0.0 and 0.0 are the same value
+    if (value == 0) value = 0;
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdULL;
+    bits ^= bits >> 33;
+    return bits;
+}
+
+/// Partially sorts \p values so that \p values[k] is the k-th smallest value, with every smaller value before it (Hoare's selection).
+static void BEMStatisticsSelect(double *values, size_t count, size_t k) {
+    size_t left = 0;
+    size_t right = count - 1;
+    while (left < right) {
+        double pivot = values[left + (right - left) / 2];
+        size_t i = left;
+        size_t j = right;
+        while (i <= j) {
+            while (values[i] < pivot) i++;
+            while (values[j] > pivot) j--;
+            if (i <= j) {
+                double swap = values[i];
+                values[i] = values[j];
+                values[j] = swap;
+                i++;
+                if (j == 0) break;
+                j--;
+            }
+        }
+        if (k <= j) right = j;
+        else if (k >= i) left = i;
+        else return;
+    }
+}
+
+bool BEMStatisticsCompute(const double *values, size_t count, double nullValue, BEMStatistics *statistics) {
+    size_t bucketCount = 16;
+    while (bucketCount < count * 2) bucketCount <<= 1;
+
+    double *sorted = malloc(sizeof(double) * (count > 0 ? count : 1));
+    BEMStatisticsBucket *buckets = calloc(bucketCount, sizeof(BEMStatisticsBucket));
+    if (sorted == NULL || buckets == NULL) {
+        free(sorted);
+        free(buckets);
+        return false;
+    }
+
+    BEMStatistics result = {0};
+    double mean = 0;
+    double m2 = 0;
+    size_t modeCount = 0;
+    result.minimum = INFINITY;
+    result.maximum = -INFINITY;
+
+    for (size_t i = 0; i < count; i++) {
+        double value = values[i];
+        if (value == nullValue || isnan(value)) continue;
+
+        sorted[result.count++] = value;
+        result.sum += value;
+        if (value < result.minimum) result.minimum = value;
+        if (value > result.maximum) result.maximum = value;
+
+        // Welford's online variance
+        double delta = value - mean;
+        mean += delta / result.count;
+        m2 += delta * (value - mean);
+
+        // Open addressing with linear probing, the table is never more than half full
+        size_t bucket = BEMStatisticsHash(value) & (bucketCount - 1);
+        while (buckets[bucket].count > 0 && buckets[bucket].value != value) {
+            bucket = (bucket + 1) & (bucketCount - 1);
+        }
+        buckets[bucket].value = value;
+        if (++buckets[bucket].count > modeCount) {
+            modeCount = buckets[bucket].count;
+            result.mode = value;
+        }
+    }
+
+    if (result.count > 0) {
+        result.average = mean;
+        result.standardDeviation = sqrt(m2 / result.count);
+
+        size_t middle = result.count / 2;
+        BEMStatisticsSelect(sorted, result.count, middle);
+        result.median = sorted[middle];
+        if (result.count % 2 == 0) {
+            // Every value before the middle one is smaller, the biggest of them is the other middle value
+            double lowerMiddle = sorted[0];
+            for (size_t i = 1; i < middle; i++) {
+                if (sorted[i] > lowerMiddle) lowerMiddle = sorted[i];
+            }
+            result.median = (result.median + lowerMiddle) / 2;
+        }
+    } else {
+        result.minimum = 0;
+        result.maximum = 0;
+    }
+
+    free(sorted);
+    free(buckets);
+    *statistics = result;
+    return true;
+}
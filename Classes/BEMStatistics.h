@@ -0,0 +1,43 @@
+//
+//  BEMStatistics.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMStatistics_h
+#define BEMStatistics_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Every statistic of a series of values. All of the statistics are 0 when the series has no values.
+typedef struct BEMStatistics {
+    /// The number of values used, null values excluded
+    size_t count;
+    double sum;
+    double average;
+    double median;
+    /// The most frequent value. When several values are equally frequent, the first one to reach the highest count.
+    double mode;
+    /// The population standard deviation
+    double standardDeviation;
+    double minimum;
+    double maximum;
+} BEMStatistics;
+
+
+/** Computes every statistic of \p values in a single pass.
+ @discussion Values equal to \p nullValue are skipped. The variance is accumulated with Welford's algorithm, the mode with a hash table built during the pass, and the median is selected afterwards in linear time from a copy of the values.
+ @return false if the scratch memory could not be allocated, in which case \p statistics is left untouched. */
+bool BEMStatisticsCompute(const double *values, size_t count, double nullValue, BEMStatistics *statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
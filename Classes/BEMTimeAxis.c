@@ -0,0 +1,232 @@
+//
+//  BEMTimeAxis.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMTimeAxis.h"
+
+#include <math.h>
+#include <stdint.h>
+
+#define BEMSecondsPerDay 86400.0
+
+/// Average lengths of the Gregorian calendar, 365.2425 days a year
+#define BEMSecondsPerYear 31556952.0
+#define BEMSecondsPerMonth (BEMSecondsPerYear / 12)
+
+/// The levels below a year, from the finest to the coarsest. Years are multiplied by 1, 2 and 5 times a power of 10 past the table.
+static const BEMTimeTickLevel BEMTimeTickLevels[] = {
+    {BEMTimeUnitSecond, 1}, {BEMTimeUnitSecond, 2}, {BEMTimeUnitSecond, 5}, {BEMTimeUnitSecond, 10}, {BEMTimeUnitSecond, 15}, {BEMTimeUnitSecond, 30},
+    {BEMTimeUnitMinute, 1}, {BEMTimeUnitMinute, 2}, {BEMTimeUnitMinute, 5}, {BEMTimeUnitMinute, 10}, {BEMTimeUnitMinute, 15}, {BEMTimeUnitMinute, 30},
+    {BEMTimeUnitHour, 1}, {BEMTimeUnitHour, 2}, {BEMTimeUnitHour, 3}, {BEMTimeUnitHour, 6}, {BEMTimeUnitHour, 12},
+    {BEMTimeUnitDay, 1}, {BEMTimeUnitDay, 2},
+    {BEMTimeUnitWeek, 1},
+    {BEMTimeUnitMonth, 1}, {BEMTimeUnitMonth, 2}, {BEMTimeUnitMonth, 3}, {BEMTimeUnitMonth, 6}
+};
+
+/// Beyond, the ticks would be further apart than the range of a double holding seconds can represent with any precision
+#define BEMTimeTickMaximumYears 100000000
+
+static int64_t BEMFloorDivide(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+}
+
+static int64_t BEMFloorModulo(int64_t value, int64_t divisor) {
+    return value - BEMFloorDivide(value, divisor) * divisor;
+}
+
+//----- CALENDAR -----//
+
+// Conversions between days since 1970-01-01 and dates of the proleptic Gregorian calendar, from Howard Hinnant's chrono-compatible date algorithms
+
+static int64_t BEMDaysFromCivil(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2;
+    int64_t era = BEMFloorDivide(year, 400);
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static void BEMCivilFromDays(int64_t days, int64_t *year, int64_t *month) {
+    days += 719468;
+    int64_t era = BEMFloorDivide(days, 146097);
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t shiftedMonth = (5 * dayOfYear + 2) / 153;
+    *month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    *year = yearOfEra + era * 400 + (*month <= 2);
+}
+
+/// The index of the month holding the local \p time, counted from January of year 0
+static int64_t BEMMonthIndexOfTime(double time) {
+    int64_t year, month;
+    BEMCivilFromDays((int64_t)floor(time / BEMSecondsPerDay), &year, &month);
+    return year * 12 + month - 1;
+}
+
+/// The local time of the first day of the month at \p monthIndex
+static double BEMTimeOfMonthIndex(int64_t monthIndex) {
+    return BEMDaysFromCivil(BEMFloorDivide(monthIndex, 12), BEMFloorModulo(monthIndex, 12) + 1, 1) * BEMSecondsPerDay;
+}
+
+//----- TICK LEVELS -----//
+
+/// The length of the ticks of the units which don't depend on the calendar, 0 for months and years
+static double BEMTimeUnitFixedDuration(BEMTimeUnit unit) {
+    switch (unit) {
+        case BEMTimeUnitSecond: return 1;
+        case BEMTimeUnitMinute: return 60;
+        case BEMTimeUnitHour: return 3600;
+        case BEMTimeUnitDay: return BEMSecondsPerDay;
+        case BEMTimeUnitWeek: return 7 * BEMSecondsPerDay;
+        default: return 0;
+    }
+}
+
+double BEMTimeTickLevelDuration(BEMTimeTickLevel level) {
+    if (level.unit == BEMTimeUnitMonth) return level.multiple * BEMSecondsPerMonth;
+    if (level.unit == BEMTimeUnitYear) return level.multiple * BEMSecondsPerYear;
+    return level.multiple * BEMTimeUnitFixedDuration(level.unit);
+}
+
+/// The level at \p index in the table followed by the years, or a level with a 0 multiple past the last one
+static BEMTimeTickLevel BEMTimeTickLevelAtIndex(size_t index) {
+    size_t tableCount = sizeof(BEMTimeTickLevels) / sizeof(BEMTimeTickLevels[0]);
+    if (index < tableCount) return BEMTimeTickLevels[index];
+
+    static const int factors[] = {1, 2, 5};
+    BEMTimeTickLevel level = {BEMTimeUnitYear, factors[(index - tableCount) % 3]};
+    for (size_t power = (index - tableCount) / 3; power > 0 && level.multiple < BEMTimeTickMaximumYears; power--) level.multiple *= 10;
+    if (level.multiple > BEMTimeTickMaximumYears) level.multiple = 0;
+    return level;
+}
+
+BEMTimeTickLevel BEMTimeTickLevelForRange(double startTime, double endTime, size_t targetCount) {
+    // n ticks split the range in n - 1 intervals
+    double span = endTime - startTime;
+    double intervals = targetCount > 1 ? (double)(targetCount - 1) : 1;
+    if (!(span > 0) || isinf(span)) return BEMTimeTickLevels[0];
+
+    // The first level with at most as many intervals as requested, unless the finer level before it is closer to the request
+    BEMTimeTickLevel finerLevel = BEMTimeTickLevels[0];
+    for (size_t i = 0;; i++) {
+        BEMTimeTickLevel level = BEMTimeTickLevelAtIndex(i);
+        if (level.multiple == 0) return finerLevel;
+
+        double levelIntervals = span / BEMTimeTickLevelDuration(level);
+        if (levelIntervals <= intervals) {
+            if (i > 0 && span / BEMTimeTickLevelDuration(finerLevel) - intervals < intervals - levelIntervals) return finerLevel;
+            return level;
+        }
+        finerLevel = level;
+    }
+}
+
+//----- TICKS -----//
+
+double BEMTimeTickFloor(BEMTimeTickLevel level, double localTime) {
+    int64_t multiple = level.multiple > 0 ? level.multiple : 1;
+
+    switch (level.unit) {
+        case BEMTimeUnitWeek: {
+            // 1970-01-05, day 4, is the first Monday since 1970
+            int64_t weekIndex = BEMFloorDivide((int64_t)floor(localTime / BEMSecondsPerDay) - 4, 7);
+            weekIndex -= BEMFloorModulo(weekIndex, multiple);
+            return (weekIndex * 7 + 4) * BEMSecondsPerDay;
+        }
+        case BEMTimeUnitMonth: {
+            int64_t monthIndex = BEMMonthIndexOfTime(localTime);
+            return BEMTimeOfMonthIndex(monthIndex - BEMFloorModulo(monthIndex, multiple));
+        }
+        case BEMTimeUnitYear: {
+            int64_t monthIndex = BEMMonthIndexOfTime(localTime);
+            int64_t year = BEMFloorDivide(monthIndex, 12);
+            return BEMTimeOfMonthIndex((year - BEMFloorModulo(year, multiple)) * 12);
+        }
+        default: {
+            // Every level below a day divides a day, the ticks fall on the multiples of the level since midnight
+            double step = multiple * BEMTimeUnitFixedDuration(level.unit);
+            return floor(localTime / step) * step;
+        }
+    }
+}
+
+double BEMTimeTickNext(BEMTimeTickLevel level, double localTick) {
+    int64_t multiple = level.multiple > 0 ? level.multiple : 1;
+    if (level.unit == BEMTimeUnitMonth || level.unit == BEMTimeUnitYear) {
+        int64_t months = level.unit == BEMTimeUnitYear ? 12 * multiple : multiple;
+        return BEMTimeOfMonthIndex(BEMMonthIndexOfTime(localTick) + months);
+    }
+    return localTick + multiple * BEMTimeUnitFixedDuration(level.unit);
+}
+
+/// The offset of the time zone at \p time, 0 for UTC or an offset which is not finite
+static double BEMTimeZoneOffset(BEMTimeZoneOffsetFunction offsetOfTime, void *context, double time) {
+    if (offsetOfTime == NULL) return 0;
+    double offset = offsetOfTime(context, time);
+    return isfinite(offset) ? offset : 0;
+}
+
+/// The time displayed as \p localTime by the wall clock. The offset is guessed at \p localTime, then read again at the guess, which is exact unless the offset changes within the offset of \p localTime.
+static double BEMTimeOfLocalTime(BEMTimeZoneOffsetFunction offsetOfTime, void *context, double localTime) {
+    double guess = localTime - BEMTimeZoneOffset(offsetOfTime, context, localTime);
+    return localTime - BEMTimeZoneOffset(offsetOfTime, context, guess);
+}
+
+size_t BEMTimeTicksMake(double startTime, double endTime, size_t targetCount, BEMTimeZoneOffsetFunction offsetOfTime, void *context, BEMTimeTickLevel *level, double *ticks, size_t capacity) {
+    *level = BEMTimeTickLevelForRange(startTime, endTime, targetCount);
+    if (!isfinite(startTime) || !isfinite(endTime) || startTime > endTime) return 0;
+
+    // The ticks are laid out on the wall clock, each one is converted with its own offset
+    double localTick = BEMTimeTickFloor(*level, startTime + BEMTimeZoneOffset(offsetOfTime, context, startTime));
+    double tick = BEMTimeOfLocalTime(offsetOfTime, context, localTick);
+
+    size_t count = 0;
+    while (tick <= endTime && count < capacity) {
+        if (tick >= startTime && (count == 0 || tick > ticks[count - 1])) ticks[count++] = tick;
+        localTick = BEMTimeTickNext(*level, localTick);
+        tick = BEMTimeOfLocalTime(offsetOfTime, context, localTick);
+    }
+    return count;
+}
+
+//----- MAPPING -----//
+
+BEMTimeAxis BEMTimeAxisMake(double startTime, double endTime, float width) {
+    BEMTimeAxis axis;
+    double span = endTime - startTime;
+    axis.startTime = startTime;
+    axis.scale = span > 0 && isfinite(span) ? width / span : 0;
+    return axis;
+}
+
+void BEMTimeAxisPlacePoints(const BEMTimeAxis *axis, const double *times, size_t count, float *x) {
+    double startTime = axis->startTime;
+    double scale = axis->scale;
+    for (size_t i = 0; i < count; i++) {
+        x[i] = (float)((times[i] - startTime) * scale);
+    }
+}
+
+bool BEMTimeAxisTimesAreSorted(const double *times, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (!isfinite(times[i]) || (i > 0 && times[i] < times[i - 1])) return false;
+    }
+    return true;
+}
+
+size_t BEMTimeAxisIndexOfTime(const double *times, size_t count, double time) {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (times[middle] < time) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
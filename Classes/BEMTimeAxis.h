@@ -0,0 +1,100 @@
+//
+//  BEMTimeAxis.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMTimeAxis_h
+#define BEMTimeAxis_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//----- TICK LEVELS -----//
+
+/// The calendar unit of a tick level
+typedef enum BEMTimeUnit {
+    BEMTimeUnitSecond,
+    BEMTimeUnitMinute,
+    BEMTimeUnitHour,
+    BEMTimeUnitDay,
+    /// Weeks start on Monday
+    BEMTimeUnitWeek,
+    BEMTimeUnitMonth,
+    BEMTimeUnitYear
+} BEMTimeUnit;
+
+/** The spacing of the ticks of a time axis, such as every 15 minutes or every 3 months.
+ @discussion The ticks of a level fall on the wall clock: every multiple of \p multiple units since midnight for the seconds, minutes and hours, every Monday for the weeks, and the first day of every \p multiple months or years of the calendar. */
+typedef struct BEMTimeTickLevel {
+    BEMTimeUnit unit;
+    /// The number of units between two ticks
+    int multiple;
+} BEMTimeTickLevel;
+
+/// The average number of seconds between two ticks of \p level. Months and years have varying lengths, their average length is used.
+double BEMTimeTickLevelDuration(BEMTimeTickLevel level);
+
+/** The level of the table of levels putting the closest number of ticks to \p targetCount between \p startTime and \p endTime.
+ @discussion Since the levels are far apart, the number of ticks can be a few more or a few less than \p targetCount. The levels are 1, 2, 5, 10, 15 and 30 seconds or minutes, 1, 2, 3, 6 and 12 hours, 1 and 2 days, 1 week, 1, 2, 3 and 6 months, and 1, 2, 5, 10... years. */
+BEMTimeTickLevel BEMTimeTickLevelForRange(double startTime, double endTime, size_t targetCount);
+
+//----- TICKS -----//
+
+/** Returns the number of seconds the wall clock of a time zone is ahead of UTC at \p time.
+ @discussion The offset changes with daylight saving time, so it is asked for every tick instead of once for the range. */
+typedef double (*BEMTimeZoneOffsetFunction)(void *context, double time);
+
+/** The wall clock time of the last tick of \p level at or before the wall clock time \p localTime.
+ @discussion Wall clock times are the seconds since 1970 of the time displayed by the clock of a time zone, as if it were UTC: the time plus the offset of the time zone at that time. The ticks fall on midnights and first days of the month of that clock. */
+double BEMTimeTickFloor(BEMTimeTickLevel level, double localTime);
+
+/// The wall clock time of the tick of \p level following the tick at the wall clock time \p localTick
+double BEMTimeTickNext(BEMTimeTickLevel level, double localTick);
+
+/** Writes the ticks of the level picked by \p BEMTimeTickLevelForRange between \p startTime and \p endTime, both included.
+ @discussion Times are seconds since 1970 in UTC, like \p NSDate.timeIntervalSince1970. The ticks are laid out on the wall clock of \p offsetOfTime, then every tick is converted back to UTC with the offset in effect at that tick, so ticks on both sides of a daylight saving time change fall on local midnights. Wall clock times skipped when the clock moves forward are moved by the change, and ticks not after the previous one are dropped.
+ @param offsetOfTime The offset of the time zone the ticks are displayed in, UTC if NULL.
+ @param level Receives the level of the ticks, to pick how they are formatted.
+ @param ticks Receives the time of every tick, in increasing order. Must hold \p capacity times.
+ @return The number of ticks written, 0 if the range is not finite or empty. */
+size_t BEMTimeTicksMake(double startTime, double endTime, size_t targetCount, BEMTimeZoneOffsetFunction offsetOfTime, void *context, BEMTimeTickLevel *level, double *ticks, size_t capacity);
+
+//----- MAPPING -----//
+
+/** Mapping from the time of a point to its x coordinate, computed once per layout from the visible range.
+ @discussion A point at \p time is placed at x = (time - \p startTime) * \p scale, so the points keep the spacing of their times instead of being evenly spaced by index. */
+typedef struct BEMTimeAxis {
+    /// The time placed at x = 0
+    double startTime;
+    /// The horizontal distance between two times one second apart
+    double scale;
+} BEMTimeAxis;
+
+/// The mapping placing \p startTime at x = 0 and \p endTime at x = \p width. Every time is placed at 0 when the range is empty.
+BEMTimeAxis BEMTimeAxisMake(double startTime, double endTime, float width);
+
+/// Returns the x coordinate of \p time
+static inline float BEMTimeAxisX(const BEMTimeAxis *axis, double time) {
+    return (float)((time - axis->startTime) * axis->scale);
+}
+
+/// Writes the x coordinate of \p count times in one pass
+void BEMTimeAxisPlacePoints(const BEMTimeAxis *axis, const double *times, size_t count, float *x);
+
+/// Returns true if every time of \p times is finite and no smaller than the one before it
+bool BEMTimeAxisTimesAreSorted(const double *times, size_t count);
+
+/// Binary search of the sorted \p times. Returns the index of the first time at or after \p time, or \p count if every time is before it.
+size_t BEMTimeAxisIndexOfTime(const double *times, size_t count, double time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,149 @@
+//
+//  BEMValueWindow.c
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#include "BEMValueWindow.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline double BEMValueWindowValueAtPosition(const BEMValueWindow *window, uint64_t position) {
+    return window->values[position - window->firstPosition];
+}
+
+static inline uint64_t *BEMValueWindowDequeSlot(const BEMValueWindow *window, uint64_t *positions, size_t head, size_t index) {
+    return &positions[(head + index) % window->dequeCapacity];
+}
+
+/// Copies a deque to the start of a bigger ring buffer
+static uint64_t *BEMValueWindowGrowDeque(const BEMValueWindow *window, uint64_t *positions, size_t head, size_t count, size_t capacity) {
+    uint64_t *grownPositions = malloc(sizeof(uint64_t) * capacity);
+    if (grownPositions == NULL) return NULL;
+    for (size_t i = 0; i < count; i++) grownPositions[i] = *BEMValueWindowDequeSlot(window, positions, head, i);
+    return grownPositions;
+}
+
+/// Makes sure the deques can hold every value of the window, since each value is at most once in each deque
+static bool BEMValueWindowReserveDeques(BEMValueWindowRef window, size_t count) {
+    if (count <= window->dequeCapacity) return true;
+
+    size_t capacity = window->dequeCapacity < 8 ? 16 : window->dequeCapacity * 2;
+    if (capacity < count) capacity = count;
+    uint64_t *minimumPositions = BEMValueWindowGrowDeque(window, window->minimumPositions, window->minimumHead, window->minimumCount, capacity);
+    uint64_t *maximumPositions = BEMValueWindowGrowDeque(window, window->maximumPositions, window->maximumHead, window->maximumCount, capacity);
+    if (minimumPositions == NULL || maximumPositions == NULL) {
+        free(minimumPositions);
+        free(maximumPositions);
+        return false;
+    }
+
+    free(window->minimumPositions);
+    free(window->maximumPositions);
+    window->minimumPositions = minimumPositions;
+    window->maximumPositions = maximumPositions;
+    window->minimumHead = 0;
+    window->maximumHead = 0;
+    window->dequeCapacity = capacity;
+    return true;
+}
+
+/// Makes room for \p count more values after the last value
+static bool BEMValueWindowReserveValues(BEMValueWindowRef window, size_t count) {
+    size_t offset = window->values - window->storage;
+    size_t requiredCount = window->count + count;
+    if (offset + requiredCount <= window->capacity) return true;
+
+    // Enough values were removed from the start to pay for moving the others back to the start of the storage
+    if (requiredCount <= window->capacity / 2) {
+        memmove(window->storage, window->values, sizeof(double) * window->count);
+        window->values = window->storage;
+        return true;
+    }
+
+    size_t capacity = window->capacity < 8 ? 16 : window->capacity * 2;
+    if (capacity < requiredCount) capacity = requiredCount;
+    double *storage = malloc(sizeof(double) * capacity);
+    if (storage == NULL) return false;
+    if (window->count > 0) memcpy(storage, window->values, sizeof(double) * window->count);
+    free(window->storage);
+    window->storage = storage;
+    window->values = storage;
+    window->capacity = capacity;
+    return true;
+}
+
+BEMValueWindowRef BEMValueWindowCreate(size_t capacity, double nullValue) {
+    BEMValueWindowRef window = calloc(1, sizeof(BEMValueWindow));
+    if (window == NULL) return NULL;
+
+    window->nullValue = nullValue;
+    window->storage = malloc(sizeof(double) * (capacity > 0 ? capacity : 1));
+    window->values = window->storage;
+    window->capacity = capacity;
+    if (window->storage == NULL || !BEMValueWindowReserveDeques(window, capacity)) {
+        BEMValueWindowFree(window);
+        return NULL;
+    }
+    return window;
+}
+
+void BEMValueWindowFree(BEMValueWindowRef window) {
+    if (window == NULL) return;
+    free(window->storage);
+    free(window->minimumPositions);
+    free(window->maximumPositions);
+    free(window);
+}
+
+bool BEMValueWindowAppendValues(BEMValueWindowRef window, const double *values, size_t count) {
+    if (!BEMValueWindowReserveValues(window, count) || !BEMValueWindowReserveDeques(window, window->count + count)) return false;
+
+    for (size_t i = 0; i < count; i++) {
+        double value = values[i];
+        uint64_t position = window->firstPosition + window->count;
+        window->values[window->count++] = value;
+        if (value == window->nullValue || isnan(value)) continue;
+
+        // A value is never the minimum again once a smaller or equal value comes after it, and the other way around for the maximum
+        while (window->minimumCount > 0 && BEMValueWindowValueAtPosition(window, *BEMValueWindowDequeSlot(window, window->minimumPositions, window->minimumHead, window->minimumCount - 1)) >= value) {
+            window->minimumCount--;
+        }
+        *BEMValueWindowDequeSlot(window, window->minimumPositions, window->minimumHead, window->minimumCount++) = position;
+
+        while (window->maximumCount > 0 && BEMValueWindowValueAtPosition(window, *BEMValueWindowDequeSlot(window, window->maximumPositions, window->maximumHead, window->maximumCount - 1)) <= value) {
+            window->maximumCount--;
+        }
+        *BEMValueWindowDequeSlot(window, window->maximumPositions, window->maximumHead, window->maximumCount++) = position;
+    }
+    return true;
+}
+
+void BEMValueWindowRemoveValuesFromStart(BEMValueWindowRef window, size_t count) {
+    if (count > window->count) count = window->count;
+    window->values += count;
+    window->count -= count;
+    window->firstPosition += count;
+
+    // The extremes which left the window are at the head of the deques
+    while (window->minimumCount > 0 && window->minimumPositions[window->minimumHead] < window->firstPosition) {
+        window->minimumHead = (window->minimumHead + 1) % window->dequeCapacity;
+        window->minimumCount--;
+    }
+    while (window->maximumCount > 0 && window->maximumPositions[window->maximumHead] < window->firstPosition) {
+        window->maximumHead = (window->maximumHead + 1) % window->dequeCapacity;
+        window->maximumCount--;
+    }
+
+    if (window->count == 0) window->values = window->storage;
+}
+
+bool BEMValueWindowGetExtremes(const BEMValueWindow *window, double *minimum, double *maximum) {
+    if (window->minimumCount == 0) return false;
+    *minimum = BEMValueWindowValueAtPosition(window, window->minimumPositions[window->minimumHead]);
+    *maximum = BEMValueWindowValueAtPosition(window, window->maximumPositions[window->maximumHead]);
+    return true;
+}
@@ -0,0 +1,67 @@
+//
+//  BEMValueWindow.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#ifndef BEMValueWindow_h
+#define BEMValueWindow_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Sliding window of values for streamed series: values are appended at the end and removed from the start.
+ @discussion Appending and removing values costs O(1) amortized. The values always stay contiguous in memory: instead of wrapping around like a ring buffer, the window moves its values back to the start of its storage once enough values have been removed to pay for the copy. The smallest and biggest values are tracked with two monotonic deques, so they are available in O(1) whatever values leave the window. Null values are kept in the window but ignored by the extremes.
+
+ Only \p values and \p count should be read, the other fields are private. */
+typedef struct BEMValueWindow {
+    /// The values of the window, oldest first. Valid until the next append.
+    double *values;
+    /// The number of values in the window
+    size_t count;
+
+    /// The value ignored by the extremes
+    double nullValue;
+    /// The allocated values, \p values points inside of it
+    double *storage;
+    size_t capacity;
+    /// The position of \p values[0] since the window was created
+    uint64_t firstPosition;
+
+    /// Positions of the candidate minimums (increasing values) and maximums (decreasing values), as ring buffers of \p dequeCapacity positions
+    uint64_t *minimumPositions;
+    uint64_t *maximumPositions;
+    size_t minimumHead, minimumCount;
+    size_t maximumHead, maximumCount;
+    size_t dequeCapacity;
+} BEMValueWindow;
+
+typedef BEMValueWindow *BEMValueWindowRef;
+
+
+/// Creates an empty window able to hold \p capacity values without reallocating. Values equal to \p nullValue (or NaN) are ignored by the extremes. Returns NULL if the memory could not be allocated.
+BEMValueWindowRef BEMValueWindowCreate(size_t capacity, double nullValue);
+
+/// Frees the window. Passing NULL does nothing.
+void BEMValueWindowFree(BEMValueWindowRef window);
+
+/// Appends \p count values at the end of the window. Returns false if the memory could not be allocated, in which case the window is left untouched.
+bool BEMValueWindowAppendValues(BEMValueWindowRef window, const double *values, size_t count);
+
+/// Removes the \p count oldest values of the window. Removing more values than the window holds empties it.
+void BEMValueWindowRemoveValuesFromStart(BEMValueWindowRef window, size_t count);
+
+/// Gets the smallest and biggest non-null values of the window in O(1). Returns false if the window has no non-null value, in which case \p minimum and \p maximum are left untouched.
+bool BEMValueWindowGetExtremes(const BEMValueWindow *window, double *minimum, double *maximum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+//
+//  BEMViewReusePool.h
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+@import Foundation;
+@import UIKit;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The kinds of views a graph draws again on every reload
+typedef NS_ENUM(NSInteger, BEMReusableViewKind) {
+    /// A UILabel of the X-Axis
+    BEMReusableViewKindXAxisLabel,
+    /// A UILabel of the Y-Axis
+    BEMReusableViewKindYAxisLabel,
+    /// The background of a permanent popup, a BEMPermanentPopupView
+    BEMReusableViewKindPopUpView,
+    /// The text of a permanent popup, a BEMPermanentPopupLabel
+    BEMReusableViewKindPopUpLabel,
+    /// A dot drawn as a view, a BEMCircle
+    BEMReusableViewKindDot
+};
+
+
+/** Views removed from a graph, kept until the graph needs a view of the same kind again instead of allocating a new one.
+ @discussion Like table view cells, a dequeued view keeps most of the properties it had when it was enqueued, so every property set by the graph must be set again. Enqueued views are removed from their superview, their animations are stopped and their alpha and transform are reset. The pool is emptied when the application receives a memory warning. */
+@interface BEMViewReusePool : NSObject
+
+/// The maximum number of views kept for each kind, the views enqueued past this limit are released. Default is 2048.
+@property (nonatomic) NSUInteger maximumViewsPerKind;
+
+/// The number of views returned from the pool, for debugging
+@property (nonatomic, readonly) NSUInteger reuseCount;
+
+/// The number of views created because the pool had no view of their kind, for debugging
+@property (nonatomic, readonly) NSUInteger creationCount;
+
+/// Removes the view from its superview and keeps it for the next view dequeued with the same kind
+- (void)enqueueView:(UIView *)view ofKind:(BEMReusableViewKind)kind;
+
+/// Returns a view enqueued with \p kind, or a new instance of \p viewClass with an empty frame if there is none
+- (__kindof UIView *)dequeueViewOfKind:(BEMReusableViewKind)kind class:(Class)viewClass;
+
+/// The number of views of a kind waiting to be reused
+- (NSUInteger)numberOfViewsOfKind:(BEMReusableViewKind)kind;
+
+/// Releases every view of the pool
+- (void)removeAllViews;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,69 @@
+//
+//  BEMViewReusePool.m
+//  SimpleLineGraph
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+#import "BEMViewReusePool.h"
+
+/// The number of values of BEMReusableViewKind
+static const NSInteger BEMReusableViewKindCount = BEMReusableViewKindDot + 1;
+
+@interface BEMViewReusePool () {
+    /// The views waiting to be reused, one array per kind
+    NSMutableArray<UIView *> *viewsOfKind[BEMReusableViewKindCount];
+}
+
+@end
+
+@implementation BEMViewReusePool
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _maximumViewsPerKind = 2048;
+        for (NSInteger kind = 0; kind < BEMReusableViewKindCount; kind++) viewsOfKind[kind] = [NSMutableArray array];
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(removeAllViews) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)enqueueView:(UIView *)view ofKind:(BEMReusableViewKind)kind {
+    [view removeFromSuperview];
+
+    NSMutableArray<UIView *> *views = viewsOfKind[kind];
+    if (views.count >= self.maximumViewsPerKind) return;
+
+    [view.layer removeAllAnimations];
+    view.alpha = 1;
+    view.transform = CGAffineTransformIdentity;
+    [views addObject:view];
+}
+
+- (__kindof UIView *)dequeueViewOfKind:(BEMReusableViewKind)kind class:(Class)viewClass {
+    NSMutableArray<UIView *> *views = viewsOfKind[kind];
+    UIView *view = views.lastObject;
+    if (view) {
+        [views removeLastObject];
+        _reuseCount++;
+        return view;
+    }
+
+    _creationCount++;
+    return [[viewClass alloc] initWithFrame:CGRectZero];
+}
+
+- (NSUInteger)numberOfViewsOfKind:(BEMReusableViewKind)kind {
+    return viewsOfKind[kind].count;
+}
+
+- (void)removeAllViews {
+    for (NSInteger kind = 0; kind < BEMReusableViewKindCount; kind++) [viewsOfKind[kind] removeAllObjects];
+}
+
+@end
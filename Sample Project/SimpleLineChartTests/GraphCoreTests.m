@@ -0,0 +1,936 @@
+//
+//  GraphCoreTests.m
+//  SimpleLineChart
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+@import XCTest;
+#import "BEMSimpleLineGraphView.h"
+#import "BEMPointBuffer.h"
+#import "BEMStatistics.h"
+#import "BEMDecimation.h"
+#import "BEMPointLookup.h"
+#import "BEMValueWindow.h"
+#import "BEMGraphRenderer.h"
+#import "BEMGraphTransform.h"
+#import "BEMBatchRenderer.h"
+#import "BEMRangeTree.h"
+#import "BEMSeriesFile.h"
+#import "BEMLabelLayout.h"
+#import "BEMAxisTicks.h"
+#import "BEMTimeAxis.h"
+#import "BEMGraphMetrics.h"
+
+/// Number of values used by the performance tests
+static const NSInteger benchmarkNumberOfValues = 100000;
+
+/// Tests for the plain C building blocks used by the graph's drawing pipeline.
+@interface GraphCoreTests : XCTestCase
+
+@end
+
+@implementation GraphCoreTests
+
+#pragma mark Point Buffer
+
+- (void)testPointBufferAppend {
+    BEMPointBufferRef buffer = BEMPointBufferCreate(0);
+    XCTAssert(buffer != NULL, @"A point buffer with no initial capacity should still be created");
+
+    for (NSInteger i = 0; i < 1000; i++) {
+        XCTAssert(BEMPointBufferAppendPoint(buffer, i, i * 2), @"Appending a point should grow the buffer");
+    }
+    XCTAssert(buffer->count == 1000, @"The buffer should hold every appended point");
+    XCTAssert(buffer->x[999] == 999 && buffer->y[999] == 1998, @"The points should keep their order after the buffer grew");
+
+    BEMPointBufferRemoveAllPoints(buffer);
+    XCTAssert(buffer->count == 0 && buffer->capacity >= 1000, @"Removing the points should keep the capacity");
+    BEMPointBufferRelease(buffer);
+}
+
+- (void)testPointBufferEndpoints {
+    BEMPointBufferRef buffer = BEMPointBufferCreate(3);
+    BEMPointBufferAppendPoint(buffer, 10, 1);
+    BEMPointBufferAppendPoint(buffer, 20, BEMPointBufferNullValue);
+    BEMPointBufferAppendPoint(buffer, 30, 3);
+
+    BEMPointBufferSetEndpoints(buffer, 0, 100, 40, 100);
+    XCTAssert(buffer->x[-1] == 0 && buffer->y[-1] == 100, @"The first endpoint should be stored before the first point");
+    XCTAssert(buffer->x[3] == 40 && buffer->y[3] == 100, @"The last endpoint should be stored after the last point");
+    XCTAssert(buffer->count == 3 && buffer->x[0] == 10 && buffer->y[2] == 3, @"Setting the endpoints should not change the points");
+    XCTAssert(BEMPointBufferIsNull(buffer->y[1]), @"Missing points should be stored as null values");
+    BEMPointBufferRelease(buffer);
+}
+
+- (void)testPointBufferPerformance {
+    [self measureBlock:^{
+        BEMPointBufferRef buffer = BEMPointBufferCreate(100000);
+        for (NSInteger i = 0; i < 100000; i++) {
+            BEMPointBufferAppendPoint(buffer, i, i);
+        }
+        BEMPointBufferRelease(buffer);
+    }];
+}
+
+#pragma mark Statistics
+
+/// Computes a statistic the way the graph used to, with a predicate filtering out null values and an expression
+- (NSNumber *)expressionValueForFunction:(NSString *)function values:(NSArray *)values {
+    NSArray *filteredValues = [values filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSNumber *value, NSDictionary *bindings) {
+        return ![value isEqualToNumber:@(BEMNullGraphValue)];
+    }]];
+    NSExpression *expression = [NSExpression expressionForFunction:function arguments:@[[NSExpression expressionForConstantValue:filteredValues]]];
+    id value = [expression expressionValueWithObject:nil context:nil];
+    return [value isKindOfClass:[NSArray class]] ? [value firstObject] : value;
+}
+
+- (void)testStatisticsMatchExpressions {
+    double values[] = {4, 1, BEMNullGraphValue, 7, 3, 3, 9, BEMNullGraphValue, 2, 8};
+    NSInteger count = sizeof(values) / sizeof(values[0]);
+    NSMutableArray *boxedValues = [NSMutableArray array];
+    for (NSInteger i = 0; i < count; i++) [boxedValues addObject:@(values[i])];
+
+    BEMStatistics statistics;
+    XCTAssert(BEMStatisticsCompute(values, count, BEMNullGraphValue, &statistics));
+    XCTAssert(statistics.count == 8, @"Null values should be skipped");
+    XCTAssertEqualWithAccuracy(statistics.sum, [self expressionValueForFunction:@"sum:" values:boxedValues].doubleValue, 1e-9);
+    XCTAssertEqualWithAccuracy(statistics.average, [self expressionValueForFunction:@"average:" values:boxedValues].doubleValue, 1e-9);
+    XCTAssertEqualWithAccuracy(statistics.median, [self expressionValueForFunction:@"median:" values:boxedValues].doubleValue, 1e-9);
+    XCTAssertEqualWithAccuracy(statistics.mode, [self expressionValueForFunction:@"mode:" values:boxedValues].doubleValue, 1e-9);
+    XCTAssertEqualWithAccuracy(statistics.standardDeviation, [self expressionValueForFunction:@"stddev:" values:boxedValues].doubleValue, 1e-9);
+    XCTAssertEqualWithAccuracy(statistics.minimum, [self expressionValueForFunction:@"min:" values:boxedValues].doubleValue, 1e-9);
+    XCTAssertEqualWithAccuracy(statistics.maximum, [self expressionValueForFunction:@"max:" values:boxedValues].doubleValue, 1e-9);
+}
+
+- (void)testStatisticsPerformance {
+    double *values = malloc(sizeof(double) * benchmarkNumberOfValues);
+    for (NSInteger i = 0; i < benchmarkNumberOfValues; i++) values[i] = arc4random_uniform(1000);
+
+    [self measureBlock:^{
+        BEMStatistics statistics;
+        BEMStatisticsCompute(values, benchmarkNumberOfValues, BEMNullGraphValue, &statistics);
+    }];
+    free(values);
+}
+
+- (void)testExpressionStatisticsPerformance {
+    NSMutableArray *values = [NSMutableArray arrayWithCapacity:benchmarkNumberOfValues];
+    for (NSInteger i = 0; i < benchmarkNumberOfValues; i++) [values addObject:@(arc4random_uniform(1000))];
+
+    // The previous implementation: one filtered copy and one expression per statistic
+    [self measureBlock:^{
+        for (NSString *function in @[@"sum:", @"average:", @"median:", @"mode:", @"stddev:", @"min:", @"max:"]) {
+            [self expressionValueForFunction:function values:values];
+        }
+    }];
+}
+
+#pragma mark Decimation
+
+/// Creates a buffer of \p count points forming a noisy sine wave, with one missing point every 5000 points
+- (BEMPointBufferRef)createWavePointsWithCount:(NSInteger)count {
+    BEMPointBufferRef points = BEMPointBufferCreate(count);
+    for (NSInteger i = 0; i < count; i++) {
+        float y = (i % 5000 == 7) ? BEMPointBufferNullValue : (float)(sin(i * 0.001) * 100 + arc4random_uniform(10));
+        BEMPointBufferAppendPoint(points, i, y);
+    }
+    return points;
+}
+
+- (void)testDecimationKeepsEnvelope {
+    BEMPointBufferRef points = [self createWavePointsWithCount:benchmarkNumberOfValues];
+    BEMPointBufferRef decimatedPoints = BEMPointBufferCreate(0);
+    size_t threshold = 1000;
+    size_t *indices = malloc(sizeof(size_t) * threshold);
+
+    float minimum = INFINITY, maximum = -INFINITY;
+    for (size_t i = 0; i < points->count; i++) {
+        if (BEMPointBufferIsNull(points->y[i])) continue;
+        minimum = MIN(minimum, points->y[i]);
+        maximum = MAX(maximum, points->y[i]);
+    }
+
+    size_t keptCount = BEMDecimateMinMax(points, threshold, decimatedPoints, indices);
+    XCTAssert(keptCount > 0 && keptCount <= threshold, @"The points should be reduced to the threshold");
+    float decimatedMinimum = INFINITY, decimatedMaximum = -INFINITY;
+    for (size_t i = 0; i < keptCount; i++) {
+        XCTAssert(i == 0 || indices[i] > indices[i - 1], @"The kept points should stay in their original order");
+        XCTAssert(decimatedPoints->x[i] == points->x[indices[i]], @"The indices should point to the original points");
+        if (BEMPointBufferIsNull(decimatedPoints->y[i])) continue;
+        decimatedMinimum = MIN(decimatedMinimum, decimatedPoints->y[i]);
+        decimatedMaximum = MAX(decimatedMaximum, decimatedPoints->y[i]);
+    }
+    XCTAssert(decimatedMinimum == minimum && decimatedMaximum == maximum, @"The min-max decimation should keep the envelope of the points");
+
+    keptCount = BEMDecimateLargestTriangleThreeBuckets(points, threshold, decimatedPoints, indices);
+    XCTAssert(keptCount == threshold, @"The LTTB decimation should keep exactly the threshold");
+    XCTAssert(indices[0] == 0 && indices[keptCount - 1] == points->count - 1, @"The first and last points should always be kept");
+
+    free(indices);
+    BEMPointBufferRelease(decimatedPoints);
+    BEMPointBufferRelease(points);
+}
+
+- (void)testDecimationKeepsGaps {
+    BEMPointBufferRef points = BEMPointBufferCreate(100);
+    for (NSInteger i = 0; i < 100; i++) BEMPointBufferAppendPoint(points, i, (i >= 40 && i < 60) ? BEMPointBufferNullValue : i);
+    BEMPointBufferRef decimatedPoints = BEMPointBufferCreate(0);
+    size_t indices[10];
+
+    size_t keptCount = BEMDecimateMinMax(points, 10, decimatedPoints, indices);
+    BOOL keptGap = NO;
+    for (size_t i = 0; i < keptCount; i++) keptGap |= BEMPointBufferIsNull(decimatedPoints->y[i]);
+    XCTAssert(keptGap, @"A column made only of missing points should keep a missing point");
+
+    keptCount = BEMDecimateLargestTriangleThreeBuckets(points, 3, decimatedPoints, indices);
+    XCTAssert(keptCount == 3 && !BEMPointBufferIsNull(decimatedPoints->y[1]), @"Missing points should not be kept when a bucket has other points");
+
+    keptCount = BEMDecimateMinMax(points, 2, decimatedPoints, indices);
+    XCTAssert(keptCount == 2 && indices[0] == 0 && indices[1] == 99, @"A threshold of 2 should keep the ends of the series");
+
+    BEMPointBufferRelease(decimatedPoints);
+    BEMPointBufferRelease(points);
+}
+
+- (void)testDecimationPerformance {
+    BEMPointBufferRef points = [self createWavePointsWithCount:benchmarkNumberOfValues * 10];
+    BEMPointBufferRef decimatedPoints = BEMPointBufferCreate(0);
+    size_t threshold = 2 * 375;
+    size_t *indices = malloc(sizeof(size_t) * threshold);
+
+    [self measureBlock:^{
+        BEMDecimateLargestTriangleThreeBuckets(points, threshold, decimatedPoints, indices);
+        BEMDecimateMinMax(points, threshold, decimatedPoints, indices);
+    }];
+
+    free(indices);
+    BEMPointBufferRelease(decimatedPoints);
+    BEMPointBufferRelease(points);
+}
+
+#pragma mark Point Lookup
+
+- (void)testPointLookupFindsClosestPoint {
+    BEMPointBufferRef points = BEMPointBufferCreate(5);
+    BEMPointBufferAppendPoint(points, 0, 1);
+    BEMPointBufferAppendPoint(points, 10, BEMPointBufferNullValue);
+    BEMPointBufferAppendPoint(points, 20, 1);
+    BEMPointBufferAppendPoint(points, 30, 1);
+    BEMPointBufferAppendPoint(points, 5, 1);
+
+    BEMPointLookupRef lookup = BEMPointLookupCreate(points);
+    XCTAssert(lookup->count == 4, @"Missing points should be left out of the lookup");
+    XCTAssert(BEMPointLookupFindClosest(lookup, -100) == 0, @"A position before every point should return the first point");
+    XCTAssert(BEMPointLookupFindClosest(lookup, 100) == 3, @"A position after every point should return the last point");
+    XCTAssert(BEMPointLookupFindClosest(lookup, 6) == 4, @"Points should be found even if they were not sorted");
+    XCTAssert(BEMPointLookupFindClosest(lookup, 11) == 4, @"Missing points should never be returned");
+    XCTAssert(BEMPointLookupFindClosest(lookup, 25) == 2, @"When two points are equally close, the one on the left should be returned");
+    BEMPointLookupFree(lookup);
+
+    BEMPointBufferRemoveAllPoints(points);
+    lookup = BEMPointLookupCreate(points);
+    XCTAssert(BEMPointLookupFindClosest(lookup, 0) == BEMPointLookupNotFound, @"An empty lookup should not find any point");
+    BEMPointLookupFree(lookup);
+    BEMPointBufferRelease(points);
+}
+
+/// Measures 100 000 queries in a lookup of \p count points
+- (void)measurePointLookupWithCount:(NSInteger)count {
+    BEMPointBufferRef points = BEMPointBufferCreate(count);
+    for (NSInteger i = 0; i < count; i++) BEMPointBufferAppendPoint(points, i, 1);
+    BEMPointLookupRef lookup = BEMPointLookupCreate(points);
+
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < 100000; i++) {
+            BEMPointLookupFindClosest(lookup, (i * 7919) % count + 0.3f);
+        }
+    }];
+
+    BEMPointLookupFree(lookup);
+    BEMPointBufferRelease(points);
+}
+
+- (void)testPointLookupPerformance1000Points {
+    [self measurePointLookupWithCount:1000];
+}
+
+- (void)testPointLookupPerformance100000Points {
+    [self measurePointLookupWithCount:benchmarkNumberOfValues];
+}
+
+- (void)testPointLookupPerformance1000000Points {
+    [self measurePointLookupWithCount:benchmarkNumberOfValues * 10];
+}
+
+#pragma mark Value Window
+
+- (void)testValueWindowTracksExtremes {
+    BEMValueWindowRef window = BEMValueWindowCreate(4, BEMNullGraphValue);
+    double minimum, maximum;
+    XCTAssert(!BEMValueWindowGetExtremes(window, &minimum, &maximum), @"An empty window should not have extremes");
+
+    // Slide a window of 50 values over a pseudo-random series and compare with a full scan
+    double series[1000];
+    for (NSInteger i = 0; i < 1000; i++) series[i] = (i % 13 == 0) ? BEMNullGraphValue : (double)((i * 7919) % 101);
+    for (NSInteger i = 0; i < 1000; i++) {
+        XCTAssert(BEMValueWindowAppendValues(window, &series[i], 1), @"Appending a value should grow the window");
+        if (window->count > 50) BEMValueWindowRemoveValuesFromStart(window, 1);
+
+        double expectedMinimum = INFINITY, expectedMaximum = -INFINITY;
+        for (size_t j = 0; j < window->count; j++) {
+            XCTAssert(window->values[j] == series[i + 1 - window->count + j], @"The window should keep the latest values in order");
+            if (window->values[j] == BEMNullGraphValue) continue;
+            expectedMinimum = MIN(expectedMinimum, window->values[j]);
+            expectedMaximum = MAX(expectedMaximum, window->values[j]);
+        }
+        XCTAssert(BEMValueWindowGetExtremes(window, &minimum, &maximum), @"A window with values should have extremes");
+        XCTAssert(minimum == expectedMinimum && maximum == expectedMaximum, @"The extremes should match a full scan of the window");
+    }
+
+    BEMValueWindowRemoveValuesFromStart(window, 100);
+    XCTAssert(window->count == 0 && !BEMValueWindowGetExtremes(window, &minimum, &maximum), @"Removing more values than the window holds should empty it");
+    BEMValueWindowFree(window);
+}
+
+- (void)testValueWindowPerformance {
+    double *series = malloc(sizeof(double) * benchmarkNumberOfValues);
+    for (NSInteger i = 0; i < benchmarkNumberOfValues; i++) series[i] = sin(i * 0.01) * 100;
+
+    [self measureBlock:^{
+        // A live graph of 1000 points, updated one sample at a time
+        BEMValueWindowRef window = BEMValueWindowCreate(1000, BEMNullGraphValue);
+        double minimum, maximum;
+        for (NSInteger i = 0; i < benchmarkNumberOfValues; i++) {
+            BEMValueWindowAppendValues(window, &series[i], 1);
+            if (window->count > 1000) BEMValueWindowRemoveValuesFromStart(window, 1);
+            BEMValueWindowGetExtremes(window, &minimum, &maximum);
+        }
+        BEMValueWindowFree(window);
+    }];
+
+    free(series);
+}
+
+#pragma mark Range Tree
+
+- (void)testRangeTreeMatchesScan {
+    NSInteger count = 1000;
+    double *values = malloc(sizeof(double) * count);
+    for (NSInteger i = 0; i < count; i++) values[i] = (i % 97 == 0) ? BEMNullGraphValue : (double)((i * 7919) % 211);
+    BEMRangeTreeRef tree = BEMRangeTreeCreate(values, count, BEMNullGraphValue);
+
+    for (NSInteger start = 0; start < count; start += 37) {
+        for (NSInteger end = start; end <= count; end += 53) {
+            size_t expectedMinimum = BEMRangeTreeNotFound, expectedMaximum = BEMRangeTreeNotFound;
+            for (NSInteger i = start; i < end; i++) {
+                if (values[i] == BEMNullGraphValue) continue;
+                if (expectedMinimum == BEMRangeTreeNotFound || values[i] < values[expectedMinimum]) expectedMinimum = i;
+                if (expectedMaximum == BEMRangeTreeNotFound || values[i] > values[expectedMaximum]) expectedMaximum = i;
+            }
+            size_t minimum, maximum;
+            BOOL found = BEMRangeTreeFindExtremes(tree, start, end, &minimum, &maximum);
+            XCTAssert(found == (expectedMinimum != BEMRangeTreeNotFound), @"Ranges of missing values only should not have extremes");
+            XCTAssert(minimum == expectedMinimum && maximum == expectedMaximum, @"The tree should find the first lowest and highest values of [%ld, %ld)", (long)start, (long)end);
+        }
+    }
+
+    size_t indices[40];
+    size_t keptCount = BEMRangeTreeEnvelope(tree, 100, 900, 20, indices);
+    XCTAssert(keptCount > 20 && keptCount <= 40, @"The envelope should keep up to 2 values per column");
+    for (size_t i = 1; i < keptCount; i++) XCTAssert(indices[i] > indices[i - 1], @"The envelope should keep the values in their original order");
+
+    BEMRangeTreeFree(tree);
+    free(values);
+}
+
+- (void)testRangeTreeEnvelopePerformance {
+    // A year of minute-level values, reduced to a 375 points wide graph at every zoom level
+    NSInteger count = 525600;
+    double *values = malloc(sizeof(double) * count);
+    for (NSInteger i = 0; i < count; i++) values[i] = sin(i * 0.001) * 100 + (i % 13);
+    BEMRangeTreeRef tree = BEMRangeTreeCreate(values, count, BEMNullGraphValue);
+    size_t *indices = malloc(sizeof(size_t) * 2 * 375);
+
+    [self measureBlock:^{
+        for (NSInteger length = count; length > 1000; length /= 2) {
+            BEMRangeTreeEnvelope(tree, (count - length) / 2, (count + length) / 2, 375, indices);
+        }
+    }];
+
+    free(indices);
+    BEMRangeTreeFree(tree);
+    free(values);
+}
+
+#pragma mark Series File
+
+- (void)testSeriesFileRoundTrip {
+    NSInteger count = 10000;
+    double *values = malloc(sizeof(double) * count);
+    for (NSInteger i = 0; i < count; i++) values[i] = (i % 97 == 0) ? BEMNullGraphValue : sin(i * 0.01) * 100 + (i % 13);
+    values[1] = NAN;
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"GraphCoreTests.bemgraph"];
+    XCTAssert(BEMSeriesFileWrite(path.fileSystemRepresentation, values, count, BEMNullGraphValue, true), @"The file should be written");
+
+    BEMSeriesFileRef file = BEMSeriesFileOpen(path.fileSystemRepresentation);
+    XCTAssert(file != NULL && file->count == (size_t)count && file->tree != NULL, @"The file should be mapped with its tree");
+    XCTAssert(BEMSeriesFileVerify(file), @"The stored tree should only index the values of the file");
+    double minimum = INFINITY, maximum = -INFINITY;
+    for (NSInteger i = 0; i < count; i++) {
+        if (i == 1) {
+            XCTAssertEqual(file->values[i], BEMSeriesFileNullValue, @"NaN should be stored as a missing value");
+            continue;
+        }
+        XCTAssertEqual(file->values[i], values[i], @"The values should be stored as they are");
+        if (values[i] == BEMNullGraphValue) continue;
+        minimum = MIN(minimum, values[i]);
+        maximum = MAX(maximum, values[i]);
+    }
+    XCTAssert(file->minimumValue == minimum && file->maximumValue == maximum, @"The header should hold the extremes of the values");
+
+    BEMRangeTreeRef tree = BEMRangeTreeCreate(file->values, count, BEMSeriesFileNullValue);
+    size_t storedIndices[40], builtIndices[40];
+    size_t storedCount = BEMRangeTreeEnvelope(file->tree, 100, 9000, 20, storedIndices);
+    size_t builtCount = BEMRangeTreeEnvelope(tree, 100, 9000, 20, builtIndices);
+    XCTAssert(storedCount == builtCount && memcmp(storedIndices, builtIndices, sizeof(size_t) * builtCount) == 0, @"The stored tree should match a tree built from the values");
+    BEMRangeTreeFree(tree);
+    BEMSeriesFileClose(file);
+
+    // Truncated files are rejected
+    truncate(path.fileSystemRepresentation, sizeof(BEMSeriesFileHeader) + sizeof(double) * count / 2);
+    XCTAssert(BEMSeriesFileOpen(path.fileSystemRepresentation) == NULL && errno == EINVAL, @"A file shorter than its header describes should not be opened");
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    free(values);
+}
+
+- (void)testSeriesFileTreeSkipsStoredNulls {
+    // The caller's null value is -1, DBL_MAX is stored as a missing value all the same
+    double values[100];
+    for (NSInteger i = 0; i < 100; i++) values[i] = i;
+    values[5] = DBL_MAX;
+    values[7] = -1;
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"GraphCoreTestsNulls.bemgraph"];
+    XCTAssert(BEMSeriesFileWrite(path.fileSystemRepresentation, values, 100, -1, true), @"The file should be written");
+
+    BEMSeriesFileRef file = BEMSeriesFileOpen(path.fileSystemRepresentation);
+    size_t minimumIndex, maximumIndex;
+    XCTAssert(file != NULL && BEMRangeTreeFindExtremes(file->tree, 0, 100, &minimumIndex, &maximumIndex));
+    XCTAssert(maximumIndex == 99 && minimumIndex == 0, @"The stored tree should skip every value the file reads back as missing");
+    BEMSeriesFileClose(file);
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+#pragma mark Label Layout
+
+static bool GraphCoreTestsMeasure(void *context, const char *text, size_t length, float *width, float *height) {
+    (*(NSInteger *)context)++;
+    *width = 8.0f * length;
+    *height = 15;
+    return true;
+}
+
+- (void)testTextMetricsCacheMeasuresOnce {
+    NSInteger measureCount = 0;
+    BEMTextMetricsCacheRef cache = BEMTextMetricsCacheCreate(100);
+    float width, height;
+
+    for (NSInteger pass = 0; pass < 3; pass++) {
+        for (NSInteger i = 0; i < 50; i++) {
+            const char *text = [NSString stringWithFormat:@"%ld", (long)i].UTF8String;
+            XCTAssert(BEMTextMetricsCacheMeasure(cache, 1, text, strlen(text), GraphCoreTestsMeasure, &measureCount, &width, &height));
+            XCTAssert(width == 8.0f * strlen(text) && height == 15, @"The cache should return the measured size");
+        }
+    }
+    XCTAssert(measureCount == 50 && cache->hitCount == 100, @"Every text should only be measured once");
+
+    BEMTextMetricsCacheMeasure(cache, 2, "1", 1, GraphCoreTestsMeasure, &measureCount, &width, &height);
+    XCTAssert(measureCount == 51, @"The same text in another font should be measured again");
+
+    for (NSInteger i = 0; i < 200; i++) {
+        const char *text = [NSString stringWithFormat:@"label %ld", (long)i].UTF8String;
+        BEMTextMetricsCacheMeasure(cache, 1, text, strlen(text), GraphCoreTestsMeasure, &measureCount, &width, &height);
+    }
+    XCTAssert(cache->count <= 100, @"The cache should never keep more texts than its maximum");
+
+    BEMTextMetricsCacheFree(cache);
+}
+
+- (void)testLabelLayoutRemovesOverlaps {
+    // Labels 30 points wide every 20 points: every other label fits
+    BEMLabelBox boxes[10];
+    for (NSInteger i = 0; i < 10; i++) boxes[i] = (BEMLabelBox){20.0f * i, 0, 30, 15};
+    BEMLabelBox bounds = {0, 0, 200, 100};
+    size_t selected[10];
+    size_t keptCount = BEMLabelLayoutSelect(boxes, 10, bounds, BEMLabelAxisHorizontal, 0, selected);
+    XCTAssert(keptCount == 5, @"Every other label should be kept, the last one doesn't fit in the bounds");
+    for (size_t i = 0; i < keptCount; i++) XCTAssert(selected[i] == 2 * i, @"The labels should be kept in the order of the axis");
+
+    // The first labels have the priority, whatever their position
+    BEMLabelBox priorityBoxes[3] = {{0, 0, 15, 30}, {0, 80, 15, 20}, {0, 20, 15, 30}};
+    keptCount = BEMLabelLayoutSelect(priorityBoxes, 3, bounds, BEMLabelAxisVertical, 0, selected);
+    XCTAssert(keptCount == 2 && selected[0] == 0 && selected[1] == 1, @"A label overlapping a label before it should be removed");
+
+    // Popups on the same height go below their point when they would overlap
+    BEMLabelBox above[3] = {{0, 10, 40, 20}, {30, 10, 40, 20}, {100, 0, 40, 20}};
+    BEMLabelBox below[3] = {{0, 50, 40, 20}, {30, 50, 40, 20}, {100, 40, 40, 20}};
+    bool isBelow[3];
+    XCTAssert(BEMLabelLayoutPlacePopups(above, below, 3, 1, isBelow));
+    XCTAssert(!isBelow[0] && isBelow[1] && isBelow[2], @"Popups should go below when they overlap a popup or reach the top");
+}
+
+- (void)testLabelLayoutPerformance {
+    // A label for each of 10,000 points on a 2,000 points wide axis, measured through the cache
+    NSInteger count = 10000;
+    BEMLabelBox *boxes = malloc(sizeof(BEMLabelBox) * count);
+    size_t *selected = malloc(sizeof(size_t) * count);
+    char (*texts)[16] = malloc(16 * count);
+    for (NSInteger i = 0; i < count; i++) snprintf(texts[i], 16, "%ld:%02ld", (long)(i / 60), (long)(i % 60));
+    BEMTextMetricsCacheRef cache = BEMTextMetricsCacheCreate(2 * count);
+    NSInteger measureCount = 0;
+
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < count; i++) {
+            float width, height;
+            BEMTextMetricsCacheMeasure(cache, 1, texts[i], strlen(texts[i]), GraphCoreTestsMeasure, &measureCount, &width, &height);
+            boxes[i] = (BEMLabelBox){2000.0f * i / (count - 1) - width / 2, 385, width, height};
+        }
+        BEMLabelLayoutSelect(boxes, count, (BEMLabelBox){0, 0, 2000, 400}, BEMLabelAxisHorizontal, 2, selected);
+    }];
+    XCTAssert(measureCount == count, @"Every text should only be measured once");
+
+    BEMTextMetricsCacheFree(cache);
+    free(texts);
+    free(selected);
+    free(boxes);
+}
+
+#pragma mark Axis Ticks
+
+- (void)testAxisTicksUseNiceSteps {
+    XCTAssertEqual(BEMAxisNiceNumber(0.87, true), 1);
+    XCTAssertEqual(BEMAxisNiceNumber(1740, true), 2000);
+    XCTAssertEqual(BEMAxisNiceNumber(31, false), 50);
+
+    BEMAxisTicks ticks;
+    XCTAssert(BEMAxisTicksMake(3, 97, 5, 1, &ticks));
+    XCTAssert(ticks.first == 20 && ticks.step == 20 && ticks.count == 4, @"The ticks should be the multiples of a nice step within the range");
+
+    XCTAssert(BEMAxisTicksMake(-42, 1234, 4, 1, &ticks));
+    XCTAssert(ticks.first == 0 && ticks.step == 500 && BEMAxisTickValue(&ticks, ticks.count - 1) == 1000, @"The ticks should go through 0");
+
+    XCTAssert(BEMAxisTicksMake(0.13, 0.87, 5, 0, &ticks));
+    XCTAssert(ticks.count == 4 && fabs(BEMAxisTickValue(&ticks, 0) - 0.2) < 1e-12 && fabs(ticks.step - 0.2) < 1e-12, @"Small ranges should have decimal steps");
+    XCTAssert(BEMAxisTicksMake(0.13, 0.87, 5, 1, &ticks));
+    XCTAssert(ticks.count == 2 && ticks.first == 0.13 && BEMAxisTickValue(&ticks, 1) == 0.87, @"Without a whole step in the range, the ticks should be the extremes");
+
+    XCTAssert(BEMAxisTicksMake(5, 5, 3, 1, &ticks));
+    XCTAssert(ticks.count == 1 && ticks.first == 5, @"Equal extremes should have a single tick");
+    XCTAssertFalse(BEMAxisTicksMake(NAN, 5, 3, 1, &ticks), @"Extremes which are not finite should be rejected");
+}
+
+/// A time zone one hour ahead of UTC
+static double GraphCoreTestsOneHourAheadOfUTC(void *context, double time) {
+    return 3600;
+}
+
+/// A time zone observing daylight saving time until 2026-11-01 06:00 UTC
+static double GraphCoreTestsDaylightSavingOffset(void *context, double time) {
+    return time < 1793512800 ? -4 * 3600 : -5 * 3600;
+}
+
+- (void)testTimeTicksFallOnCalendarBoundaries {
+    // 2023-11-14 22:13:20 UTC
+    double start = 1700000000;
+    double ticks[64];
+    BEMTimeTickLevel level;
+
+    size_t count = BEMTimeTicksMake(start, start + 5 * 3600, 6, GraphCoreTestsOneHourAheadOfUTC, NULL, &level, ticks, 64);
+    XCTAssert(level.unit == BEMTimeUnitHour && level.multiple == 1 && count == 5, @"5 hours should be ticked every hour");
+    XCTAssertEqual(ticks[0], 1700002800, @"The first tick should be the first local hour after the start");
+    XCTAssertEqual(BEMTimeTickFloor(level, ticks[0] + 3600 + 1), ticks[0] + 3600, @"Ticks should be floored on the wall clock");
+
+    count = BEMTimeTicksMake(start, start + 400 * 86400.0, 5, NULL, NULL, &level, ticks, 64);
+    XCTAssert(level.unit == BEMTimeUnitMonth && level.multiple == 3 && count == 4, @"400 days should be ticked every quarter");
+    XCTAssertEqual(ticks[0], 1704067200, @"The first quarter should start on 2024-01-01");
+    XCTAssertEqual(ticks[1] - ticks[0], 91 * 86400.0, @"Quarters should follow the lengths of the months");
+
+    count = BEMTimeTicksMake(start, start + 20 * 86400.0, 4, NULL, NULL, &level, ticks, 64);
+    XCTAssert(level.unit == BEMTimeUnitWeek && count == 3 && ticks[0] == 1700438400, @"Weeks should start on Monday");
+    XCTAssertEqual(BEMTimeTicksMake(NAN, start, 4, NULL, NULL, &level, ticks, 64), 0U, @"Times which are not finite should be rejected");
+
+    // A clock 4 hours behind UTC until 2026-11-01 06:00 UTC, 5 hours after: every month still starts at local midnight
+    count = BEMTimeTicksMake(1788235200, 1788235200 + 150 * 86400.0, 5, GraphCoreTestsDaylightSavingOffset, NULL, &level, ticks, 64);
+    XCTAssert(level.unit == BEMTimeUnitMonth && level.multiple == 1 && count == 5, @"150 days should be ticked every month");
+    XCTAssertEqual(ticks[2], 1793505600, @"2026-11-01 should start at midnight with the offset before the change");
+    XCTAssertEqual(ticks[3], 1796101200, @"2026-12-01 should start at midnight with the offset after the change");
+
+    // Non-uniform times are placed at their time, and found back with a binary search
+    double times[] = {0, 10, 10, 40, 100};
+    BEMTimeAxis axis = BEMTimeAxisMake(times[0], times[4], 200);
+    float x[5];
+    BEMTimeAxisPlacePoints(&axis, times, 5, x);
+    XCTAssert(x[0] == 0 && x[1] == 20 && x[3] == 80 && x[4] == 200);
+    XCTAssertEqual(BEMTimeAxisIndexOfTime(times, 5, 10), 1U);
+    XCTAssertEqual(BEMTimeAxisIndexOfTime(times, 5, 41), 4U);
+    XCTAssertEqual(BEMTimeAxisIndexOfTime(times, 5, 101), 5U);
+    XCTAssert(BEMTimeAxisTimesAreSorted(times, 5));
+    times[2] = 5;
+    XCTAssertFalse(BEMTimeAxisTimesAreSorted(times, 5), @"Decreasing times should be rejected");
+}
+
+#pragma mark Graph Metrics
+
+- (void)testMetricsHistoryPercentiles {
+    BEMGraphMetricsHistoryRef history = BEMGraphMetricsHistoryCreate(100);
+    BEMGraphMetricsSummary summary;
+    XCTAssert(!BEMGraphMetricsHistorySummarize(history, BEMGraphMetricsStageTotal, &summary) && summary.count == 0, @"An empty history has no summary");
+
+    // Reloads taking 1 to 250 seconds, only the last 100 are kept
+    for (NSInteger i = 1; i <= 250; i++) {
+        BEMGraphMetrics metrics = {0};
+        metrics.durations[BEMGraphMetricsStageTotal] = i;
+        BEMGraphMetricsHistoryAdd(history, &metrics);
+    }
+    XCTAssert(BEMGraphMetricsHistorySummarize(history, BEMGraphMetricsStageTotal, &summary));
+    XCTAssert(summary.count == 100 && summary.maximum == 250 && summary.mean == 200.5, @"The history should only aggregate the last reloads");
+    XCTAssert(summary.p50 == 200 && summary.p99 == 249, @"Percentiles should use the nearest rank");
+
+    BEMGraphMetricsHistoryRemoveAll(history);
+    XCTAssert(history->count == 0, @"Removing every reload should empty the history");
+    BEMGraphMetricsHistoryFree(history);
+}
+
+#pragma mark Headless Rendering
+
+- (void)testGraphScaleMatchesGraphView {
+    BEMGraphScale scale = {0};
+    scale.minimumValue = 0;
+    scale.maximumValue = 100;
+    scale.height = 200;
+    scale.padding = BEMGraphScaleDefaultPadding(scale.height);
+    scale.autoScale = true;
+    XCTAssert(scale.padding == 90, @"The default padding should be capped at 90 points");
+    XCTAssertEqualWithAccuracy(BEMGraphScaleYPosition(&scale, 0), 200 - 45, 0.001, @"The smallest value should be half the padding above the bottom");
+    XCTAssertEqualWithAccuracy(BEMGraphScaleYPosition(&scale, 100), 45, 0.001, @"The biggest value should be half the padding under the top");
+
+    scale.maximumValue = 0;
+    XCTAssertEqualWithAccuracy(BEMGraphScaleYPosition(&scale, 0), 100, 0.001, @"A flat graph should be centered");
+}
+
+- (void)testTransformKernelsMatchScale {
+    const size_t count = 1003;
+    double *values = malloc(sizeof(double) * count);
+    for (size_t i = 0; i < count; i++) values[i] = i % 11 == 5 ? BEMNullGraphValue : (i % 13 == 7 ? NAN : sin(i * 0.1) * 1000);
+
+    BEMGraphScale scale = {0};
+    scale.minimumValue = -1000;
+    scale.maximumValue = 1000;
+    scale.height = 300;
+    scale.padding = 40;
+    scale.xAxisLabelHeight = 20;
+    scale.autoScale = true;
+    BEMGraphTransform transform = BEMGraphTransformMake(&scale, 500, count + 2);
+
+    // The scalar kernel is the reference, starting at index 2 like a graph updating its last points only
+    float *expectedX = malloc(sizeof(float) * count), *expectedY = malloc(sizeof(float) * count);
+    float *x = malloc(sizeof(float) * count), *y = malloc(sizeof(float) * count);
+    XCTAssert(BEMGraphTransformPointsWithKernel(BEMGraphTransformKernelScalar, &transform, values, count, BEMNullGraphValue, 2, expectedX, expectedY), @"The scalar kernel should always be available");
+    for (size_t i = 0; i < count; i++) {
+        BOOL isMissing = values[i] == BEMNullGraphValue || isnan(values[i]);
+        XCTAssert(isMissing ? BEMPointBufferIsNull(expectedY[i]) : expectedY[i] == BEMGraphScaleYPosition(&scale, values[i]), @"Every value should be placed by the scale");
+        XCTAssertEqualWithAccuracy(expectedX[i], (i + 2) * 500.0 / (count + 1), 0.001, @"The points should be spread evenly");
+    }
+
+    for (BEMGraphTransformKernel kernel = BEMGraphTransformKernelSSE2; kernel <= BEMGraphTransformKernelNEON; kernel++) {
+        if (!BEMGraphTransformKernelIsAvailable(kernel)) continue;
+        BEMGraphTransformPointsWithKernel(kernel, &transform, values, count, BEMNullGraphValue, 2, x, y);
+        XCTAssert(memcmp(x, expectedX, sizeof(float) * count) == 0, @"Every kernel should place the points at the same x coordinates");
+        for (size_t i = 0; i < count; i++) {
+            XCTAssert(BEMPointBufferIsNull(y[i]) ? BEMPointBufferIsNull(expectedY[i]) : y[i] == expectedY[i], @"Every kernel should place the points at the same y coordinates");
+        }
+    }
+
+    free(y);
+    free(x);
+    free(expectedY);
+    free(expectedX);
+    free(values);
+}
+
+- (void)testTransformPerformance {
+    // 1 million values mapped with the fastest kernel
+    const size_t count = 1000000;
+    double *values = malloc(sizeof(double) * count);
+    for (size_t i = 0; i < count; i++) values[i] = i % 64 == 63 ? BEMNullGraphValue : sin(i * 0.01) * 100;
+    float *x = malloc(sizeof(float) * count), *y = malloc(sizeof(float) * count);
+    BEMGraphScale scale = {-100, 100, 300, 90, 20, true};
+    BEMGraphTransform transform = BEMGraphTransformMake(&scale, 1000, count);
+
+    [self measureBlock:^{
+        BEMGraphTransformPoints(&transform, values, count, BEMNullGraphValue, 0, x, y);
+    }];
+
+    free(y);
+    free(x);
+    free(values);
+}
+
+- (void)testAreaPathExtendsLine {
+    BEMPointBufferRef points = BEMPointBufferCreate(0);
+    float y[5] = {10, 30, BEMPointBufferNullValue, 20, 40};
+    for (NSInteger i = 0; i < 5; i++) BEMPointBufferAppendPoint(points, i * 25, y[i]);
+
+    // Straight lines: the area is the points closed by two endpoints, as the fills were built before
+    BEMPathRef line = BEMPathCreate();
+    BEMPathRef area = BEMPathCreate();
+    BEMPathRef closedPoints = BEMPathCreate();
+    BEMPathAppendPoints(line, points->x, points->y, points->count, BEMCurveInterpolationNone);
+    BEMPathAppendArea(area, line, 0, 100, 50);
+    BEMPointBufferSetEndpoints(points, 0, 50, 100, 50);
+    BEMPathAppendPoints(closedPoints, points->x - 1, points->y - 1, points->count + 2, BEMCurveInterpolationNone);
+    XCTAssert(area->elementCount == closedPoints->elementCount && memcmp(area->elements, closedPoints->elements, area->elementCount) == 0, @"The area should have the elements of the closed points");
+    XCTAssert(area->pointCount == closedPoints->pointCount && memcmp(area->points, closedPoints->points, sizeof(float) * 2 * area->pointCount) == 0, @"The area should have the points of the closed points");
+
+    // Curves: the curve of the line is copied as it is
+    BEMPathRemoveAllElements(line);
+    BEMPathRemoveAllElements(area);
+    BEMPathAppendPoints(line, points->x, points->y, points->count, BEMCurveInterpolationQuadratic);
+    BEMPathAppendArea(area, line, 0, 100, 0);
+    XCTAssert(area->elementCount == line->elementCount + 2 && area->elements[1] == BEMPathElementLine && area->elements[area->elementCount - 1] == BEMPathElementLine, @"The area should join the line to the edge with straight lines");
+    XCTAssert(memcmp(area->elements + 2, line->elements + 1, line->elementCount - 1) == 0 && memcmp(area->points + 2, line->points, sizeof(float) * 2 * line->pointCount) == 0, @"The area should follow the curve of the line");
+    XCTAssert(area->points[0] == 0 && area->points[1] == 0 && area->points[2 * area->pointCount - 2] == 100 && area->points[2 * area->pointCount - 1] == 0, @"The area should start and end on the edge");
+
+    BEMPathFree(closedPoints);
+    BEMPathFree(area);
+    BEMPathFree(line);
+    BEMPointBufferRelease(points);
+}
+
+- (void)testCubicCurvesStayWithinPoints {
+    float y[9] = {10, 10, 40, 5, BEMPointBufferNullValue, 5, 30, 30, 31};
+    BEMPointBufferRef points = BEMPointBufferCreate(0);
+    for (NSInteger i = 0; i < 9; i++) BEMPointBufferAppendPoint(points, i * 20, y[i]);
+    size_t drawnCount = 8;
+
+    BEMPathRef quadratic = BEMPathCreate();
+    BEMPathAppendPoints(quadratic, points->x, points->y, points->count, BEMCurveInterpolationQuadratic);
+
+    BEMCurveInterpolation curves[2] = {BEMCurveInterpolationMonotoneCubic, BEMCurveInterpolationCatmullRom};
+    BEMPathRef line = BEMPathCreate();
+    for (NSInteger c = 0; c < 2; c++) {
+        BEMPathRemoveAllElements(line);
+        XCTAssert(BEMPathAppendPoints(line, points->x, points->y, points->count, curves[c]), @"Building the curve should succeed");
+        XCTAssert(line->elementCount == drawnCount && line->pointCount == 1 + 3 * (drawnCount - 1), @"There should be one cubic curve per segment");
+        XCTAssert(2 * line->elementCount - 1 == quadratic->elementCount, @"The cubic curve should have half the elements of the quadratic curve");
+
+        // The control points of every segment stay within the box of its points, so the curve can't overshoot
+        const float *segment = line->points;
+        for (size_t i = 1; i < line->elementCount; i++) {
+            XCTAssert(line->elements[i] == BEMPathElementCubicCurve, @"Every segment should be a cubic curve");
+            float startX = segment[0], startY = segment[1], endX = segment[6], endY = segment[7];
+            for (NSInteger p = 1; p <= 2; p++) {
+                XCTAssert(segment[2 * p] >= startX && segment[2 * p] <= endX, @"The control points should be between the points of the segment");
+                XCTAssert(segment[2 * p + 1] >= MIN(startY, endY) && segment[2 * p + 1] <= MAX(startY, endY), @"The curve should not overshoot the points of segment %zu", i);
+            }
+            if (curves[c] == BEMCurveInterpolationMonotoneCubic && startY == endY) {
+                XCTAssert(segment[3] == startY && segment[5] == startY, @"Flat runs should stay flat");
+            }
+            segment += 6;
+        }
+        XCTAssert(segment[0] == points->x[8] && segment[1] == 31, @"The curve should end on the last point");
+
+        // The flattened curve joins the same points
+        float *outline = NULL;
+        size_t outlineCapacity = 0;
+        size_t outlineCount = BEMPathFlatten(line, 0.25f, &outline, &outlineCapacity);
+        XCTAssert(outlineCount > line->elementCount, @"The curves should be split in several segments");
+        XCTAssert(outline[2 * outlineCount - 2] == points->x[8] && outline[2 * outlineCount - 1] == 31, @"The outline should end on the last point");
+        for (size_t i = 0; i < outlineCount; i++) XCTAssertEqualWithAccuracy(outline[2 * i + 1], MIN(MAX(outline[2 * i + 1], 5), 40), 1e-3, @"The outline should stay within the range of the values");
+        free(outline);
+    }
+
+    BEMPathFree(line);
+    BEMPathFree(quadratic);
+    BEMPointBufferRelease(points);
+}
+
+- (void)testNullValueFills {
+    float y[9] = {BEMPointBufferNullValue, 10, 20, BEMPointBufferNullValue, BEMPointBufferNullValue, 30, 40, 50, BEMPointBufferNullValue};
+    float x[9];
+    for (NSInteger i = 0; i < 9; i++) x[i] = i * 10;
+
+    BEMPointSegmentsRef segments = BEMPointSegmentsCreate();
+    XCTAssert(BEMPointSegmentsClassify(segments, y, 9), @"Classifying the points should succeed");
+    XCTAssert(segments->count == 2 && segments->pointCount == 5, @"There should be two runs of present points");
+    XCTAssert(segments->segments[0].start == 1 && segments->segments[0].count == 2 && segments->segments[1].start == 5 && segments->segments[1].count == 3, @"The runs should skip the missing points");
+
+    // Gaps: one subpath per run, and one closed area per subpath under the drawn points only
+    BEMPathRef line = BEMPathCreate();
+    BEMPathRef area = BEMPathCreate();
+    XCTAssert(BEMPathAppendSegments(line, x, y, segments, BEMCurveInterpolationMonotoneCubic, BEMNullValueFillGap), @"Building the line should succeed");
+    uint8_t gapElements[5] = {BEMPathElementMove, BEMPathElementLine, BEMPathElementMove, BEMPathElementCubicCurve, BEMPathElementCubicCurve};
+    XCTAssert(line->elementCount == 5 && memcmp(line->elements, gapElements, 5) == 0, @"Every run should be its own subpath, curved on its own points");
+    for (size_t i = 0; i < line->pointCount; i++) XCTAssert(!isnan(line->points[2 * i + 1]) && line->points[2 * i + 1] <= 50, @"The line should have no coordinate for missing points");
+
+    float startX, endX;
+    BEMPathAreaBounds(x, segments, BEMNullValueFillGap, 100, &startX, &endX);
+    XCTAssert(startX == 10 && endX == 70, @"The area should start and end under the first and last points");
+    XCTAssert(BEMPathAppendArea(area, line, startX, endX, 60), @"Building the area should succeed");
+    XCTAssert(area->elementCount == line->elementCount + 4, @"Every subpath should be closed on the edge");
+    XCTAssert(area->points[6] == 20 && area->points[7] == 60 && area->points[8] == 50 && area->points[9] == 60, @"The area should drop to the edge on both sides of the gap");
+
+    // Linear: one subpath joining both sides of the gap
+    BEMPathRemoveAllElements(line);
+    BEMPathAppendSegments(line, x, y, segments, BEMCurveInterpolationNone, BEMNullValueFillLinear);
+    BEMPathRef skippedLine = BEMPathCreate();
+    BEMPathAppendPoints(skippedLine, x, y, 9, BEMCurveInterpolationNone);
+    XCTAssert(line->elementCount == 5 && line->pointCount == skippedLine->pointCount && memcmp(line->points, skippedLine->points, sizeof(float) * 2 * line->pointCount) == 0, @"The linear fill should join the same points as skipping missing points");
+
+    // Previous: the value before a gap is held up to its last missing point, and up to the end of the line
+    BEMPathRemoveAllElements(line);
+    BEMPathAppendSegments(line, x, y, segments, BEMCurveInterpolationNone, BEMNullValueFillPrevious);
+    float heldPoints[14] = {10, 10, 20, 20, 40, 20, 50, 30, 60, 40, 70, 50, 80, 50};
+    XCTAssert(line->elementCount == 7 && memcmp(line->points, heldPoints, sizeof(heldPoints)) == 0, @"The held values should add one point at the end of every gap");
+
+    BEMPathFree(skippedLine);
+    BEMPathFree(area);
+    BEMPathFree(line);
+    BEMPointSegmentsFree(segments);
+}
+
+- (void)testRendererDrawsFillsAndLine {
+    size_t width = 100, height = 50;
+    uint8_t *pixels = malloc(width * height * 4);
+    BEMRasterCanvasRef canvas = BEMRasterCanvasCreate(pixels, width, height, width * 4);
+    BEMGraphRendererRef renderer = BEMGraphRendererCreate();
+
+    BEMGraphStyle style = BEMGraphStyleDefault();
+    style.topColor = (BEMRasterColor){1, 0, 0, 1};
+    style.bottomColor = (BEMRasterColor){0, 1, 0, 1};
+    style.lineColor = (BEMRasterColor){0, 0, 1, 1};
+    style.lineWidth = 2;
+    double values[4] = {1, 1, BEMNullGraphValue, 1};
+    XCTAssert(BEMGraphRendererRender(renderer, values, 4, BEMNullGraphValue, &style, canvas), @"Rendering should succeed");
+
+    // A flat graph is a horizontal line in the middle of the canvas
+    uint8_t *top = pixels + 5 * width * 4 + 50 * 4;
+    uint8_t *middle = pixels + 25 * width * 4 + 50 * 4;
+    uint8_t *bottom = pixels + 45 * width * 4 + 50 * 4;
+    XCTAssert(top[0] == 255 && top[1] == 0 && top[3] == 255, @"The area above the line should have the top color");
+    XCTAssert(bottom[1] == 255 && bottom[0] == 0, @"The area under the line should have the bottom color");
+    XCTAssert(middle[2] == 255 && middle[0] == 0 && middle[1] == 0, @"The line should be drawn over the fills, through the missing point");
+
+    size_t capacity = BEMRasterPNGSize(width, height);
+    uint8_t *png = malloc(capacity);
+    XCTAssert(BEMRasterEncodePNG(canvas, png, capacity - 1) == 0, @"Encoding should fail when the buffer is too small");
+    XCTAssert(BEMRasterEncodePNG(canvas, png, capacity) == capacity, @"The encoded size should be known in advance");
+    XCTAssert(memcmp(png, "\x89PNG\r\n\x1a\n", 8) == 0, @"The image should start with the PNG signature");
+    UIImage *image = [UIImage imageWithData:[NSData dataWithBytesNoCopy:png length:capacity freeWhenDone:NO]];
+    XCTAssert(image.size.width == width && image.size.height == height, @"The PNG image should be readable by UIKit");
+
+    free(png);
+    BEMGraphRendererFree(renderer);
+    BEMRasterCanvasFree(canvas);
+    free(pixels);
+}
+
+- (void)testRendererPerformance {
+    // 1000 sparkline thumbnails of 200 x 60 pixels, encoded as PNG
+    size_t width = 200, height = 60;
+    uint8_t *pixels = malloc(width * height * 4);
+    size_t capacity = BEMRasterPNGSize(width, height);
+    uint8_t *png = malloc(capacity);
+    BEMRasterCanvasRef canvas = BEMRasterCanvasCreate(pixels, width, height, width * 4);
+    BEMGraphRendererRef renderer = BEMGraphRendererCreate();
+    BEMGraphStyle style = BEMGraphStyleDefault();
+    double values[100];
+
+    [self measureBlock:^{
+        for (NSInteger graph = 0; graph < 1000; graph++) {
+            for (NSInteger i = 0; i < 100; i++) values[i] = sin((i + graph) * 0.2) * 50;
+            BEMGraphRendererRender(renderer, values, 100, BEMNullGraphValue, &style, canvas);
+            BEMRasterEncodePNG(canvas, png, capacity);
+        }
+    }];
+
+    BEMGraphRendererFree(renderer);
+    BEMRasterCanvasFree(canvas);
+    free(png);
+    free(pixels);
+}
+
+/// Stores the FNV-1a hash of every image of a batch at its index
+static void BEMBatchTestsOutput(void *context, size_t index, const uint8_t *bytes, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    ((uint64_t *)context)[index] = hash;
+}
+
+- (void)testBatchMatchesRenderer {
+    const size_t count = 500, width = 120, height = 40;
+    double *values = malloc(sizeof(double) * count * 100);
+    BEMBatchSeries *series = malloc(sizeof(BEMBatchSeries) * count);
+    for (size_t graph = 0; graph < count; graph++) {
+        // Uneven lengths, so some threads finish their share early and steal
+        series[graph].count = graph % 50 == 0 ? 100 : 2 + graph % 40;
+        series[graph].values = values + graph * 100;
+        for (size_t i = 0; i < series[graph].count; i++) values[graph * 100 + i] = (i % 7 == 3) ? BEMNullGraphValue : sin((graph + i) * 0.3) * graph;
+    }
+
+    uint64_t *hashes = calloc(count, sizeof(uint64_t));
+    BEMBatchOptions options = BEMBatchOptionsDefault(width, height);
+    options.threadCount = 4;
+    options.output = BEMBatchTestsOutput;
+    options.context = hashes;
+    BEMBatchStatistics statistics;
+    XCTAssert(BEMBatchRender(series, count, &options, &statistics), @"The batch should be rendered");
+    XCTAssert(statistics.imageCount == count && statistics.failedCount == 0, @"Every series should have an image");
+    XCTAssert(statistics.threadCount >= 1 && statistics.threadCount <= 4, @"The batch should use at most the requested threads");
+    XCTAssert(statistics.imagesPerSecond > 0 && statistics.layoutTime >= 0 && statistics.rasterizationTime > 0 && statistics.encodingTime > 0, @"The statistics should be filled");
+
+    // Every image should be the one the single-threaded renderer draws
+    uint64_t *expected = calloc(count, sizeof(uint64_t));
+    uint8_t *pixels = malloc(width * height * 4);
+    size_t capacity = BEMRasterPNGSize(width, height);
+    uint8_t *png = malloc(capacity);
+    BEMRasterCanvasRef canvas = BEMRasterCanvasCreate(pixels, width, height, width * 4);
+    BEMGraphRendererRef renderer = BEMGraphRendererCreate();
+    for (size_t graph = 0; graph < count; graph++) {
+        BEMGraphRendererRender(renderer, series[graph].values, series[graph].count, BEMNullGraphValue, &options.style, canvas);
+        BEMBatchTestsOutput(expected, graph, png, BEMRasterEncodePNG(canvas, png, capacity));
+    }
+    XCTAssert(memcmp(hashes, expected, sizeof(uint64_t) * count) == 0, @"The batch should render the same images as the renderer");
+
+    BEMGraphRendererFree(renderer);
+    BEMRasterCanvasFree(canvas);
+    free(png);
+    free(pixels);
+    free(expected);
+    free(hashes);
+    free(series);
+    free(values);
+}
+
+- (void)testBatchPerformance {
+    // 10000 sparkline thumbnails of 200 x 60 pixels, encoded as PNG on every core
+    const size_t count = 10000;
+    double *values = malloc(sizeof(double) * count * 100);
+    BEMBatchSeries *series = malloc(sizeof(BEMBatchSeries) * count);
+    for (size_t graph = 0; graph < count; graph++) {
+        series[graph].values = values + graph * 100;
+        series[graph].count = 100;
+        for (size_t i = 0; i < 100; i++) values[graph * 100 + i] = sin((i + graph) * 0.2) * 50;
+    }
+    BEMBatchOptions options = BEMBatchOptionsDefault(200, 60);
+
+    [self measureBlock:^{
+        BEMBatchRender(series, count, &options, NULL);
+    }];
+
+    free(series);
+    free(values);
+}
+
+@end
@@ -0,0 +1,101 @@
+//
+//  MultipleSeriesTests.m
+//  SimpleLineChart
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+@import XCTest;
+#import "BEMSimpleLineGraphView.h"
+#import "contantsTests.h"
+
+/// Same tags as in BEMSimpleLineGraphView.m
+typedef NS_ENUM(NSInteger, BEMInternalTags)
+{
+    LabelYAxisTag2000 = 2000,
+};
+
+/// Tests of graphs drawing several series, each series being \p pointValue times its number
+@interface MultipleSeriesTests : XCTestCase <BEMSimpleLineGraphDelegate, BEMSimpleLineGraphDataSource> {
+    /// Number returned by 'numberOfSeriesInLineGraph:'
+    NSInteger numberOfSeriesInTest;
+}
+
+@property (strong, nonatomic) BEMSimpleLineGraphView *lineGraph;
+
+@end
+
+@implementation MultipleSeriesTests
+
+- (void)setUp {
+    [super setUp];
+    
+    numberOfSeriesInTest = 3;
+    self.lineGraph = [[BEMSimpleLineGraphView alloc] initWithFrame:CGRectMake(0, 0, 200, 200)];
+    self.lineGraph.delegate = self;
+    self.lineGraph.dataSource = self;
+}
+
+#pragma mark BEMSimpleLineGraph Data Source
+
+- (NSInteger)numberOfPointsInLineGraph:(BEMSimpleLineGraphView * __nonnull)graph {
+    return numberOfPoints;
+}
+
+- (NSInteger)numberOfSeriesInLineGraph:(BEMSimpleLineGraphView * __nonnull)graph {
+    return numberOfSeriesInTest;
+}
+
+- (CGFloat)lineGraph:(BEMSimpleLineGraphView * __nonnull)graph valueForPointAtIndex:(NSInteger)index inSeries:(NSInteger)series {
+    return pointValue * (series + 1);
+}
+
+#pragma mark Tests
+
+- (void)testMultipleSeries {
+    self.lineGraph.animationGraphEntranceTime = 0.0;
+    [self.lineGraph reloadGraph];
+    
+    XCTAssert(self.lineGraph.numberOfSeries == 3, @"The graph should load as many series as 'numberOfSeriesInLineGraph:' returns");
+    XCTAssert([self.lineGraph valueForPointAtIndex:10 inSeries:2] == pointValue * 3, @"Every series should keep the values of the data source");
+    XCTAssert(isnan([self.lineGraph valueForPointAtIndex:10 inSeries:3]), @"Series out of range have no values");
+    XCTAssert([[self.lineGraph calculateMaximumPointValue] floatValue] == pointValue, @"Statistics describe the first series");
+    
+    NSMutableArray<BEMLine *> *lines = [NSMutableArray new];
+    for (UIView *subview in self.lineGraph.subviews) {
+        if ([subview isKindOfClass:[BEMLine class]]) [lines addObject:(BEMLine *)subview];
+    }
+    XCTAssert(lines.count == 3, @"Every series should be drawn with its own line");
+    
+    // One scale for every series: the biggest values are at the top of the graph, the smallest at the bottom
+    CGFloat firstY = lines[0].pointBuffer->y[0];
+    CGFloat secondY = lines[1].pointBuffer->y[0];
+    CGFloat thirdY = lines[2].pointBuffer->y[0];
+    XCTAssert(firstY > secondY && secondY > thirdY, @"The series should share the scale of the graph");
+    XCTAssert(lines[1].pointBuffer->x[50] == lines[0].pointBuffer->x[50], @"The series should share the x positions of the graph");
+    XCTAssert(lines[1].topColor == nil && lines[1].bottomColor == nil, @"Only the first series is filled");
+    
+    numberOfSeriesInTest = 1;
+    [self.lineGraph reloadGraph];
+    XCTAssert(self.lineGraph.numberOfSeries == 1, @"Reloading should drop the series which are gone");
+}
+
+- (void)testYAxisLabelsSpanEverySeries {
+    self.lineGraph.animationGraphEntranceTime = 0.0;
+    self.lineGraph.enableYAxisLabel = YES;
+    [self.lineGraph reloadGraph];
+    
+    NSMutableSet<NSString *> *texts = [NSMutableSet new];
+    for (UILabel *label in self.lineGraph.subviews) {
+        if ([label isKindOfClass:[UILabel class]] && label.tag == LabelYAxisTag2000) [texts addObject:label.text];
+    }
+    NSSet *expectedTexts = [NSSet setWithObjects:[NSString stringWithFormat:@"%.f", pointValue], [NSString stringWithFormat:@"%.f", pointValue * 2], [NSString stringWithFormat:@"%.f", pointValue * 3], nil];
+    XCTAssert([texts isEqualToSet:expectedTexts], @"The Y-Axis labels should go from the smallest value of every series to the biggest one");
+}
+
+- (void)tearDown {
+    self.lineGraph = nil;
+    [super tearDown];
+}
+
+@end
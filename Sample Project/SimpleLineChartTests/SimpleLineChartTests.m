@@ -22,7 +22,13 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
 };
 
 /// General, simple tests for BEMSimpleLineGraph. Mostly testing default values.
-@interface SimpleLineGraphTests : XCTestCase <BEMSimpleLineGraphDelegate, BEMSimpleLineGraphDataSource>
+@interface SimpleLineGraphTests : XCTestCase <BEMSimpleLineGraphDelegate, BEMSimpleLineGraphDataSource> {
+    /// Buffer returned by 'valuesForLineGraph:', NULL unless a test sets it
+    const double *valuesBuffer;
+    
+    /// The number of times 'lineGraph:didRecordMetrics:' was sent
+    NSInteger recordedMetricsCount;
+}
 
 @property (strong, nonatomic) BEMSimpleLineGraphView *lineGraph;
 
@@ -53,6 +59,16 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     return xAxisLabelString;
 }
 
+- (const double *)valuesForLineGraph:(BEMSimpleLineGraphView * __nonnull)graph {
+    return valuesBuffer;
+}
+
+#pragma mark BEMSimpleLineGraph Delegate
+
+- (void)lineGraph:(BEMSimpleLineGraphView *)graph didRecordMetrics:(BEMGraphMetrics)metrics {
+    recordedMetricsCount++;
+}
+
 #pragma mark Test Methods
 
 - (void)testInit {
@@ -94,6 +110,27 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     XCTAssert([values isEqualToArray:mockedValues], @"The array returned by 'graphValuesForDataPoints' should be similar than the one returned by the data source method 'valueForPointAtIndex:'labelOnXAxisForIndex:");
 }
 
+- (void)testValuesBuffer {
+    double *buffer = malloc(sizeof(double) * numberOfPoints);
+    for (NSInteger i = 0; i < numberOfPoints; i++) {
+        buffer[i] = (i == 1) ? BEMNullGraphValue : i;
+    }
+    valuesBuffer = buffer;
+    [self.lineGraph reloadGraph];
+    
+    NSArray *values = [self.lineGraph graphValuesForDataPoints];
+    XCTAssert(values.count == numberOfPoints, @"The number of data points should be equal to the number returned by the data source method 'numberOfPointsInLineGraph:'");
+    for (NSInteger i = 0; i < numberOfPoints; i++) {
+        XCTAssert([values[i] doubleValue] == (CGFloat)buffer[i], @"The values should be read from the buffer returned by the data source method 'valuesForLineGraph:'");
+    }
+    XCTAssert([self.lineGraph calculateMinimumPointValue].doubleValue == 0, @"Null values in the buffer should be ignored");
+    XCTAssert([self.lineGraph calculateMaximumPointValue].doubleValue == numberOfPoints - 1, @"The maximum value should come from the buffer");
+    
+    valuesBuffer = NULL;
+    [self.lineGraph reloadGraph];
+    free(buffer);
+}
+
 - (void)testDrawnPoints {
     self.lineGraph.animationGraphEntranceTime = 0.0;
     [self.lineGraph reloadGraph];
@@ -116,6 +153,366 @@ typedef NS_ENUM(NSInteger, BEMInternalTags)
     }
 }
 
+- (void)testDecimatedPoints {
+    // A 40 points wide graph draws at most 80 of the 100 points
+    self.lineGraph.frame = CGRectMake(0, 0, 40, 200);
+    self.lineGraph.animationGraphEntranceTime = 0.0;
+    
+    for (NSNumber *decimation in @[@(BEMLineDecimationLargestTriangleThreeBuckets), @(BEMLineDecimationMinMax)]) {
+        self.lineGraph.lineDecimation = decimation.integerValue;
+        [self.lineGraph reloadGraph];
+        
+        NSInteger numberOfDots = 0;
+        for (UIView *dot in self.lineGraph.subviews) {
+            if ([dot isKindOfClass:[BEMCircle class]] && dot.tag >= DotFirstTag100 && dot.tag <= DotLastTag1000) {
+                NSInteger index = dot.tag - DotFirstTag100;
+                XCTAssert(index >= 0 && index < numberOfPoints, @"Dots are expected to keep the index of their point in the data source");
+                XCTAssertEqualWithAccuracy(dot.center.x, index * 40.0 / (numberOfPoints - 1), 0.01, @"Dots are expected to be drawn at the position of their point in the data source");
+                numberOfDots++;
+            }
+        }
+        XCTAssert(numberOfDots > 0 && numberOfDots <= 80, @"The points should be reduced to twice the width of the graph");
+    }
+}
+
+- (void)testDotsLayer {
+    self.lineGraph.animationGraphEntranceTime = 0.0;
+    self.lineGraph.dotRendering = BEMDotRenderingLayer;
+    self.lineGraph.alwaysDisplayDots = YES;
+    [self.lineGraph reloadGraph];
+    
+    for (UIView *dot in self.lineGraph.subviews) {
+        XCTAssert(![dot isKindOfClass:[BEMCircle class]], @"No BEMCircle view is expected when the dots are rendered with a layer");
+    }
+    
+    NSMutableArray *dotsLayers = [NSMutableArray new];
+    for (CALayer *layer in self.lineGraph.layer.sublayers) {
+        if ([layer isKindOfClass:[BEMDotsLayer class]]) [dotsLayers addObject:layer];
+    }
+    XCTAssert(dotsLayers.count == 1, @"Every dot is expected to be drawn in a single BEMDotsLayer");
+    
+    BEMDotsLayer *dotsLayer = dotsLayers.firstObject;
+    XCTAssert(dotsLayer.pointBuffer->count == numberOfPoints, @"The dots layer should draw every point of the graph");
+    XCTAssert(dotsLayer.dotSize == 10.0, @"Dots are expected to have a default width of 10.0");
+    XCTAssert([dotsLayer.dotColor isEqual:[UIColor colorWithWhite:1.0 alpha:0.7]], @"Dots are expected to be white by default");
+    for (NSInteger i = 0; i < numberOfPoints; i++) {
+        XCTAssert([dotsLayer alphaForDotAtIndex:i] == 1.0, @"Dots are expected to be displayed when 'alwaysDisplayDots' is YES");
+    }
+    
+    dotsLayer.highlightedIndex = 3;
+    XCTAssert(dotsLayer.highlightedIndex == 3, @"Any dot of the graph can be highlighted");
+    dotsLayer.highlightedIndex = numberOfPoints;
+    XCTAssert(dotsLayer.highlightedIndex == NSNotFound, @"Highlighting a dot out of bounds should remove the highlight");
+}
+
+- (void)testIndexOfPointClosestToX {
+    double *buffer = malloc(sizeof(double) * numberOfPoints);
+    for (NSInteger i = 0; i < numberOfPoints; i++) {
+        buffer[i] = (i == 1) ? BEMNullGraphValue : i;
+    }
+    valuesBuffer = buffer;
+    [self.lineGraph reloadGraph];
+    
+    CGFloat pointSpacing = self.lineGraph.frame.size.width / (numberOfPoints - 1);
+    XCTAssert([self.lineGraph indexOfPointClosestToX:-10] == 0, @"A position before the graph should return the first point");
+    XCTAssert([self.lineGraph indexOfPointClosestToX:self.lineGraph.frame.size.width + 10] == numberOfPoints - 1, @"A position after the graph should return the last point");
+    XCTAssert([self.lineGraph indexOfPointClosestToX:pointSpacing * 10.2] == 10, @"The closest point to a position should be returned");
+    XCTAssert([self.lineGraph indexOfPointClosestToX:pointSpacing * 1.2] != 1, @"Null points should never be returned");
+    
+    valuesBuffer = NULL;
+    [self.lineGraph reloadGraph];
+    free(buffer);
+}
+
+- (void)testStreamingPoints {
+    [self.lineGraph reloadGraph];
+    
+    [self.lineGraph appendPoints:@[@(pointValue), @(pointValue)]];
+    XCTAssert([self.lineGraph indexOfPointClosestToX:self.lineGraph.frame.size.width + 10] == numberOfPoints + 1, @"Appended points should be added at the end of the graph");
+    XCTAssert([self.lineGraph calculatePointValueSum].doubleValue == pointValue * (numberOfPoints + 2), @"Appended points should be part of the calculations");
+    
+    [self.lineGraph removePointsFromStart:2];
+    XCTAssert([self.lineGraph indexOfPointClosestToX:self.lineGraph.frame.size.width + 10] == numberOfPoints - 1, @"Removed points should be taken out of the graph");
+    
+    [self.lineGraph appendPoints:@[@(pointValue * 2)]];
+    XCTAssert([self.lineGraph calculateMaximumPointValue].doubleValue == pointValue * 2, @"A new maximum should be found when a point is appended");
+    [self.lineGraph removePointsFromStart:numberOfPoints];
+    XCTAssert([self.lineGraph calculateMaximumPointValue].doubleValue == pointValue * 2, @"The maximum should follow the points left in the graph");
+    
+    [self.lineGraph reloadGraph];
+    XCTAssert([self.lineGraph calculatePointValueSum].doubleValue == pointValue * numberOfPoints, @"Reloading the graph should ask the data source for the values again");
+}
+
+- (void)testStreamingSlidesLine {
+    [self.lineGraph reloadGraph];
+    [self.lineGraph setNeedsLayout];
+    [self.lineGraph layoutIfNeeded];
+    BEMLine *line = [self drawnLine];
+    NSUInteger buildCount = line.geometry.buildCount;
+    
+    [self.lineGraph appendPoints:@[@(pointValue)]];
+    [self.lineGraph removePointsFromStart:1];
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert([self drawnLine] == line && line.geometry.buildCount == buildCount, @"A window sliding without changing the scale should add the new segment to the line instead of building it again");
+    XCTAssert(line.pointBuffer->count == numberOfPoints, @"The line should keep the number of points of the window");
+    XCTAssert([self.lineGraph indexOfPointClosestToX:self.lineGraph.frame.size.width + 10] == numberOfPoints - 1, @"The new point should be found at the end of the graph");
+    
+    [self.lineGraph appendPoints:@[@(pointValue * 2)]];
+    [self.lineGraph removePointsFromStart:1];
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert([self drawnLine].geometry.buildCount > buildCount, @"A new maximum changes the scale, the line should be built again");
+    XCTAssert(self.lineGraph.stagesUpdatedInLastLayout == (BEMGraphStageScale | BEMGraphStageGeometry | BEMGraphStageAxes), @"A new scale should move the points and the axes without reloading the graph");
+}
+
+- (void)testStaleStages {
+    [self.lineGraph reloadGraph];
+    [self.lineGraph setNeedsLayout];
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert(self.lineGraph.stagesUpdatedInLastLayout == (BEMGraphStageGeometry | BEMGraphStageAxes), @"The first layout pass after a reload should only place the points and axes for the size of the graph");
+    
+    [self.lineGraph setNeedsLayout];
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert(self.lineGraph.numberOfStagesUpdatedInLastLayout == 0, @"A layout pass without stale stages should not update anything");
+    
+    self.lineGraph.colorLine = [UIColor redColor];
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert(self.lineGraph.stagesUpdatedInLastLayout == BEMGraphStageStyle, @"Changing a color should only update the style");
+    
+    self.lineGraph.enableBezierCurve = YES;
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert(self.lineGraph.stagesUpdatedInLastLayout == (BEMGraphStageGeometry | BEMGraphStageAxes), @"Changing the curve should move the line");
+    
+    self.lineGraph.labelFont = [UIFont systemFontOfSize:20];
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert(self.lineGraph.stagesUpdatedInLastLayout & BEMGraphStageScale, @"Changing the font should measure the labels again");
+    
+    [self.lineGraph setNeedsUpdateOfStages:BEMGraphStageScale];
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert(self.lineGraph.stagesUpdatedInLastLayout == BEMGraphStageScale, @"An unchanged scale should not move the points");
+    
+    self.lineGraph.frame = CGRectMake(0, 0, 300, 200);
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert(self.lineGraph.stagesUpdatedInLastLayout == (BEMGraphStageGeometry | BEMGraphStageAxes), @"Resizing the graph should move the points and the axes");
+    XCTAssert([self.lineGraph indexOfPointClosestToX:self.lineGraph.frame.size.width] == numberOfPoints - 1, @"The points should be placed for the new size");
+    
+    [self.lineGraph setNeedsUpdateOfStages:BEMGraphStageData];
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert(self.lineGraph.numberOfStagesUpdatedInLastLayout == 5, @"Stale data should update every stage");
+}
+
+- (BEMLine *)drawnLine {
+    BEMLine *drawnLine;
+    for (UIView *subview in self.lineGraph.subviews) {
+        if ([subview isKindOfClass:[BEMLine class]]) drawnLine = (BEMLine *)subview;
+    }
+    [drawnLine layoutIfNeeded];
+    UIGraphicsBeginImageContext(drawnLine.bounds.size);
+    [drawnLine.layer renderInContext:UIGraphicsGetCurrentContext()];
+    UIGraphicsEndImageContext();
+    return drawnLine;
+}
+
+- (void)testLineGeometryIsReused {
+    [self.lineGraph reloadGraph];
+    [self.lineGraph setNeedsLayout];
+    [self.lineGraph layoutIfNeeded];
+    BEMLineGeometry *geometry = [self drawnLine].geometry;
+    NSUInteger buildCount = geometry.buildCount;
+    XCTAssert(geometry.linePath != NULL && geometry.topAreaPath != NULL && geometry.bottomAreaPath != NULL, @"Drawing the line should build its paths");
+    
+    self.lineGraph.colorLine = [UIColor redColor];
+    [self.lineGraph setNeedsUpdateOfStages:BEMGraphStageStyle];
+    [self.lineGraph layoutIfNeeded];
+    BEMLine *line = [self drawnLine];
+    XCTAssert(line.geometry == geometry && geometry.buildCount == buildCount, @"Redrawing the same points should reuse the paths");
+    
+    CGRect bottomArea = CGPathGetBoundingBox(geometry.bottomAreaPath);
+    CGRect lineBounds = CGPathGetBoundingBox(geometry.linePath);
+    XCTAssert(CGRectGetMaxY(bottomArea) == line.frame.size.height && CGRectGetMinY(bottomArea) == CGRectGetMinY(lineBounds), @"The area under the line should be closed along the bottom edge");
+    XCTAssert(CGRectGetMinY(CGPathGetBoundingBox(geometry.topAreaPath)) == 0, @"The area above the line should be closed along the top edge");
+    
+    self.lineGraph.frame = CGRectMake(0, 0, 300, 200);
+    [self.lineGraph layoutIfNeeded];
+    [self drawnLine];
+    XCTAssert(geometry.buildCount == buildCount + 1, @"Moving the points should build the paths again");
+}
+
+- (void)testLineLayersAreUpdatedInPlace {
+    self.lineGraph.enableReferenceAxisFrame = YES;
+    [self.lineGraph reloadGraph];
+    [self.lineGraph layoutIfNeeded];
+    BEMLine *line = [self drawnLine];
+    NSArray<CALayer *> *layers = line.layer.sublayers;
+    
+    self.lineGraph.colorLine = [UIColor redColor];
+    self.lineGraph.widthLine = 7;
+    [self.lineGraph setNeedsUpdateOfStages:BEMGraphStageStyle];
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert([self drawnLine] == line, @"A style change should keep the line");
+    XCTAssertEqualObjects(line.layer.sublayers, layers, @"A style change should neither add nor replace layers");
+    
+    BOOL lineIsRestyled = NO;
+    for (CALayer *layer in layers) {
+        if (![layer isKindOfClass:[CAShapeLayer class]] || layer.hidden) continue;
+        CAShapeLayer *shapeLayer = (CAShapeLayer *)layer;
+        if (shapeLayer.lineWidth == 7 && CGColorEqualToColor(shapeLayer.strokeColor, [UIColor redColor].CGColor)) lineIsRestyled = YES;
+    }
+    XCTAssert(lineIsRestyled, @"The line layer should have the new color and width");
+    
+    [self.lineGraph reloadGraph];
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert([self drawnLine] == line && [line.layer.sublayers isEqualToArray:layers], @"Reloading should update the same line and layers");
+}
+
+- (void)testViewsAreReusedAcrossReloads {
+    self.lineGraph.alwaysDisplayPopUpLabels = YES;
+    [self.lineGraph reloadGraph];
+    NSSet *labels = [NSSet setWithArray:[self.lineGraph graphLabelsForXAxis]];
+    NSSet *subviews = [NSSet setWithArray:self.lineGraph.subviews];
+    NSUInteger creationCount = self.lineGraph.viewReusePool.creationCount;
+    XCTAssert(creationCount > 0, @"The first load should create the views");
+    
+    [self.lineGraph reloadGraph];
+    XCTAssert(self.lineGraph.viewReusePool.creationCount == creationCount, @"Reloading a graph with the same shape should not create views");
+    XCTAssert([[NSSet setWithArray:[self.lineGraph graphLabelsForXAxis]] isEqualToSet:labels], @"The X-Axis labels should be reused");
+    for (UIView *subview in self.lineGraph.subviews) {
+        if ([subview isKindOfClass:[BEMCircle class]] || [subview isKindOfClass:[BEMPermanentPopupView class]] || [subview isKindOfClass:[BEMPermanentPopupLabel class]] || subview.tag == LabelYAxisTag2000) {
+            XCTAssert([subviews containsObject:subview], @"The dots, popups and Y-Axis labels should be reused");
+        } else if (subview.tag == BackgroundXAxisTag2200 || subview.tag == BackgroundYAxisTag2100) {
+            XCTAssert([subviews containsObject:subview], @"The backgrounds of the axes should be updated in place");
+        }
+    }
+    
+    self.lineGraph.alwaysDisplayPopUpLabels = NO;
+    [self.lineGraph reloadGraph];
+    XCTAssert([self.lineGraph.viewReusePool numberOfViewsOfKind:BEMReusableViewKindPopUpView] == numberOfPoints, @"The popups which are not displayed anymore should wait in the pool");
+}
+
+- (void)testAsynchronousReload {
+    self.lineGraph.animationGraphEntranceTime = 0.0;
+    [self.lineGraph reloadGraph];
+    NSArray *values = [self.lineGraph graphValuesForDataPoints];
+    
+    double *buffer = malloc(sizeof(double) * numberOfPoints);
+    for (NSInteger i = 0; i < numberOfPoints; i++) {
+        buffer[i] = i;
+    }
+    valuesBuffer = buffer;
+    
+    // The first reload is superseded by the second one before it's applied
+    XCTestExpectation *supersededExpectation = [self expectationWithDescription:@"Superseded reload"];
+    XCTestExpectation *appliedExpectation = [self expectationWithDescription:@"Applied reload"];
+    [self.lineGraph reloadGraphAsynchronouslyWithCompletion:^(BOOL applied) {
+        XCTAssert(applied == NO, @"A reload superseded by a later one should not be applied");
+        [supersededExpectation fulfill];
+    }];
+    [self.lineGraph reloadGraphAsynchronouslyWithCompletion:^(BOOL applied) {
+        XCTAssert(applied == YES, @"The last reload should be applied");
+        [appliedExpectation fulfill];
+    }];
+    XCTAssert([[self.lineGraph graphValuesForDataPoints] isEqualToArray:values], @"The graph should keep its values until the reload is applied");
+    
+    // The buffer is copied on the reload queue, it can be released as soon as the reload is applied
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    valuesBuffer = NULL;
+    free(buffer);
+    
+    XCTAssert([self.lineGraph valueForPointAtIndex:10 inSeries:0] == 10, @"The values fetched on the reload queue should be displayed");
+    XCTAssert([[self.lineGraph calculateMaximumPointValue] integerValue] == numberOfPoints - 1, @"The statistics computed on the reload queue should be used");
+    XCTAssert([self.lineGraph indexOfPointClosestToX:self.lineGraph.frame.size.width + 10] == numberOfPoints - 1, @"The points should be drawn");
+    
+    [self.lineGraph reloadGraph];
+    XCTAssert([self.lineGraph valueForPointAtIndex:10 inSeries:0] == pointValue, @"A synchronous reload should fetch the values again");
+}
+
+- (void)testPerformanceMetrics {
+    self.lineGraph.animationGraphEntranceTime = 0.0;
+    [self.lineGraph reloadGraph];
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    XCTAssert(recordedMetricsCount == 0, @"Metrics should only be recorded when enabled");
+    
+    // The metrics are sent once the run loop committed the reload
+    self.lineGraph.enablePerformanceMetrics = YES;
+    for (NSInteger reload = 0; reload < 3; reload++) {
+        [self.lineGraph reloadGraph];
+        [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    }
+    XCTAssert(recordedMetricsCount == 3, @"Every reload should be reported once");
+    
+    BEMGraphMetrics metrics = self.lineGraph.lastMetrics;
+    XCTAssert(metrics.pointCount == numberOfPoints && metrics.drawnPointCount == numberOfPoints, @"The metrics should count the points");
+    XCTAssert(metrics.labelCount > 0, @"The metrics should count the labels");
+    XCTAssert(metrics.createdViewCount == 0, @"Reloads of the same shape should reuse their views");
+    double stagesDuration = 0;
+    for (NSInteger stage = 0; stage < BEMGraphMetricsStageTotal; stage++) stagesDuration += metrics.durations[stage];
+    XCTAssert(stagesDuration > 0 && stagesDuration <= metrics.durations[BEMGraphMetricsStageTotal], @"The stages should be part of the whole reload");
+    
+    BEMGraphMetricsSummary summary = [self.lineGraph metricsSummaryForStage:BEMGraphMetricsStageTotal];
+    XCTAssert(summary.count == 3 && summary.p50 <= summary.p99 && summary.p99 <= summary.maximum, @"The summary should aggregate every recorded reload");
+}
+
+- (void)testVisibleIndexRange {
+    self.lineGraph.animationGraphEntranceTime = 0.0;
+    [self.lineGraph reloadGraph];
+    XCTAssert(NSEqualRanges(self.lineGraph.visibleIndexRange, NSMakeRange(0, numberOfPoints)), @"Every point should be visible by default");
+    
+    self.lineGraph.visibleIndexRange = NSMakeRange(90, 50);
+    XCTAssert(NSEqualRanges(self.lineGraph.visibleIndexRange, NSMakeRange(50, 50)), @"The visible range should be clamped to the points of the graph");
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert(self.lineGraph.stagesUpdatedInLastLayout == (BEMGraphStageScale | BEMGraphStageGeometry | BEMGraphStageAxes), @"Changing the visible range should not load the data again");
+    XCTAssert([self.lineGraph indexOfPointClosestToX:-1000] == 50 && [self.lineGraph indexOfPointClosestToX:1000] == numberOfPoints - 1, @"Only the visible points should be drawn across the graph, with their index in the data source");
+    
+    NSInteger numberOfDots = 0;
+    for (UIView *dot in self.lineGraph.subviews) {
+        if ([dot isKindOfClass:[BEMCircle class]] && dot.tag >= DotFirstTag100 && dot.tag <= DotLastTag1000) {
+            XCTAssert(dot.tag - DotFirstTag100 >= 50, @"Points scrolled out of the view should not have dots");
+            numberOfDots++;
+        }
+    }
+    XCTAssert(numberOfDots == 50, @"Every visible point should have a dot");
+    
+    // Zoomed out over more points than the width can display, the line is the envelope read from the tree
+    self.lineGraph.frame = CGRectMake(0, 0, 40, 200);
+    self.lineGraph.lineDecimation = BEMLineDecimationMinMax;
+    self.lineGraph.enableZooming = YES;
+    self.lineGraph.visibleIndexRange = NSMakeRange(0, 0);
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert(self.lineGraph.visibleIndexRange.length == numberOfPoints, @"A range of length 0 should show every point");
+    XCTAssert([self drawnLine].pointBuffer->count <= 80, @"The points should be reduced to twice the width of the graph");
+    
+    // The envelope doesn't depend on the decimation
+    self.lineGraph.lineDecimation = BEMLineDecimationNone;
+    self.lineGraph.visibleIndexRange = NSMakeRange(10, 90);
+    [self.lineGraph layoutIfNeeded];
+    XCTAssert([self drawnLine].pointBuffer->count <= 80, @"The points should be reduced to twice the width of the graph without a decimation");
+}
+
+- (void)testYAxisLabelsFollowVisibleRange {
+    double *buffer = malloc(sizeof(double) * numberOfPoints);
+    for (NSInteger i = 0; i < numberOfPoints; i++) {
+        buffer[i] = i;
+    }
+    valuesBuffer = buffer;
+    self.lineGraph.animationGraphEntranceTime = 0.0;
+    self.lineGraph.enableYAxisLabel = YES;
+    [self.lineGraph reloadGraph];
+    
+    self.lineGraph.visibleIndexRange = NSMakeRange(50, 50);
+    [self.lineGraph layoutIfNeeded];
+    
+    NSMutableArray<NSNumber *> *labelValues = [NSMutableArray new];
+    for (UILabel *label in self.lineGraph.subviews) {
+        if ([label isKindOfClass:[UILabel class]] && label.tag == LabelYAxisTag2000) [labelValues addObject:@(label.text.doubleValue)];
+    }
+    XCTAssert(labelValues.count > 0, @"The zoomed graph should have Y-Axis labels");
+    XCTAssert([[labelValues valueForKeyPath:@"@min.doubleValue"] doubleValue] == 50, @"The lowest Y-Axis label should be the lowest visible value");
+    XCTAssert([[labelValues valueForKeyPath:@"@max.doubleValue"] doubleValue] == numberOfPoints - 1, @"The highest Y-Axis label should be the highest visible value");
+    
+    valuesBuffer = NULL;
+    [self.lineGraph reloadGraph];
+    free(buffer);
+}
+    
 - (void)testGraphLabelsForXAxis {
     self.lineGraph.enableXAxisLabel = NO;
     [self.lineGraph reloadGraph];
@@ -0,0 +1,87 @@
+//
+//  TimeAxisTests.m
+//  SimpleLineChart
+//
+//  Copyright (c) 2016 Boris Emorine. All rights reserved.
+//
+
+@import XCTest;
+#import "BEMSimpleLineGraphView.h"
+
+/// 2026-09-01 at midnight in New York
+static const double timeAxisTestsStart = 1788235200;
+static const NSInteger timeAxisTestsNumberOfDays = 151;
+
+/// Tests of graphs placing their points at their time, one point a day
+@interface TimeAxisTests : XCTestCase <BEMSimpleLineGraphDelegate, BEMSimpleLineGraphDataSource> {
+    /// The time of every point, a day apart
+    double *timestamps;
+    NSTimeZone *previousTimeZone;
+}
+
+@property (strong, nonatomic) BEMSimpleLineGraphView *lineGraph;
+
+@end
+
+@implementation TimeAxisTests
+
+- (void)setUp {
+    [super setUp];
+    
+    timestamps = malloc(sizeof(double) * timeAxisTestsNumberOfDays);
+    for (NSInteger i = 0; i < timeAxisTestsNumberOfDays; i++) {
+        timestamps[i] = timeAxisTestsStart + i * 86400.0;
+    }
+    previousTimeZone = [NSTimeZone defaultTimeZone];
+    [NSTimeZone setDefaultTimeZone:[NSTimeZone timeZoneWithName:@"America/New_York"]];
+    
+    // Wide enough for about one tick a month over 150 days
+    self.lineGraph = [[BEMSimpleLineGraphView alloc] initWithFrame:CGRectMake(0, 0, 800, 200)];
+    self.lineGraph.delegate = self;
+    self.lineGraph.dataSource = self;
+}
+
+#pragma mark BEMSimpleLineGraph Data Source
+
+- (NSInteger)numberOfPointsInLineGraph:(BEMSimpleLineGraphView * __nonnull)graph {
+    return timeAxisTestsNumberOfDays;
+}
+
+- (CGFloat)lineGraph:(BEMSimpleLineGraphView * __nonnull)graph valueForPointAtIndex:(NSInteger)index {
+    return index % 7;
+}
+
+- (const double *)timestampsForLineGraph:(BEMSimpleLineGraphView * __nonnull)graph {
+    return timestamps;
+}
+
+#pragma mark Tests
+
+- (void)testMonthTicksAcrossDaylightSavingTime {
+    self.lineGraph.animationGraphEntranceTime = 0.0;
+    self.lineGraph.enableXAxisLabel = YES;
+    [self.lineGraph reloadGraph];
+    
+    // Daylight saving time ends on 2026-11-01, the months after it still start at midnight
+    NSCalendar *calendar = [NSCalendar calendarWithIdentifier:NSCalendarIdentifierGregorian];
+    calendar.timeZone = [NSTimeZone defaultTimeZone];
+    NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
+    [formatter setLocalizedDateFormatFromTemplate:@"yMMM"];
+    formatter.timeZone = [NSTimeZone defaultTimeZone];
+    
+    NSMutableArray<NSString *> *expectedTexts = [NSMutableArray new];
+    for (NSInteger month = 0; month < 5; month++) {
+        NSDate *firstDay = [calendar dateByAddingUnit:NSCalendarUnitMonth value:month toDate:[NSDate dateWithTimeIntervalSince1970:timeAxisTestsStart] options:0];
+        [expectedTexts addObject:[formatter stringFromDate:firstDay]];
+    }
+    XCTAssert([[self.lineGraph graphValuesForXAxis] isEqualToArray:expectedTexts], @"Every month from September to January should be labeled once");
+}
+
+- (void)tearDown {
+    self.lineGraph = nil;
+    free(timestamps);
+    [NSTimeZone setDefaultTimeZone:previousTimeZone];
+    [super tearDown];
+}
+
+@end